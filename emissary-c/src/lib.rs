@@ -125,6 +125,7 @@ impl EmissaryRouter {
             tcp_port: 0, // Will be assigned by OS
             udp_port: 0, // Will be assigned by OS
             host: "127.0.0.1".to_string(),
+            unix_socket: None,
         });
         
         // Disable transit tunnels for minimal resource usage
@@ -113,6 +113,7 @@ struct Ssu2Config {
 struct I2cpConfig {
     port: u16,
     host: Option<String>,
+    unix_socket: Option<String>,
 }
 
 #[derive(Debug, Serialize, Deserialize)]
@@ -120,6 +121,7 @@ pub struct SamConfig {
     tcp_port: u16,
     udp_port: u16,
     host: Option<String>,
+    unix_socket: Option<String>,
 }
 
 #[derive(Debug, Serialize, Deserialize)]
@@ -246,6 +248,7 @@ impl Default for EmissaryConfig {
             i2cp: Some(I2cpConfig {
                 port: 7654,
                 host: None,
+                unix_socket: None,
             }),
             metrics: Some(MetricsConfig { port: 7788 }),
             ntcp2: Some(Ntcp2Config {
@@ -279,6 +282,7 @@ impl Default for EmissaryConfig {
                 tcp_port: 7656,
                 udp_port: 7655,
                 host: None,
+                unix_socket: None,
             }),
             transit: Some(TransitConfig {
                 max_tunnels: Some(1000),
@@ -731,6 +735,7 @@ impl Config {
             i2cp_config: config.i2cp.map(|config| emissary_core::I2cpConfig {
                 port: config.port,
                 host: config.host.unwrap_or(String::from("127.0.0.1")),
+                unix_socket: config.unix_socket,
             }),
             insecure_tunnels: config.insecure_tunnels,
             log: config.log,
@@ -755,6 +760,7 @@ impl Config {
                 tcp_port: config.tcp_port,
                 udp_port: config.udp_port,
                 host: config.host.unwrap_or(String::from("127.0.0.1")),
+                unix_socket: config.unix_socket,
             }),
             server_tunnels: config.server_tunnels.unwrap_or(Vec::new()),
             signing_key,
@@ -870,6 +876,7 @@ impl Config {
             i2cp_config: config.i2cp.map(|config| emissary_core::I2cpConfig {
                 port: config.port,
                 host: config.host.unwrap_or(String::from("127.0.0.1")),
+                unix_socket: config.unix_socket,
             }),
             insecure_tunnels: config.insecure_tunnels,
             log: config.log,
@@ -894,6 +901,7 @@ impl Config {
                 tcp_port: config.tcp_port,
                 udp_port: config.udp_port,
                 host: config.host.unwrap_or(String::from("127.0.0.1")),
+                unix_socket: config.unix_socket,
             }),
             server_tunnels: config.server_tunnels.unwrap_or(Vec::new()),
             signing_key,
@@ -1360,6 +1368,7 @@ mod tests {
             i2cp: Some(I2cpConfig {
                 port: 0u16,
                 host: None,
+                unix_socket: None,
             }),
             ntcp2: Some(Ntcp2Config {
                 port: 1337u16,
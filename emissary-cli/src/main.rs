@@ -389,6 +389,9 @@ fn main() -> anyhow::Result<()> {
         }) => {
             std::thread::spawn(move || {
                 runtime.block_on(router_event_loop(router, port_mapper, shutdown_rx));
+
+                // drop tasks before exiting so listeners can clean up after themselves
+                drop(runtime);
                 std::process::exit(0);
             });
 
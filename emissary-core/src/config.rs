@@ -101,6 +101,9 @@ pub struct I2cpConfig {
 
     /// Host where the I2CP server shoud be bound to.
     pub host: String,
+
+    /// Path of the Unix domain socket the I2CP server should also listen on, if any.
+    pub unix_socket: Option<String>,
 }
 
 /// SAMv3 configuration.
@@ -114,6 +117,9 @@ pub struct SamConfig {
 
     /// Host where the SAM server shoud be bound to.
     pub host: String,
+
+    /// Path of the Unix domain socket the SAM server should also listen on, if any.
+    pub unix_socket: Option<String>,
 }
 
 /// Metrics configuration.
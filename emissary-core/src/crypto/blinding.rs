@@ -0,0 +1,361 @@
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//! Key blinding for encrypted lease sets.
+//!
+//! The signing key of a destination is blinded with a factor derived from the current date so
+//! that the lease set is stored under a different, unlinkable key every day.
+//!
+//! https://geti2p.net/spec/encryptedleaseset#key-blinding
+
+use crate::{
+    crypto::{hmac::hkdf, sha256::Sha256, SigningPrivateKey, SigningPublicKey},
+    runtime::Runtime,
+};
+
+use bytes::Bytes;
+use curve25519_elligator2::{
+    edwards::{CompressedEdwardsY, EdwardsPoint},
+    scalar::Scalar,
+};
+use rand_core::{CryptoRng, RngCore};
+use sha2::{Digest, Sha512};
+
+use alloc::vec::Vec;
+use core::time::Duration;
+
+/// Signature type of an unblinded Ed25519 key (EdDSA-SHA512-Ed25519).
+pub const SIG_TYPE_ED25519: u16 = 7u16;
+
+/// Signature type of a blinded Ed25519 key (RedDSA-SHA512-Ed25519).
+pub const SIG_TYPE_REDDSA: u16 = 11u16;
+
+/// Number of seconds in a day.
+const SECONDS_PER_DAY: u64 = 24 * 60 * 60;
+
+/// Get the UTC date of `since_epoch` as `YYYYMMDD`, used as input for the blinding factor.
+pub fn blinding_date(since_epoch: Duration) -> [u8; 8] {
+    // convert days since epoch to a civil date
+    //
+    // http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+    let days = since_epoch.as_secs() / SECONDS_PER_DAY;
+    let z = days + 719_468;
+    let era = z / 146_097;
+    let doe = z - era * 146_097;
+    let yoe = (doe - doe / 1_460 + doe / 36_524 - doe / 146_096) / 365;
+    let doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    let mp = (5 * doy + 2) / 153;
+    let day = doy - (153 * mp + 2) / 5 + 1;
+    let month = if mp < 10 { mp + 3 } else { mp - 9 };
+    let year = yoe + era * 400 + (month <= 2) as u64;
+
+    let mut out = [0u8; 8];
+    let mut value = year * 10_000 + month * 100 + day;
+
+    for byte in out.iter_mut().rev() {
+        *byte = b'0' + (value % 10) as u8;
+        value /= 10;
+    }
+
+    out
+}
+
+/// Hash `parts` with SHA-512 and reduce the digest modulo the group order.
+fn hash_to_scalar(parts: &[&[u8]]) -> Scalar {
+    let digest = parts
+        .iter()
+        .fold(Sha512::new(), |hasher, part| hasher.chain_update(part))
+        .finalize();
+
+    let mut wide = [0u8; 64];
+    wide.copy_from_slice(&digest);
+
+    Scalar::from_bytes_mod_order_wide(&wide)
+}
+
+/// Derive blinding factor `alpha` for `public_key` from `date` and optional `secret`.
+fn generate_alpha(public_key: &[u8; 32], date: &[u8; 8], secret: Option<&[u8]>) -> Scalar {
+    let salt = Sha256::new()
+        .update("I2PGenerateAlpha")
+        .update(public_key)
+        .update(SIG_TYPE_ED25519.to_be_bytes())
+        .update(SIG_TYPE_REDDSA.to_be_bytes())
+        .finalize_new();
+
+    let mut input = Vec::with_capacity(date.len() + secret.map_or(0usize, |secret| secret.len()));
+    input.extend_from_slice(date);
+
+    if let Some(secret) = secret {
+        input.extend_from_slice(secret);
+    }
+
+    let (first, second) = hkdf(&salt, &input, b"i2pblinding1");
+    let mut seed = [0u8; 64];
+    seed[..32].copy_from_slice(&first);
+    seed[32..].copy_from_slice(&second);
+
+    Scalar::from_bytes_mod_order_wide(&seed)
+}
+
+/// Blinded public key of a destination.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct BlindedPublicKey {
+    /// Blinded public key.
+    key: [u8; 32],
+
+    /// `NetDb` key of the encrypted lease set.
+    routing_key: Bytes,
+
+    /// Subcredential used to derive the encryption keys of the lease set.
+    subcredential: [u8; 32],
+}
+
+impl BlindedPublicKey {
+    /// Create [`BlindedPublicKey`] from the unblinded `key` and blinded public key `blinded`.
+    fn from_keys(key: &[u8; 32], blinded: [u8; 32]) -> Self {
+        let credential = Sha256::new()
+            .update("credential")
+            .update(key)
+            .update(SIG_TYPE_ED25519.to_be_bytes())
+            .update(SIG_TYPE_REDDSA.to_be_bytes())
+            .finalize_new();
+        let subcredential = Sha256::new()
+            .update("subcredential")
+            .update(credential)
+            .update(blinded)
+            .finalize_new();
+        let routing_key = Bytes::from(
+            Sha256::new().update(SIG_TYPE_REDDSA.to_be_bytes()).update(blinded).finalize(),
+        );
+
+        Self {
+            key: blinded,
+            routing_key,
+            subcredential,
+        }
+    }
+
+    /// Blind `public_key` of a destination using `date` and optional `secret`.
+    ///
+    /// Returns `None` if `public_key` is not an Ed25519 key or is not a valid point.
+    pub fn new(
+        public_key: &SigningPublicKey,
+        date: &[u8; 8],
+        secret: Option<&[u8]>,
+    ) -> Option<Self> {
+        let key = match public_key {
+            SigningPublicKey::Ed25519(key) => key.as_bytes(),
+            _ => return None,
+        };
+        let alpha = generate_alpha(key, date, secret);
+        let point = CompressedEdwardsY(*key).decompress()?;
+        let blinded = (point + EdwardsPoint::mul_base(&alpha)).compress().to_bytes();
+
+        Some(Self::from_keys(key, blinded))
+    }
+
+    /// Get `NetDb` key of the encrypted lease set.
+    pub fn routing_key(&self) -> &Bytes {
+        &self.routing_key
+    }
+
+    /// Get subcredential.
+    pub fn subcredential(&self) -> &[u8; 32] {
+        &self.subcredential
+    }
+
+    /// Get blinded key as a [`SigningPublicKey`] for signature verification.
+    pub fn verifying_key(&self) -> Option<SigningPublicKey> {
+        SigningPublicKey::from_bytes(&self.key)
+    }
+}
+
+impl AsRef<[u8]> for BlindedPublicKey {
+    fn as_ref(&self) -> &[u8] {
+        &self.key
+    }
+}
+
+/// Blinded signing key of a destination.
+#[derive(Clone)]
+pub struct BlindedSigningKey {
+    /// Blinded public key.
+    public: BlindedPublicKey,
+
+    /// Blinded private scalar.
+    scalar: Scalar,
+}
+
+impl BlindedSigningKey {
+    /// Blind `signing_key` of a destination using `date` and optional `secret`.
+    pub fn new(signing_key: &SigningPrivateKey, date: &[u8; 8], secret: Option<&[u8]>) -> Self {
+        match signing_key {
+            SigningPrivateKey::Ed25519(key) => {
+                let mut bytes = key.to_scalar_bytes();
+                bytes[0] &= 248;
+                bytes[31] &= 127;
+                bytes[31] |= 64;
+
+                let public = key.verifying_key().to_bytes();
+                let alpha = generate_alpha(&public, date, secret);
+                let scalar = Scalar::from_bytes_mod_order(bytes) + alpha;
+                let blinded = EdwardsPoint::mul_base(&scalar).compress().to_bytes();
+
+                Self {
+                    public: BlindedPublicKey::from_keys(&public, blinded),
+                    scalar,
+                }
+            }
+        }
+    }
+
+    /// Get blinded public key.
+    pub fn public(&self) -> &BlindedPublicKey {
+        &self.public
+    }
+
+    /// Sign `message` with RedDSA.
+    ///
+    /// The signature verifies as a regular Ed25519 signature under the blinded public key.
+    pub fn sign(&self, message: &[u8], mut csprng: impl RngCore + CryptoRng) -> Vec<u8> {
+        let mut nonce = [0u8; 80];
+        csprng.fill_bytes(&mut nonce);
+
+        let r = hash_to_scalar(&[&nonce, &self.public.key, message]);
+        let big_r = EdwardsPoint::mul_base(&r).compress();
+        let k = hash_to_scalar(&[big_r.as_bytes(), &self.public.key, message]);
+        let s = k * self.scalar + r;
+
+        let mut out = Vec::with_capacity(64);
+        out.extend_from_slice(big_r.as_bytes());
+        out.extend_from_slice(s.as_bytes());
+
+        out
+    }
+}
+
+/// Blinded signing key of a local destination, re-derived only when the date changes.
+pub struct LeaseSetBlinder {
+    /// Blinded key and the day it was derived for.
+    cached: Option<(u64, BlindedSigningKey)>,
+
+    /// Optional secret for the blinding factor.
+    secret: Option<Vec<u8>>,
+
+    /// Signing key of the destination.
+    signing_key: SigningPrivateKey,
+}
+
+impl LeaseSetBlinder {
+    /// Create new [`LeaseSetBlinder`].
+    pub fn new(signing_key: SigningPrivateKey, secret: Option<Vec<u8>>) -> Self {
+        Self {
+            cached: None,
+            secret,
+            signing_key,
+        }
+    }
+
+    /// Get blinded signing key for the current date.
+    pub fn blinded_key<R: Runtime>(&mut self) -> &BlindedSigningKey {
+        let now = R::time_since_epoch();
+        let day = now.as_secs() / SECONDS_PER_DAY;
+
+        if self.cached.as_ref().map_or(true, |(cached, _)| *cached != day) {
+            self.cached = Some((
+                day,
+                BlindedSigningKey::new(
+                    &self.signing_key,
+                    &blinding_date(now),
+                    self.secret.as_deref(),
+                ),
+            ));
+        }
+
+        &self.cached.as_ref().expect("to exist").1
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::runtime::mock::MockRuntime;
+
+    #[test]
+    fn date_formatting() {
+        assert_eq!(&blinding_date(Duration::from_secs(0)), b"19700101");
+        assert_eq!(
+            &blinding_date(Duration::from_secs(951_782_400)),
+            b"20000229"
+        );
+        assert_eq!(
+            &blinding_date(Duration::from_secs(1_792_195_200 + SECONDS_PER_DAY - 1)),
+            b"20261017"
+        );
+    }
+
+    #[test]
+    fn blinded_public_and_private_keys_match() {
+        let signing_key = SigningPrivateKey::random(MockRuntime::rng());
+        let date = blinding_date(MockRuntime::time_since_epoch());
+
+        let private = BlindedSigningKey::new(&signing_key, &date, None);
+        let public = BlindedPublicKey::new(&signing_key.public(), &date, None).unwrap();
+
+        assert_eq!(private.public(), &public);
+        assert_ne!(public.as_ref(), signing_key.public().as_ref());
+
+        // blinding with a secret or on another date results in a different key
+        assert_ne!(
+            BlindedPublicKey::new(&signing_key.public(), &date, Some(b"secret")).unwrap(),
+            public
+        );
+        assert_ne!(
+            BlindedPublicKey::new(&signing_key.public(), b"19700101", None).unwrap(),
+            public
+        );
+    }
+
+    #[test]
+    fn blinded_signature_verifies() {
+        let signing_key = SigningPrivateKey::random(MockRuntime::rng());
+        let date = blinding_date(MockRuntime::time_since_epoch());
+        let blinded = BlindedSigningKey::new(&signing_key, &date, None);
+
+        let signature = blinded.sign(b"hello, world", MockRuntime::rng());
+        let verifying_key = blinded.public().verifying_key().unwrap();
+
+        assert!(verifying_key.verify(b"hello, world", &signature).is_ok());
+        assert!(verifying_key.verify(b"goodbye, world", &signature).is_err());
+        assert!(signing_key.public().verify(b"hello, world", &signature).is_err());
+    }
+
+    #[test]
+    fn blinder_uses_current_date() {
+        let signing_key = SigningPrivateKey::random(MockRuntime::rng());
+        let public = BlindedPublicKey::new(
+            &signing_key.public(),
+            &blinding_date(MockRuntime::time_since_epoch()),
+            None,
+        )
+        .unwrap();
+
+        let mut blinder = LeaseSetBlinder::new(signing_key, None);
+        assert_eq!(blinder.blinded_key::<MockRuntime>().public(), &public);
+    }
+}
@@ -138,6 +138,26 @@ impl ChaChaPoly {
         Ok(tag.as_slice().to_vec())
     }
 
+    /// Encrypt `plaintext` in place, passing in associated data for authentication.
+    ///
+    /// Return authentication tag on success without allocating.
+    pub fn encrypt_with_ad_detached(
+        &mut self,
+        associated_data: &[u8],
+        plaintext: &mut [u8],
+    ) -> crate::Result<[u8; 16]> {
+        let tag = self.cipher.encrypt_in_place_detached(
+            &self.nonce.next().ok_or(Error::NonceOverflow)?,
+            associated_data,
+            plaintext,
+        )?;
+
+        let mut out = [0u8; 16];
+        out.copy_from_slice(tag.as_slice());
+
+        Ok(out)
+    }
+
     /// Encrypt `plaintext` in place, passing in associated data for authentication.
     pub fn encrypt_with_ad_new(
         &mut self,
@@ -18,6 +18,7 @@
 
 use hmac::Mac;
 use sha2::Sha256;
+use zeroize::Zeroize;
 
 use alloc::vec::Vec;
 
@@ -53,3 +54,86 @@ impl Hmac {
         self.hmac.finalize().into_bytes().into()
     }
 }
+
+/// HMAC-SHA256 key with precomputed inner and outer pad states.
+///
+/// Creating an [`Hmac`] from [`HmacKey`] copies the two precomputed SHA-256 states instead of
+/// hashing the padded key again, making it cheap to compute several MACs with the same key.
+#[derive(Clone)]
+pub struct HmacKey {
+    hmac: hmac::Hmac<Sha256>,
+}
+
+impl HmacKey {
+    /// Create new [`HmacKey`].
+    pub fn new(key: &[u8]) -> Self {
+        Self {
+            hmac: hmac::Hmac::new_from_slice(key).expect("valid key size"),
+        }
+    }
+
+    /// Create new [`Hmac`] from the precomputed state.
+    pub fn hmac(&self) -> Hmac {
+        Hmac {
+            hmac: self.hmac.clone(),
+        }
+    }
+}
+
+/// Derive two 32-byte outputs from `key` and `input` using HKDF-SHA256 with `info`.
+///
+/// The outputs are stored on the stack and the pad states of the temporary key are computed only
+/// once for both outputs.
+///
+/// https://geti2p.net/spec/ecies#kdfs
+pub fn hkdf(key: &[u8], input: &[u8], info: &[u8]) -> ([u8; 32], [u8; 32]) {
+    let mut temp_key = Hmac::new(key).update(input).finalize_new();
+    let temp = HmacKey::new(&temp_key);
+    temp_key.zeroize();
+
+    let first = temp.hmac().update(info).update([0x01]).finalize_new();
+    let second = temp.hmac().update(first).update(info).update([0x02]).finalize_new();
+
+    (first, second)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn hkdf_matches_hmac_chain() {
+        let key = [0xaa; 32];
+        let input = [0xbb; 32];
+
+        let temp_key = Hmac::new(&key).update(input).finalize();
+        let first = Hmac::new(&temp_key).update(b"KDFDHRatchetStep").update([0x01]).finalize();
+        let second = Hmac::new(&temp_key)
+            .update(&first)
+            .update(b"KDFDHRatchetStep")
+            .update([0x02])
+            .finalize();
+
+        assert_eq!(
+            hkdf(&key, &input, b"KDFDHRatchetStep"),
+            (
+                TryInto::<[u8; 32]>::try_into(first).unwrap(),
+                TryInto::<[u8; 32]>::try_into(second).unwrap()
+            )
+        );
+    }
+
+    #[test]
+    fn precomputed_key_matches() {
+        let key = HmacKey::new(b"session key");
+
+        assert_eq!(
+            key.hmac().update(b"hello, world").finalize_new(),
+            Hmac::new(b"session key").update(b"hello, world").finalize_new(),
+        );
+        assert_eq!(
+            key.hmac().update([]).finalize_new(),
+            Hmac::new(b"session key").update([]).finalize_new(),
+        );
+    }
+}
@@ -21,6 +21,9 @@ use sha2::Digest;
 use alloc::vec::Vec;
 
 /// Sha256 hasher.
+///
+/// Backed by `sha2` which detects SHA-NI support at runtime on x86 and uses the hardware
+/// implementation when it's available.
 pub struct Sha256 {
     /// Inner hasher.
     hasher: sha2::Sha256,
@@ -56,6 +56,15 @@ const LOG_TARGET: &str = "emissary::destination::lease-set";
 /// How many closest floodfills does [`LeaseSetManager`] store
 const NUM_CLOSEST_FLOODFILLS: usize = 10usize;
 
+/// How many floodfills is the lease set stored to in parallel.
+const NUM_STORE_FLOODFILLS: usize = 3usize;
+
+/// How many of the known floodfills are left out of storage so they can be used for verification.
+const NUM_VERIFICATION_FLOODFILLS: usize = 2usize;
+
+/// How many stores must be acknowledged before the lease set is considered stored.
+const STORE_QUORUM: usize = 2usize;
+
 /// How long [`LeaseSetManager`] awaits new tunnels before forcibly publishing an new [`LeaseSet`].
 const TUNNEL_BUILD_WAIT_TIMEOUT: Duration = Duration::from_secs(30);
 
@@ -67,6 +76,12 @@ const RETRY_TIMEOUT: Duration = Duration::from_secs(1);
 /// `LeaseSet Storage Verification` in https://geti2p.net/en/docs/how/network-database
 const STORAGE_VERIFICATION_START_TIMEOUT: Duration = Duration::from_secs(10);
 
+/// Time to wait before the lease set storage is verified if a quorum of stores were acknowledged.
+const STORAGE_VERIFICATION_QUORUM_TIMEOUT: Duration = Duration::from_secs(3);
+
+/// How long is a `DatabaseStore` waited for before a hedged lookup is sent to another floodfill.
+const STORAGE_VERIFICATION_HEDGE_TIMEOUT: Duration = Duration::from_secs(1);
+
 /// How long is a `DatabaseStore` waited for before it's considered failed.
 ///
 /// Once deemed failed, new `DatabaseStore` is sent if there is still time left.
@@ -140,6 +155,9 @@ enum PublishState<R: Runtime> {
 
         /// Expiration timer for current [`DatabaseLookupMessage`], if it has been sent.
         timer: Option<R::Timer>,
+
+        /// Timer for sending a hedged [`DatabaseLookupMessage`] to another floodfill.
+        hedge: Option<R::Timer>,
     },
 
     /// [`LeaseSetPublisherState`] has been poisoned.
@@ -173,6 +191,9 @@ pub struct LeaseSetManager<R: Runtime> {
     /// ID of the local destination.
     destination_id: DestinationId,
 
+    /// Is the lease set an encrypted lease set stored under the destination's blinded key.
+    encrypted: bool,
+
     /// Expiring inbound tunnels.
     expiring_tunnels: HashSet<TunnelId>,
 
@@ -216,6 +237,12 @@ pub struct LeaseSetManager<R: Runtime> {
     /// [`LeaseSet2`] publish state.
     state: PublishState<R>,
 
+    /// How many more stores must be acknowledged for the lease set to be stored to a quorum.
+    store_acks_needed: usize,
+
+    /// Reply tokens of the unacknowledged `DatabaseStore`s.
+    store_tokens: HashSet<u32>,
+
     /// Router IDs of the floodfills that unsuccessfully used to store the lease set.
     storage_floodfills: HashSet<RouterId>,
 
@@ -263,6 +290,7 @@ impl<R: Runtime> LeaseSetManager<R> {
 
         Self {
             destination_id: destination_id.clone(),
+            encrypted: false,
             expiring_tunnels: HashSet::new(),
             floodfills: HashMap::new(),
             key,
@@ -275,6 +303,8 @@ impl<R: Runtime> LeaseSetManager<R> {
             queried_floodfills: HashSet::new(),
             router_info_queries: R::join_set(),
             state,
+            store_acks_needed: 0usize,
+            store_tokens: HashSet::new(),
             storage_floodfills: HashSet::new(),
             tunnel_message_sender,
             tunnels: HashMap::from_iter(tunnels.into_iter().map(|lease| (lease.tunnel_id, lease))),
@@ -314,6 +344,42 @@ impl<R: Runtime> LeaseSetManager<R> {
         }
     }
 
+    /// Register new encrypted lease set for the [`Destination`].
+    ///
+    /// `key` is the `NetDb` key derived from the blinded key of the destination. The blinded key
+    /// changes daily and when it does, floodfills closest to the previous key are forgotten and the
+    /// lease set is published to floodfills closest to the new key.
+    pub fn register_encrypted_lease_set(&mut self, key: Bytes, lease_set: Bytes) {
+        self.encrypted = true;
+
+        if self.key == key {
+            return self.register_lease_set(lease_set);
+        }
+
+        tracing::debug!(
+            target: LOG_TARGET,
+            local = %self.destination_id,
+            "blinded key changed",
+        );
+
+        self.key = key;
+        self.lease_set = lease_set;
+        self.floodfills.clear();
+        self.pending_floodfills.clear();
+        self.queried_floodfills.clear();
+        self.storage_floodfills.clear();
+
+        if self.unpublished {
+            return;
+        }
+
+        self.get_closest_floodfills();
+
+        if let Some(waker) = self.waker.take() {
+            waker.wake_by_ref();
+        }
+    }
+
     /// Register [`DatabaseStore`] message.
     pub fn register_database_store(&mut self, key: Bytes) {
         if self.key != key {
@@ -347,6 +413,44 @@ impl<R: Runtime> LeaseSetManager<R> {
         }
     }
 
+    /// Register `DeliveryStatus` message.
+    ///
+    /// If `message_id` is a reply token of a `DatabaseStore` and enough stores have been
+    /// acknowledged to reach the quorum, storage verification is started sooner.
+    pub fn register_delivery_status(&mut self, message_id: u32) {
+        if !self.store_tokens.remove(&message_id) || self.store_acks_needed == 0 {
+            return;
+        }
+        self.store_acks_needed -= 1;
+
+        tracing::trace!(
+            target: LOG_TARGET,
+            local = %self.destination_id,
+            acks_needed = ?self.store_acks_needed,
+            "lease set store acknowledged",
+        );
+
+        if self.store_acks_needed != 0 {
+            return;
+        }
+
+        if let PublishState::AwaitingFlooding { .. } = &self.state {
+            tracing::debug!(
+                target: LOG_TARGET,
+                local = %self.destination_id,
+                "lease set stored to a quorum of floodfills",
+            );
+
+            self.state = PublishState::AwaitingFlooding {
+                timer: R::timer(STORAGE_VERIFICATION_QUORUM_TIMEOUT),
+            };
+
+            if let Some(waker) = self.waker.take() {
+                waker.wake_by_ref();
+            }
+        }
+    }
+
     /// Register [`DatabaseSearchReply`].
     pub fn register_database_search_reply(&mut self, key: Bytes, floodfills: Vec<RouterId>) {
         if self.unpublished {
@@ -470,12 +574,64 @@ impl<R: Runtime> LeaseSetManager<R> {
         self.expiring_tunnels.remove(&tunnel_id);
     }
 
-    /// Create [`DatabaseStore`] message for the leaset set and return the message and ID
-    /// of the selected floodfill to whom the message should be sent.
+    /// Select floodfills the lease set is stored to.
+    ///
+    /// The lease set is stored to at most [`NUM_STORE_FLOODFILLS`] floodfills closest to the key
+    /// while leaving [`NUM_VERIFICATION_FLOODFILLS`] floodfills for storage verification, if there
+    /// are enough floodfills.
     ///
-    /// Returns `None` if there are no inbound tunnels or no floofills to choose from. This means
-    /// that the `DatabaseStore` message cannot be sent.
-    fn create_database_store(&self) -> Option<(RouterId, Vec<u8>)> {
+    /// If previous stores failed, the floodfills used for them are excluded unless there are no
+    /// other floodfills available, in which case the failing floodfills are tried again.
+    fn select_storage_floodfills(&self) -> HashSet<RouterId> {
+        let num_floodfills = self
+            .floodfills
+            .len()
+            .saturating_sub(NUM_VERIFICATION_FLOODFILLS)
+            .clamp(1usize, NUM_STORE_FLOODFILLS);
+
+        let mut selected = Dht::<R>::get_n_closest(
+            &self.key,
+            &self
+                .floodfills
+                .keys()
+                .filter(|router_id| !self.storage_floodfills.contains(*router_id))
+                .cloned()
+                .collect::<HashSet<_>>(),
+            num_floodfills,
+        );
+
+        if selected.len() < num_floodfills {
+            tracing::debug!(
+                target: LOG_TARGET,
+                local = %self.destination_id,
+                num_selected = ?selected.len(),
+                "not enough floodfills for lease set publication, trying failing floodfills",
+            );
+
+            let failing = self
+                .floodfills
+                .keys()
+                .filter(|router_id| !selected.contains(*router_id))
+                .cloned()
+                .collect::<HashSet<_>>();
+
+            selected.extend(Dht::<R>::get_n_closest(
+                &self.key,
+                &failing,
+                num_floodfills - selected.len(),
+            ));
+        }
+
+        selected
+    }
+
+    /// Create [`DatabaseStore`] message for the leaset set that is sent to `floodfill`.
+    ///
+    /// Returns the reply token of the store and the message.
+    ///
+    /// Returns `None` if there are no inbound tunnels. This means that the `DatabaseStore` message
+    /// cannot be sent.
+    fn create_database_store(&self, floodfill: &RouterId) -> Option<(u32, Vec<u8>)> {
         if self.tunnels.is_empty() {
             tracing::warn!(
                 target: LOG_TARGET,
@@ -489,35 +645,6 @@ impl<R: Runtime> LeaseSetManager<R> {
         // one of the destination's outbound tunnels
         let reply_token = R::rng().next_u32();
 
-        // select floodfill closest to us
-        //
-        // if the previous database store failed, try to excluse that floodfill
-        //
-        // if there are no other floodfills available, retry to failing floodfill
-        let floodfill = match Dht::<R>::get_closest(
-            &self.key,
-            &self
-                .floodfills
-                .keys()
-                .filter(|router_id| !self.storage_floodfills.contains(*router_id))
-                .cloned()
-                .collect::<HashSet<_>>(),
-        ) {
-            None => {
-                tracing::debug!(
-                    target: LOG_TARGET,
-                    local = %self.destination_id,
-                    "no floodfills for lease set publication, trying a failing floodfill",
-                );
-
-                Dht::<R>::get_closest(
-                    &self.key,
-                    &self.floodfills.keys().cloned().collect::<HashSet<_>>(),
-                )?
-            }
-            Some(floodfill) => floodfill,
-        };
-
         tracing::debug!(
             target: LOG_TARGET,
             local = %self.destination_id,
@@ -527,7 +654,7 @@ impl<R: Runtime> LeaseSetManager<R> {
         );
 
         // key must exist since the floodfill was selected from `self.floodfills`
-        let floodfill_public_key = self.floodfills.get(&floodfill).expect("to exist");
+        let floodfill_public_key = self.floodfills.get(floodfill).expect("to exist");
 
         // select random tunnel for `DeliveryStatus`
         //
@@ -546,18 +673,22 @@ impl<R: Runtime> LeaseSetManager<R> {
             .nth(R::rng().next_u32() as usize % self.tunnels.len())
             .expect("index to be within bounds");
 
-        let message = DatabaseStoreBuilder::new(
-            self.key.clone(),
-            DatabaseStoreKind::LeaseSet2 {
+        let kind = match self.encrypted {
+            true => DatabaseStoreKind::EncryptedLeaseSet {
                 lease_set: self.lease_set.clone(),
             },
-        )
-        .with_reply_type(ReplyType::Tunnel {
-            reply_token,
-            tunnel_id: *gateway_tunnel_id,
-            router_id: gateway_router_id.clone(),
-        })
-        .build();
+            false => DatabaseStoreKind::LeaseSet2 {
+                lease_set: self.lease_set.clone(),
+            },
+        };
+
+        let message = DatabaseStoreBuilder::new(self.key.clone(), kind)
+            .with_reply_type(ReplyType::Tunnel {
+                reply_token,
+                tunnel_id: *gateway_tunnel_id,
+                router_id: gateway_router_id.clone(),
+            })
+            .build();
 
         let mut message = GarlicMessageBuilder::default()
             .with_date_time(R::time_since_epoch().as_secs() as u32)
@@ -588,7 +719,7 @@ impl<R: Runtime> LeaseSetManager<R> {
         out.put_slice(&message);
 
         Some((
-            floodfill,
+            reply_token,
             MessageBuilder::standard()
                 .with_expiration(R::time_since_epoch() + I2NP_MESSAGE_EXPIRATION)
                 .with_message_type(MessageType::Garlic)
@@ -704,6 +835,73 @@ impl<R: Runtime> LeaseSetManager<R> {
 
         Some((floodfill, message))
     }
+
+    /// Send the lease set to floodfills selected by
+    /// [`LeaseSetManager::select_storage_floodfills()`].
+    ///
+    /// Returns the number of floodfills the lease set was sent to.
+    fn publish_lease_set(&mut self) -> usize {
+        self.store_tokens.clear();
+        let mut num_sent = 0usize;
+
+        for floodfill in self.select_storage_floodfills() {
+            let Some((reply_token, message)) = self.create_database_store(&floodfill) else {
+                break;
+            };
+
+            match self
+                .tunnel_message_sender
+                .send_message(message)
+                .router_delivery(floodfill.clone())
+                .try_send()
+            {
+                Err(error) => tracing::debug!(
+                    target: LOG_TARGET,
+                    local = %self.destination_id,
+                    %floodfill,
+                    ?error,
+                    "failed to send DSM to floodfill",
+                ),
+                Ok(()) => {
+                    self.storage_floodfills.insert(floodfill.clone());
+                    self.queried_floodfills.insert(floodfill);
+                    self.store_tokens.insert(reply_token);
+                    num_sent += 1;
+                }
+            }
+        }
+        self.store_acks_needed = num_sent.min(STORE_QUORUM);
+
+        num_sent
+    }
+
+    /// Send a hedged storage verification lookup to the next closest floodfill.
+    ///
+    /// Sent if the previous lookup hasn't been answered in [`STORAGE_VERIFICATION_HEDGE_TIMEOUT`]
+    /// and the first response to either of the lookups verifies the storage.
+    fn send_hedged_lookup(&mut self) {
+        let Some((floodfill, message)) = self.create_database_lookup() else {
+            return;
+        };
+
+        match self
+            .tunnel_message_sender
+            .send_message(message)
+            .router_delivery(floodfill.clone())
+            .try_send()
+        {
+            Err(error) => tracing::debug!(
+                target: LOG_TARGET,
+                local = %self.destination_id,
+                %floodfill,
+                ?error,
+                "failed to send hedged DLM to floodfill",
+            ),
+            Ok(()) => {
+                self.queried_floodfills.insert(floodfill);
+            }
+        }
+    }
 }
 
 impl<R: Runtime> Future for LeaseSetManager<R> {
@@ -733,6 +931,7 @@ impl<R: Runtime> Future for LeaseSetManager<R> {
                             self.state = PublishState::VerifyStorage {
                                 started,
                                 timer: None,
+                                hedge: None,
                             };
                         }
                     },
@@ -770,12 +969,12 @@ impl<R: Runtime> Future for LeaseSetManager<R> {
                         self.state = PublishState::PublishLeaseSet;
                     }
                 },
-                PublishState::PublishLeaseSet => match self.create_database_store() {
-                    None => {
+                PublishState::PublishLeaseSet => match self.publish_lease_set() {
+                    0 => {
                         tracing::debug!(
                             target: LOG_TARGET,
                             local = %self.destination_id,
-                            "failed to create DSM, trying again later",
+                            "failed to publish lease set, trying again later",
                         );
 
                         self.state = PublishState::Retry {
@@ -783,34 +982,18 @@ impl<R: Runtime> Future for LeaseSetManager<R> {
                             timer: R::timer(RETRY_TIMEOUT),
                         };
                     }
-                    Some((floodfill, message)) => match self
-                        .tunnel_message_sender
-                        .send_message(message.clone())
-                        .router_delivery(floodfill.clone())
-                        .try_send()
-                    {
-                        Err(error) => {
-                            tracing::debug!(
-                                target: LOG_TARGET,
-                                local = %self.destination_id,
-                                ?error,
-                                "failed to send DSM to floodfill, trying again later",
-                            );
-
-                            self.state = PublishState::Retry {
-                                kind: RetryKind::PublishLeaseSet,
-                                timer: R::timer(RETRY_TIMEOUT),
-                            };
-                        }
-                        Ok(()) => {
-                            self.storage_floodfills.insert(floodfill.clone());
-                            self.queried_floodfills.insert(floodfill);
+                    num_sent => {
+                        tracing::trace!(
+                            target: LOG_TARGET,
+                            local = %self.destination_id,
+                            ?num_sent,
+                            "lease set sent to floodfills",
+                        );
 
-                            self.state = PublishState::AwaitingFlooding {
-                                timer: R::timer(STORAGE_VERIFICATION_START_TIMEOUT),
-                            };
-                        }
-                    },
+                        self.state = PublishState::AwaitingFlooding {
+                            timer: R::timer(STORAGE_VERIFICATION_START_TIMEOUT),
+                        };
+                    }
                 },
                 PublishState::AwaitingFlooding { mut timer } => match timer.poll_unpin(cx) {
                     Poll::Pending => {
@@ -821,10 +1004,15 @@ impl<R: Runtime> Future for LeaseSetManager<R> {
                         self.state = PublishState::VerifyStorage {
                             started: R::now(),
                             timer: None,
+                            hedge: None,
                         };
                     }
                 },
-                PublishState::VerifyStorage { started, timer } => {
+                PublishState::VerifyStorage {
+                    started,
+                    timer,
+                    hedge,
+                } => {
                     if started.elapsed() >= STORAGE_VERIFICATION_TOTAL_TIMEOUT {
                         tracing::debug!(
                             target: LOG_TARGET,
@@ -875,32 +1063,54 @@ impl<R: Runtime> Future for LeaseSetManager<R> {
                                     self.state = PublishState::VerifyStorage {
                                         started,
                                         timer: Some(R::timer(STORAGE_VERIFICATION_TIMEOUT)),
+                                        hedge: Some(R::timer(STORAGE_VERIFICATION_HEDGE_TIMEOUT)),
                                     };
                                     continue;
                                 }
                             },
                         },
-                        Some(mut timer) => match timer.poll_unpin(cx) {
-                            Poll::Pending => {
-                                self.state = PublishState::VerifyStorage {
-                                    started,
-                                    timer: Some(timer),
-                                };
-                                break;
-                            }
-                            Poll::Ready(()) => {
-                                tracing::trace!(
-                                    target: LOG_TARGET,
-                                    local = %self.destination_id,
-                                    "lease set verification DLM timed out, resending verification DLM",
-                                );
+                        Some(mut timer) => {
+                            let hedge = match hedge {
+                                None => None,
+                                Some(mut hedge) => match hedge.poll_unpin(cx) {
+                                    Poll::Pending => Some(hedge),
+                                    Poll::Ready(()) => {
+                                        tracing::trace!(
+                                            target: LOG_TARGET,
+                                            local = %self.destination_id,
+                                            "lease set verification DLM not answered, sending hedged DLM",
+                                        );
+
+                                        self.send_hedged_lookup();
+                                        None
+                                    }
+                                },
+                            };
 
-                                self.state = PublishState::VerifyStorage {
-                                    started,
-                                    timer: None,
-                                };
+                            match timer.poll_unpin(cx) {
+                                Poll::Pending => {
+                                    self.state = PublishState::VerifyStorage {
+                                        started,
+                                        timer: Some(timer),
+                                        hedge,
+                                    };
+                                    break;
+                                }
+                                Poll::Ready(()) => {
+                                    tracing::trace!(
+                                        target: LOG_TARGET,
+                                        local = %self.destination_id,
+                                        "lease set verification DLM timed out, resending verification DLM",
+                                    );
+
+                                    self.state = PublishState::VerifyStorage {
+                                        started,
+                                        timer: None,
+                                        hedge: None,
+                                    };
+                                }
                             }
-                        },
+                        }
                     }
                 }
                 PublishState::Poisoned => {
@@ -3086,4 +3296,308 @@ mod tests {
 
         assert!(std::matches!(manager.state, PublishState::Inactive));
     }
+
+    #[tokio::test]
+    async fn lease_set_stored_to_quorum_and_lookup_hedged() {
+        let (tp_handle, tm_rx, _tp_tx, _srx) = TunnelPoolHandle::create();
+        let sender = tp_handle.sender();
+        let (netdb_handle, netdb_rx) = NetDbHandle::create();
+        let noise_ctx = NoiseContext::new(
+            StaticPrivateKey::random(MockRuntime::rng()),
+            Bytes::from(RouterId::random().to_vec()),
+        );
+        let (lease_set, signing_key) = LeaseSet2::random();
+        let tunnels = lease_set.leases.clone();
+        let destination_id = lease_set.header.destination.id();
+        let key = Bytes::from(destination_id.to_vec());
+        let serialized = lease_set.serialize(&signing_key);
+        let mut manager = LeaseSetManager::<MockRuntime>::new(
+            tunnels,
+            destination_id,
+            sender,
+            3usize,
+            netdb_handle,
+            noise_ctx,
+            ProfileStorage::new(&[], &[]),
+            false,
+            Bytes::from(serialized),
+        );
+
+        let floodfills = (0..5)
+            .map(|_| {
+                (
+                    RouterId::random(),
+                    StaticPrivateKey::random(MockRuntime::rng()),
+                )
+            })
+            .collect::<HashMap<_, _>>();
+
+        loop {
+            tokio::select! {
+                _ = &mut manager => {}
+                event = netdb_rx.recv() => match event.unwrap() {
+                    NetDbAction::GetClosestFloodfills { tx, .. } => {
+                        tx.send(
+                            floodfills
+                                .iter()
+                                .map(|(router_id, key)| (router_id.clone(), key.public()))
+                                .collect(),
+                        )
+                        .unwrap();
+                        break;
+                    }
+                    _ => panic!("invalid action received"),
+                },
+                _ = tokio::time::sleep(Duration::from_secs(40)) => panic!("timeout"),
+            }
+        }
+
+        // the lease set is stored to three floodfills in parallel, leaving two for verification
+        let mut store_floodfills = HashSet::new();
+        let mut reply_tokens = Vec::new();
+
+        while store_floodfills.len() < NUM_STORE_FLOODFILLS {
+            tokio::select! {
+                _ = &mut manager => {}
+                event = tm_rx.recv() => match event.unwrap() {
+                    TunnelMessage::RouterDeliveryViaRoute {
+                        outbound_tunnel: None,
+                        router_id,
+                        message,
+                    } => {
+                        let message = Message::parse_standard(&message).unwrap();
+                        let static_key = floodfills.get(&router_id).unwrap();
+
+                        let mut garlic = GarlicHandler::<MockRuntime>::new(
+                            NoiseContext::new(static_key.clone(), Bytes::from(router_id.to_vec())),
+                            MockRuntime::register_metrics(vec![], None),
+                        );
+                        let GarlicDeliveryInstructions::Local { message } = garlic
+                            .handle_message(message)
+                            .unwrap()
+                            .filter(|message| {
+                                std::matches!(message, GarlicDeliveryInstructions::Local { .. })
+                            })
+                            .collect::<VecDeque<_>>()
+                            .pop_front()
+                            .expect("to exist")
+                        else {
+                            panic!("invalid type");
+                        };
+
+                        match message.message_type {
+                            MessageType::DatabaseStore => {
+                                let DatabaseStore { reply, .. } =
+                                    DatabaseStore::<MockRuntime>::parse(&message.payload).unwrap();
+
+                                let ReplyType::Tunnel { reply_token, .. } = reply else {
+                                    panic!("invalid reply type");
+                                };
+
+                                assert!(store_floodfills.insert(router_id));
+                                reply_tokens.push(reply_token);
+                            }
+                            _ => panic!("invalid message type"),
+                        }
+                    }
+                    _ => panic!("unexpected tunnel message"),
+                },
+                _ = tokio::time::sleep(Duration::from_secs(5)) => panic!("timeout"),
+            }
+        }
+
+        // acknowledge two of the stores which starts storage verification early
+        manager.register_delivery_status(reply_tokens[0]);
+        assert_eq!(manager.store_acks_needed, 1);
+        manager.register_delivery_status(reply_tokens[0]);
+        assert_eq!(manager.store_acks_needed, 1);
+        manager.register_delivery_status(reply_tokens[1]);
+        assert_eq!(manager.store_acks_needed, 0);
+
+        // ignore the first lookup and respond to the hedged lookup
+        let mut lookup_floodfills = HashSet::new();
+
+        loop {
+            tokio::select! {
+                _ = &mut manager => {}
+                event = tm_rx.recv() => match event.unwrap() {
+                    TunnelMessage::RouterDeliveryViaRoute {
+                        outbound_tunnel: None,
+                        router_id,
+                        message,
+                    } => {
+                        let message = Message::parse_standard(&message).unwrap();
+                        let static_key = floodfills.get(&router_id).unwrap();
+
+                        let mut garlic = GarlicHandler::<MockRuntime>::new(
+                            NoiseContext::new(static_key.clone(), Bytes::from(router_id.to_vec())),
+                            MockRuntime::register_metrics(vec![], None),
+                        );
+                        let GarlicDeliveryInstructions::Local { message } = garlic
+                            .handle_message(message)
+                            .unwrap()
+                            .filter(|message| {
+                                std::matches!(message, GarlicDeliveryInstructions::Local { .. })
+                            })
+                            .collect::<VecDeque<_>>()
+                            .pop_front()
+                            .expect("to exist")
+                        else {
+                            panic!("invalid type");
+                        };
+
+                        match message.message_type {
+                            MessageType::DatabaseLookup => {
+                                let DatabaseLookup {
+                                    key: lookup_key, ..
+                                } = DatabaseLookup::parse(&message.payload).unwrap();
+
+                                assert_eq!(key.as_ref(), &lookup_key);
+                                assert!(!store_floodfills.contains(&router_id));
+                                assert!(lookup_floodfills.insert(router_id));
+
+                                if lookup_floodfills.len() == 2 {
+                                    manager.register_database_store(lookup_key);
+                                    break;
+                                }
+                            }
+                            _ => panic!("invalid message type"),
+                        }
+                    }
+                    _ => panic!("unexpected tunnel message"),
+                },
+                // both lookups must be sent before the default verification start timeout
+                _ = tokio::time::sleep(STORAGE_VERIFICATION_START_TIMEOUT) => panic!("timeout"),
+            }
+        }
+
+        assert!(std::matches!(manager.state, PublishState::Inactive));
+    }
+
+    #[tokio::test]
+    async fn encrypted_lease_set_published_under_blinded_key() {
+        use crate::{
+            crypto::blinding::{blinding_date, BlindedSigningKey},
+            i2np::database::store::DatabaseStorePayload,
+            primitives::EncryptedLeaseSet,
+        };
+
+        let (tp_handle, tm_rx, _tp_tx, _srx) = TunnelPoolHandle::create();
+        let sender = tp_handle.sender();
+        let (netdb_handle, netdb_rx) = NetDbHandle::create();
+        let noise_ctx = NoiseContext::new(
+            StaticPrivateKey::random(MockRuntime::rng()),
+            Bytes::from(RouterId::random().to_vec()),
+        );
+        let (lease_set, signing_key) = LeaseSet2::random();
+        let tunnels = lease_set.leases.clone();
+        let destination_id = lease_set.header.destination.id();
+        let serialized = Bytes::from(lease_set.serialize(&signing_key));
+        let mut manager = LeaseSetManager::<MockRuntime>::new(
+            tunnels.clone(),
+            destination_id.clone(),
+            sender,
+            3usize,
+            netdb_handle,
+            noise_ctx,
+            ProfileStorage::new(&[], &[]),
+            false,
+            serialized.clone(),
+        );
+
+        let blinded = BlindedSigningKey::new(
+            &signing_key,
+            &blinding_date(MockRuntime::time_since_epoch()),
+            None,
+        );
+        let encrypted = EncryptedLeaseSet::new::<MockRuntime>(
+            &serialized,
+            &blinded,
+            MockRuntime::time_since_epoch().as_secs() as u32,
+            600,
+        );
+        let blinded_key = encrypted.routing_key();
+        manager.register_encrypted_lease_set(
+            blinded_key.clone(),
+            Bytes::from(encrypted.serialize::<MockRuntime>(&blinded)),
+        );
+        assert_ne!(blinded_key, Bytes::from(destination_id.to_vec()));
+
+        let floodfills = (0..5)
+            .map(|_| {
+                (
+                    RouterId::random(),
+                    StaticPrivateKey::random(MockRuntime::rng()),
+                )
+            })
+            .collect::<HashMap<_, _>>();
+
+        loop {
+            tokio::select! {
+                _ = &mut manager => {}
+                event = netdb_rx.recv() => match event.unwrap() {
+                    NetDbAction::GetClosestFloodfills { key, tx } => {
+                        // the query started for the destination id has been abandoned
+                        if key != blinded_key {
+                            continue;
+                        }
+
+                        tx.send(
+                            floodfills
+                                .iter()
+                                .map(|(router_id, key)| (router_id.clone(), key.public()))
+                                .collect(),
+                        )
+                        .unwrap();
+                    }
+                    _ => panic!("invalid action received"),
+                },
+                event = tm_rx.recv() => match event.unwrap() {
+                    TunnelMessage::RouterDeliveryViaRoute {
+                        outbound_tunnel: None,
+                        router_id,
+                        message,
+                    } => {
+                        let message = Message::parse_standard(&message).unwrap();
+                        let static_key = floodfills.get(&router_id).unwrap();
+
+                        let mut garlic = GarlicHandler::<MockRuntime>::new(
+                            NoiseContext::new(static_key.clone(), Bytes::from(router_id.to_vec())),
+                            MockRuntime::register_metrics(vec![], None),
+                        );
+                        let GarlicDeliveryInstructions::Local { message } = garlic
+                            .handle_message(message)
+                            .unwrap()
+                            .filter(|message| {
+                                std::matches!(message, GarlicDeliveryInstructions::Local { .. })
+                            })
+                            .collect::<VecDeque<_>>()
+                            .pop_front()
+                            .expect("to exist")
+                        else {
+                            panic!("invalid type");
+                        };
+                        assert_eq!(message.message_type, MessageType::DatabaseStore);
+
+                        let DatabaseStore { key, payload, .. } =
+                            DatabaseStore::<MockRuntime>::parse(&message.payload).unwrap();
+                        assert_eq!(key, blinded_key);
+
+                        match payload {
+                            DatabaseStorePayload::EncryptedLeaseSet { lease_set } => {
+                                let decrypted = lease_set
+                                    .decrypt(blinded.public().subcredential())
+                                    .unwrap();
+                                assert_eq!(decrypted.header.destination.id(), destination_id);
+                            }
+                            _ => panic!("invalid payload"),
+                        }
+                        break;
+                    }
+                    _ => panic!("unexpected tunnel message"),
+                },
+                _ = tokio::time::sleep(Duration::from_secs(30)) => panic!("timeout"),
+            }
+        }
+    }
 }
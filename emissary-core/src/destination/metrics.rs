@@ -0,0 +1,57 @@
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+use crate::runtime::MetricType;
+
+use alloc::vec::Vec;
+
+// `NewSession` admission
+pub const NS_ACCEPTED_COUNT: &str = "destination_ns_accepted_count";
+pub const NS_OFFLOADED_COUNT: &str = "destination_ns_offloaded_count";
+pub const NS_REPLAYED_COUNT: &str = "destination_ns_replayed_count";
+pub const NS_SHED_COUNT: &str = "destination_ns_shed_count";
+pub const NS_IN_FLIGHT: &str = "destination_ns_in_flight_count";
+
+/// Register destination metrics.
+pub fn register_metrics(mut metrics: Vec<MetricType>) -> Vec<MetricType> {
+    // counters
+    metrics.push(MetricType::Counter {
+        name: NS_ACCEPTED_COUNT,
+        description: "how many `NewSession` messages have been decrypted and accepted",
+    });
+    metrics.push(MetricType::Counter {
+        name: NS_OFFLOADED_COUNT,
+        description: "how many `NewSession` messages have been processed in the background",
+    });
+    metrics.push(MetricType::Counter {
+        name: NS_REPLAYED_COUNT,
+        description: "how many replayed `NewSession` messages have been dropped",
+    });
+    metrics.push(MetricType::Counter {
+        name: NS_SHED_COUNT,
+        description: "how many `NewSession` messages have been dropped because of overload",
+    });
+
+    // gauges
+    metrics.push(MetricType::Gauge {
+        name: NS_IN_FLIGHT,
+        description: "how many `NewSession` messages are being processed in the background",
+    });
+
+    metrics
+}
@@ -17,7 +17,7 @@
 // DEALINGS IN THE SOFTWARE.
 
 use crate::{
-    crypto::StaticPrivateKey,
+    crypto::{blinding::LeaseSetBlinder, StaticPrivateKey},
     destination::{
         lease_set::LeaseSetManager,
         routing_path::{
@@ -32,12 +32,13 @@ use crate::{
             store::{DatabaseStore, DatabaseStorePayload},
         },
         delivery_status::DeliveryStatus,
+        garlic::GarlicClove,
         Message, MessageBuilder, MessageType, I2NP_MESSAGE_EXPIRATION,
     },
     netdb::NetDbHandle,
-    primitives::{DestinationId, Lease, LeaseSet2, TunnelId},
+    primitives::{DestinationId, EncryptedLeaseSet, Lease, LeaseSet2, TunnelId},
     profile::ProfileStorage,
-    runtime::{JoinSet, Runtime},
+    runtime::{JoinSet, MetricType, Runtime},
     tunnel::{NoiseContext, TunnelPoolEvent, TunnelPoolHandle},
 };
 
@@ -55,6 +56,7 @@ use core::{
 };
 
 mod lease_set;
+mod metrics;
 
 pub mod routing_path;
 pub mod session;
@@ -75,6 +77,16 @@ const NUM_QUERY_RETRIES: usize = 3usize;
 /// Stale lease set prune interval.
 const LEASE_SET_PRUNE_INTERVAL: Duration = Duration::from_secs(2 * 60);
 
+/// How long is a published encrypted lease set valid for.
+const ENCRYPTED_LEASE_SET_EXPIRATION: Duration = Duration::from_secs(10 * 60);
+
+/// Maximum size of a garlic message created by coalescing queued messages.
+///
+/// Covers the encoded garlic cloves of the queued messages and the garlic message overhead,
+/// including a bundled lease set, so coalescing small messages never produces a garlic message
+/// larger than a single full-sized streaming packet would.
+const MAX_COALESCED_SIZE: usize = 1730usize;
+
 /// How the message should be delivered to remote destination.
 #[derive(Default, Clone)]
 pub enum DeliveryStyle {
@@ -186,8 +198,23 @@ pub struct DestinationContext {
     expiring_leases: HashMap<TunnelId, Lease>,
 }
 
+/// Messages queued for a remote destination, waiting to be coalesced into one garlic message.
+struct CoalescedMessages {
+    /// How the messages should be delivered to remote destination.
+    delivery_style: DeliveryStyle,
+
+    /// Queued messages.
+    messages: Vec<Vec<u8>>,
+
+    /// Total size of the garlic cloves of the queued messages.
+    size: usize,
+}
+
 /// Client destination.
 pub struct Destination<R: Runtime> {
+    /// Messages queued for remote destinations.
+    coalesced: HashMap<DestinationId, CoalescedMessages>,
+
     /// Destination ID of the client.
     destination_id: DestinationId,
 
@@ -198,6 +225,9 @@ pub struct Destination<R: Runtime> {
     /// Local lease set manager.
     lease_set_manager: LeaseSetManager<R>,
 
+    /// Blinded signing key of the destination, if the lease set is published encrypted.
+    lease_set_blinder: Option<LeaseSetBlinder>,
+
     /// Timer for periodic pruning of stale lease sets.
     lease_set_prune_timer: R::Timer,
 
@@ -243,8 +273,10 @@ impl<R: Runtime> Destination<R> {
         inbound_tunnels: Vec<Lease>,
         unpublished: bool,
         profile_storage: ProfileStorage<R>,
+        metrics: R::MetricsHandle,
     ) -> Self {
         Self {
+            coalesced: HashMap::new(),
             destination_id: destination_id.clone(),
             lease_set: lease_set.clone(),
             lease_set_manager: LeaseSetManager::new(
@@ -258,18 +290,24 @@ impl<R: Runtime> Destination<R> {
                 unpublished,
                 lease_set.clone(),
             ),
+            lease_set_blinder: None,
             lease_set_prune_timer: R::timer(LEASE_SET_PRUNE_INTERVAL),
             netdb_handle,
             pending_queries: HashSet::new(),
             query_futures: R::join_set(),
             remote_destinations: HashMap::new(),
             routing_path_manager: RoutingPathManager::new(destination_id.clone(), outbound_tunnels),
-            session_manager: SessionManager::new(destination_id, private_key, lease_set),
+            session_manager: SessionManager::new(destination_id, private_key, lease_set, metrics),
             tunnel_pool_handle,
             waker: None,
         }
     }
 
+    /// Collect destination-related metric counters, gauges and histograms.
+    pub fn metrics(metrics: Vec<MetricType>) -> Vec<MetricType> {
+        metrics::register_metrics(metrics)
+    }
+
     /// Look up lease set status of remote destination.
     ///
     /// Before sending a message to remote, the caller must ensure [`Destination`] holds a valid
@@ -517,12 +555,86 @@ impl<R: Runtime> Destination<R> {
         delivery_style: DeliveryStyle,
         message: Vec<u8>,
     ) -> crate::Result<()> {
+        // messages queued earlier for the same remote must be sent first to preserve ordering
+        self.flush_queued(delivery_style.destination_id())?;
+
         match self.session_manager.encrypt(delivery_style.destination_id(), message) {
             Ok(message) => self.send_message_inner(delivery_style, message),
             Err(error) => Err(Error::Session(error)),
         }
     }
 
+    /// Queue `message` to be sent to remote destination.
+    ///
+    /// Messages queued for the same remote destination before [`Destination`] is polled again are
+    /// coalesced into as few garlic messages as possible, each at most [`MAX_COALESCED_SIZE`]
+    /// bytes, which saves an AEAD operation and a tunnel message per queued message.
+    ///
+    /// If the queued messages must be sent before `message` can be queued and sending them
+    /// fails, the error is logged and `message` is queued regardless.
+    ///
+    /// Session manager is expected to have public key of the remote destination.
+    pub fn queue_message(
+        &mut self,
+        delivery_style: DeliveryStyle,
+        message: Vec<u8>,
+    ) -> crate::Result<()> {
+        let destination_id = delivery_style.destination_id().clone();
+        let clove_size = SessionManager::<R>::data_clove_size(message.len());
+        let overhead = self.session_manager.message_overhead(&destination_id);
+
+        if self
+            .coalesced
+            .get(&destination_id)
+            .is_some_and(|queued| overhead + queued.size + clove_size > MAX_COALESCED_SIZE)
+        {
+            if let Err(error) = self.flush_queued(&destination_id) {
+                tracing::warn!(
+                    target: LOG_TARGET,
+                    local = %self.destination_id,
+                    remote = %destination_id,
+                    ?error,
+                    "failed to send queued messages",
+                );
+            }
+        }
+
+        let queued = self.coalesced.entry(destination_id).or_insert_with(|| CoalescedMessages {
+            delivery_style: delivery_style.clone(),
+            messages: Vec::new(),
+            size: 0usize,
+        });
+
+        // use the most recent routing path for the coalesced message
+        queued.delivery_style = delivery_style;
+        queued.size += clove_size;
+        queued.messages.push(message);
+
+        if let Some(waker) = self.waker.take() {
+            waker.wake_by_ref();
+        }
+
+        Ok(())
+    }
+
+    /// Encrypt and send messages queued for `destination_id`, if any.
+    fn flush_queued(&mut self, destination_id: &DestinationId) -> crate::Result<()> {
+        let Some(CoalescedMessages {
+            delivery_style,
+            messages,
+            ..
+        }) = self.coalesced.remove(destination_id)
+        else {
+            return Ok(());
+        };
+
+        self.session_manager
+            .encrypt_many(destination_id, messages)
+            .map_err(Error::Session)?
+            .into_iter()
+            .try_for_each(|message| self.send_message_inner(delivery_style.clone(), message))
+    }
+
     /// Handle garlic messages received into one of the [`Destination`]'s inbound tunnels.
     ///
     /// The decrypted garlic message may contain a database store for an up-to-date [`LeaseSet2`] of
@@ -552,7 +664,8 @@ impl<R: Runtime> Destination<R> {
                     })?;
 
                 match payload {
-                    DatabaseStorePayload::LeaseSet2 { .. } => {
+                    DatabaseStorePayload::LeaseSet2 { .. }
+                    | DatabaseStorePayload::EncryptedLeaseSet { .. } => {
                         // self.lease_set_manager.register_database_store(
                         //     key.clone(),
                         //     DatabaseStore::<R>::extract_raw_lease_set(&message.payload),
@@ -602,6 +715,7 @@ impl<R: Runtime> Destination<R> {
                     "delivery status",
                 );
 
+                self.lease_set_manager.register_delivery_status(message_id);
                 return Ok(Vec::new());
             }
             MessageType::Garlic => {}
@@ -627,10 +741,16 @@ impl<R: Runtime> Destination<R> {
             return Err(Error::InvalidData);
         }
 
-        Ok(self
-            .session_manager
-            .decrypt(message)
-            .map_err(Error::Session)?
+        let cloves = self.session_manager.decrypt(message).map_err(Error::Session)?;
+
+        Ok(self.handle_cloves(cloves))
+    }
+
+    /// Handle garlic cloves of a decrypted garlic message.
+    ///
+    /// Lease sets of remote destinations are stored and I2NP Data messages are returned to user.
+    fn handle_cloves(&mut self, cloves: impl Iterator<Item = GarlicClove>) -> Vec<Vec<u8>> {
+        cloves
             .filter_map(|clove| match clove.message_type {
                 MessageType::DatabaseStore => {
                     tracing::debug!(
@@ -720,7 +840,16 @@ impl<R: Runtime> Destination<R> {
                     None
                 }
             })
-            .collect::<Vec<_>>())
+            .collect::<Vec<_>>()
+    }
+
+    /// Publish lease sets of the [`Destination`] as encrypted lease sets.
+    ///
+    /// Lease sets given to [`Destination::publish_lease_set()`] are encrypted and stored under
+    /// the blinded key of the destination. Remote destinations still receive the unencrypted lease
+    /// set in garlic messages.
+    pub fn enable_encrypted_lease_set(&mut self, blinder: LeaseSetBlinder) {
+        self.lease_set_blinder = Some(blinder);
     }
 
     /// Attempt to publish new lease set to `NetDb`.
@@ -728,7 +857,24 @@ impl<R: Runtime> Destination<R> {
         // store our new lease set proactively to `SessionManager` so it can be given to all active
         // session right away while publishing the new lease set to NetDb in the background
         self.session_manager.register_lease_set(lease_set.clone());
-        self.lease_set_manager.register_lease_set(lease_set.clone());
+
+        match &mut self.lease_set_blinder {
+            None => self.lease_set_manager.register_lease_set(lease_set),
+            Some(blinder) => {
+                // blinded key is derived only once per day
+                let signing_key = blinder.blinded_key::<R>();
+                let encrypted = EncryptedLeaseSet::new::<R>(
+                    &lease_set,
+                    signing_key,
+                    R::time_since_epoch().as_secs() as u32,
+                    ENCRYPTED_LEASE_SET_EXPIRATION.as_secs() as u32,
+                );
+                let key = encrypted.routing_key();
+                let encrypted = Bytes::from(encrypted.serialize::<R>(signing_key));
+
+                self.lease_set_manager.register_encrypted_lease_set(key, encrypted);
+            }
+        }
     }
 
     /// Shutdown session by shutting down the tunnel pool.
@@ -751,6 +897,20 @@ impl<R: Runtime> Stream for Destination<R> {
     type Item = DestinationEvent;
 
     fn poll_next(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Option<Self::Item>> {
+        let queued = self.coalesced.keys().cloned().collect::<Vec<_>>();
+
+        for destination_id in queued {
+            if let Err(error) = self.flush_queued(&destination_id) {
+                tracing::warn!(
+                    target: LOG_TARGET,
+                    local = %self.destination_id,
+                    remote = %destination_id,
+                    ?error,
+                    "failed to send queued messages",
+                );
+            }
+        }
+
         loop {
             match self.tunnel_pool_handle.poll_next_unpin(cx) {
                 Poll::Pending => break,
@@ -816,6 +976,13 @@ impl<R: Runtime> Stream for Destination<R> {
                     return Poll::Ready(Some(DestinationEvent::SessionTerminated {
                         destination_id,
                     })),
+                Poll::Ready(Some(SessionManagerEvent::Cloves { cloves })) => {
+                    let messages = self.handle_cloves(cloves.into_iter());
+
+                    if !messages.is_empty() {
+                        return Poll::Ready(Some(DestinationEvent::Messages { messages }));
+                    }
+                }
                 Poll::Ready(Some(SessionManagerEvent::SendMessage {
                     destination_id,
                     message,
@@ -992,6 +1159,7 @@ mod tests {
             Vec::new(),
             false,
             ProfileStorage::new(&[], &[]),
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // insert dummy lease set for `remote` into `Destination`
@@ -1024,6 +1192,7 @@ mod tests {
             Vec::new(),
             false,
             ProfileStorage::new(&[], &[]),
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // insert lease set which expired 10 seconds ago
@@ -1063,6 +1232,7 @@ mod tests {
             Vec::new(),
             false,
             ProfileStorage::new(&[], &[]),
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // query lease set and verify it's not found and that a query has been started
@@ -1091,6 +1261,7 @@ mod tests {
             Vec::new(),
             false,
             ProfileStorage::new(&[], &[]),
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // query lease set and verify it's not found and that a query has been started
@@ -1125,6 +1296,7 @@ mod tests {
             Vec::new(),
             false,
             ProfileStorage::new(&[], &[]),
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // spam the netdb handle full of queries
@@ -1171,6 +1343,7 @@ mod tests {
             Vec::new(),
             false,
             ProfileStorage::new(&[], &[]),
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         destination
@@ -1200,6 +1373,7 @@ mod tests {
             Vec::new(),
             false,
             ProfileStorage::new(&[], &[]),
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // new inbound tunnel built
@@ -1246,6 +1420,7 @@ mod tests {
             Vec::new(),
             true,
             ProfileStorage::new(&[], &[]),
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // insert lease set which expired 10 seconds ago
@@ -1356,6 +1531,7 @@ mod tests {
             Vec::new(),
             false,
             ProfileStorage::new(&[], &[]),
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create remote destination and two leases for it
@@ -1393,6 +1569,7 @@ mod tests {
             remote_dest_id.clone(),
             encryption_key.clone(),
             lease_set,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         session_manager.add_remote_destination(destination_id.clone(), public_key);
         let payload = session_manager.encrypt(&destination_id, vec![1, 3, 3, 7]).unwrap();
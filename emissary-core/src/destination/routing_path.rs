@@ -28,12 +28,18 @@ use hashbrown::{HashMap, HashSet};
 use rand_core::RngCore;
 use thingbuf::mpsc;
 
-use alloc::{vec, vec::Vec};
+#[cfg(feature = "std")]
+use parking_lot::RwLock;
+#[cfg(feature = "no_std")]
+use spin::rwlock::RwLock;
+
+use alloc::{sync::Arc, vec, vec::Vec};
 use core::{
     fmt,
     future::Future,
     marker::PhantomData,
     pin::Pin,
+    sync::atomic::{AtomicUsize, Ordering},
     task::{Context, Poll},
     time::Duration,
 };
@@ -50,6 +56,25 @@ const INBOUND_TUNNEL_MIN_AGE: Duration = Duration::from_secs(30);
 /// Maximum number of lease set queries before remote is considered unreachable.
 const MAX_LEASE_SET_QUERIES: usize = 3usize;
 
+/// Smoothing factor for per-path RTT, new sample is weighted as `1 / RTT_SMOOTHING`.
+const RTT_SMOOTHING: u32 = 8u32;
+
+/// How often an unmeasured path is tried instead of the best measured path.
+///
+/// An unmeasured (outbound tunnel, lease) pair is selected with probability
+/// `1 / PATH_EXPLORATION_RATIO` if there are measured pairs available.
+const PATH_EXPLORATION_RATIO: u32 = 8u32;
+
+/// Scale of the selection weight of a measured path, in milliseconds.
+///
+/// A measured (outbound tunnel, lease) pair is selected with a weight proportional to the inverse
+/// square of its smoothed RTT, `(RTT_WEIGHT_SCALE / rtt)^2`, so that a path with half the RTT of
+/// another path is selected four times as often.
+const RTT_WEIGHT_SCALE: u64 = 65_536u64;
+
+/// Sort key for failing outbound tunnels that are not expiring.
+const NO_EXPIRATION: Duration = Duration::MAX;
+
 /// Recycling strategy for [`NetDbAction`].
 #[derive(Default, Clone, Debug)]
 pub struct RoutingPathCommandRecycle(());
@@ -80,6 +105,7 @@ enum RoutingPathCommand {
             Vec<(TunnelId, Duration)>,
             HashSet<TunnelId>,
             Vec<(TunnelId, Duration)>,
+            PathStats,
         )>,
     },
 
@@ -145,6 +171,197 @@ impl fmt::Display for RoutingPath {
     }
 }
 
+/// Smoothed RTTs of routing paths, keyed by (outbound tunnel ID, remote inbound tunnel ID).
+///
+/// Owned by [`RoutingPathManager`] and shared with all of its [`RoutingPathHandle`]s so that
+/// a new stream to a destination benefits from the measurements of earlier streams.
+#[derive(Clone, Default)]
+struct PathStats {
+    /// Smoothed RTTs.
+    rtts: Arc<RwLock<HashMap<(TunnelId, TunnelId), Duration>>>,
+
+    /// Version of the measurements, incremented every time they change.
+    ///
+    /// Allows [`RoutingPathHandle`]s to detect that their ranked paths are out of date.
+    version: Arc<AtomicUsize>,
+}
+
+impl PathStats {
+    /// Get smoothed RTT of the path formed by `outbound` and `inbound`, if it has been measured.
+    #[cfg(test)]
+    fn get(&self, outbound: &TunnelId, inbound: &TunnelId) -> Option<Duration> {
+        self.rtts.read().get(&(*outbound, *inbound)).copied()
+    }
+
+    /// Get current version of the measurements.
+    fn version(&self) -> usize {
+        self.version.load(Ordering::Acquire)
+    }
+
+    /// Register RTT `sample` measured over the path formed by `outbound` and `inbound`.
+    fn register(&self, outbound: TunnelId, inbound: TunnelId, sample: Duration) {
+        self.rtts
+            .write()
+            .entry((outbound, inbound))
+            .and_modify(|rtt| *rtt = (*rtt * (RTT_SMOOTHING - 1) + sample) / RTT_SMOOTHING)
+            .or_insert(sample);
+        self.version.fetch_add(1, Ordering::Release);
+    }
+
+    /// Forget the measurement of the path formed by `outbound` and `inbound`.
+    fn remove(&self, outbound: &TunnelId, inbound: &TunnelId) {
+        self.rtts.write().remove(&(*outbound, *inbound));
+        self.version.fetch_add(1, Ordering::Release);
+    }
+
+    /// Forget all measurements of paths which use outbound tunnel `tunnel_id`.
+    fn remove_outbound(&self, tunnel_id: &TunnelId) {
+        self.rtts.write().retain(|(outbound, _), _| outbound != tunnel_id);
+        self.version.fetch_add(1, Ordering::Release);
+    }
+
+    /// Forget all measurements of paths which use any of the remote inbound tunnels in `tunnels`.
+    fn remove_inbound(&self, tunnels: &[TunnelId]) {
+        if tunnels.is_empty() {
+            return;
+        }
+
+        self.rtts.write().retain(|(_, inbound), _| !tunnels.contains(inbound));
+        self.version.fetch_add(1, Ordering::Release);
+    }
+}
+
+/// (outbound tunnel, lease) pairs ranked by their smoothed RTTs.
+///
+/// The pairs are formed from the active outbound tunnels and the eligible inbound tunnels of the
+/// remote destination. Measured pairs are kept in an alias table (Vose's alias method) weighted by
+/// their RTTs, allowing an RTT-weighted random pair to be selected in constant time.
+///
+/// The ranking is recomputed only after a tunnel, lease or RTT event has made it stale or after
+/// one of the ranked leases has stopped being eligible.
+#[derive(Default)]
+struct RankedPaths {
+    /// Have the tunnels changed since the pairs were ranked.
+    stale: bool,
+
+    /// Version of [`PathStats`] the pairs were ranked with.
+    version: usize,
+
+    /// The pairs stay valid as long as the eligibility threshold is below this value.
+    ///
+    /// Set to the earliest expiration of the ranked leases.
+    valid_until: Duration,
+
+    /// Measured pairs.
+    measured: Vec<(TunnelId, (TunnelId, Duration))>,
+
+    /// Alias table for `measured`.
+    ///
+    /// Slot `i` holds the scaled probability of keeping pair `i` and the index of the pair that is
+    /// selected otherwise.
+    aliases: Vec<(u64, usize)>,
+
+    /// Total weight of the measured pairs.
+    total_weight: u64,
+
+    /// Unmeasured pairs.
+    unmeasured: Vec<(TunnelId, (TunnelId, Duration))>,
+}
+
+impl RankedPaths {
+    /// Get selection weight of a path with smoothed RTT `rtt`.
+    fn weight(rtt: Duration) -> u64 {
+        let rtt = (rtt.as_millis() as u64).clamp(1, RTT_WEIGHT_SCALE);
+
+        (RTT_WEIGHT_SCALE / rtt).pow(2)
+    }
+
+    /// Is the ranking up to date with respect to `version` and eligibility `threshold`.
+    fn is_valid(&self, version: usize, threshold: Duration) -> bool {
+        !self.stale && self.version == version && threshold < self.valid_until
+    }
+
+    /// Rank pairs formed from `outbound` tunnels and eligible `inbound` tunnels using `stats`.
+    fn rank(&mut self, outbound: &[TunnelId], inbound: &[(TunnelId, Duration)], stats: &PathStats) {
+        self.stale = false;
+        self.version = stats.version();
+        self.valid_until =
+            inbound.iter().map(|(_, expires)| *expires).min().unwrap_or(Duration::MAX);
+        self.measured.clear();
+        self.unmeasured.clear();
+
+        let mut weights = Vec::new();
+        {
+            let rtts = stats.rtts.read();
+
+            for outbound in outbound {
+                for lease in inbound {
+                    match rtts.get(&(*outbound, lease.0)) {
+                        Some(rtt) => {
+                            self.measured.push((*outbound, *lease));
+                            weights.push(Self::weight(*rtt));
+                        }
+                        None => self.unmeasured.push((*outbound, *lease)),
+                    }
+                }
+            }
+        }
+
+        // build the alias table
+        //
+        // the weights are scaled by the number of pairs so that a slot whose scaled weight equals
+        // the total weight is selected with probability `1 / n`; slots below that are topped up
+        // with the excess of slots above it, recording the donor as the slot's alias
+        let num_pairs = weights.len() as u64;
+        let total_weight = weights.iter().sum::<u64>();
+        let mut scaled = weights.into_iter().map(|weight| weight * num_pairs).collect::<Vec<_>>();
+        let (mut small, mut large): (Vec<_>, Vec<_>) =
+            (0..scaled.len()).partition(|index| scaled[*index] < total_weight);
+
+        self.total_weight = total_weight;
+        self.aliases.clear();
+        self.aliases.extend((0..scaled.len()).map(|index| (total_weight, index)));
+
+        // the scaled weights sum up to `n * total_weight` so the slots above the total weight run
+        // out only after the slots below it have been topped up
+        while let (Some(small_index), Some(large_index)) = (small.pop(), large.last().copied()) {
+            self.aliases[small_index] = (scaled[small_index], large_index);
+            scaled[large_index] -= total_weight - scaled[small_index];
+
+            if scaled[large_index] < total_weight {
+                large.pop();
+                small.push(large_index);
+            }
+        }
+    }
+
+    /// Select a ranked pair.
+    ///
+    /// A measured pair is selected with probability proportional to its weight but with probability
+    /// `1 / PATH_EXPLORATION_RATIO`, a random unmeasured pair is selected instead so that new
+    /// tunnels and leases get measured. If none of the pairs have been measured, a random pair is
+    /// selected.
+    fn select(&self, rng: &mut impl RngCore) -> Option<(TunnelId, (TunnelId, Duration))> {
+        if !self.unmeasured.is_empty()
+            && (self.measured.is_empty() || rng.next_u32() % PATH_EXPLORATION_RATIO == 0)
+        {
+            return Some(self.unmeasured[(rng.next_u32() as usize) % self.unmeasured.len()]);
+        }
+
+        if self.measured.is_empty() {
+            return None;
+        }
+
+        let index = (rng.next_u32() as usize) % self.measured.len();
+        let (probability, alias) = self.aliases[index];
+
+        match rng.next_u64() % self.total_weight < probability {
+            true => Some(self.measured[index]),
+            false => Some(self.measured[alias]),
+        }
+    }
+}
+
 /// Evens sent by [`RoutingPathManager`] to [`RoutingPathHandle`]s.
 #[derive(Default, Clone)]
 enum RoutingPathEvent {
@@ -226,6 +443,9 @@ pub struct RoutingPathManager<R> {
     /// Outbound tunnels.
     outbound_tunnels: HashSet<TunnelId>,
 
+    /// RTTs of routing paths, shared with [`RoutingPathHandle`]s.
+    path_stats: PathStats,
+
     /// Pending lease set queries.
     pending_queries: HashMap<DestinationId, Vec<oneshot::Sender<Result<(), QueryError>>>>,
 
@@ -251,6 +471,7 @@ impl<R: Runtime> RoutingPathManager<R> {
             expiring_outbound_tunnels: Vec::new(),
             inbound_tunnels: HashMap::new(),
             outbound_tunnels: outbound_tunnels.into_iter().collect(),
+            path_stats: PathStats::default(),
             pending_queries: HashMap::new(),
             subscribers: HashMap::new(),
             _runtime: Default::default(),
@@ -281,6 +502,7 @@ impl<R: Runtime> RoutingPathManager<R> {
             inbound_tunnels,
             self.outbound_tunnels.clone(),
             self.expiring_outbound_tunnels.clone(),
+            self.path_stats.clone(),
         )
     }
 
@@ -356,6 +578,7 @@ impl<R: Runtime> RoutingPathManager<R> {
             "outbound tunnel expired",
         );
         self.expiring_outbound_tunnels.retain(|(tunnel, _)| tunnel != &tunnel_id);
+        self.path_stats.remove_outbound(&tunnel_id);
 
         self.subscribers.values_mut().for_each(|subscribers| {
             subscribers.retain(|tx| {
@@ -448,8 +671,19 @@ impl<R: Runtime> RoutingPathManager<R> {
         }
 
         // extend the current set of `destination_id`'s leases and prune all expired leases
+        let now = R::time_since_epoch();
+        let mut expired = Vec::new();
+
         current_leases.extend(leases.clone());
-        current_leases.retain(|lease| lease.expires > R::time_since_epoch());
+        current_leases.retain(|lease| {
+            if lease.expires > now {
+                return true;
+            }
+
+            expired.push(lease.tunnel_id);
+            false
+        });
+        self.path_stats.remove_inbound(&expired);
 
         if let Some(subscribers) = self.subscribers.get_mut(destination_id) {
             subscribers.retain(|tx| {
@@ -503,6 +737,7 @@ impl<R: Unpin> Stream for RoutingPathManager<R> {
                         inbound_tunnels,
                         self.outbound_tunnels.clone(),
                         self.expiring_outbound_tunnels.clone(),
+                        self.path_stats.clone(),
                     )) {
                         tracing::debug!(
                             target: LOG_TARGET,
@@ -574,7 +809,7 @@ impl PendingRoutingPathHandle {
             .ok()?;
 
         rx.await.ok().map(
-            |(rx, cmd_tx, inbound_tunnels, outbound_tunnels, expiring_outbound_tunnels)| {
+            |(rx, cmd_tx, inbound_tunnels, outbound_tunnels, expiring_outbound_tunnels, stats)| {
                 RoutingPathHandle::<R>::new(
                     destination_id,
                     rx,
@@ -582,6 +817,7 @@ impl PendingRoutingPathHandle {
                     inbound_tunnels,
                     outbound_tunnels,
                     expiring_outbound_tunnels,
+                    stats,
                 )
             },
         )
@@ -646,6 +882,147 @@ enum TunnelKind {
     },
 }
 
+/// Tunnels known to a [`RoutingPathHandle`].
+///
+/// In addition to the tunnel kinds, the tunnels are kept ranked in tiers which are updated
+/// incrementally as tunnel events are received. Tiers with time-based eligibility are sorted by
+/// expiration, latest first, so the eligible tunnels of a tier are always a prefix of the tier
+/// and selecting a tunnel for a new routing path doesn't require rescanning all tunnels.
+#[derive(Default)]
+struct Tunnels {
+    /// Tunnel kinds.
+    kinds: HashMap<TunnelId, TunnelKind>,
+
+    /// Active outbound tunnels.
+    outbound: Vec<TunnelId>,
+
+    /// Expiring outbound tunnels, sorted by expiration.
+    expiring_outbound: Vec<(TunnelId, Duration)>,
+
+    /// Failing outbound tunnels, sorted by expiration.
+    ///
+    /// Tunnels that are not expiring use [`NO_EXPIRATION`] as their expiration.
+    failing_outbound: Vec<(TunnelId, Duration)>,
+
+    /// Active inbound tunnels, sorted by expiration.
+    inbound: Vec<(TunnelId, Duration)>,
+
+    /// Failing inbound tunnels, sorted by expiration.
+    failing_inbound: Vec<(TunnelId, Duration)>,
+
+    /// Ranked (outbound tunnel, lease) pairs formed from active tunnels.
+    paths: RankedPaths,
+}
+
+impl Tunnels {
+    /// Insert `tunnel_id` into `tier` while keeping the tier sorted by expiration.
+    fn insert_sorted(tier: &mut Vec<(TunnelId, Duration)>, tunnel_id: TunnelId, expires: Duration) {
+        let index = tier.partition_point(|(_, other)| *other > expires);
+        tier.insert(index, (tunnel_id, expires));
+    }
+
+    /// Get those tunnels of `tier` which don't expire before `threshold`.
+    fn eligible(tier: &[(TunnelId, Duration)], threshold: Duration) -> &[(TunnelId, Duration)] {
+        &tier[..tier.partition_point(|(_, expires)| *expires > threshold)]
+    }
+
+    /// Remove `tunnel_id` from the tier it's currently ranked in.
+    fn unrank(&mut self, tunnel_id: &TunnelId, kind: &TunnelKind) {
+        self.paths.stale |= core::matches!(
+            kind,
+            TunnelKind::Outbound { .. } | TunnelKind::Inbound { .. }
+        );
+
+        match kind {
+            TunnelKind::Outbound { .. } => self.outbound.retain(|tunnel| tunnel != tunnel_id),
+            TunnelKind::ExpiringOutbound { .. } =>
+                self.expiring_outbound.retain(|(tunnel, _)| tunnel != tunnel_id),
+            TunnelKind::FailingOutbound { .. } =>
+                self.failing_outbound.retain(|(tunnel, _)| tunnel != tunnel_id),
+            TunnelKind::Inbound { .. } => self.inbound.retain(|(tunnel, _)| tunnel != tunnel_id),
+            TunnelKind::FailingInbound { .. } =>
+                self.failing_inbound.retain(|(tunnel, _)| tunnel != tunnel_id),
+        }
+    }
+
+    /// Rank `tunnel_id` into the tier corresponding to `kind`.
+    fn rank(&mut self, tunnel_id: TunnelId, kind: &TunnelKind) {
+        self.paths.stale |= core::matches!(
+            kind,
+            TunnelKind::Outbound { .. } | TunnelKind::Inbound { .. }
+        );
+
+        match kind {
+            TunnelKind::Outbound { .. } => self.outbound.push(tunnel_id),
+            TunnelKind::ExpiringOutbound { expires, .. } =>
+                Self::insert_sorted(&mut self.expiring_outbound, tunnel_id, *expires),
+            TunnelKind::FailingOutbound { expires, .. } => Self::insert_sorted(
+                &mut self.failing_outbound,
+                tunnel_id,
+                expires.unwrap_or(NO_EXPIRATION),
+            ),
+            TunnelKind::Inbound { expires, .. } =>
+                Self::insert_sorted(&mut self.inbound, tunnel_id, *expires),
+            TunnelKind::FailingInbound { expires, .. } =>
+                Self::insert_sorted(&mut self.failing_inbound, tunnel_id, *expires),
+        }
+    }
+
+    /// Get [`TunnelKind`] of `tunnel_id`.
+    fn get(&self, tunnel_id: &TunnelId) -> Option<&TunnelKind> {
+        self.kinds.get(tunnel_id)
+    }
+
+    /// Get number of tunnels.
+    #[cfg(test)]
+    fn len(&self) -> usize {
+        self.kinds.len()
+    }
+
+    /// Insert `tunnel_id`, replacing its previous kind if it exists.
+    fn insert(&mut self, tunnel_id: TunnelId, kind: TunnelKind) {
+        if let Some(previous) = self.kinds.remove(&tunnel_id) {
+            self.unrank(&tunnel_id, &previous);
+        }
+
+        self.rank(tunnel_id, &kind);
+        self.kinds.insert(tunnel_id, kind);
+    }
+
+    /// Remove `tunnel_id`.
+    fn remove(&mut self, tunnel_id: &TunnelId) -> Option<TunnelKind> {
+        let kind = self.kinds.remove(tunnel_id)?;
+        self.unrank(tunnel_id, &kind);
+
+        Some(kind)
+    }
+
+    /// Get ranked (outbound tunnel, lease) pairs, re-ranking them first if they're out of date.
+    ///
+    /// Only leases which don't expire before `threshold` are ranked.
+    fn ranked_paths(&mut self, stats: &PathStats, threshold: Duration) -> &RankedPaths {
+        if !self.paths.is_valid(stats.version(), threshold) {
+            let inbound = Self::eligible(&self.inbound, threshold);
+            self.paths.rank(&self.outbound, inbound, stats);
+        }
+
+        &self.paths
+    }
+
+    /// Retain only the tunnels specified by `f`.
+    fn retain(&mut self, mut f: impl FnMut(&TunnelId, &TunnelKind) -> bool) {
+        let removed = self
+            .kinds
+            .iter()
+            .filter_map(|(tunnel_id, kind)| (!f(tunnel_id, kind)).then_some(*tunnel_id))
+            .collect::<Vec<_>>();
+
+        removed.into_iter().for_each(|tunnel_id| {
+            self.remove(&tunnel_id);
+        });
+    }
+}
+
 /// Remote lease set query status.
 enum LeaseSetQueryStatus {
     /// Remote lease set is not being quried.
@@ -689,11 +1066,14 @@ pub struct RoutingPathHandle<R: Runtime> {
     /// Lease set query status.
     lease_set_query_status: LeaseSetQueryStatus,
 
+    /// RTTs of routing paths, shared with [`RoutingPathManager`].
+    path_stats: PathStats,
+
     /// Selected routing path, if any.
     routing_path: Option<RoutingPath>,
 
     /// Tunnels.
-    tunnels: HashMap<TunnelId, TunnelKind>,
+    tunnels: Tunnels,
 }
 
 impl<R: Runtime> RoutingPathHandle<R> {
@@ -705,8 +1085,11 @@ impl<R: Runtime> RoutingPathHandle<R> {
         inbound_tunnels: Vec<(TunnelId, Duration)>,
         outbound_tunnels: HashSet<TunnelId>,
         expiring_outbound_tunnels: Vec<(TunnelId, Duration)>,
+        path_stats: PathStats,
     ) -> Self {
-        let tunnels = inbound_tunnels
+        let mut tunnels = Tunnels::default();
+
+        inbound_tunnels
             .into_iter()
             .map(|(tunnel_id, expires)| (tunnel_id, TunnelKind::Inbound { tunnel_id, expires }))
             .chain(
@@ -722,7 +1105,7 @@ impl<R: Runtime> RoutingPathHandle<R> {
                     )
                 }),
             )
-            .collect::<HashMap<_, _>>();
+            .for_each(|(tunnel_id, kind)| tunnels.insert(tunnel_id, kind));
 
         Self {
             cmd_tx,
@@ -732,6 +1115,7 @@ impl<R: Runtime> RoutingPathHandle<R> {
             lease_set_query_status: LeaseSetQueryStatus::Inactive {
                 num_retries: 0usize,
             },
+            path_stats,
             routing_path: None,
             tunnels,
         }
@@ -744,58 +1128,34 @@ impl<R: Runtime> RoutingPathHandle<R> {
     /// tunnels, attempt to select a tunnel from the set of failing tunnels in hopes that the tunnel
     /// works now. If there are no tunnels, `None` is returned and the caller must try again later.
     fn select_outbound_tunnel(&self) -> Option<TunnelId> {
-        let now = R::time_since_epoch();
-
-        // TODO: upgrade to 2024 and collect into three vectors
-        let available = self
-            .tunnels
-            .iter()
-            .filter_map(|(tunnel_id, kind)| {
-                core::matches!(kind, TunnelKind::Outbound { .. }).then_some(*tunnel_id)
-            })
-            .collect::<Vec<_>>();
-
-        let (expiring, failing): (Vec<_>, Vec<_>) = self
-            .tunnels
-            .iter()
-            .filter_map(|(_, kind)| match kind {
-                TunnelKind::ExpiringOutbound { tunnel_id, expires }
-                    if *expires > now + OUTBOUND_TUNNEL_EXPIRATION =>
-                    Some((Some(*tunnel_id), None)),
-                TunnelKind::FailingOutbound { tunnel_id, expires } => match expires {
-                    Some(expires) if *expires > now + OUTBOUND_TUNNEL_EXPIRATION =>
-                        Some((None, Some(*tunnel_id))),
-                    None => Some((None, Some(*tunnel_id))),
-                    _ => None,
-                },
-                _ => None,
-            })
-            .unzip();
-
-        // first attempt to select an expiring tunnel
-        let expiring = expiring.into_iter().flatten().collect::<Vec<_>>();
-        let failing = failing.into_iter().flatten().collect::<Vec<_>>();
+        let threshold = R::time_since_epoch() + OUTBOUND_TUNNEL_EXPIRATION;
+        let expiring = Tunnels::eligible(&self.tunnels.expiring_outbound, threshold);
+        let failing = Tunnels::eligible(&self.tunnels.failing_outbound, threshold);
 
         tracing::trace!(
             target: LOG_TARGET,
             destination_id = %self.destination_id,
-            num_available = ?available.len(),
+            num_available = ?self.tunnels.outbound.len(),
             num_expiring = ?expiring.len(),
             num_failing = ?failing.len(),
             "attempt to select outbound tunnel",
         );
 
-        if !available.is_empty() {
-            return Some(available[(R::rng().next_u32() as usize) % available.len()]);
+        // first attempt to select a random active tunnel
+        if !self.tunnels.outbound.is_empty() {
+            return Some(
+                self.tunnels.outbound[(R::rng().next_u32() as usize) % self.tunnels.outbound.len()],
+            );
         }
 
+        // attempt to select an expiring tunnel
         if !expiring.is_empty() {
-            return Some(expiring[(R::rng().next_u32() as usize) % expiring.len()]);
+            return Some(expiring[(R::rng().next_u32() as usize) % expiring.len()].0);
         }
 
         // finally attempt to select a failing tunnel
         if !failing.is_empty() {
-            return Some(failing[(R::rng().next_u32() as usize) % failing.len()]);
+            return Some(failing[(R::rng().next_u32() as usize) % failing.len()].0);
         }
 
         tracing::debug!(
@@ -812,25 +1172,9 @@ impl<R: Runtime> RoutingPathHandle<R> {
     /// Select those inbound tunnels which won't expire for the next 30 seconds and from the set
     /// of non-expiring tunnels, select a random tunnel.
     fn select_inbound_tunnel(&mut self) -> Option<(TunnelId, Duration)> {
-        let now = R::time_since_epoch();
-
-        let (available, failing): (Vec<_>, Vec<_>) = self
-            .tunnels
-            .iter()
-            .filter_map(|(_, kind)| match kind {
-                TunnelKind::Inbound { tunnel_id, expires }
-                    if *expires > now + INBOUND_TUNNEL_MIN_AGE =>
-                    Some((Some((*tunnel_id, *expires)), None)),
-                TunnelKind::FailingInbound { tunnel_id, expires }
-                    if *expires > now + INBOUND_TUNNEL_MIN_AGE =>
-                    Some((None, Some((*tunnel_id, *expires)))),
-                _ => None,
-            })
-            .unzip();
-
-        // first attempt select a random inbound tunnel
-        let available = available.into_iter().flatten().collect::<Vec<_>>();
-        let failing = failing.into_iter().flatten().collect::<Vec<_>>();
+        let threshold = R::time_since_epoch() + INBOUND_TUNNEL_MIN_AGE;
+        let available = Tunnels::eligible(&self.tunnels.inbound, threshold);
+        let failing = Tunnels::eligible(&self.tunnels.failing_inbound, threshold);
 
         tracing::trace!(
             target: LOG_TARGET,
@@ -840,6 +1184,7 @@ impl<R: Runtime> RoutingPathHandle<R> {
             "attempt to select inbound tunnel",
         );
 
+        // first attempt select a random inbound tunnel
         if !available.is_empty() {
             return Some(available[(R::rng().next_u32() as usize) % available.len()]);
         }
@@ -892,14 +1237,31 @@ impl<R: Runtime> RoutingPathHandle<R> {
         None
     }
 
+    /// Attempt to select a ranked (outbound tunnel, lease) pair for routing path.
+    ///
+    /// See [`RankedPaths::select()`] for more details.
+    ///
+    /// Returns `None` if there are either no active outbound or no active inbound tunnels.
+    fn select_ranked_path(&mut self) -> Option<(TunnelId, (TunnelId, Duration))> {
+        let threshold = R::time_since_epoch() + INBOUND_TUNNEL_MIN_AGE;
+
+        self.tunnels.ranked_paths(&self.path_stats, threshold).select(&mut R::rng())
+    }
+
     /// Attempt to create routing path.
     ///
-    /// Try selecting an inbound and an outbound tunnel from the available tunnels and if both
-    /// tunnels are found, start an expiration timer for the inbound tunnel so a new routing path is
-    /// created before the tunnel expires, create and return the new routing path.
+    /// Try selecting a ranked (outbound tunnel, lease) pair and if there are no active tunnels to
+    /// form one, select an inbound and an outbound tunnel from the expiring and failing tunnels. If
+    /// both tunnels are found, start an expiration timer for the inbound tunnel so a new routing
+    /// path is created before the tunnel expires, create and return the new routing path.
     fn make_routing_path(&mut self) -> Option<RoutingPath> {
-        let outbound = self.select_outbound_tunnel()?;
-        let (inbound, expires) = self.select_inbound_tunnel()?;
+        let (outbound, (inbound, expires)) = match self.select_ranked_path() {
+            Some(path) => path,
+            None => (
+                self.select_outbound_tunnel()?,
+                self.select_inbound_tunnel()?,
+            ),
+        };
 
         // `select_inbond_tunnel()` has ensured the tunnel doesn't expire in the next 30 seconds
         self.inbound_expiration_timer = Some(R::timer(
@@ -931,6 +1293,58 @@ impl<R: Runtime> RoutingPathHandle<R> {
         }
     }
 
+    /// Register RTT `sample` measured over the current routing path.
+    ///
+    /// The sample is attributed to the (outbound tunnel, lease) pair of the routing path and is
+    /// shared with all handles of the [`RoutingPathManager`], allowing them to prefer paths with
+    /// lower latency when a new routing path is created.
+    pub fn register_rtt(&mut self, sample: Duration) {
+        if let Some(RoutingPath {
+            inbound, outbound, ..
+        }) = &self.routing_path
+        {
+            self.path_stats.register(*outbound, *inbound, sample);
+        }
+    }
+
+    /// Get a routing path that shares no tunnels with the current routing path.
+    ///
+    /// The alternative routing path is not stored and the current routing path is left intact,
+    /// allowing the owner of the handle to send a latency-critical message over two independent
+    /// paths at the same time.
+    ///
+    /// Returns `None` if there is no current routing path or if there are no other active inbound
+    /// and outbound tunnels available.
+    pub fn alternative_routing_path(&self) -> Option<RoutingPath> {
+        let RoutingPath {
+            inbound, outbound, ..
+        } = self.routing_path.as_ref()?;
+
+        let threshold = R::time_since_epoch() + INBOUND_TUNNEL_MIN_AGE;
+        let inbound_tunnels = Tunnels::eligible(&self.tunnels.inbound, threshold)
+            .iter()
+            .filter_map(|(tunnel_id, _)| (tunnel_id != inbound).then_some(*tunnel_id))
+            .collect::<Vec<_>>();
+        let outbound_tunnels = self
+            .tunnels
+            .outbound
+            .iter()
+            .filter(|tunnel_id| *tunnel_id != outbound)
+            .collect::<Vec<_>>();
+
+        if inbound_tunnels.is_empty() || outbound_tunnels.is_empty() {
+            return None;
+        }
+
+        let mut rng = R::rng();
+
+        Some(RoutingPath {
+            destination_id: self.destination_id.clone(),
+            inbound: inbound_tunnels[(rng.next_u32() as usize) % inbound_tunnels.len()],
+            outbound: *outbound_tunnels[(rng.next_u32() as usize) % outbound_tunnels.len()],
+        })
+    }
+
     /// Attempt to create new routing path, replacing the old one.
     ///
     /// Note that the same routing path may be created if there are no other tunnels available.
@@ -958,6 +1372,7 @@ impl<R: Runtime> RoutingPathHandle<R> {
 
         // reset inbound expiration time in case a new routing path cannot be constructed
         self.inbound_expiration_timer = None;
+        self.path_stats.remove(outbound, inbound);
 
         match self.tunnels.remove(inbound) {
             Some(
@@ -1224,6 +1639,57 @@ mod tests {
         }
     }
 
+    #[tokio::test]
+    async fn alternative_routing_path() {
+        let remote = DestinationId::random();
+        let outbound1 = TunnelId::random();
+        let outbound2 = TunnelId::random();
+        let lease1 = Lease::random();
+        let lease2 = Lease::random();
+
+        let mut manager = RoutingPathManager::<MockRuntime>::new(
+            DestinationId::random(),
+            vec![outbound1, outbound2],
+        );
+        manager.register_leases(&remote, Ok(vec![lease1.clone(), lease2.clone()]));
+
+        let mut handle = manager.handle(remote.clone());
+
+        // no alternative path before a routing path has been created
+        assert!(handle.alternative_routing_path().is_none());
+
+        let routing_path = handle.routing_path().unwrap();
+        let alternative = handle.alternative_routing_path().unwrap();
+
+        assert_eq!(alternative.destination_id, remote);
+        assert_ne!(alternative.inbound, routing_path.inbound);
+        assert_ne!(alternative.outbound, routing_path.outbound);
+
+        // current routing path is left intact
+        let current = handle.routing_path().unwrap();
+        assert_eq!(current.inbound, routing_path.inbound);
+        assert_eq!(current.outbound, routing_path.outbound);
+    }
+
+    #[tokio::test]
+    async fn no_alternative_routing_path() {
+        let remote = DestinationId::random();
+        let lease1 = Lease::random();
+        let lease2 = Lease::random();
+
+        let mut manager = RoutingPathManager::<MockRuntime>::new(
+            DestinationId::random(),
+            vec![TunnelId::random()],
+        );
+        manager.register_leases(&remote, Ok(vec![lease1, lease2]));
+
+        let mut handle = manager.handle(remote.clone());
+        assert!(handle.routing_path().is_some());
+
+        // only one outbound tunnel so there is no disjoint routing path
+        assert!(handle.alternative_routing_path().is_none());
+    }
+
     #[test]
     fn expiring_inbound_tunnel() {
         let remote = DestinationId::random();
@@ -2059,4 +2525,221 @@ mod tests {
         manager.register_leases(&remote, Err(QueryError::Timeout));
         assert!(tokio::time::timeout(Duration::from_secs(1), &mut handle).await.is_ok());
     }
+
+    #[test]
+    fn tunnel_tiers_updated_incrementally() {
+        let now = MockRuntime::time_since_epoch();
+        let mut tunnels = Tunnels::default();
+
+        let short = TunnelId::random();
+        let long = TunnelId::random();
+        let outbound = TunnelId::random();
+
+        tunnels.insert(
+            short,
+            TunnelKind::ExpiringOutbound {
+                tunnel_id: short,
+                expires: now + Duration::from_secs(10),
+            },
+        );
+        tunnels.insert(
+            long,
+            TunnelKind::ExpiringOutbound {
+                tunnel_id: long,
+                expires: now + Duration::from_secs(90),
+            },
+        );
+        tunnels.insert(
+            outbound,
+            TunnelKind::Outbound {
+                tunnel_id: outbound,
+            },
+        );
+
+        // only the long-lived expiring tunnel is eligible
+        assert_eq!(
+            Tunnels::eligible(&tunnels.expiring_outbound, now + OUTBOUND_TUNNEL_EXPIRATION),
+            &[(long, now + Duration::from_secs(90))]
+        );
+
+        // mark the active tunnel as failing and verify it's moved to the correct tier
+        tunnels.insert(
+            outbound,
+            TunnelKind::FailingOutbound {
+                tunnel_id: outbound,
+                expires: None,
+            },
+        );
+        assert!(tunnels.outbound.is_empty());
+        assert_eq!(tunnels.failing_outbound, vec![(outbound, NO_EXPIRATION)]);
+
+        // remove all expiring tunnels
+        tunnels.retain(|_, kind| !core::matches!(kind, TunnelKind::ExpiringOutbound { .. }));
+        assert!(tunnels.expiring_outbound.is_empty());
+        assert_eq!(tunnels.len(), 1);
+    }
+
+    #[tokio::test]
+    async fn measured_path_preferred() {
+        let remote = DestinationId::random();
+        let slow = TunnelId::random();
+        let fast = TunnelId::random();
+        let lease = Lease::random();
+
+        let mut manager =
+            RoutingPathManager::<MockRuntime>::new(DestinationId::random(), vec![slow, fast]);
+        manager.register_leases(&remote, Ok(vec![lease.clone()]));
+
+        manager.path_stats.register(slow, lease.tunnel_id, Duration::from_millis(800));
+        manager.path_stats.register(fast, lease.tunnel_id, Duration::from_millis(100));
+
+        // all pairs are measured and the fast pair has 64 times the weight of the slow pair
+        let mut handle = manager.handle(remote.clone());
+        let threshold = MockRuntime::time_since_epoch() + INBOUND_TUNNEL_MIN_AGE;
+        let paths = handle.tunnels.ranked_paths(&handle.path_stats, threshold);
+
+        assert!(paths.unmeasured.is_empty());
+        assert_eq!(paths.measured.len(), 2);
+
+        let num_fast = (0..1000)
+            .filter(|_| handle.make_routing_path().unwrap().outbound == fast)
+            .count();
+        assert!(num_fast > 950, "{num_fast}");
+
+        // rtt is forgotten when the tunnel expires
+        manager.register_outbound_tunnel_expired(fast);
+        assert!(manager.path_stats.get(&fast, &lease.tunnel_id).is_none());
+        assert!(manager.path_stats.get(&slow, &lease.tunnel_id).is_some());
+    }
+
+    #[tokio::test]
+    async fn unmeasured_path_explored_rarely() {
+        let remote = DestinationId::random();
+        let measured = TunnelId::random();
+        let unmeasured = TunnelId::random();
+        let lease = Lease::random();
+
+        let mut manager = RoutingPathManager::<MockRuntime>::new(
+            DestinationId::random(),
+            vec![measured, unmeasured],
+        );
+        manager.register_leases(&remote, Ok(vec![lease.clone()]));
+        manager
+            .path_stats
+            .register(measured, lease.tunnel_id, Duration::from_millis(500));
+
+        let mut handle = manager.handle(remote.clone());
+        let num_unmeasured = (0..1000)
+            .filter(|_| handle.make_routing_path().unwrap().outbound == unmeasured)
+            .count();
+
+        // unmeasured path is selected ~1/8 of the time
+        assert!(
+            num_unmeasured > 50 && num_unmeasured < 250,
+            "{num_unmeasured}"
+        );
+    }
+
+    #[tokio::test]
+    async fn rtt_shared_between_handles() {
+        let remote = DestinationId::random();
+        let outbound = TunnelId::random();
+        let lease = Lease::random();
+
+        let mut manager =
+            RoutingPathManager::<MockRuntime>::new(DestinationId::random(), vec![outbound]);
+        manager.register_leases(&remote, Ok(vec![lease.clone()]));
+
+        // measure the path over the first handle
+        let mut handle = manager.handle(remote.clone());
+        assert!(handle.routing_path().is_some());
+        handle.register_rtt(Duration::from_millis(200));
+
+        // handle bound to the same destination later sees the measurement
+        let pending = manager.pending_handle();
+        let future = pending.bind::<MockRuntime>(remote.clone());
+        tokio::pin!(future);
+
+        assert!(futures::poll!(&mut future).is_pending());
+        assert!(manager.next().now_or_never().is_none());
+
+        let mut other = future.await.unwrap();
+        let threshold = MockRuntime::time_since_epoch() + INBOUND_TUNNEL_MIN_AGE;
+        let paths = other.tunnels.ranked_paths(&other.path_stats, threshold);
+
+        assert!(paths.unmeasured.is_empty());
+        assert_eq!(
+            paths.measured,
+            vec![(outbound, (lease.tunnel_id, lease.expires))]
+        );
+        assert_eq!(
+            other.path_stats.get(&outbound, &lease.tunnel_id),
+            Some(Duration::from_millis(200))
+        );
+
+        // marking the path as failing forgets the measurement
+        handle.recreate_routing_path();
+        assert!(manager.path_stats.get(&outbound, &lease.tunnel_id).is_none());
+    }
+
+    #[test]
+    fn paths_selected_by_rtt_weight() {
+        let stats = PathStats::default();
+        let mut tunnels = Tunnels::default();
+        let now = MockRuntime::time_since_epoch();
+        let outbound = [TunnelId::random(), TunnelId::random(), TunnelId::random()];
+        let inbound = TunnelId::random();
+        let expires = now + Duration::from_secs(60);
+
+        outbound.iter().for_each(|tunnel_id| {
+            tunnels.insert(
+                *tunnel_id,
+                TunnelKind::Outbound {
+                    tunnel_id: *tunnel_id,
+                },
+            )
+        });
+        tunnels.insert(
+            inbound,
+            TunnelKind::Inbound {
+                tunnel_id: inbound,
+                expires,
+            },
+        );
+
+        stats.register(outbound[0], inbound, Duration::from_millis(100));
+        stats.register(outbound[1], inbound, Duration::from_millis(200));
+        stats.register(outbound[2], inbound, Duration::from_millis(400));
+
+        // selection frequencies follow the inverse square of the rtt, 16:4:1
+        let mut rng = MockRuntime::rng();
+        let paths = tunnels.ranked_paths(&stats, now);
+        let mut counts = [0usize; 3];
+
+        for _ in 0..21_000 {
+            let (selected, _) = paths.select(&mut rng).unwrap();
+            counts[outbound.iter().position(|tunnel_id| *tunnel_id == selected).unwrap()] += 1;
+        }
+        assert!((15_000..17_000).contains(&counts[0]), "{counts:?}");
+        assert!((3_500..4_500).contains(&counts[1]), "{counts:?}");
+        assert!((700..1_300).contains(&counts[2]), "{counts:?}");
+
+        // ranking is reused until an rtt event makes it stale
+        assert!(tunnels.paths.is_valid(stats.version(), now));
+        stats.remove(&outbound[0], &inbound);
+        assert!(!tunnels.paths.is_valid(stats.version(), now));
+
+        let paths = tunnels.ranked_paths(&stats, now);
+        assert_eq!(paths.measured.len(), 2);
+        assert_eq!(paths.unmeasured, vec![(outbound[0], (inbound, expires))]);
+
+        // tunnel event makes the ranking stale
+        tunnels.remove(&outbound[2]);
+        assert!(!tunnels.paths.is_valid(stats.version(), now));
+        assert_eq!(tunnels.ranked_paths(&stats, now).measured.len(), 1);
+
+        // lease that is no longer eligible makes the ranking stale
+        assert!(!tunnels.paths.is_valid(stats.version(), expires));
+        assert!(tunnels.ranked_paths(&stats, expires).select(&mut rng).is_none());
+    }
 }
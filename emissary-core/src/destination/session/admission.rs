@@ -0,0 +1,326 @@
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//! Admission control for `NewSession` messages.
+//!
+//! Every `NewSession` message requires an Elligator2 decoding and two X25519 key exchanges before
+//! it can be authenticated, which makes it by far the most expensive message to process. Before
+//! doing any of that work, [`NewSessionAdmission`] rejects exact replays of previously processed
+//! `NewSession` messages and sheds messages that exceed the processing budget of the destination
+//! so that a burst of new sessions cannot starve the already-established sessions.
+//!
+//! During bursts, the key exchanges are offloaded to background tasks so the destination's event
+//! loop can keep serving the established sessions while the new sessions are being processed.
+//!
+//! Ephemeral keys are recorded and the processing budget is charged only after the `NewSession`
+//! message has been decrypted successfully so that unauthenticated messages, such as garbage or
+//! `ExistingSession` messages with expired tags, cannot push legitimate keys out of the replay
+//! filter or consume the budget.
+
+use crate::{
+    destination::session::{context::NS_EPHEMERAL_PUBKEY_OFFSET, LOG_TARGET},
+    primitives::DestinationId,
+    runtime::{Instant, Runtime},
+};
+
+use hashbrown::HashSet;
+
+use core::{mem, time::Duration};
+
+/// Interval over which the `NewSession` processing budget is measured.
+const NS_RATE_INTERVAL: Duration = Duration::from_secs(1);
+
+/// Maximum number of `NewSession` messages accepted during [`NS_RATE_INTERVAL`].
+const NS_MAX_PER_INTERVAL: usize = 1024usize;
+
+/// Number of `NewSession` messages processed inline during [`NS_RATE_INTERVAL`] before the rest
+/// are offloaded to background tasks.
+pub const NS_MAX_INLINE_PER_INTERVAL: usize = 8usize;
+
+/// Maximum number of `NewSession` messages being processed in background tasks.
+pub const NS_MAX_IN_FLIGHT: usize = 64usize;
+
+/// How long are ephemeral keys of processed `NewSession` messages tracked.
+///
+/// The ephemeral keys are stored in two generations, each spanning this interval, so a key is
+/// remembered for at least the maximum allowed age of a `NewSession` message.
+const NS_REPLAY_WINDOW: Duration = Duration::from_secs(5 * 60);
+
+/// Maximum number of ephemeral keys stored in one generation of the replay filter.
+///
+/// Sized so that a generation can hold every `NewSession` message accepted at the maximum rate
+/// over [`NS_REPLAY_WINDOW`], otherwise a sustained burst would rotate the generations early and
+/// shorten the replay window. This is ~300k keys, or ~10 MB of key material per generation, which
+/// is only reached under such a burst since the generations grow on demand.
+const NS_MAX_TRACKED_KEYS: usize =
+    NS_MAX_PER_INTERVAL * (NS_REPLAY_WINDOW.as_secs() / NS_RATE_INTERVAL.as_secs()) as usize;
+
+/// Admission decision for a `NewSession` message.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Admission {
+    /// Process the message inline.
+    Accept,
+
+    /// Process the message in a background task.
+    Offload,
+
+    /// The message is a replay of an already-processed `NewSession` message.
+    Replay,
+
+    /// The processing budget has been exhausted and the message must be dropped.
+    Overloaded,
+}
+
+/// `NewSession` admission statistics.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct AdmissionStats {
+    /// Number of accepted messages.
+    pub num_accepted: usize,
+
+    /// Number of messages processed in background tasks.
+    pub num_offloaded: usize,
+
+    /// Number of replayed messages.
+    pub num_replayed: usize,
+
+    /// Number of messages dropped because of overload.
+    pub num_shed: usize,
+}
+
+/// Admission control for `NewSession` messages.
+pub struct NewSessionAdmission<R: Runtime> {
+    /// Ephemeral keys of the current generation.
+    current: HashSet<[u8; 32]>,
+
+    /// When was the current generation started.
+    generation_start: R::Instant,
+
+    /// Start of the current rate interval.
+    interval_start: R::Instant,
+
+    /// Number of messages accepted during the current rate interval.
+    num_admitted: usize,
+
+    /// Number of messages processed during the current rate interval.
+    num_processed: usize,
+
+    /// Ephemeral keys of the previous generation.
+    previous: HashSet<[u8; 32]>,
+
+    /// Statistics since the last report.
+    stats: AdmissionStats,
+}
+
+impl<R: Runtime> NewSessionAdmission<R> {
+    /// Create new [`NewSessionAdmission`].
+    pub fn new() -> Self {
+        Self {
+            current: HashSet::new(),
+            generation_start: R::now(),
+            interval_start: R::now(),
+            num_admitted: 0usize,
+            num_processed: 0usize,
+            previous: HashSet::new(),
+            stats: AdmissionStats::default(),
+        }
+    }
+
+    /// Extract ephemeral key from `NewSession` message in `payload`.
+    pub fn ephemeral_key(payload: &[u8]) -> Option<[u8; 32]> {
+        payload
+            .get(NS_EPHEMERAL_PUBKEY_OFFSET)
+            .and_then(|key| TryInto::<[u8; 32]>::try_into(key).ok())
+    }
+
+    /// Decide whether `NewSession` message in `payload` should be processed and how.
+    ///
+    /// `num_in_flight` is the number of `NewSession` messages currently processed in background
+    /// tasks. Messages too short to hold an ephemeral key are accepted and rejected by the parser.
+    pub fn admit(&mut self, payload: &[u8], num_in_flight: usize) -> Admission {
+        let Some(key) = Self::ephemeral_key(payload) else {
+            return Admission::Accept;
+        };
+
+        if self.current.contains(&key) || self.previous.contains(&key) {
+            self.stats.num_replayed += 1;
+            return Admission::Replay;
+        }
+
+        if self.interval_start.elapsed() >= NS_RATE_INTERVAL {
+            self.interval_start = R::now();
+            self.num_admitted = 0usize;
+            self.num_processed = 0usize;
+        }
+
+        if self.num_admitted >= NS_MAX_PER_INTERVAL || num_in_flight >= NS_MAX_IN_FLIGHT {
+            self.stats.num_shed += 1;
+            return Admission::Overloaded;
+        }
+        self.num_processed += 1;
+
+        // keep processing inline while the destination isn't receiving a burst of new sessions
+        if num_in_flight == 0 && self.num_processed <= NS_MAX_INLINE_PER_INTERVAL {
+            return Admission::Accept;
+        }
+
+        self.stats.num_offloaded += 1;
+        Admission::Offload
+    }
+
+    /// Record ephemeral `key` of a successfully decrypted `NewSession` message.
+    ///
+    /// Returns `false` if the key has already been recorded, meaning the message was a replay that
+    /// was processed concurrently with the original message.
+    pub fn record(&mut self, key: [u8; 32]) -> bool {
+        if self.current.contains(&key) || self.previous.contains(&key) {
+            self.stats.num_replayed += 1;
+            return false;
+        }
+
+        if self.generation_start.elapsed() >= NS_REPLAY_WINDOW
+            || self.current.len() >= NS_MAX_TRACKED_KEYS
+        {
+            self.previous = mem::take(&mut self.current);
+            self.generation_start = R::now();
+        }
+
+        self.current.insert(key);
+        self.num_admitted += 1;
+        self.stats.num_accepted += 1;
+
+        true
+    }
+
+    /// Report and reset admission statistics.
+    pub fn report(&mut self, local: &DestinationId) -> AdmissionStats {
+        let stats = mem::take(&mut self.stats);
+
+        if stats.num_replayed != 0 || stats.num_shed != 0 || stats.num_offloaded != 0 {
+            tracing::debug!(
+                target: LOG_TARGET,
+                %local,
+                num_accepted = ?stats.num_accepted,
+                num_offloaded = ?stats.num_offloaded,
+                num_replayed = ?stats.num_replayed,
+                num_shed = ?stats.num_shed,
+                "new session admission statistics",
+            );
+        }
+
+        stats
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::runtime::mock::MockRuntime;
+
+    fn new_session(key: u64) -> [u8; 64] {
+        let mut payload = [0u8; 64];
+        payload[NS_EPHEMERAL_PUBKEY_OFFSET.start..NS_EPHEMERAL_PUBKEY_OFFSET.start + 8]
+            .copy_from_slice(&key.to_le_bytes());
+
+        payload
+    }
+
+    fn accept(admission: &mut NewSessionAdmission<MockRuntime>, key: u64) {
+        let payload = new_session(key);
+
+        assert_eq!(admission.admit(&payload, 0), Admission::Accept);
+        assert!(
+            admission.record(NewSessionAdmission::<MockRuntime>::ephemeral_key(&payload).unwrap())
+        );
+    }
+
+    #[tokio::test]
+    async fn replay_rejected() {
+        let mut admission = NewSessionAdmission::<MockRuntime>::new();
+
+        accept(&mut admission, 1);
+        accept(&mut admission, 2);
+        assert_eq!(admission.admit(&new_session(1), 0), Admission::Replay);
+
+        // too short to hold an ephemeral key
+        assert_eq!(admission.admit(&[0u8; 16], 0), Admission::Accept);
+
+        assert_eq!(
+            admission.report(&DestinationId::random()),
+            AdmissionStats {
+                num_accepted: 2,
+                num_offloaded: 0,
+                num_replayed: 1,
+                num_shed: 0,
+            }
+        );
+    }
+
+    #[tokio::test]
+    async fn undecrypted_messages_not_recorded() {
+        let mut admission = NewSessionAdmission::<MockRuntime>::new();
+
+        // message failed to decrypt so its key is never recorded and it can be received again
+        assert_eq!(admission.admit(&new_session(1), 0), Admission::Accept);
+        assert_eq!(admission.admit(&new_session(1), 0), Admission::Accept);
+        assert_eq!(admission.num_admitted, 0);
+
+        // concurrently processed replay is caught when the key is recorded
+        let key = NewSessionAdmission::<MockRuntime>::ephemeral_key(&new_session(1)).unwrap();
+        assert!(admission.record(key));
+        assert!(!admission.record(key));
+    }
+
+    #[tokio::test]
+    async fn bursts_offloaded() {
+        let mut admission = NewSessionAdmission::<MockRuntime>::new();
+
+        for i in 0..NS_MAX_INLINE_PER_INTERVAL as u64 {
+            assert_eq!(admission.admit(&new_session(i), 0), Admission::Accept);
+        }
+        assert_eq!(admission.admit(&new_session(0xff), 0), Admission::Offload);
+
+        // messages are offloaded while earlier messages are being processed in the background
+        admission.interval_start = MockRuntime::now().subtract(NS_RATE_INTERVAL);
+        assert_eq!(admission.admit(&new_session(0xfe), 1), Admission::Offload);
+        assert_eq!(
+            admission.admit(&new_session(0xfd), NS_MAX_IN_FLIGHT),
+            Admission::Overloaded
+        );
+    }
+
+    #[tokio::test]
+    async fn excess_messages_shed() {
+        let mut admission = NewSessionAdmission::<MockRuntime>::new();
+
+        for i in 0..NS_MAX_PER_INTERVAL as u64 {
+            let payload = new_session(i);
+
+            assert_ne!(admission.admit(&payload, 0), Admission::Overloaded);
+            assert!(admission
+                .record(NewSessionAdmission::<MockRuntime>::ephemeral_key(&payload).unwrap()));
+        }
+        assert_eq!(
+            admission.admit(&new_session(0xffff), 0),
+            Admission::Overloaded
+        );
+
+        // budget is restored after the rate interval
+        admission.interval_start = MockRuntime::now().subtract(NS_RATE_INTERVAL);
+        assert_eq!(admission.admit(&new_session(0xffff), 0), Admission::Accept);
+    }
+}
@@ -49,7 +49,7 @@ const LOG_TARGET: &str = "emissary::destination::session::context";
 const PROTOCOL_NAME: &str = "Noise_IKelg2+hs2_25519_ChaChaPoly_SHA256";
 
 /// Ephemeral public key offset in `NewSession` message.
-const NS_EPHEMERAL_PUBKEY_OFFSET: Range<usize> = 4..36;
+pub const NS_EPHEMERAL_PUBKEY_OFFSET: Range<usize> = 4..36;
 
 /// Static public key offset in `NewSession` message, including Poly1305 MAC.
 const NS_STATIC_PUBKEY_OFFSET: Range<usize> = 36..84;
@@ -23,8 +23,8 @@ use crate::{
         chachapoly::ChaChaPoly, hmac::Hmac, sha256::Sha256, StaticPrivateKey, StaticPublicKey,
     },
     destination::session::{
-        tag_set::{TagSet, TagSetEntry},
-        KeyContext, NUM_TAGS_TO_GENERATE,
+        tag_set::{PendingTag, TagSet},
+        KeyContext, INITIAL_TAG_WINDOW,
     },
     error::SessionError,
     runtime::Runtime,
@@ -148,7 +148,7 @@ impl<R: Runtime> InboundSession<R> {
         &mut self,
         mut payload: Vec<u8>,
         ratchet_threshold: u16,
-    ) -> Result<(Vec<u8>, Vec<TagSetEntry>), SessionError> {
+    ) -> Result<(Vec<u8>, Vec<PendingTag>), SessionError> {
         match mem::replace(&mut self.state, InboundSessionState::Poisoned) {
             InboundSessionState::AwaitingNewSessionReplyTransmit {
                 chaining_key: ns_chaining_key,
@@ -183,8 +183,8 @@ impl<R: Runtime> InboundSession<R> {
                     let mut nsr_tag_set =
                         TagSet::new(&ns_chaining_key, tagset_key, ratchet_threshold);
 
-                    // `next_entry()` must succeed as `nsr_tag_set` is a fresh `TagSet`
-                    let garlic_tag = nsr_tag_set.next_entry().expect("to succeed").tag;
+                    // `next_tag()` must succeed as `nsr_tag_set` is a fresh `TagSet`
+                    let garlic_tag = nsr_tag_set.next_tag().expect("to succeed").tag;
 
                     (nsr_tag_set, garlic_tag)
                 };
@@ -267,16 +267,18 @@ impl<R: Runtime> InboundSession<R> {
                     out.freeze().to_vec()
                 };
 
-                // generate garlic tag/session key pairs for reception
+                // generate the initial lookahead window of garlic tags for reception
                 //
-                // `next_entry()` must succeed as this is a fresh `TagSet` and
-                // `NUM_TAGS_TO_GENERATE` is smaller than the maximum tag count
+                // session keys are derived only once a message with one of the tags is received
+                //
+                // `next_tag()` must succeed as this is a fresh `TagSet` and
+                // `INITIAL_TAG_WINDOW` is smaller than the maximum tag count
                 // in a `Tagset`
-                let (tag_set_mappings, tags): (HashMap<_, _>, Vec<_>) = (0..NUM_TAGS_TO_GENERATE)
+                let (tag_set_mappings, tags): (HashMap<_, _>, Vec<_>) = (0..INITIAL_TAG_WINDOW)
                     .map(|_| {
-                        let entry = recv_tag_set.next_entry().expect("to succeed");
+                        let tag = recv_tag_set.next_tag().expect("to succeed");
 
-                        ((entry.tag, 0usize), entry)
+                        ((tag.tag, 0usize), tag)
                     })
                     .unzip();
 
@@ -327,7 +329,7 @@ impl<R: Runtime> InboundSession<R> {
 
                 // garlic tag generation is expected to succeed as the number of sent NSR messages
                 // should never exceed the total number of tags in the NSR tag set
-                let garlic_tag = nsr_tag_set.next_entry().expect("to succeed").tag;
+                let garlic_tag = nsr_tag_set.next_tag().expect("to succeed").tag;
 
                 tracing::trace!(
                     target: LOG_TARGET,
@@ -407,13 +409,13 @@ impl<R: Runtime> InboundSession<R> {
                     out.freeze().to_vec()
                 };
 
-                // generate garlic tag/session key pairs for reception
+                // generate the initial lookahead window of garlic tags for reception
                 //
-                // `next_entry()` must succeed as this is a fresh `TagSet` and
-                // `NUM_TAGS_TO_GENERATE` is smaller than the maximum tag count
+                // `next_tag()` must succeed as this is a fresh `TagSet` and
+                // `INITIAL_TAG_WINDOW` is smaller than the maximum tag count
                 // in a `Tagset`
-                let tags = (0..NUM_TAGS_TO_GENERATE)
-                    .map(|_| recv_tag_set.next_entry().expect("to succeed"))
+                let tags = (0..INITIAL_TAG_WINDOW)
+                    .map(|_| recv_tag_set.next_tag().expect("to succeed"))
                     .collect::<Vec<_>>();
 
                 // associated the garlic tags of `tags` with this send/receive tag set pair
@@ -452,15 +454,19 @@ impl<R: Runtime> InboundSession<R> {
 
     /// Handle `ExistingSession` message.
     ///
-    /// Decrypt `message` using `session_key` and return the decrypted payload and the inner state
-    /// of `InboundSession`, allowing the caller to create a new `Session` object which contains
-    /// both send and receive `TagSet`s.
+    /// Derive the session key for `tag` from the receive tag set it belongs to, decrypt `message`
+    /// using that key and return the decrypted payload and the inner state of `InboundSession`,
+    /// allowing the caller to create a new `Session` object which contains both send and receive
+    /// `TagSet`s.
+    ///
+    /// Garlic tags generated for the tag sets of the other, unused `NewSessionReply` messages are
+    /// returned so the caller can discard them.
     pub fn handle_existing_session(
         &mut self,
         garlic_tag: u64,
-        tag_set_entry: TagSetEntry,
+        tag: PendingTag,
         payload: Vec<u8>,
-    ) -> Result<(Vec<u8>, TagSet, TagSet), SessionError> {
+    ) -> Result<(Vec<u8>, TagSet, TagSet, Vec<u64>), SessionError> {
         let InboundSessionState::NewSessionReplySent {
             mut tag_sets,
             tag_set_mappings,
@@ -481,14 +487,19 @@ impl<R: Runtime> InboundSession<R> {
         // responds to one of them and the response must be associated with the correct tag set pair
         // so that remote is able to decrypt our messages
         let tag_set_index = tag_set_mappings.get(&garlic_tag).ok_or(SessionError::UnknownTag)?;
-        let (send_tag_set, recv_tag_set) =
+        let (send_tag_set, mut recv_tag_set) =
             tag_sets.remove(tag_set_index).ok_or(SessionError::UnknownTag)?;
+        let unused_tags = tag_set_mappings
+            .iter()
+            .filter_map(|(tag, index)| (index != tag_set_index).then_some(*tag))
+            .collect::<Vec<_>>();
+        let tag_set_entry = recv_tag_set.derive_entry(tag).ok_or(SessionError::UnknownTag)?;
 
         let mut payload = payload[12..].to_vec();
 
         ChaChaPoly::with_nonce(&tag_set_entry.key, tag_set_entry.tag_index as u64)
             .decrypt_with_ad(&tag_set_entry.tag.to_le_bytes(), &mut payload)?;
 
-        Ok((payload, send_tag_set, recv_tag_set))
+        Ok((payload, send_tag_set, recv_tag_set, unused_tags))
     }
 }
@@ -22,9 +22,16 @@
 
 use crate::{
     crypto::{StaticPrivateKey, StaticPublicKey},
-    destination::session::{
-        context::KeyContext,
-        session::{PendingSession, PendingSessionEvent, Session},
+    destination::{
+        metrics::*,
+        session::{
+            admission::{Admission, AdmissionStats, NewSessionAdmission},
+            context::KeyContext,
+            inbound::InboundSession,
+            session::{PendingSession, PendingSessionEvent, Session},
+            tag_set::PendingTag,
+            tag_table::{SessionSlot, TagTable},
+        },
     },
     error::SessionError,
     i2np::{
@@ -34,11 +41,12 @@ use crate::{
         garlic::{
             DeliveryInstructions as GarlicDeliveryInstructions, GarlicClove, GarlicMessage,
             GarlicMessageBlock, GarlicMessageBuilder, OwnedDeliveryInstructions,
+            GARLIC_CLOVE_OVERHEAD,
         },
         Message, MessageType, I2NP_MESSAGE_EXPIRATION,
     },
     primitives::{DestinationId, MessageId},
-    runtime::{Instant, JoinSet, Runtime},
+    runtime::{Counter, Gauge, Instant, JoinSet, MetricsHandle, Runtime},
 };
 
 use bytes::{BufMut, Bytes, BytesMut};
@@ -59,17 +67,31 @@ use core::{
     time::Duration,
 };
 
+mod admission;
 mod context;
 mod inbound;
 mod outbound;
 mod session;
 mod tag_set;
+mod tag_table;
 
 /// Logging target for the file.
 const LOG_TARGET: &str = "emissary::destination::session";
 
-/// Number of garlic tags to generate.
-const NUM_TAGS_TO_GENERATE: usize = 4096;
+/// Initial size of the receive tag lookahead window.
+///
+/// Receive tags are generated at most this many tag indices ahead of the highest tag index
+/// received from remote destination and the window slides forward as messages are received.
+const INITIAL_TAG_WINDOW: usize = 128;
+
+/// Maximum size of the receive tag lookahead window.
+///
+/// The window grows towards this limit if the session has a high inbound message rate.
+const MAX_TAG_WINDOW: usize = 4096;
+
+/// Interval over which the inbound message rate of a session is measured when resizing the
+/// receive tag lookahead window.
+const TAG_WINDOW_RATE_INTERVAL: Duration = Duration::from_secs(2);
 
 /// Default number of tag set entries consumed per key before a DH ratchet is performed.
 const SESSION_DH_RATCHET_THRESHOLD: u16 = 20_000u16;
@@ -93,6 +115,22 @@ const ES_SEND_TAGSET_TIMEOUT: Duration = Duration::from_secs(8 * 60);
 /// If the send tag set is also considered inactive, the active session is removed
 const ES_RECEIVE_TAGSET_TIMEOUT: Duration = Duration::from_secs(10 * 60);
 
+/// Size of an `ExistingSession` message, excluding its garlic blocks.
+///
+/// 4-byte message length, 8-byte garlic tag and 16-byte Poly1305 MAC.
+const ES_MESSAGE_OVERHEAD: usize = 4usize + 8usize + 16usize;
+
+/// Maximum size of the `NextKey` blocks a session may add to an outbound message.
+///
+/// Forward and reverse `NextKey` blocks, each with a block header, flag, key ID and public key.
+const MAX_NEXT_KEY_BLOCKS_SIZE: usize = 2 * (3usize + 3usize + 32usize);
+
+/// Size of the local `DatabaseStore` clove excluding the lease set.
+///
+/// Clove overhead, local delivery instructions, database key, store type, reply token and the
+/// `AckRequest` block sent with the lease set.
+const LEASE_SET_CLOVE_OVERHEAD: usize = GARLIC_CLOVE_OVERHEAD + 1 + 32 + 1 + 4 + 4;
+
 /// Session manager maintenance interval.
 const MAINTENANCE_INTERVAL: Duration = Duration::from_secs(2 * 60);
 
@@ -155,6 +193,61 @@ impl<R: Runtime> ActiveSession<R> {
     }
 }
 
+/// Session slot allocator.
+///
+/// Each remote destination with a pending or an active session is assigned a compact slot which
+/// is stored in the garlic tag table instead of the full destination ID. Slots are reused once
+/// the destination no longer has any sessions.
+#[derive(Default)]
+struct SessionSlots {
+    /// Destinations, indexed by session slot.
+    destinations: Vec<Option<DestinationId>>,
+
+    /// Free session slots.
+    free: Vec<SessionSlot>,
+
+    /// Destination ID -> session slot mapping.
+    slots: HashMap<DestinationId, SessionSlot>,
+}
+
+impl SessionSlots {
+    /// Get session slot of `destination_id`, allocating a new slot if one doesn't exist.
+    fn acquire(&mut self, destination_id: &DestinationId) -> SessionSlot {
+        if let Some(slot) = self.slots.get(destination_id) {
+            return *slot;
+        }
+
+        let slot = match self.free.pop() {
+            Some(slot) => {
+                self.destinations[slot.index()] = Some(destination_id.clone());
+                slot
+            }
+            None => {
+                self.destinations.push(Some(destination_id.clone()));
+                SessionSlot::new((self.destinations.len() - 1) as u32)
+            }
+        };
+        self.slots.insert(destination_id.clone(), slot);
+
+        slot
+    }
+
+    /// Release session slot of `destination_id`.
+    fn release(&mut self, destination_id: &DestinationId) {
+        if let Some(slot) = self.slots.remove(destination_id) {
+            self.destinations[slot.index()] = None;
+            self.free.push(slot);
+        }
+    }
+
+    /// Get destination ID of the session occupying `slot`.
+    fn destination(&self, slot: SessionSlot) -> Option<&DestinationId> {
+        self.destinations
+            .get(slot.index())
+            .and_then(|destination_id| destination_id.as_ref())
+    }
+}
+
 /// Events emitted by the [`SessionManager`].
 pub enum SessionManagerEvent {
     /// Send scheduled message to remote destination.
@@ -176,8 +269,20 @@ pub enum SessionManagerEvent {
         /// ID of the remote destination.
         destination_id: DestinationId,
     },
+
+    /// `NewSession` message processed in the background has been decrypted.
+    Cloves {
+        /// Garlic cloves of the message.
+        cloves: Vec<GarlicClove>,
+    },
 }
 
+/// Result of a `NewSession` message processed in the background.
+type NewSessionResult<R> = (
+    Option<[u8; 32]>,
+    Result<(InboundSession<R>, Vec<u8>), SessionError>,
+);
+
 /// Session manager for a `Destination`.
 ///
 /// Handles both inbound and outbound sessions.
@@ -188,8 +293,8 @@ pub struct SessionManager<R: Runtime> {
     /// Destination ID.
     destination_id: DestinationId,
 
-    /// Mapping from garlic tags to session keys.
-    garlic_tags: Arc<RwLock<HashMap<u64, DestinationId>>>,
+    /// Mapping from garlic tags to session slots.
+    garlic_tags: Arc<RwLock<TagTable>>,
 
     /// Key context.
     key_context: KeyContext<R>,
@@ -209,6 +314,15 @@ pub struct SessionManager<R: Runtime> {
     /// Maintenance timer.
     maintenance_timer: R::Timer,
 
+    /// Metrics handle.
+    metrics: R::MetricsHandle,
+
+    /// `NewSession` messages processed in the background.
+    new_sessions: R::JoinSet<NewSessionResult<R>>,
+
+    /// Admission control for `NewSession` messages.
+    ns_admission: NewSessionAdmission<R>,
+
     /// Pending sessions.
     pending: HashMap<DestinationId, PendingSession<R>>,
 
@@ -218,6 +332,9 @@ pub struct SessionManager<R: Runtime> {
     /// Known remote destinations and their public keys.
     remote_destinations: HashMap<DestinationId, StaticPublicKey>,
 
+    /// Session slots of remote destinations.
+    slots: SessionSlots,
+
     /// Waker.
     waker: Option<Waker>,
 
@@ -232,11 +349,13 @@ impl<R: Runtime> SessionManager<R> {
         destination_id: DestinationId,
         private_key: StaticPrivateKey,
         lease_set: Bytes,
+        metrics: R::MetricsHandle,
     ) -> Self {
         Self::with_ratchet_threshold(
             destination_id,
             private_key,
             lease_set,
+            metrics,
             SESSION_DH_RATCHET_THRESHOLD,
         )
     }
@@ -246,6 +365,7 @@ impl<R: Runtime> SessionManager<R> {
         destination_id: DestinationId,
         private_key: StaticPrivateKey,
         lease_set: Bytes,
+        metrics: R::MetricsHandle,
         ratchet_threshold: u16,
     ) -> Self {
         Self {
@@ -257,9 +377,13 @@ impl<R: Runtime> SessionManager<R> {
             lease_set_publish_timers: R::join_set(),
             protocol_response_timers: R::join_set(),
             maintenance_timer: R::timer(MAINTENANCE_INTERVAL),
+            metrics,
+            new_sessions: R::join_set(),
+            ns_admission: NewSessionAdmission::new(),
             pending_events: VecDeque::new(),
             pending: HashMap::new(),
             remote_destinations: HashMap::new(),
+            slots: SessionSlots::default(),
             waker: None,
             ratchet_threshold,
         }
@@ -322,6 +446,7 @@ impl<R: Runtime> SessionManager<R> {
 
         if let Some(session) = self.active.remove(destination_id) {
             session.session.destroy();
+            self.release_slot(destination_id);
 
             self.pending_events.push_back(SessionManagerEvent::SessionTerminated {
                 destination_id: destination_id.clone(),
@@ -329,6 +454,13 @@ impl<R: Runtime> SessionManager<R> {
         }
     }
 
+    /// Release session slot of `destination_id` if it has no pending or active sessions left.
+    fn release_slot(&mut self, destination_id: &DestinationId) {
+        if !self.pending.contains_key(destination_id) && !self.active.contains_key(destination_id) {
+            self.slots.release(destination_id);
+        }
+    }
+
     /// Creates an empty garlic message if there are inbound ACK or NextKey requests.
     fn explicit_protocol_response_message(
         &mut self,
@@ -364,13 +496,7 @@ impl<R: Runtime> SessionManager<R> {
         session
             .session
             .encrypt(message_builder)
-            .map(|(_tag_set_id, _tag_index, message)| {
-                let mut out = BytesMut::with_capacity(message.len() + 4);
-
-                out.put_u32(message.len() as u32);
-                out.put_slice(&message);
-                out.freeze().to_vec()
-            })
+            .map(|(_tag_set_id, _tag_index, message)| message)
             .ok()
     }
 
@@ -415,12 +541,7 @@ impl<R: Runtime> SessionManager<R> {
             .encrypt(builder)
             .map(|(tag_set_id, tag_index, message)| {
                 session.insert_outbound_ack_request(tag_set_id, tag_index);
-
-                let mut out = BytesMut::with_capacity(message.len() + 4);
-
-                out.put_u32(message.len() as u32);
-                out.put_slice(&message);
-                out.freeze().to_vec()
+                message
             })
             .ok()
     }
@@ -439,191 +560,260 @@ impl<R: Runtime> SessionManager<R> {
         destination_id: &DestinationId,
         message: Vec<u8>,
     ) -> Result<Vec<u8>, SessionError> {
-        match self.active.get_mut(destination_id) {
+        if self.active.contains_key(destination_id) {
+            return self.encrypt_existing(destination_id, core::slice::from_ref(&message));
+        }
+
+        // no active session for `destination_id`, check if pending session exists
+        match self.pending.get_mut(destination_id) {
             Some(session) => {
-                // TODO: ugly
-                let hash = destination_id.to_vec();
-                let message = {
-                    let mut out = BytesMut::with_capacity(message.len() + 4);
-
-                    out.put_u32(message.len() as u32);
-                    out.put_slice(&message);
-                    out
-                };
-                let mut builder = GarlicMessageBuilder::default().with_garlic_clove(
-                    MessageType::Data,
-                    MessageId::from(R::rng().next_u32()),
-                    R::time_since_epoch() + I2NP_MESSAGE_EXPIRATION,
-                    GarlicDeliveryInstructions::Destination { hash: &hash },
-                    &message,
-                );
+                match session.advance_outbound(
+                    self.lease_set.clone(),
+                    message,
+                    self.ratchet_threshold,
+                )? {
+                    PendingSessionEvent::SendMessage { message } => Ok({
+                        let mut out = BytesMut::with_capacity(message.len() + 4);
 
-                // send acks for all inbound ack requests
-                if !session.inbound_ack_requests.is_empty() {
-                    tracing::trace!(
+                        out.put_u32(message.len() as u32);
+                        out.put_slice(&message);
+                        out.freeze().to_vec()
+                    }),
+                    PendingSessionEvent::CreateSession {
+                        message, context, ..
+                    } => {
+                        tracing::info!(
+                            target: LOG_TARGET,
+                            local = %self.destination_id,
+                            remote = %destination_id,
+                            "new session started",
+                        );
+
+                        self.pending.remove(destination_id);
+                        self.active.insert(
+                            destination_id.clone(),
+                            ActiveSession::new(Session::new(*context)),
+                        );
+
+                        let mut out = BytesMut::with_capacity(message.len() + 4);
+
+                        out.put_u32(message.len() as u32);
+                        out.put_slice(&message);
+                        Ok(out.freeze().to_vec())
+                    }
+                    PendingSessionEvent::ReturnMessage { .. } => unreachable!(),
+                }
+            }
+            // no pending nor active session for `destination_id`, create new outbound session
+            None => {
+                // public key of the destination should exist since the caller (`Destination`)
+                // should've queried the lease set of the remote destination when sending the
+                // first message to them
+                let public_key = self.remote_destinations.get(destination_id).ok_or_else(|| {
+                    tracing::warn!(
                         target: LOG_TARGET,
                         local = %self.destination_id,
                         remote = %destination_id,
-                        acks = ?session.inbound_ack_requests,
-                        "add pending acks",
+                        "public key for remote destination doesn't exist",
                     );
 
-                    let acks = mem::replace(&mut session.inbound_ack_requests, HashSet::new());
-                    builder = builder.with_ack(acks.into_iter().collect());
-                }
+                    debug_assert!(false);
+                    SessionError::InvalidState
+                })?;
 
-                match &session.lease_set {
-                    None => session
-                        .session
-                        .encrypt(builder)
-                        .map(|(_, _, message)| {
-                            let mut out = BytesMut::with_capacity(message.len() + 4);
+                // wrap the garlic message inside a `NewSession` message
+                // and create a pending outbound session
+                let (session, payload) = self.key_context.create_outbound_session(
+                    self.destination_id.clone(),
+                    destination_id.clone(),
+                    public_key,
+                    self.lease_set.clone(),
+                    &message,
+                );
 
-                            out.put_u32(message.len() as u32);
-                            out.put_slice(&message);
-                            out.freeze().to_vec()
-                        })
-                        .map_err(|error| {
-                            if let SessionError::SessionTerminated = error {
-                                self.remove_session(destination_id);
-                            }
-
-                            error
-                        }),
-                    Some(lease_set) => {
-                        let database_store = DatabaseStoreBuilder::new(
-                            Bytes::from(self.destination_id.to_vec()),
-                            DatabaseStoreKind::LeaseSet2 {
-                                lease_set: lease_set.clone(),
-                            },
-                        )
-                        .build();
-
-                        let builder = builder
-                            .with_garlic_clove(
-                                MessageType::DatabaseStore,
-                                MessageId::from(R::rng().next_u32()),
-                                R::time_since_epoch() + I2NP_MESSAGE_EXPIRATION,
-                                GarlicDeliveryInstructions::Local,
-                                &database_store,
-                            )
-                            .with_ack_request();
-
-                        // save the `(tag_set_id, tag_index)` into `ActiveSession` so that inbound
-                        // ack can be associated with an ack request sent in this message
-                        session
-                            .session
-                            .encrypt(builder)
-                            .map(|(tag_set_id, tag_index, message)| {
-                                session.insert_outbound_ack_request(tag_set_id, tag_index);
-                                session.last_sent = R::now();
-
-                                let mut out = BytesMut::with_capacity(message.len() + 4);
-
-                                out.put_u32(message.len() as u32);
-                                out.put_slice(&message);
-                                out.freeze().to_vec()
-                            })
-                            .map_err(|error| {
-                                if let SessionError::SessionTerminated = error {
-                                    self.remove_session(destination_id);
-                                }
+                let slot = self.slots.acquire(destination_id);
 
-                                error
-                            })
-                    }
-                }
-            }
-            // no active session for `destination_id`, check if pending session exists
-            None => match self.pending.get_mut(destination_id) {
-                Some(session) => {
-                    match session.advance_outbound(
-                        self.lease_set.clone(),
-                        message,
+                self.pending.insert(
+                    destination_id.clone(),
+                    PendingSession::new_outbound(
+                        self.destination_id.clone(),
+                        destination_id.clone(),
+                        slot,
+                        public_key.clone(),
+                        session,
+                        Arc::clone(&self.garlic_tags),
+                        self.key_context.clone(),
                         self.ratchet_threshold,
-                    )? {
-                        PendingSessionEvent::SendMessage { message } => Ok({
-                            let mut out = BytesMut::with_capacity(message.len() + 4);
+                    ),
+                );
 
-                            out.put_u32(message.len() as u32);
-                            out.put_slice(&message);
-                            out.freeze().to_vec()
-                        }),
-                        PendingSessionEvent::CreateSession {
-                            message, context, ..
-                        } => {
-                            tracing::info!(
-                                target: LOG_TARGET,
-                                local = %self.destination_id,
-                                remote = %destination_id,
-                                "new session started",
-                            );
+                Ok({
+                    let mut out = BytesMut::with_capacity(payload.len() + 4);
 
-                            self.pending.remove(destination_id);
-                            self.active.insert(
-                                destination_id.clone(),
-                                ActiveSession::new(Session::new(*context)),
-                            );
+                    out.put_u32(payload.len() as u32);
+                    out.put_slice(&payload);
+                    out.freeze().to_vec()
+                })
+            }
+        }
+    }
 
-                            let mut out = BytesMut::with_capacity(message.len() + 4);
+    /// Get the serialized size of the garlic clove carrying a message of `message_len` bytes.
+    ///
+    /// The message is wrapped in an I2NP Data message with a 4-byte length prefix and delivered to
+    /// the remote destination.
+    pub fn data_clove_size(message_len: usize) -> usize {
+        GARLIC_CLOVE_OVERHEAD + 33usize + 4usize + message_len
+    }
 
-                            out.put_u32(message.len() as u32);
-                            out.put_slice(&message);
-                            Ok(out.freeze().to_vec())
-                        }
-                        PendingSessionEvent::ReturnMessage { .. } => unreachable!(),
-                    }
-                }
-                // no pending nor active session for `destination_id`, create new outbound session
-                None => {
-                    // public key of the destination should exist since the caller (`Destination`)
-                    // should've queried the lease set of the remote destination when sending the
-                    // first message to them
-                    let public_key =
-                        self.remote_destinations.get(destination_id).ok_or_else(|| {
-                            tracing::warn!(
-                                target: LOG_TARGET,
-                                local = %self.destination_id,
-                                remote = %destination_id,
-                                "public key for remote destination doesn't exist",
-                            );
+    /// Get the number of bytes a garlic message sent to `destination_id` adds on top of the data
+    /// cloves it carries.
+    ///
+    /// Accounts for the message header and MAC, pending ACKs, `NextKey` blocks and the local lease
+    /// set if it's bundled with the message. For sessions that are not active yet, the estimate
+    /// assumes the lease set is bundled.
+    pub fn message_overhead(&self, destination_id: &DestinationId) -> usize {
+        let overhead = ES_MESSAGE_OVERHEAD + MAX_NEXT_KEY_BLOCKS_SIZE;
 
-                            debug_assert!(false);
-                            SessionError::InvalidState
-                        })?;
+        match self.active.get(destination_id) {
+            Some(session) => {
+                let acks = match session.inbound_ack_requests.len() {
+                    0 => 0usize,
+                    num_acks => 3usize + num_acks * 4,
+                };
+                let lease_set = session.lease_set.as_ref().map_or(0usize, |lease_set| {
+                    LEASE_SET_CLOVE_OVERHEAD + lease_set.len()
+                });
 
-                    // wrap the garlic message inside a `NewSession` message
-                    // and create a pending outbound session
-                    let (session, payload) = self.key_context.create_outbound_session(
-                        self.destination_id.clone(),
-                        destination_id.clone(),
-                        public_key,
-                        self.lease_set.clone(),
-                        &message,
-                    );
+                overhead + acks + lease_set
+            }
+            None => overhead + LEASE_SET_CLOVE_OVERHEAD + self.lease_set.len(),
+        }
+    }
 
-                    self.pending.insert(
-                        destination_id.clone(),
-                        PendingSession::new_outbound(
-                            self.destination_id.clone(),
-                            destination_id.clone(),
-                            public_key.clone(),
-                            session,
-                            Arc::clone(&self.garlic_tags),
-                            self.key_context.clone(),
-                            self.ratchet_threshold,
-                        ),
-                    );
+    /// Encrypt `messages` destined to `destination_id`.
+    ///
+    /// If there is an active session with the remote destination, all messages are packed into
+    /// a single `ExistingSession` message, one garlic clove per message, which saves an AEAD
+    /// operation and tunnel message per message compared to calling
+    /// [`SessionManager::encrypt()`] separately for each message.
+    ///
+    /// `NewSession` and `NewSessionReply` messages carry only one payload so if the session is
+    /// still pending, each message is encrypted separately.
+    pub fn encrypt_many(
+        &mut self,
+        destination_id: &DestinationId,
+        messages: Vec<Vec<u8>>,
+    ) -> Result<Vec<Vec<u8>>, SessionError> {
+        if self.active.contains_key(destination_id) {
+            return self.encrypt_existing(destination_id, &messages).map(|message| vec![message]);
+        }
 
-                    Ok({
-                        let mut out = BytesMut::with_capacity(payload.len() + 4);
+        messages
+            .into_iter()
+            .map(|message| self.encrypt(destination_id, message))
+            .collect()
+    }
 
-                        out.put_u32(payload.len() as u32);
-                        out.put_slice(&payload);
-                        out.freeze().to_vec()
+    /// Encrypt `messages` into an `ExistingSession` message of an active session.
+    fn encrypt_existing(
+        &mut self,
+        destination_id: &DestinationId,
+        messages: &[Vec<u8>],
+    ) -> Result<Vec<u8>, SessionError> {
+        let Some(session) = self.active.get_mut(destination_id) else {
+            debug_assert!(false);
+            return Err(SessionError::InvalidState);
+        };
+
+        // TODO: ugly
+        let hash = destination_id.to_vec();
+        let messages = messages
+            .iter()
+            .map(|message| {
+                let mut out = BytesMut::with_capacity(message.len() + 4);
+
+                out.put_u32(message.len() as u32);
+                out.put_slice(message);
+                out
+            })
+            .collect::<Vec<_>>();
+        let mut builder =
+            messages.iter().fold(GarlicMessageBuilder::default(), |builder, message| {
+                builder.with_garlic_clove(
+                    MessageType::Data,
+                    MessageId::from(R::rng().next_u32()),
+                    R::time_since_epoch() + I2NP_MESSAGE_EXPIRATION,
+                    GarlicDeliveryInstructions::Destination { hash: &hash },
+                    message,
+                )
+            });
+
+        // send acks for all inbound ack requests
+        if !session.inbound_ack_requests.is_empty() {
+            tracing::trace!(
+                target: LOG_TARGET,
+                local = %self.destination_id,
+                remote = %destination_id,
+                acks = ?session.inbound_ack_requests,
+                "add pending acks",
+            );
+
+            let acks = mem::replace(&mut session.inbound_ack_requests, HashSet::new());
+            builder = builder.with_ack(acks.into_iter().collect());
+        }
+
+        match &session.lease_set {
+            None =>
+                session
+                    .session
+                    .encrypt(builder)
+                    .map(|(_, _, message)| message)
+                    .map_err(|error| {
+                        if let SessionError::SessionTerminated = error {
+                            self.remove_session(destination_id);
+                        }
+
+                        error
+                    }),
+            Some(lease_set) => {
+                let database_store = DatabaseStoreBuilder::new(
+                    Bytes::from(self.destination_id.to_vec()),
+                    DatabaseStoreKind::LeaseSet2 {
+                        lease_set: lease_set.clone(),
+                    },
+                )
+                .build();
+
+                let builder = builder
+                    .with_garlic_clove(
+                        MessageType::DatabaseStore,
+                        MessageId::from(R::rng().next_u32()),
+                        R::time_since_epoch() + I2NP_MESSAGE_EXPIRATION,
+                        GarlicDeliveryInstructions::Local,
+                        &database_store,
+                    )
+                    .with_ack_request();
+
+                // save the `(tag_set_id, tag_index)` into `ActiveSession` so that inbound
+                // ack can be associated with an ack request sent in this message
+                session
+                    .session
+                    .encrypt(builder)
+                    .map(|(tag_set_id, tag_index, message)| {
+                        session.insert_outbound_ack_request(tag_set_id, tag_index);
+                        session.last_sent = R::now();
+
+                        message
                     })
-                }
-            },
+                    .map_err(|error| {
+                        if let SessionError::SessionTerminated = error {
+                            self.remove_session(destination_id);
+                        }
+
+                        error
+                    })
+            }
         }
     }
 
@@ -648,8 +838,20 @@ impl<R: Runtime> SessionManager<R> {
         // extract garlic tag and attempt to find session key for the tag
         //
         // if no key is found, `message` is assumed to be `NewSession`
+        //
+        // the lookup only needs shared access to the tag table so that messages which don't match
+        // any tag, such as `NewSession` messages, never contend with sessions generating new tags
+        //
+        // a matched tag is consumed by the session it belongs to, so it's removed from the table
+        // before the message is handed to the session
         let garlic_tag = GarlicMessage::garlic_tag(&message);
-        let session = { self.garlic_tags.write().remove(&garlic_tag) };
+        let entry = { self.garlic_tags.read().get(garlic_tag) };
+        let session = entry
+            .and_then(|entry| self.slots.destination(entry.slot).map(|id| (entry, id.clone())));
+
+        if entry.is_some() {
+            self.garlic_tags.write().remove(garlic_tag);
+        }
 
         tracing::trace!(
             target: LOG_TARGET,
@@ -668,143 +870,74 @@ impl<R: Runtime> SessionManager<R> {
                     "session key not found, assume new session",
                 );
 
-                // parse `NewSession` and attempt to create an inbound session
-                //
-                // the returned session is either a bound or an unbound inbound session
+                // replayed `NewSession` messages and messages exceeding the processing budget are
+                // dropped before doing any of the expensive elligator2/x25519 operations
                 //
-                // if it's a bound session, the parsed garlic clove set must include a `LeaseSet2`
-                // so a reply can be sent to the remote destination and if `LeaseSet2` is not
-                // bundled, the inbound session is rejected
-                let (session, payload) =
-                    self.key_context.create_inbound_session(message.payload)?;
-
-                // attempt to parse `payload` into clove set
-                let clove_set = GarlicMessage::parse(&payload).ok_or_else(|| {
-                    tracing::warn!(
-                        target: LOG_TARGET,
-                        local = %self.destination_id,
-                        id = %self.destination_id,
-                        "failed to parse NS payload into a clove set",
-                    );
-
-                    SessionError::Malformed
-                })?;
-
-                // validate `DateTime` block
-                let Some(GarlicMessageBlock::DateTime { timestamp }) = clove_set
-                    .blocks
-                    .iter()
-                    .find(|clove| core::matches!(clove, GarlicMessageBlock::DateTime { .. }))
-                else {
-                    tracing::warn!(
-                        target: LOG_TARGET,
-                        local = %self.destination_id,
-                        id = %self.destination_id,
-                        "`DateTime` missing from `NewSession`",
-                    );
-
-                    return Err(SessionError::Timestamp);
-                };
-
-                let now = R::time_since_epoch();
-                let timestamp = Duration::from_secs(*timestamp as u64);
+                // during bursts of new sessions, the messages are processed in the background and
+                // their cloves are returned through `SessionManagerEvent::Cloves`
+                let key = NewSessionAdmission::<R>::ephemeral_key(&message.payload);
 
-                if now - NS_MAX_AGE > timestamp || now + NS_FUTURE_LIMIT < timestamp {
-                    tracing::warn!(
-                        target: LOG_TARGET,
-                        local = %self.destination_id,
-                        id = %self.destination_id,
-                        ?now,
-                        ?timestamp,
-                        "`DateTime` outside of allowed range",
-                    );
-                    return Err(SessionError::Timestamp);
-                }
-
-                // locate `DatabaseStore` i2np message from the clove set
-                let Some(GarlicMessageBlock::GarlicClove { message_body, .. }) =
-                    clove_set.blocks.iter().find(|clove| {
-                        core::matches!(
-                            clove,
-                            GarlicMessageBlock::GarlicClove {
-                                message_type: MessageType::DatabaseStore,
-                                ..
-                            }
-                        )
-                    })
-                else {
-                    tracing::warn!(
-                        target: LOG_TARGET,
-                        id = %self.destination_id,
-                        "clove set doesn't contain `DatabaseStore`, cannot reply",
-                    );
-
-                    return Err(SessionError::Malformed);
-                };
+                match self.ns_admission.admit(&message.payload, self.new_sessions.len()) {
+                    Admission::Accept => {}
+                    Admission::Offload => {
+                        tracing::trace!(
+                            target: LOG_TARGET,
+                            local = %self.destination_id,
+                            "process `NewSession` in the background",
+                        );
 
-                // attempt to parse the `DatabaseStore` as `LeaseSet2`
-                let Some(DatabaseStore {
-                    key,
-                    payload: DatabaseStorePayload::LeaseSet2 { lease_set },
-                    ..
-                }) = DatabaseStore::<R>::parse(message_body)
-                else {
-                    tracing::warn!(
-                        target: LOG_TARGET,
-                        id = %self.destination_id,
-                        "`DatabaseStore` is not a valid `LeaseSet2` store, cannot reply",
-                    );
+                        let key_context = self.key_context.clone();
+                        let payload = message.payload;
 
-                    return Err(SessionError::Malformed);
-                };
-                let destination_id = lease_set.header.destination.id();
-                let key = DestinationId::from(key);
+                        self.new_sessions.push(async move {
+                            (key, key_context.create_inbound_session(payload))
+                        });
+                        self.metrics.gauge(NS_IN_FLIGHT).increment(1);
 
-                if key != destination_id {
-                    tracing::warn!(
-                        target: LOG_TARGET,
-                        ?destination_id,
-                        ?key,
-                        "key/lease set id mismatch for database store",
-                    );
-                    return Err(SessionError::InvalidKey);
-                }
+                        if let Some(waker) = self.waker.take() {
+                            waker.wake_by_ref();
+                        }
 
-                match self.pending.get_mut(&destination_id) {
-                    None => {
+                        return Ok(Vec::new().into_iter());
+                    }
+                    Admission::Replay => {
                         tracing::debug!(
                             target: LOG_TARGET,
                             local = %self.destination_id,
-                            remote = %destination_id,
-                            "inbound session created",
+                            "replayed `NewSession` message, dropping",
                         );
-
-                        self.pending.insert(
-                            destination_id.clone(),
-                            PendingSession::new_inbound(
-                                self.destination_id.clone(),
-                                destination_id.clone(),
-                                session,
-                                Arc::clone(&self.garlic_tags),
-                                self.key_context.clone(),
-                            ),
+                        return Err(SessionError::Replay);
+                    }
+                    Admission::Overloaded => {
+                        tracing::debug!(
+                            target: LOG_TARGET,
+                            local = %self.destination_id,
+                            "too many `NewSession` messages, dropping",
                         );
+                        return Err(SessionError::Overloaded);
                     }
-                    Some(_) => tracing::trace!(
-                        target: LOG_TARGET,
-                        local = %self.destination_id,
-                        remote = %destination_id,
-                        "inbound session already exists",
-                    ),
                 }
 
-                // this is the first message of the session so both tag set id and tag index are 0
-                (0u16, 0u16, destination_id, payload)
+                // parse `NewSession` and attempt to create an inbound session
+                //
+                // the returned session is either a bound or an unbound inbound session
+                //
+                // if it's a bound session, the parsed garlic clove set must include a `LeaseSet2`
+                // so a reply can be sent to the remote destination and if `LeaseSet2` is not
+                // bundled, the inbound session is rejected
+                let (session, payload) =
+                    self.key_context.create_inbound_session(message.payload)?;
+
+                self.on_new_session(key, session, payload)?
             }
-            Some(destination_id) => match self.active.get_mut(&destination_id) {
+            Some((entry, destination_id)) => match self.active.get_mut(&destination_id) {
                 Some(session) => session
                     .session
-                    .decrypt(garlic_tag, message.payload, self.ratchet_threshold)
+                    .decrypt(
+                        PendingTag::from(entry),
+                        message.payload,
+                        self.ratchet_threshold,
+                    )
                     .map(|(tag_set_id, tag_index, message)| {
                         session.last_received = R::now();
 
@@ -866,10 +999,174 @@ impl<R: Runtime> SessionManager<R> {
             },
         };
 
-        // parse garlic cloves from the decrypted messages and return them to the caller
+        self.parse_cloves(tag_set_id, tag_index, destination_id, payload)
+            .map(|cloves| cloves.into_iter())
+    }
+
+    /// Handle successfully decrypted `NewSession` message.
+    ///
+    /// Records the ephemeral `key` of the message for replay protection, validates the message and
+    /// creates a pending inbound session for the remote destination.
+    ///
+    /// Returns the tag set ID, tag index, ID of the remote destination and the decrypted payload.
+    fn on_new_session(
+        &mut self,
+        key: Option<[u8; 32]>,
+        session: InboundSession<R>,
+        payload: Vec<u8>,
+    ) -> Result<(u16, u16, DestinationId, Vec<u8>), SessionError> {
+        // the message has been authenticated so its ephemeral key can be recorded
         //
+        // if the key has already been recorded, the message is a replay that was processed
+        // concurrently with the original message
+        if let Some(key) = key {
+            if !self.ns_admission.record(key) {
+                tracing::debug!(
+                    target: LOG_TARGET,
+                    local = %self.destination_id,
+                    "replayed `NewSession` message, dropping",
+                );
+                return Err(SessionError::Replay);
+            }
+        }
+
+        // attempt to parse `payload` into clove set
+        let clove_set = GarlicMessage::parse(&payload).ok_or_else(|| {
+            tracing::warn!(
+                target: LOG_TARGET,
+                local = %self.destination_id,
+                id = %self.destination_id,
+                "failed to parse NS payload into a clove set",
+            );
+
+            SessionError::Malformed
+        })?;
+
+        // validate `DateTime` block
+        let Some(GarlicMessageBlock::DateTime { timestamp }) = clove_set
+            .blocks
+            .iter()
+            .find(|clove| core::matches!(clove, GarlicMessageBlock::DateTime { .. }))
+        else {
+            tracing::warn!(
+                target: LOG_TARGET,
+                local = %self.destination_id,
+                id = %self.destination_id,
+                "`DateTime` missing from `NewSession`",
+            );
+
+            return Err(SessionError::Timestamp);
+        };
+
+        let now = R::time_since_epoch();
+        let timestamp = Duration::from_secs(*timestamp as u64);
+
+        if now - NS_MAX_AGE > timestamp || now + NS_FUTURE_LIMIT < timestamp {
+            tracing::warn!(
+                target: LOG_TARGET,
+                local = %self.destination_id,
+                id = %self.destination_id,
+                ?now,
+                ?timestamp,
+                "`DateTime` outside of allowed range",
+            );
+            return Err(SessionError::Timestamp);
+        }
+
+        // locate `DatabaseStore` i2np message from the clove set
+        let Some(GarlicMessageBlock::GarlicClove { message_body, .. }) =
+            clove_set.blocks.iter().find(|clove| {
+                core::matches!(
+                    clove,
+                    GarlicMessageBlock::GarlicClove {
+                        message_type: MessageType::DatabaseStore,
+                        ..
+                    }
+                )
+            })
+        else {
+            tracing::warn!(
+                target: LOG_TARGET,
+                id = %self.destination_id,
+                "clove set doesn't contain `DatabaseStore`, cannot reply",
+            );
+
+            return Err(SessionError::Malformed);
+        };
+
+        // attempt to parse the `DatabaseStore` as `LeaseSet2`
+        let Some(DatabaseStore {
+            key,
+            payload: DatabaseStorePayload::LeaseSet2 { lease_set },
+            ..
+        }) = DatabaseStore::<R>::parse(message_body)
+        else {
+            tracing::warn!(
+                target: LOG_TARGET,
+                id = %self.destination_id,
+                "`DatabaseStore` is not a valid `LeaseSet2` store, cannot reply",
+            );
+
+            return Err(SessionError::Malformed);
+        };
+        let destination_id = lease_set.header.destination.id();
+        let key = DestinationId::from(key);
+
+        if key != destination_id {
+            tracing::warn!(
+                target: LOG_TARGET,
+                ?destination_id,
+                ?key,
+                "key/lease set id mismatch for database store",
+            );
+            return Err(SessionError::InvalidKey);
+        }
+
+        match self.pending.get_mut(&destination_id) {
+            None => {
+                tracing::debug!(
+                    target: LOG_TARGET,
+                    local = %self.destination_id,
+                    remote = %destination_id,
+                    "inbound session created",
+                );
+
+                let slot = self.slots.acquire(&destination_id);
+
+                self.pending.insert(
+                    destination_id.clone(),
+                    PendingSession::new_inbound(
+                        self.destination_id.clone(),
+                        destination_id.clone(),
+                        slot,
+                        session,
+                        Arc::clone(&self.garlic_tags),
+                        self.key_context.clone(),
+                    ),
+                );
+            }
+            Some(_) => tracing::trace!(
+                target: LOG_TARGET,
+                local = %self.destination_id,
+                remote = %destination_id,
+                "inbound session already exists",
+            ),
+        }
+
+        // this is the first message of the session so both tag set id and tag index are 0
+        Ok((0u16, 0u16, destination_id, payload))
+    }
+
+    /// Parse garlic cloves from decrypted `payload` received from `destination_id`.
+    fn parse_cloves(
+        &mut self,
+        tag_set_id: u16,
+        tag_index: u16,
+        destination_id: DestinationId,
+        payload: Vec<u8>,
+    ) -> Result<Vec<GarlicClove>, SessionError> {
         // TODO: optimize, ideally this should return references
-        let cloves = GarlicMessage::parse(&payload)
+        Ok(GarlicMessage::parse(&payload)
             .ok_or_else(|| {
                 tracing::warn!(
                     target: LOG_TARGET,
@@ -978,9 +1275,7 @@ impl<R: Runtime> SessionManager<R> {
                     None
                 }
             })
-            .collect::<Vec<_>>();
-
-        Ok(cloves.into_iter())
+            .collect::<Vec<_>>())
     }
 
     /// Perform periodic maintenance of active and pending sessions.
@@ -989,6 +1284,18 @@ impl<R: Runtime> SessionManager<R> {
     /// activity within the last 10 minutes, and calls `Session::maintain()` for each active session
     /// which removes expired tags of the active session.
     fn maintain(&mut self) {
+        let AdmissionStats {
+            num_accepted,
+            num_offloaded,
+            num_replayed,
+            num_shed,
+        } = self.ns_admission.report(&self.destination_id);
+
+        self.metrics.counter(NS_ACCEPTED_COUNT).increment(num_accepted);
+        self.metrics.counter(NS_OFFLOADED_COUNT).increment(num_offloaded);
+        self.metrics.counter(NS_REPLAYED_COUNT).increment(num_replayed);
+        self.metrics.counter(NS_SHED_COUNT).increment(num_shed);
+
         self.pending
             .iter()
             .filter_map(|(key, session)| session.is_expired().then_some(key.clone()))
@@ -1001,7 +1308,10 @@ impl<R: Runtime> SessionManager<R> {
                     %remote,
                     "purging expired pending session",
                 );
-                self.pending.remove(&remote);
+
+                // session must exist since it was deemed expired
+                self.pending.remove(&remote).expect("to exist").destroy();
+                self.release_slot(&remote);
             });
 
         self.active
@@ -1023,6 +1333,7 @@ impl<R: Runtime> SessionManager<R> {
 
                 // session must exist since it was deemed inactive
                 self.active.remove(&remote).expect("to exist").session.destroy();
+                self.release_slot(&remote);
             });
 
         self.active.values_mut().for_each(|session| session.session.maintain());
@@ -1049,6 +1360,12 @@ impl<R: Runtime> SessionManager<R> {
     }
 }
 
+impl<R: Runtime> Drop for SessionManager<R> {
+    fn drop(&mut self) {
+        self.metrics.gauge(NS_IN_FLIGHT).decrement(self.new_sessions.len());
+    }
+}
+
 impl<R: Runtime> Stream for SessionManager<R> {
     type Item = SessionManagerEvent;
 
@@ -1091,6 +1408,35 @@ impl<R: Runtime> Stream for SessionManager<R> {
             }
         }
 
+        loop {
+            match self.new_sessions.poll_next_unpin(cx) {
+                Poll::Pending => break,
+                Poll::Ready(None) => return Poll::Ready(None),
+                Poll::Ready(Some((key, result))) => {
+                    self.metrics.gauge(NS_IN_FLIGHT).decrement(1);
+
+                    let result = result.and_then(|(session, payload)| {
+                        let (tag_set_id, tag_index, destination_id, payload) =
+                            self.on_new_session(key, session, payload)?;
+
+                        self.parse_cloves(tag_set_id, tag_index, destination_id, payload)
+                    });
+
+                    match result {
+                        Ok(cloves) if cloves.is_empty() => {}
+                        Ok(cloves) =>
+                            return Poll::Ready(Some(SessionManagerEvent::Cloves { cloves })),
+                        Err(error) => tracing::debug!(
+                            target: LOG_TARGET,
+                            local = %self.destination_id,
+                            ?error,
+                            "failed to handle `NewSession`",
+                        ),
+                    }
+                }
+            }
+        }
+
         if self.maintenance_timer.poll_unpin(cx).is_ready() {
             self.maintain();
 
@@ -1146,8 +1492,12 @@ mod tests {
         let destination_id = DestinationId::random();
         let (leaseset, signing_key) = LeaseSet2::random();
         let leaseset = Bytes::from(leaseset.serialize(&signing_key));
-        let mut session =
-            SessionManager::<MockRuntime>::new(destination_id.clone(), private_key, leaseset);
+        let mut session = SessionManager::<MockRuntime>::new(
+            destination_id.clone(),
+            private_key,
+            leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
+        );
 
         // create outbound `SessionManager`
         let outbound_private_key = StaticPrivateKey::random(thread_rng());
@@ -1164,6 +1514,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key,
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(destination_id.clone(), public_key);
         let message = outbound_session.encrypt(&destination_id, vec![1, 2, 3, 4]).unwrap();
@@ -1234,8 +1585,12 @@ mod tests {
         let destination_id = DestinationId::random();
         let (leaseset, signing_key) = LeaseSet2::random();
         let leaseset = Bytes::from(leaseset.serialize(&signing_key));
-        let mut session =
-            SessionManager::<MockRuntime>::new(destination_id.clone(), private_key, leaseset);
+        let mut session = SessionManager::<MockRuntime>::new(
+            destination_id.clone(),
+            private_key,
+            leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
+        );
 
         // create outbound `SessionManager`
         let outbound_private_key = StaticPrivateKey::random(thread_rng());
@@ -1252,6 +1607,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key,
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(destination_id.clone(), public_key);
         let message = outbound_session.encrypt(&destination_id, vec![1, 2, 3, 4]).unwrap();
@@ -1376,6 +1732,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -1393,6 +1750,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key,
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -1492,6 +1850,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create first outbound `SessionManager`
@@ -1509,6 +1868,7 @@ mod tests {
             outbound1_destination_id.clone(),
             outbound1_private_key,
             outbound1_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound1_session
             .add_remote_destination(inbound_destination_id.clone(), inbound_public_key.clone());
@@ -1528,6 +1888,7 @@ mod tests {
             outbound2_destination_id.clone(),
             outbound2_private_key,
             outbound2_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound2_session
             .add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
@@ -1723,6 +2084,7 @@ mod tests {
             inbound1_destination_id.clone(),
             inbound1_private_key,
             inbound1_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create second inbound `SessionManager`
@@ -1741,6 +2103,7 @@ mod tests {
             inbound2_destination_id.clone(),
             inbound2_private_key,
             inbound2_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -1758,6 +2121,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key,
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session
             .add_remote_destination(inbound1_destination_id.clone(), inbound1_public_key);
@@ -1922,6 +2286,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -1939,6 +2304,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key,
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -2001,9 +2367,9 @@ mod tests {
         };
         assert_eq!(message_body[4..], [1, 3, 3, 7]);
 
-        // send twice as many messages as there were initial tags
+        // send more messages than fit in the maximum tag window
         // and verify that all messages are decrypted correctly
-        for i in 0..NUM_TAGS_TO_GENERATE * 2 {
+        for i in 0..MAX_TAG_WINDOW * 2 {
             // send `ExistingSession` from inbound session
             // finalize inbound session by sending an `ExistingSession` message
             let message =
@@ -2044,6 +2410,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
             TEST_THRESHOLD,
         );
 
@@ -2062,6 +2429,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key,
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
             TEST_THRESHOLD,
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
@@ -2187,6 +2555,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -2212,6 +2581,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -2418,6 +2788,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -2443,6 +2814,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -2659,6 +3031,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -2684,6 +3057,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -2738,6 +3112,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -2763,6 +3138,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -2815,6 +3191,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -2840,6 +3217,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -2899,6 +3277,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -2924,6 +3303,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -2951,6 +3331,91 @@ mod tests {
         decrypt_and_verify!(&mut outbound_session, message, vec![5u8; 4]);
     }
 
+    #[tokio::test]
+    async fn multiple_messages_coalesced() {
+        // create inbound `SessionManager`
+        let inbound_private_key = StaticPrivateKey::random(thread_rng());
+        let inbound_public_key = inbound_private_key.public();
+        let (inbound_leaseset, inbound_destination_id) = {
+            let (leaseset, signing_key) = LeaseSet2::random();
+            let inbound_destination_id = leaseset.header.destination.id();
+
+            (
+                Bytes::from(leaseset.serialize(&signing_key)),
+                inbound_destination_id,
+            )
+        };
+        let mut inbound_session = SessionManager::<MockRuntime>::new(
+            inbound_destination_id.clone(),
+            inbound_private_key,
+            inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
+        );
+
+        // create outbound `SessionManager`
+        let outbound_private_key = StaticPrivateKey::random(thread_rng());
+        let (outbound_leaseset, outbound_destination_id) = {
+            let (leaseset, signing_key) = LeaseSet2::random();
+            let outbound_destination_id = leaseset.header.destination.id();
+
+            (
+                Bytes::from(leaseset.serialize(&signing_key)),
+                outbound_destination_id,
+            )
+        };
+        let mut outbound_session = SessionManager::<MockRuntime>::new(
+            outbound_destination_id.clone(),
+            outbound_private_key,
+            outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
+        );
+        outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
+
+        // session is still pending so each message is encrypted into its own `NewSession`
+        let messages = outbound_session
+            .encrypt_many(&inbound_destination_id, vec![vec![1u8; 4], vec![2u8; 4]])
+            .unwrap();
+        assert_eq!(messages.len(), 2);
+
+        for (i, message) in messages.into_iter().enumerate() {
+            decrypt_and_verify!(&mut inbound_session, message, vec![(i + 1) as u8; 4]);
+        }
+
+        // finalize the session
+        let message = inbound_session.encrypt(&outbound_destination_id, vec![3u8; 4]).unwrap();
+        decrypt_and_verify!(&mut outbound_session, message, vec![3u8; 4]);
+
+        let message = outbound_session.encrypt(&inbound_destination_id, vec![4u8; 4]).unwrap();
+        decrypt_and_verify!(&mut inbound_session, message, vec![4u8; 4]);
+
+        // session is active so all messages are packed into one `ExistingSession`
+        //
+        // the size estimate covers the cloves and all garlic overhead, including the bundled lease
+        // set and an allowance for `NextKey` blocks which are not sent in this message
+        let estimate = outbound_session.message_overhead(&inbound_destination_id)
+            + 3 * SessionManager::<MockRuntime>::data_clove_size(4);
+        let mut messages = outbound_session
+            .encrypt_many(
+                &inbound_destination_id,
+                vec![vec![5u8; 4], vec![6u8; 4], vec![7u8; 4]],
+            )
+            .unwrap();
+        assert_eq!(messages.len(), 1);
+        assert_eq!(messages[0].len(), estimate - MAX_NEXT_KEY_BLOCKS_SIZE);
+
+        let cloves = inbound_session
+            .decrypt(Message {
+                payload: messages.pop().unwrap(),
+                ..Default::default()
+            })
+            .unwrap()
+            .filter(|clove| std::matches!(clove.message_type, MessageType::Data))
+            .map(|clove| clove.message_body[4..].to_vec())
+            .collect::<Vec<_>>();
+
+        assert_eq!(cloves, vec![vec![5u8; 4], vec![6u8; 4], vec![7u8; 4]]);
+    }
+
     #[tokio::test]
     async fn new_session_reply_retried() {
         // create inbound `SessionManager`
@@ -2969,6 +3434,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -2994,6 +3460,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -3041,6 +3508,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -3066,6 +3534,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -3110,6 +3579,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -3135,6 +3605,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -3267,6 +3738,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
 
         // create outbound `SessionManager`
@@ -3292,6 +3764,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
 
@@ -3403,6 +3876,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
             TEST_THRESHOLD,
         );
 
@@ -3429,6 +3903,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
             TEST_THRESHOLD,
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
@@ -3532,6 +4007,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
             TEST_THRESHOLD,
         );
 
@@ -3558,6 +4034,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
             TEST_THRESHOLD,
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
@@ -3640,6 +4117,7 @@ mod tests {
             inbound_destination_id.clone(),
             inbound_private_key,
             inbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
             TEST_THRESHOLD,
         );
 
@@ -3666,6 +4144,7 @@ mod tests {
             outbound_destination_id.clone(),
             outbound_private_key.clone(),
             outbound_leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
             TEST_THRESHOLD,
         );
         outbound_session.add_remote_destination(inbound_destination_id.clone(), inbound_public_key);
@@ -3971,8 +4450,12 @@ mod tests {
         let destination_id = DestinationId::random();
         let (leaseset, signing_key) = LeaseSet2::random();
         let leaseset = Bytes::from(leaseset.serialize(&signing_key));
-        let mut session =
-            SessionManager::<MockRuntime>::new(destination_id.clone(), private_key, leaseset);
+        let mut session = SessionManager::<MockRuntime>::new(
+            destination_id.clone(),
+            private_key,
+            leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
+        );
 
         let message = Message {
             message_type: MessageType::Garlic,
@@ -3995,8 +4478,12 @@ mod tests {
         let destination_id = DestinationId::random();
         let (leaseset, signing_key) = LeaseSet2::random();
         let leaseset = Bytes::from(leaseset.serialize(&signing_key));
-        let mut session =
-            SessionManager::<MockRuntime>::new(destination_id.clone(), private_key, leaseset);
+        let mut session = SessionManager::<MockRuntime>::new(
+            destination_id.clone(),
+            private_key,
+            leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
+        );
 
         let message = Message {
             message_type: MessageType::Garlic,
@@ -4023,8 +4510,12 @@ mod tests {
         let destination_id = DestinationId::random();
         let (leaseset, signing_key) = LeaseSet2::random();
         let leaseset = Bytes::from(leaseset.serialize(&signing_key));
-        let mut session =
-            SessionManager::<MockRuntime>::new(destination_id.clone(), private_key, leaseset);
+        let mut session = SessionManager::<MockRuntime>::new(
+            destination_id.clone(),
+            private_key,
+            leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
+        );
 
         let message = Message {
             message_type: MessageType::Garlic,
@@ -4046,4 +4537,95 @@ mod tests {
             Ok(_) => panic!("unexpected success"),
         }
     }
+
+    #[tokio::test]
+    async fn new_session_burst_processed_in_background() {
+        let private_key = StaticPrivateKey::random(thread_rng());
+        let public_key = private_key.public();
+        let destination_id = DestinationId::random();
+        let (leaseset, signing_key) = LeaseSet2::random();
+        let leaseset = Bytes::from(leaseset.serialize(&signing_key));
+        let mut session = SessionManager::<MockRuntime>::new(
+            destination_id.clone(),
+            private_key,
+            leaseset,
+            MockRuntime::register_metrics(Vec::new(), None),
+        );
+
+        let num_sessions = admission::NS_MAX_INLINE_PER_INTERVAL + 4;
+        let mut num_inline = 0usize;
+        let mut first_message = None;
+
+        for _ in 0..num_sessions {
+            let (leaseset, signing_key) = LeaseSet2::random();
+            let outbound_destination_id = leaseset.header.destination.id();
+            let mut outbound_session = SessionManager::<MockRuntime>::new(
+                outbound_destination_id,
+                StaticPrivateKey::random(thread_rng()),
+                Bytes::from(leaseset.serialize(&signing_key)),
+                MockRuntime::register_metrics(Vec::new(), None),
+            );
+            outbound_session.add_remote_destination(destination_id.clone(), public_key.clone());
+
+            let message = outbound_session.encrypt(&destination_id, vec![1, 2, 3, 4]).unwrap();
+            first_message.get_or_insert_with(|| message.clone());
+
+            let cloves = session
+                .decrypt(Message {
+                    payload: message,
+                    ..Default::default()
+                })
+                .unwrap()
+                .collect::<Vec<_>>();
+
+            if !cloves.is_empty() {
+                num_inline += 1;
+            }
+        }
+        assert_eq!(num_inline, admission::NS_MAX_INLINE_PER_INTERVAL);
+        assert_eq!(MockRuntime::get_gauge_value(NS_IN_FLIGHT), Some(4));
+
+        // the rest of the messages are decrypted in the background
+        for _ in 0..num_sessions - num_inline {
+            match tokio::time::timeout(Duration::from_secs(5), session.next())
+                .await
+                .expect("no timeout")
+                .expect("to succeed")
+            {
+                SessionManagerEvent::Cloves { cloves } => {
+                    let Some(GarlicClove { message_body, .. }) = cloves
+                        .into_iter()
+                        .find(|clove| std::matches!(clove.message_type, MessageType::Data))
+                    else {
+                        panic!("message not found");
+                    };
+                    assert_eq!(&message_body[4..], &vec![1, 2, 3, 4]);
+                }
+                _ => panic!("invalid event"),
+            }
+        }
+
+        assert_eq!(session.pending.len(), num_sessions);
+        assert_eq!(MockRuntime::get_gauge_value(NS_IN_FLIGHT), Some(0));
+
+        // replayed message is dropped
+        assert!(std::matches!(
+            session.decrypt(Message {
+                payload: first_message.unwrap(),
+                ..Default::default()
+            }),
+            Err(SessionError::Replay)
+        ));
+
+        // admission statistics are published during maintenance
+        session.maintain();
+
+        assert_eq!(
+            MockRuntime::get_counter_value(NS_ACCEPTED_COUNT),
+            Some(num_sessions)
+        );
+        assert_eq!(MockRuntime::get_counter_value(NS_OFFLOADED_COUNT), Some(4));
+        assert_eq!(MockRuntime::get_counter_value(NS_REPLAYED_COUNT), Some(1));
+        assert_eq!(MockRuntime::get_counter_value(NS_SHED_COUNT), Some(0));
+    }
 }
@@ -22,8 +22,9 @@ use crate::{
         context::KeyContext,
         inbound::InboundSession,
         outbound::OutboundSession,
-        tag_set::{TagSet, TagSetEntry},
-        LOG_TARGET, NUM_TAGS_TO_GENERATE,
+        tag_set::{PendingTag, TagSet, TagSetEntry},
+        tag_table::{SessionSlot, TagTable},
+        INITIAL_TAG_WINDOW, LOG_TARGET, MAX_TAG_WINDOW, TAG_WINDOW_RATE_INTERVAL,
     },
     error::SessionError,
     i2np::{
@@ -38,7 +39,7 @@ use crate::{
 };
 
 use bytes::{BufMut, Bytes, BytesMut};
-use hashbrown::{HashMap, HashSet};
+use hashbrown::HashMap;
 use rand_core::RngCore;
 
 #[cfg(feature = "std")]
@@ -110,10 +111,10 @@ enum PendingSessionState<R: Runtime> {
         inbound: InboundSession<R>,
 
         /// Garlic tags, global mapping for all active and pending sessions.
-        garlic_tags: Arc<RwLock<HashMap<u64, DestinationId>>>,
+        garlic_tags: Arc<RwLock<TagTable>>,
 
-        /// Garlic tag -> session key mapping for inbound messages.
-        tag_set_entries: HashMap<u64, TagSetEntry>,
+        /// Garlic tag -> pending tag mapping for inbound messages.
+        tag_set_entries: HashMap<u64, PendingTag>,
     },
 
     /// Outbound session is awaiting the reception of an NSR message.
@@ -125,13 +126,13 @@ enum PendingSessionState<R: Runtime> {
         remote_public_key: StaticPublicKey,
 
         /// Garlic tags, global mapping for all active and pending sessions.
-        garlic_tags: Arc<RwLock<HashMap<u64, DestinationId>>>,
+        garlic_tags: Arc<RwLock<TagTable>>,
 
         /// Garlic tag -> (session, session key) mapping for NSR message(s).
         nsr_tag_set_entries: HashMap<u64, (usize, TagSetEntry)>,
 
-        /// Garlic tag -> session key mapping for ES messages.
-        tag_set_entries: HashMap<u64, TagSetEntry>,
+        /// Garlic tag -> pending tag mapping for ES messages.
+        tag_set_entries: HashMap<u64, PendingTag>,
     },
 
     /// Outbound session is awaiting the destination to send its first message so the session can
@@ -153,13 +154,13 @@ enum PendingSessionState<R: Runtime> {
         remote_public_key: StaticPublicKey,
 
         /// Garlic tags, global mapping for all active and pending sessions.
-        garlic_tags: Arc<RwLock<HashMap<u64, DestinationId>>>,
+        garlic_tags: Arc<RwLock<TagTable>>,
 
         /// Garlic tag -> (session, session key) mapping for NSR message(s).
         nsr_tag_set_entries: HashMap<u64, (usize, TagSetEntry)>,
 
-        /// Garlic tag -> session key mapping for ES messages.
-        tag_set_entries: HashMap<u64, TagSetEntry>,
+        /// Garlic tag -> pending tag mapping for ES messages.
+        tag_set_entries: HashMap<u64, PendingTag>,
     },
 
     /// State has been poisoned.
@@ -196,6 +197,9 @@ pub struct PendingSession<R: Runtime> {
     /// ID of the remote destination.
     remote: DestinationId,
 
+    /// Slot of the session in the garlic tag table.
+    slot: SessionSlot,
+
     /// State of the session.
     state: PendingSessionState<R>,
 }
@@ -205,8 +209,9 @@ impl<R: Runtime> PendingSession<R> {
     pub fn new_inbound(
         local: DestinationId,
         remote: DestinationId,
+        slot: SessionSlot,
         inbound: InboundSession<R>,
-        garlic_tags: Arc<RwLock<HashMap<u64, DestinationId>>>,
+        garlic_tags: Arc<RwLock<TagTable>>,
         key_context: KeyContext<R>,
     ) -> Self {
         Self {
@@ -214,6 +219,7 @@ impl<R: Runtime> PendingSession<R> {
             key_context,
             local,
             remote,
+            slot,
             state: PendingSessionState::InboundActive {
                 inbound,
                 tag_set_entries: HashMap::new(),
@@ -226,9 +232,10 @@ impl<R: Runtime> PendingSession<R> {
     pub fn new_outbound(
         local: DestinationId,
         remote: DestinationId,
+        slot: SessionSlot,
         remote_public_key: StaticPublicKey,
         outbound: OutboundSession<R>,
-        garlic_tags: Arc<RwLock<HashMap<u64, DestinationId>>>,
+        garlic_tags: Arc<RwLock<TagTable>>,
         key_context: KeyContext<R>,
         ratchet_threshold: u16,
     ) -> Self {
@@ -239,7 +246,7 @@ impl<R: Runtime> PendingSession<R> {
             outbound
                 .generate_new_session_reply_tags(ratchet_threshold)
                 .map(|tag_set| {
-                    inner.insert(tag_set.tag, remote.clone());
+                    inner.insert(tag_set.table_entry(slot));
                     (tag_set.tag, (0usize, tag_set))
                 })
                 .collect()
@@ -250,6 +257,7 @@ impl<R: Runtime> PendingSession<R> {
             key_context,
             local,
             remote,
+            slot,
             state: PendingSessionState::AwaitingNsr {
                 outbound: HashMap::from_iter([(0usize, outbound)]),
                 remote_public_key,
@@ -305,19 +313,19 @@ impl<R: Runtime> PendingSession<R> {
                     .build();
 
                 // create `NewSessionReply` and garlic receive tags
-                let (message, entries) =
+                let (message, tags) =
                     inbound.create_new_session_reply(message, ratchet_threshold)?;
 
                 // store receive garlic tags both in the global storage common for all destinations
                 // so `SessionManager` can dispatch received messages to the correct `Session` and
-                // also in the session's own `TagSetEntry` storage so the session has access to the
-                // session key and associated context to decrypt the message
+                // also in the session's own storage so the session can derive the session key for
+                // the tag once a message is received
                 {
                     let mut inner = garlic_tags.write();
 
-                    entries.into_iter().for_each(|entry| {
-                        inner.insert(entry.tag, self.remote.clone());
-                        tag_set_entries.insert(entry.tag, entry);
+                    tags.into_iter().for_each(|tag| {
+                        inner.insert(tag.table_entry(self.slot));
+                        tag_set_entries.insert(tag.tag, tag);
                     })
                 }
 
@@ -357,7 +365,7 @@ impl<R: Runtime> PendingSession<R> {
 
                     session.generate_new_session_reply_tags(ratchet_threshold).for_each(
                         |tag_set| {
-                            inner.insert(tag_set.tag, self.remote.clone());
+                            inner.insert(tag_set.table_entry(self.slot));
                             nsr_tag_set_entries.insert(tag_set.tag, (outbound.len(), tag_set));
                         },
                     );
@@ -439,6 +447,7 @@ impl<R: Runtime> PendingSession<R> {
                         local: self.local.clone(),
                         recv_tag_set: *recv_tag_set,
                         remote: self.remote.clone(),
+                        slot: self.slot,
                         send_tag_set: *send_tag_set,
                         tag_set_entries,
                         nsr_context: NsrContext::new(nsr_tag_set_entries, outbound),
@@ -484,23 +493,33 @@ impl<R: Runtime> PendingSession<R> {
                     "ES received",
                 );
 
-                let tag_set_entry = tag_set_entries.remove(&garlic_tag).ok_or_else(|| {
+                let tag = tag_set_entries.remove(&garlic_tag).ok_or_else(|| {
                     tracing::warn!(
                         target: LOG_TARGET,
                         local = %self.local,
                         remote = %self.remote,
                         ?garlic_tag,
-                        "`TagSetEntry` doesn't exist for ES",
+                        "pending tag doesn't exist for ES",
                     );
 
                     debug_assert!(false);
                     SessionError::InvalidState
                 })?;
-                let tag_set_id = tag_set_entry.tag_set_id;
-                let tag_index = tag_set_entry.tag_index;
+                let tag_set_id = tag.tag_set_id;
+                let tag_index = tag.tag_index;
 
-                let (message, send_tag_set, recv_tag_set) =
-                    inbound.handle_existing_session(garlic_tag, tag_set_entry, message)?;
+                let (message, send_tag_set, recv_tag_set, unused_tags) =
+                    inbound.handle_existing_session(garlic_tag, tag, message)?;
+
+                // remove tags generated for the tag sets of the unused `NewSessionReply` messages
+                {
+                    let mut inner = garlic_tags.write();
+
+                    unused_tags.into_iter().for_each(|tag| {
+                        inner.remove(tag);
+                        tag_set_entries.remove(&tag);
+                    });
+                }
 
                 Ok(PendingSessionEvent::CreateSession {
                     message,
@@ -511,6 +530,7 @@ impl<R: Runtime> PendingSession<R> {
                         garlic_tags,
                         local: self.local.clone(),
                         remote: self.remote.clone(),
+                        slot: self.slot,
                         nsr_context: NsrContext::Inactive,
                     }),
                     tag_set_id,
@@ -552,20 +572,20 @@ impl<R: Runtime> PendingSession<R> {
                     .expect("to exist")
                     .handle_new_session_reply(tag_set_entry, message, ratchet_threshold)?;
 
-                // generate tag set entries for inbound messages and store remote's id in the global
-                // storage under the generated garlic tags and store the tag set entries themselves
+                // generate the initial tag window for inbound messages and store remote's id in the
+                // global storage under the generated garlic tags and store the tags themselves
                 // inside the `Session`'s storage
                 //
                 // these tags are for ES messages and the session tracks NSR tags separately
                 {
                     let mut inner = garlic_tags.write();
 
-                    // `next_entry()` must succeed as `recv_tag_set` is a fresh `TagSet`
-                    (0..NUM_TAGS_TO_GENERATE).for_each(|_| {
-                        let entry = recv_tag_set.next_entry().expect("to succeed");
+                    // `next_tag()` must succeed as `recv_tag_set` is a fresh `TagSet`
+                    (0..INITIAL_TAG_WINDOW).for_each(|_| {
+                        let tag = recv_tag_set.next_tag().expect("to succeed");
 
-                        inner.insert(entry.tag, self.remote.clone());
-                        tag_set_entries.insert(entry.tag, entry);
+                        inner.insert(tag.table_entry(self.slot));
+                        tag_set_entries.insert(tag.tag, tag);
                     });
                 };
 
@@ -650,6 +670,39 @@ impl<R: Runtime> PendingSession<R> {
             }
         }
     }
+
+    /// Destroy pending session and remove all of its garlic tags from the tag table.
+    pub fn destroy(self) {
+        let (garlic_tags, tags) = match self.state {
+            PendingSessionState::InboundActive {
+                garlic_tags,
+                tag_set_entries,
+                ..
+            } => (garlic_tags, tag_set_entries.into_keys().collect::<Vec<_>>()),
+            PendingSessionState::AwaitingNsr {
+                garlic_tags,
+                nsr_tag_set_entries,
+                tag_set_entries,
+                ..
+            }
+            | PendingSessionState::AwaitingEsTransmit {
+                garlic_tags,
+                nsr_tag_set_entries,
+                tag_set_entries,
+                ..
+            } => (
+                garlic_tags,
+                nsr_tag_set_entries.into_keys().chain(tag_set_entries.into_keys()).collect(),
+            ),
+            PendingSessionState::Poisoned => return,
+        };
+
+        let mut inner = garlic_tags.write();
+
+        tags.into_iter().for_each(|tag| {
+            inner.remove(tag);
+        });
+    }
 }
 
 /// NSR context.
@@ -730,6 +783,18 @@ impl<R: Runtime> NsrContext<R> {
             .map(|(message, _, _)| (tag_set_id, tag_index, message))
     }
 
+    /// Get iterator over the outstanding garlic tags of the context.
+    fn tags(&self) -> impl Iterator<Item = u64> + '_ {
+        let tags = match self {
+            Self::Inactive => None,
+            Self::Active {
+                tag_set_entries, ..
+            } => Some(tag_set_entries.keys().copied()),
+        };
+
+        tags.into_iter().flatten()
+    }
+
     /// Attempt to expire
     fn try_expire(&mut self) -> Option<impl Iterator<Item = u64>> {
         match self {
@@ -747,10 +812,190 @@ impl<R: Runtime> NsrContext<R> {
     }
 }
 
+/// Receive tag lookahead window of an active session.
+///
+/// Instead of generating a large, fixed batch of tags for each receive tag set, the session keeps
+/// the tag set at most `size` tag indices ahead of the highest tag index received so far and the
+/// window slides forward as messages are received. Session keys for the tags are derived lazily,
+/// only once a message with the tag has been received.
+///
+/// The window grows if the inbound message rate of the session is high or if messages are
+/// received far ahead of the previously highest tag index, e.g., due to packet loss or reordering,
+/// and shrinks back towards [`INITIAL_TAG_WINDOW`] once the session becomes less busy.
+struct TagWindow<R: Runtime> {
+    /// Highest tag index received from the current receive tag set, if any.
+    highest_index: Option<u16>,
+
+    /// Start of the current rate measurement interval.
+    interval_start: R::Instant,
+
+    /// Number of messages received during the current rate measurement interval.
+    num_received: usize,
+
+    /// Size of the lookahead window.
+    size: usize,
+}
+
+impl<R: Runtime> TagWindow<R> {
+    /// Create new [`TagWindow`].
+    fn new() -> Self {
+        Self {
+            highest_index: None,
+            interval_start: R::now(),
+            num_received: 0usize,
+            size: INITIAL_TAG_WINDOW,
+        }
+    }
+
+    /// Register reception of a message with `tag_index`.
+    fn register(&mut self, tag_index: u16) {
+        let highest_index = self.highest_index.unwrap_or(0u16);
+
+        if tag_index as usize > highest_index as usize + self.size / 2 {
+            self.size = core::cmp::min(self.size * 2, MAX_TAG_WINDOW);
+        }
+        self.highest_index = Some(core::cmp::max(highest_index, tag_index));
+        self.num_received += 1;
+
+        if self.interval_start.elapsed() < TAG_WINDOW_RATE_INTERVAL {
+            return;
+        }
+
+        if self.num_received >= self.size / 2 {
+            self.size = core::cmp::min(self.size * 2, MAX_TAG_WINDOW);
+        } else if self.num_received < self.size / 8 {
+            self.size = core::cmp::max(self.size / 2, INITIAL_TAG_WINDOW);
+        }
+
+        self.interval_start = R::now();
+        self.num_received = 0usize;
+    }
+
+    /// Reset the window after the receive tag set has done a DH ratchet.
+    ///
+    /// The size of the window is preserved since the message rate doesn't change.
+    fn reset(&mut self) {
+        self.highest_index = None;
+    }
+
+    /// Index up to which (exclusive) tags should have been generated.
+    fn target_index(&self) -> usize {
+        self.highest_index.map_or(0usize, |index| index as usize + 1) + self.size
+    }
+
+    /// Tag index below which unused tags of the current tag set are considered lost.
+    fn prune_index(&self) -> Option<u16> {
+        (self.highest_index? as usize)
+            .checked_sub(MAX_TAG_WINDOW)
+            .map(|index| index as u16)
+    }
+}
+
+/// Outstanding tags of the current receive tag set, indexed by tag index.
+///
+/// Tags are generated in tag index order, so the position of a tag is found directly from the tag
+/// index stored in the garlic tag table without a second hash table lookup.
+struct TagRing {
+    /// Tag index of the first tag in the ring.
+    base: u16,
+
+    /// Garlic tags, `None` if the tag has been consumed.
+    tags: VecDeque<Option<u64>>,
+}
+
+impl TagRing {
+    /// Create new [`TagRing`] from `tags` which were generated from a tag set whose next tag index
+    /// is `next_index`.
+    fn new(tags: impl Iterator<Item = PendingTag>, next_index: u16) -> Self {
+        let tags = tags.collect::<Vec<_>>();
+        let base = tags.iter().map(|tag| tag.tag_index).min().unwrap_or(next_index);
+        let mut ring = Self {
+            base,
+            tags: (base..next_index).map(|_| None).collect(),
+        };
+
+        tags.into_iter().for_each(|tag| {
+            if let Some(entry) = ring.tags.get_mut((tag.tag_index - base) as usize) {
+                *entry = Some(tag.tag);
+            }
+        });
+        ring.compact();
+        ring
+    }
+
+    /// Push `tag` into the ring.
+    ///
+    /// The tag index of `tag` must be one greater than the index of the last tag in the ring.
+    fn push(&mut self, tag: &PendingTag) {
+        debug_assert_eq!(self.base as usize + self.tags.len(), tag.tag_index as usize);
+
+        self.tags.push_back(Some(tag.tag));
+    }
+
+    /// Remove consumed tags from the front of the ring.
+    fn compact(&mut self) {
+        while let Some(None) = self.tags.front() {
+            self.tags.pop_front();
+            self.base = self.base.saturating_add(1);
+        }
+    }
+
+    /// Take `tag` with `tag_index` from the ring.
+    ///
+    /// Returns `false` if the tag doesn't exist in the ring.
+    fn take(&mut self, tag_index: u16, tag: u64) -> bool {
+        let Some(index) = tag_index.checked_sub(self.base) else {
+            return false;
+        };
+
+        match self.tags.get_mut(index as usize) {
+            Some(entry) if *entry == Some(tag) => {
+                *entry = None;
+                self.compact();
+                true
+            }
+            _ => false,
+        }
+    }
+
+    /// Remove all tags with tag index lower than `tag_index`.
+    fn prune(&mut self, tag_index: u16) -> Vec<u64> {
+        let mut pruned = Vec::new();
+
+        while self.base < tag_index {
+            let Some(entry) = self.tags.pop_front() else {
+                break;
+            };
+
+            pruned.extend(entry);
+            self.base = self.base.saturating_add(1);
+        }
+        self.compact();
+
+        pruned
+    }
+
+    /// Remove all tags from the ring, returning them in tag index order.
+    fn drain(&mut self) -> Vec<(u16, u64)> {
+        let base = self.base;
+
+        self.tags
+            .drain(..)
+            .enumerate()
+            .filter_map(|(offset, tag)| tag.map(|tag| (base + offset as u16, tag)))
+            .collect()
+    }
+
+    /// Get iterator over the outstanding tags of the ring.
+    fn tags(&self) -> impl Iterator<Item = u64> + '_ {
+        self.tags.iter().filter_map(|tag| *tag)
+    }
+}
+
 /// Session context, passed into [`Session::new()`].
 pub struct SessionContext<R: Runtime> {
     /// Garlic tags, global mapping for all active and pending sessions.
-    garlic_tags: Arc<RwLock<HashMap<u64, DestinationId>>>,
+    garlic_tags: Arc<RwLock<TagTable>>,
 
     /// ID of the local destination.
     local: DestinationId,
@@ -764,8 +1009,11 @@ pub struct SessionContext<R: Runtime> {
     /// `TagSet` for outbound messages.
     send_tag_set: TagSet,
 
-    /// `TagSet` entries for inbound messages.
-    tag_set_entries: HashMap<u64, TagSetEntry>,
+    /// Slot of the session in the garlic tag table.
+    slot: SessionSlot,
+
+    /// Pending tags for inbound messages.
+    tag_set_entries: HashMap<u64, PendingTag>,
 
     /// NSR context.
     ///
@@ -778,11 +1026,14 @@ pub struct SessionContext<R: Runtime> {
 
 /// Active ECIES-X25519-AEAD-Ratchet session.
 pub struct Session<R: Runtime> {
-    /// Tags that marked to expire.
-    expiring: VecDeque<(R::Instant, HashSet<u64>)>,
+    /// Tags of previous tag sets that are marked to expire.
+    ///
+    /// Session keys of these tags are derived when the tag set is ratcheted as the symmetric key
+    /// chain of the previous tag set is not available after the ratchet.
+    expiring: VecDeque<(R::Instant, HashMap<u64, TagSetEntry>)>,
 
     /// Garlic tags, global mapping for all active and pending sessions.
-    garlic_tags: Arc<RwLock<HashMap<u64, DestinationId>>>,
+    garlic_tags: Arc<RwLock<TagTable>>,
 
     /// ID of the local destination.
     local: DestinationId,
@@ -806,8 +1057,14 @@ pub struct Session<R: Runtime> {
     /// `TagSet` for outbound messages.
     send_tag_set: TagSet,
 
-    /// `TagSet` entries for inbound messages.
-    tag_set_entries: HashMap<u64, TagSetEntry>,
+    /// Slot of the session in the garlic tag table.
+    slot: SessionSlot,
+
+    /// Outstanding tags of the current receive tag set.
+    tag_ring: TagRing,
+
+    /// Receive tag lookahead window.
+    tag_window: TagWindow<R>,
 }
 
 impl<R: Runtime> Session<R> {
@@ -819,9 +1076,11 @@ impl<R: Runtime> Session<R> {
             recv_tag_set,
             remote,
             send_tag_set,
+            slot,
             tag_set_entries,
             nsr_context,
         } = context;
+        let tag_ring = TagRing::new(tag_set_entries.into_values(), recv_tag_set.next_tag_index());
 
         Self {
             expiring: VecDeque::new(),
@@ -832,7 +1091,35 @@ impl<R: Runtime> Session<R> {
             recv_tag_set,
             remote,
             send_tag_set,
-            tag_set_entries,
+            slot,
+            tag_ring,
+            tag_window: TagWindow::new(),
+        }
+    }
+
+    /// Generate tags from the receive tag set until the lookahead window is full.
+    fn fill_tag_window(&mut self) {
+        let target_index = self.tag_window.target_index();
+
+        if self.recv_tag_set.next_tag_index() as usize >= target_index {
+            return;
+        }
+
+        let mut inner = self.garlic_tags.write();
+
+        while (self.recv_tag_set.next_tag_index() as usize) < target_index {
+            let Some(tag) = self.recv_tag_set.next_tag() else {
+                tracing::debug!(
+                    target: LOG_TARGET,
+                    local = %self.local,
+                    remote = %self.remote,
+                    "receive tag set ran out of tags",
+                );
+                break;
+            };
+
+            inner.insert(tag.table_entry(self.slot));
+            self.tag_ring.push(&tag);
         }
     }
 
@@ -841,12 +1128,12 @@ impl<R: Runtime> Session<R> {
         self.pending_next_key.is_some()
     }
 
-    /// Decrypt `message` using `garlic_tag` which identifies a `TagSetEntry`.
+    /// Decrypt `message` using `tag` which was found from the garlic tag table.
     ///
     /// Retuns the tag set ID and tag index of the decrypted message, along with the message itself.
     pub fn decrypt(
         &mut self,
-        garlic_tag: u64,
+        tag: PendingTag,
         message: Vec<u8>,
         ratchet_threshold: u16,
     ) -> Result<(u16, u16, Vec<u8>), SessionError> {
@@ -854,24 +1141,54 @@ impl<R: Runtime> Session<R> {
             target: LOG_TARGET,
             local = %self.local,
             remote = %self.remote,
-            ?garlic_tag,
+            garlic_tag = ?tag.tag,
             len = ?message.len(),
             "received ES",
         );
+        let garlic_tag = tag.tag;
 
-        // try to find a tag set entry from the tag sets generated for this session
+        // try to find the tag from the lookahead window of the current receive tag set and derive
+        // the session key for it and if the tag is not found there, check if it belongs to one of
+        // the previous tag sets that are about to expire
         //
         // if no entry is found, try to decrypt the message using one of the tags generated for NSR
         // messages in case this is a late and/or retransmitted NSR message received after an ES
         // message was sent
         //
         // if the tag is not found in either set, reject the message and return an error
+        let entry = match self.tag_ring.take(tag.tag_index, garlic_tag) {
+            true => {
+                self.tag_window.register(tag.tag_index);
+
+                // session key must be available since the tag was generated from the current
+                // receive tag set and each tag is consumed only once
+                let entry = self.recv_tag_set.derive_entry(tag).ok_or_else(|| {
+                    tracing::warn!(
+                        target: LOG_TARGET,
+                        local = %self.local,
+                        remote = %self.remote,
+                        ?garlic_tag,
+                        "failed to derive session key for tag",
+                    );
+
+                    debug_assert!(false);
+                    SessionError::InvalidState
+                })?;
+
+                // slide the window forward and generate new tags if needed
+                self.fill_tag_window();
+
+                Some(entry)
+            }
+            false => self.expiring.iter_mut().find_map(|(_, entries)| entries.remove(&garlic_tag)),
+        };
+
         let Some(TagSetEntry {
             key,
             tag,
             tag_index,
             tag_set_id,
-        }) = self.tag_set_entries.remove(&garlic_tag)
+        }) = entry
         else {
             return self.nsr_context.decrypt(garlic_tag, message, ratchet_threshold).map_err(
                 |error| {
@@ -890,22 +1207,6 @@ impl<R: Runtime> Session<R> {
             );
         };
 
-        // generate new tag for the used tag if there are tags left
-        {
-            match self.recv_tag_set.next_entry() {
-                None => tracing::debug!(
-                    target: LOG_TARGET,
-                    local = %self.local,
-                    remote = %self.remote,
-                    "receive tag set ran out of tags",
-                ),
-                Some(entry) => {
-                    self.garlic_tags.write().insert(entry.tag, self.remote.clone());
-                    self.tag_set_entries.insert(entry.tag, entry);
-                }
-            }
-        }
-
         let mut payload = message[12..].to_vec();
         let payload = ChaChaPoly::with_nonce(&key, tag_index as u64)
             .decrypt_with_ad(&tag.to_le_bytes(), &mut payload)
@@ -963,40 +1264,48 @@ impl<R: Runtime> Session<R> {
                                 let mut inner = self.garlic_tags.write();
 
                                 for _ in 0..NUM_EXTRA_TAGS_TO_GENERATE {
-                                    if let Some(entry) = self.recv_tag_set.next_entry() {
-                                        inner.insert(entry.tag, self.remote.clone());
-                                        self.tag_set_entries.insert(entry.tag, entry);
+                                    if let Some(tag) = self.recv_tag_set.next_tag() {
+                                        inner.insert(tag.table_entry(self.slot));
+                                        self.tag_ring.push(&tag);
                                     }
                                 }
 
-                                // collect all tags of the current tag set into a separate storage
-                                // from which they're easy to expire once the tag set they belonged
-                                // to expires
-                                let expiring_tags =
-                                    self.tag_set_entries.keys().copied().collect::<HashSet<_>>();
-                                self.expiring.push_back((R::now(), expiring_tags));
+                                // derive session keys for all outstanding tags of the current tag
+                                // set since the symmetric key chain is lost in the ratchet and move
+                                // them into a separate storage from which they're easy to expire
+                                // once the tag set they belonged to expires
+                                //
+                                // the ring returns tags in tag index order so the key chain is
+                                // advanced without storing intermediate keys
+                                let tag_set_id = self.recv_tag_set.tag_set_id();
+                                let expiring_entries = self
+                                    .tag_ring
+                                    .drain()
+                                    .into_iter()
+                                    .filter_map(|(tag_index, tag)| {
+                                        self.recv_tag_set
+                                            .derive_entry(PendingTag {
+                                                tag,
+                                                tag_index,
+                                                tag_set_id,
+                                            })
+                                            .map(|entry| (entry.tag, entry))
+                                    })
+                                    .collect::<HashMap<_, _>>();
+                                self.expiring.push_back((R::now(), expiring_entries));
                             }
 
                             // handle `NextKey` block which does a DH ratchet and creates a new
                             // `TagSet`, replacing the old one
                             let next_key = self.recv_tag_set.handle_next_key::<R>(kind)?;
 
-                            // generate tag set entries for the new tag set
+                            // generate the lookahead window for the new tag set
                             //
                             // associate `self.remote` with the new tags in the global tag storage
-                            // and store the `TagSetEntry` objects into
-                            // `Session`'s own storage
-                            {
-                                let mut inner = self.garlic_tags.write();
-
-                                // `next_entry()` must succeed as `recv_tag_set` is a fresh `TagSet`
-                                (0..NUM_TAGS_TO_GENERATE).for_each(|_| {
-                                    let entry = self.recv_tag_set.next_entry().expect("to succeed");
-
-                                    inner.insert(entry.tag, self.remote.clone());
-                                    self.tag_set_entries.insert(entry.tag, entry);
-                                });
-                            }
+                            // and store the pending tags into `Session`'s own storage
+                            self.tag_ring = TagRing::new(core::iter::empty(), 0u16);
+                            self.tag_window.reset();
+                            self.fill_tag_window();
 
                             next_key
                         } else {
@@ -1037,6 +1346,8 @@ impl<R: Runtime> Session<R> {
     }
 
     /// Encrypt `message`.
+    ///
+    /// The returned message is prefixed with its length and can be sent as-is.
     pub fn encrypt(
         &mut self,
         mut message_builder: GarlicMessageBuilder,
@@ -1101,16 +1412,20 @@ impl<R: Runtime> Session<R> {
             None => message_builder,
         };
 
-        let mut message = message_builder.build();
-        let mut out = BytesMut::with_capacity(message.len() + GARLIC_MESSAGE_OVERHEAD);
-
-        ChaChaPoly::with_nonce(&key, tag_index as u64)
-            .encrypt_with_ad_new(&tag.to_le_bytes(), &mut message)?;
+        // serialize the garlic message directly into the output buffer, after the length prefix
+        // and garlic tag, and encrypt it in place so the message is allocated exactly once
+        let size = message_builder.serialized_len();
+        let mut out = Vec::with_capacity(4 + GARLIC_MESSAGE_OVERHEAD + size);
 
+        out.put_u32((GARLIC_MESSAGE_OVERHEAD + size) as u32);
         out.put_u64_le(tag);
-        out.put_slice(&message);
+        message_builder.build_into(&mut out);
+
+        let mac = ChaChaPoly::with_nonce(&key, tag_index as u64)
+            .encrypt_with_ad_detached(&tag.to_le_bytes(), &mut out[12..])?;
+        out.put_slice(&mac);
 
-        Ok((tag_set_id, tag_index, out.freeze().to_vec()))
+        Ok((tag_set_id, tag_index, out))
     }
 
     /// Do periodic maintenance for the session.
@@ -1119,7 +1434,7 @@ impl<R: Runtime> Session<R> {
             let mut inner = self.garlic_tags.write();
 
             tags.for_each(|tag| {
-                inner.remove(&tag);
+                inner.remove(tag);
             });
         }
 
@@ -1133,18 +1448,29 @@ impl<R: Runtime> Session<R> {
             }
 
             // entry must exist since it was just checked to exist
-            let (_, tags) = self.expiring.pop_front().expect("to exist");
+            let (_, entries) = self.expiring.pop_front().expect("to exist");
 
-            // remove all expired tags from both the global and local storage
+            // remove all expired tags from the global storage
             {
                 let mut inner = self.garlic_tags.write();
 
-                tags.into_iter().for_each(|tag| {
-                    inner.remove(&tag);
-                    self.tag_set_entries.remove(&tag);
+                entries.keys().for_each(|tag| {
+                    inner.remove(*tag);
                 });
             }
         }
+
+        // remove tags of the current tag set that have fallen too far behind the highest received
+        // tag index as the messages they were generated for are most likely lost, along with any
+        // session keys that were derived for them when the key chain was advanced
+        if let Some(prune_index) = self.tag_window.prune_index() {
+            let mut inner = self.garlic_tags.write();
+
+            self.tag_ring.prune(prune_index).into_iter().for_each(|tag| {
+                inner.remove(tag);
+            });
+            self.recv_tag_set.forget_keys_before(prune_index);
+        }
     }
 
     /// Destroy session and return all active and expiring garlic tags.
@@ -1157,8 +1483,13 @@ impl<R: Runtime> Session<R> {
         );
         let mut inner = self.garlic_tags.write();
 
-        self.tag_set_entries.keys().for_each(|tag| {
+        self.tag_ring.tags().chain(self.nsr_context.tags()).for_each(|tag| {
             inner.remove(tag);
         });
+        self.expiring.iter().for_each(|(_, entries)| {
+            entries.keys().for_each(|tag| {
+                inner.remove(*tag);
+            });
+        });
     }
 }
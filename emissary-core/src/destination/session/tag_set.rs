@@ -17,14 +17,20 @@
 // DEALINGS IN THE SOFTWARE.
 
 use crate::{
-    crypto::{hmac::Hmac, StaticPrivateKey, StaticPublicKey},
-    destination::session::LOG_TARGET,
+    crypto::{
+        hmac::{hkdf, Hmac},
+        StaticPrivateKey, StaticPublicKey,
+    },
+    destination::session::{
+        tag_table::{SessionSlot, TagTableEntry},
+        LOG_TARGET,
+    },
     error::SessionError,
     i2np::garlic::{NextKeyBuilder, NextKeyKind},
     runtime::Runtime,
 };
 
-use bytes::{Bytes, BytesMut};
+use hashbrown::HashMap;
 use zeroize::Zeroize;
 
 use alloc::vec::Vec;
@@ -141,59 +147,41 @@ impl fmt::Debug for KeyState {
 }
 
 /// Key context for a [`TagSet`].
+///
+/// All chain keys are fixed-size and stored inline so ratcheting the session tag and symmetric key
+/// chains doesn't allocate.
 struct KeyContext {
     /// Next root key.
-    next_root_key: Bytes,
+    next_root_key: [u8; 32],
 
     /// Session key data.
-    session_key_data: Bytes,
+    session_key_data: [u8; 32],
 
     /// Session key constant.
-    session_tag_constant: Vec<u8>,
+    session_tag_constant: [u8; 32],
 
     /// Session tag key.
     #[allow(unused)]
-    session_tag_key: Vec<u8>,
+    session_tag_key: [u8; 32],
 
     /// Symmetric key.
-    symmetric_key: Vec<u8>,
+    symmetric_key: [u8; 32],
 }
 
 impl KeyContext {
     /// Create new [`KeyContext`] for a [`TagSet`].
     pub fn new(root_key: impl AsRef<[u8]>, tag_set_key: impl AsRef<[u8]>) -> Self {
-        let temp_key = Hmac::new(root_key.as_ref()).update(tag_set_key.as_ref()).finalize();
-        let next_root_key =
-            Hmac::new(&temp_key).update(b"KDFDHRatchetStep").update([0x01]).finalize();
-        let ratchet_key = Hmac::new(&temp_key)
-            .update(&next_root_key)
-            .update(b"KDFDHRatchetStep")
-            .update([0x02])
-            .finalize();
-
-        let temp_key = Hmac::new(&ratchet_key).update([]).finalize();
-        let session_tag_key =
-            Hmac::new(&temp_key).update(b"TagAndKeyGenKeys").update([0x01]).finalize();
-        let symmetric_key = Hmac::new(&temp_key)
-            .update(&session_tag_key)
-            .update(b"TagAndKeyGenKeys")
-            .update([0x02])
-            .finalize();
-
-        let mut temp_key = Hmac::new(&session_tag_key).update([]).finalize();
-        let session_key_data =
-            Hmac::new(&temp_key).update(b"STInitialization").update([0x01]).finalize();
-        let session_tag_constant = Hmac::new(&temp_key)
-            .update(&session_key_data)
-            .update(b"STInitialization")
-            .update([0x02])
-            .finalize();
-
-        temp_key.zeroize();
+        let (next_root_key, mut ratchet_key) =
+            hkdf(root_key.as_ref(), tag_set_key.as_ref(), b"KDFDHRatchetStep");
+        let (session_tag_key, symmetric_key) = hkdf(&ratchet_key, &[], b"TagAndKeyGenKeys");
+        let (session_key_data, session_tag_constant) =
+            hkdf(&session_tag_key, &[], b"STInitialization");
+
+        ratchet_key.zeroize();
 
         Self {
-            next_root_key: Bytes::from(next_root_key),
-            session_key_data: Bytes::from(session_key_data),
+            next_root_key,
+            session_key_data,
             session_tag_constant,
             session_tag_key,
             symmetric_key,
@@ -205,7 +193,7 @@ impl KeyContext {
 #[derive(Debug, PartialEq, Eq)]
 pub struct TagSetEntry {
     /// Session key.
-    pub key: Bytes,
+    pub key: [u8; 32],
 
     /// Session tag.
     pub tag: u64,
@@ -217,6 +205,57 @@ pub struct TagSetEntry {
     pub tag_set_id: u16,
 }
 
+/// Session tag whose session key hasn't been derived yet.
+///
+/// Receive tag sets only generate session tags for the lookahead window of the session and the
+/// session key for a tag is derived with [`TagSet::session_key()`] once a message with that tag
+/// has actually been received.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct PendingTag {
+    /// Session tag.
+    pub tag: u64,
+
+    /// Tag Index.
+    pub tag_index: u16,
+
+    /// Tag set ID.
+    pub tag_set_id: u16,
+}
+
+impl PendingTag {
+    /// Create [`TagTableEntry`] for the tag, owned by the session in `slot`.
+    pub fn table_entry(&self, slot: SessionSlot) -> TagTableEntry {
+        TagTableEntry {
+            tag: self.tag,
+            slot,
+            tag_index: self.tag_index,
+            tag_set_id: self.tag_set_id,
+        }
+    }
+}
+
+impl From<TagTableEntry> for PendingTag {
+    fn from(entry: TagTableEntry) -> Self {
+        Self {
+            tag: entry.tag,
+            tag_index: entry.tag_index,
+            tag_set_id: entry.tag_set_id,
+        }
+    }
+}
+
+impl TagSetEntry {
+    /// Create [`TagTableEntry`] for the tag, owned by the session in `slot`.
+    pub fn table_entry(&self, slot: SessionSlot) -> TagTableEntry {
+        TagTableEntry {
+            tag: self.tag,
+            slot,
+            tag_index: self.tag_index,
+            tag_set_id: self.tag_set_id,
+        }
+    }
+}
+
 /// Tag set.
 ///
 /// https://geti2p.net/spec/ecies#sample-implementation
@@ -242,6 +281,16 @@ pub struct TagSet {
     /// Next tag index.
     tag_index: u16,
 
+    /// Index of the next session key in the symmetric key chain.
+    ///
+    /// Lags behind `tag_index` for receive tag sets as session keys are derived only when a tag is
+    /// matched.
+    key_index: u16,
+
+    /// Session keys that were derived when the symmetric key chain was advanced past tags which
+    /// haven't been received yet, i.e., messages that were lost or received out of order.
+    skipped_keys: HashMap<u16, [u8; 32]>,
+
     /// ID of the tag set.
     tag_set_id: u16,
 
@@ -266,14 +315,37 @@ impl TagSet {
             send_key_id: None,
             tag_set_id: 0u16,
             tag_index: 0u16,
+            key_index: 0u16,
+            skipped_keys: HashMap::new(),
             ratchet_threshold,
         }
     }
 
+    /// Get ID of the [`TagSet`].
+    pub fn tag_set_id(&self) -> u16 {
+        self.tag_set_id
+    }
+
+    /// Get index of the next tag generated from the [`TagSet`].
+    pub fn next_tag_index(&self) -> u16 {
+        self.tag_index
+    }
+
     /// Get next [`TagSetEntry`].
     ///
     /// Returns `None` if all tags have been used.
     pub fn next_entry(&mut self) -> Option<TagSetEntry> {
+        let tag = self.next_tag()?;
+
+        // the session key must exist since the tag was just generated and keys are never derived
+        // ahead of their tags
+        self.derive_entry(tag)
+    }
+
+    /// Get next session tag without deriving the session key for it.
+    ///
+    /// Returns `None` if all tags have been used.
+    pub fn next_tag(&mut self) -> Option<PendingTag> {
         let tag_index = {
             let tag_index = self.tag_index;
             self.tag_index = self.tag_index.checked_add(1)?;
@@ -281,56 +353,85 @@ impl TagSet {
             tag_index
         };
 
-        // ratchet next tag
-        let garlic_tag = {
-            let mut temp_key = Hmac::new(&self.key_context.session_key_data)
-                .update(&self.key_context.session_tag_constant)
-                .finalize();
+        // ratchet next tag and store session key data for the next session tag ratchet
+        let (session_key_data, mut session_tag_key_data) = hkdf(
+            &self.key_context.session_key_data,
+            &self.key_context.session_tag_constant,
+            b"SessionTagKeyGen",
+        );
+        self.key_context.session_key_data = session_key_data;
 
-            // store session key data for the next session tag ratchet
-            self.key_context.session_key_data = Bytes::from(
-                Hmac::new(&temp_key).update(b"SessionTagKeyGen").update([0x01]).finalize(),
-            );
+        let tag = u64::from_le_bytes(
+            TryInto::<[u8; 8]>::try_into(&session_tag_key_data[..8]).expect("to succeed"),
+        );
+        session_tag_key_data.zeroize();
 
-            let session_tag_key_data = Hmac::new(&temp_key)
-                .update(&self.key_context.session_key_data)
-                .update(b"SessionTagKeyGen")
-                .update([0x02])
-                .finalize();
+        Some(PendingTag {
+            tag_index,
+            tag_set_id: self.tag_set_id,
+            tag,
+        })
+    }
 
-            temp_key.zeroize();
+    /// Ratchet the symmetric key chain once and return the session key.
+    fn next_session_key(&mut self) -> [u8; 32] {
+        // store symmetric key for the next key ratchet
+        let (symmetric_key, session_key) =
+            hkdf(&self.key_context.symmetric_key, &[], b"SymmetricRatchet");
+        self.key_context.symmetric_key = symmetric_key;
 
-            BytesMut::from(&session_tag_key_data[0..8]).freeze()
-        };
+        session_key
+    }
 
-        let symmetric_key = {
-            let mut temp_key = Hmac::new(&self.key_context.symmetric_key).update([]).finalize();
+    /// Get session key for `tag_index`.
+    ///
+    /// The symmetric key chain is advanced up to `tag_index` and the keys of any tags that were
+    /// skipped over are stored so that messages received out of order can still be decrypted.
+    ///
+    /// Returns `None` if the tag hasn't been generated or its key has already been consumed.
+    pub fn session_key(&mut self, tag_index: u16) -> Option<[u8; 32]> {
+        if tag_index >= self.tag_index {
+            return None;
+        }
 
-            // store symmetric key for the next key ratchet
-            self.key_context.symmetric_key =
-                Hmac::new(&temp_key).update("SymmetricRatchet").update([0x01]).finalize();
+        if tag_index < self.key_index {
+            return self.skipped_keys.remove(&tag_index);
+        }
 
-            let symmetric_key = Hmac::new(&temp_key)
-                .update(&self.key_context.symmetric_key)
-                .update(b"SymmetricRatchet")
-                .update([0x02])
-                .finalize();
+        while self.key_index < tag_index {
+            let key = self.next_session_key();
 
-            temp_key.zeroize();
+            self.skipped_keys.insert(self.key_index, key);
+            self.key_index += 1;
+        }
 
-            BytesMut::from(&symmetric_key[..]).freeze()
-        };
+        // cannot overflow since `key_index` <= `tag_index` < `self.tag_index`
+        self.key_index += 1;
+        Some(self.next_session_key())
+    }
+
+    /// Derive session key for `tag` and return it as a [`TagSetEntry`].
+    ///
+    /// Returns `None` if `tag` doesn't belong to the current tag set or if its key has already been
+    /// consumed.
+    pub fn derive_entry(&mut self, tag: PendingTag) -> Option<TagSetEntry> {
+        if tag.tag_set_id != self.tag_set_id {
+            return None;
+        }
 
         Some(TagSetEntry {
-            tag_index,
-            tag_set_id: self.tag_set_id,
-            key: symmetric_key,
-            tag: u64::from_le_bytes(
-                TryInto::<[u8; 8]>::try_into(garlic_tag.as_ref()).expect("to succeed"),
-            ),
+            key: self.session_key(tag.tag_index)?,
+            tag: tag.tag,
+            tag_index: tag.tag_index,
+            tag_set_id: tag.tag_set_id,
         })
     }
 
+    /// Forget session keys of skipped tags which have index lower than `tag_index`.
+    pub fn forget_keys_before(&mut self, tag_index: u16) {
+        self.skipped_keys.retain(|index, _| *index >= tag_index);
+    }
+
     /// Reinitialize [`TagSet`] by performing a DH ratchet
     ///
     /// Do DH key exchange between `private_key` and `public_key` to generate a new tag set key
@@ -347,9 +448,9 @@ impl TagSet {
     ) {
         let tag_set_key = {
             let mut shared = private_key.diffie_hellman(&public_key);
-            let mut temp_key = Hmac::new(&shared).update([]).finalize();
+            let mut temp_key = Hmac::new(&shared).update([]).finalize_new();
             let tagset_key =
-                Hmac::new(&temp_key).update(b"XDHRatchetTagSet").update([0x01]).finalize();
+                Hmac::new(&temp_key).update(b"XDHRatchetTagSet").update([0x01]).finalize_new();
 
             shared.zeroize();
             temp_key.zeroize();
@@ -359,7 +460,7 @@ impl TagSet {
 
         // perform a dh ratchet and reset `TagSet`'s state
         {
-            self.key_context = KeyContext::new(self.key_context.next_root_key.clone(), tag_set_key);
+            self.key_context = KeyContext::new(self.key_context.next_root_key, tag_set_key);
 
             // tag set id is calculated as `1 + send key id + receive key id`
             //
@@ -373,8 +474,9 @@ impl TagSet {
             };
 
             // for the new tag set, tag numbers start again from zero
-            // and progress towards `NUM_TAGS_TO_GENERATE`
             self.tag_index = 0u16;
+            self.key_index = 0u16;
+            self.skipped_keys.clear();
         }
     }
 
@@ -825,6 +927,57 @@ mod tests {
         assert_eq!(tags.len(), MAX_TAGS);
     }
 
+    #[test]
+    fn lazily_derived_keys_match() {
+        let mut eager = TagSet::new([1u8; 32], [2u8; 32], TEST_THRESHOLD);
+        let mut lazy = TagSet::new([1u8; 32], [2u8; 32], TEST_THRESHOLD);
+
+        let entries = (0..64).map(|_| eager.next_entry().unwrap()).collect::<Vec<_>>();
+        let tags = (0..64).map(|_| lazy.next_tag().unwrap()).collect::<Vec<_>>();
+
+        // derive keys out of order, skipping over some of the tags first
+        for index in [5usize, 1, 63, 0, 2, 40] {
+            assert_eq!(lazy.derive_entry(tags[index]).unwrap(), entries[index]);
+        }
+
+        // keys can only be consumed once
+        assert!(lazy.derive_entry(tags[5]).is_none());
+        assert!(lazy.session_key(0).is_none());
+
+        // keys for tags that haven't been generated can't be derived
+        assert!(lazy.session_key(64).is_none());
+
+        // forget old skipped keys
+        lazy.forget_keys_before(30);
+        assert!(lazy.session_key(3).is_none());
+        assert_eq!(lazy.derive_entry(tags[35]).unwrap(), entries[35]);
+    }
+
+    // microbenchmark for tag and session key derivation of a single core, run with:
+    // `cargo test --release tag_generation_throughput -- --ignored --nocapture`
+    #[test]
+    #[ignore]
+    fn tag_generation_throughput() {
+        const NUM_TAGS: usize = 60_000;
+        const MIN_TAGS_PER_SECOND: f64 = 50_000f64;
+
+        let mut tag_set = TagSet::new([1u8; 32], [2u8; 32], TEST_THRESHOLD);
+        let started = std::time::Instant::now();
+
+        for _ in 0..NUM_TAGS {
+            core::hint::black_box(tag_set.next_entry().unwrap());
+        }
+
+        let elapsed = started.elapsed();
+        let tags_per_second = NUM_TAGS as f64 / elapsed.as_secs_f64();
+
+        println!("generated {NUM_TAGS} tags in {elapsed:?} ({tags_per_second:.0} tags/s)");
+        assert!(
+            tags_per_second >= MIN_TAGS_PER_SECOND,
+            "{tags_per_second:.0} tags/s, expected at least {MIN_TAGS_PER_SECOND}",
+        );
+    }
+
     #[test]
     fn full_dh_ratchet_cycle() {
         let mut send_tag_set = TagSet::new([1u8; 32], [2u8; 32], TEST_THRESHOLD);
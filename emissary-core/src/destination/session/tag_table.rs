@@ -0,0 +1,242 @@
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//! Garlic tag table.
+//!
+//! Garlic tags are outputs of HMAC-SHA256 and are therefore uniformly distributed, meaning they can
+//! be used directly as the hash of the table entry. The table is a `hashbrown` map with an identity
+//! hasher, so a lookup costs a single probe into the swiss table without hashing the tag again.
+//!
+//! Each entry maps a garlic tag to the [`SessionSlot`] of the session that owns the tag and to the
+//! tag's index in the tag set, allowing the owning session to locate the tag without a second hash
+//! table lookup.
+
+use hashbrown::HashMap;
+
+use core::hash::{BuildHasherDefault, Hasher};
+
+/// Compact ID of a session owned by a `SessionManager`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct SessionSlot(u32);
+
+impl SessionSlot {
+    /// Create new [`SessionSlot`] from `index`.
+    pub fn new(index: u32) -> Self {
+        Self(index)
+    }
+
+    /// Get index of the slot.
+    pub fn index(&self) -> usize {
+        self.0 as usize
+    }
+}
+
+/// Tag table entry.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct TagTableEntry {
+    /// Garlic tag.
+    pub tag: u64,
+
+    /// Slot of the session which owns the tag.
+    pub slot: SessionSlot,
+
+    /// Index of the tag in its tag set.
+    pub tag_index: u16,
+
+    /// ID of the tag set.
+    pub tag_set_id: u16,
+}
+
+/// Value stored in the table for a garlic tag.
+#[derive(Clone, Copy)]
+struct TagValue {
+    /// Slot of the session which owns the tag.
+    slot: SessionSlot,
+
+    /// Index of the tag in its tag set.
+    tag_index: u16,
+
+    /// ID of the tag set.
+    tag_set_id: u16,
+}
+
+impl TagValue {
+    /// Convert [`TagValue`] of `tag` into [`TagTableEntry`].
+    fn into_entry(self, tag: u64) -> TagTableEntry {
+        TagTableEntry {
+            tag,
+            slot: self.slot,
+            tag_index: self.tag_index,
+            tag_set_id: self.tag_set_id,
+        }
+    }
+}
+
+/// Identity hasher for garlic tags.
+///
+/// Only `u64` keys are hashed with [`TagHasher`] and since they're already uniformly distributed,
+/// the tag itself is used as the hash.
+#[derive(Default)]
+struct TagHasher(u64);
+
+impl Hasher for TagHasher {
+    fn finish(&self) -> u64 {
+        self.0
+    }
+
+    fn write(&mut self, bytes: &[u8]) {
+        // not called for `u64` keys but implemented for completeness
+        bytes.iter().for_each(|byte| {
+            self.0 = self.0.rotate_left(8) ^ *byte as u64;
+        });
+    }
+
+    fn write_u64(&mut self, tag: u64) {
+        self.0 = tag;
+    }
+}
+
+/// Garlic tag table.
+#[derive(Default)]
+pub struct TagTable {
+    /// Garlic tag -> tag value mapping.
+    tags: HashMap<u64, TagValue, BuildHasherDefault<TagHasher>>,
+}
+
+impl TagTable {
+    /// Create new [`TagTable`] with space for at least `capacity` entries.
+    #[cfg(test)]
+    pub fn with_capacity(capacity: usize) -> Self {
+        Self {
+            tags: HashMap::with_capacity_and_hasher(capacity, Default::default()),
+        }
+    }
+
+    /// Get number of entries in the table.
+    #[cfg(test)]
+    pub fn len(&self) -> usize {
+        self.tags.len()
+    }
+
+    /// Get entry for `tag`.
+    pub fn get(&self, tag: u64) -> Option<TagTableEntry> {
+        self.tags.get(&tag).map(|value| value.into_entry(tag))
+    }
+
+    /// Insert `entry` into the table.
+    ///
+    /// Returns the previous entry of the tag, if it existed.
+    pub fn insert(&mut self, entry: TagTableEntry) -> Option<TagTableEntry> {
+        self.tags
+            .insert(
+                entry.tag,
+                TagValue {
+                    slot: entry.slot,
+                    tag_index: entry.tag_index,
+                    tag_set_id: entry.tag_set_id,
+                },
+            )
+            .map(|value| value.into_entry(entry.tag))
+    }
+
+    /// Remove `tag` from the table.
+    pub fn remove(&mut self, tag: u64) -> Option<TagTableEntry> {
+        self.tags.remove(&tag).map(|value| value.into_entry(tag))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::runtime::{mock::MockRuntime, Runtime};
+    use hashbrown::HashMap;
+    use rand_core::RngCore;
+
+    fn entry(tag: u64, index: u32) -> TagTableEntry {
+        TagTableEntry {
+            tag,
+            slot: SessionSlot::new(index),
+            tag_index: index as u16,
+            tag_set_id: 0u16,
+        }
+    }
+
+    #[test]
+    fn insert_get_remove() {
+        let mut table = TagTable::default();
+        let tags = (0..10_000).map(|_| MockRuntime::rng().next_u64()).collect::<Vec<_>>();
+
+        tags.iter().enumerate().for_each(|(i, tag)| {
+            assert!(table.insert(entry(*tag, i as u32)).is_none());
+        });
+        assert_eq!(table.len(), tags.len());
+
+        tags.iter().enumerate().for_each(|(i, tag)| {
+            assert_eq!(table.get(*tag), Some(entry(*tag, i as u32)));
+        });
+
+        // remove every other tag
+        tags.iter().enumerate().step_by(2).for_each(|(i, tag)| {
+            assert_eq!(table.remove(*tag), Some(entry(*tag, i as u32)));
+        });
+        assert_eq!(table.len(), tags.len() / 2);
+
+        tags.iter().enumerate().for_each(|(i, tag)| match i % 2 == 0 {
+            true => assert!(table.get(*tag).is_none()),
+            false => assert_eq!(table.get(*tag), Some(entry(*tag, i as u32))),
+        });
+    }
+
+    #[test]
+    fn overwrite_existing() {
+        let mut table = TagTable::default();
+
+        assert!(table.insert(entry(1337, 1)).is_none());
+        assert_eq!(table.insert(entry(1337, 2)), Some(entry(1337, 1)));
+        assert_eq!(table.get(1337), Some(entry(1337, 2)));
+        assert_eq!(table.len(), 1);
+    }
+
+    #[test]
+    fn sliding_window_churn() {
+        let mut table = TagTable::with_capacity(256);
+        let mut reference = HashMap::<u64, TagTableEntry>::new();
+        let mut window = alloc::collections::VecDeque::new();
+
+        // keep a constant number of tags in the table while continuously inserting new tags and
+        // removing old ones
+        for i in 0..100_000u32 {
+            let tag = MockRuntime::rng().next_u64();
+
+            table.insert(entry(tag, i));
+            reference.insert(tag, entry(tag, i));
+            window.push_back(tag);
+
+            if window.len() > 200 {
+                let tag = window.pop_front().unwrap();
+
+                assert_eq!(table.remove(tag), reference.remove(&tag));
+            }
+        }
+
+        assert_eq!(table.len(), reference.len());
+        reference.iter().for_each(|(tag, entry)| {
+            assert_eq!(table.get(*tag), Some(*entry));
+        });
+    }
+}
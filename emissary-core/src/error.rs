@@ -95,6 +95,12 @@ pub enum SessionError {
 
     /// New session message has an invalid timestamp
     Timestamp,
+
+    /// New session message is a replay of an already-processed message.
+    Replay,
+
+    /// New session message was dropped because the destination is overloaded.
+    Overloaded,
 }
 
 impl fmt::Display for SessionError {
@@ -107,6 +113,8 @@ impl fmt::Display for SessionError {
             Self::InvalidState => write!(f, "invalid state"),
             Self::InvalidKey => write!(f, "invalid key"),
             Self::Timestamp => write!(f, "excess message timestamp skew"),
+            Self::Replay => write!(f, "replayed new session message"),
+            Self::Overloaded => write!(f, "too many new session messages"),
         }
     }
 }
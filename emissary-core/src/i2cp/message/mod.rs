@@ -162,7 +162,13 @@ pub enum MessageType {
     ReceiveMessageBegin,
 
     /// Inform router that a message was delivered successfully.
-    ReceiveMessageEnd,
+    ReceiveMessageEnd {
+        /// Session ID.
+        session_id: SessionId,
+
+        /// Message ID.
+        message_id: u32,
+    },
 
     /// Reconfigure session.
     ReconfigureSession,
@@ -458,6 +464,21 @@ impl Message {
         })
     }
 
+    /// Attempt to parse [`Message::ReceiveMessageEnd`] from `input`.
+    ///
+    /// https://geti2p.net/spec/i2cp#receivemessageendmessage
+    fn parse_receive_message_end(input: impl AsRef<[u8]>) -> Option<Self> {
+        let (rest, session_id) = be_u16::<_, ()>(input.as_ref()).ok()?;
+        let (rest, message_id) = be_u32::<_, ()>(rest).ok()?;
+
+        debug_assert!(rest.is_empty());
+
+        Some(Message::ReceiveMessageEnd {
+            session_id: SessionId::from(session_id),
+            message_id,
+        })
+    }
+
     /// Attempt to parse [`Message::CreateSession`] from `input`.
     ///
     /// https://geti2p.net/spec/i2cp#createsessionmessage
@@ -669,6 +690,7 @@ impl Message {
             MessageType::HostLookup => Self::parse_host_lookup(input),
             MessageType::CreateLeaseSet2 => Self::parse_create_leaseset2(input),
             MessageType::SendMessageExpires => Self::parse_send_message_expires(input),
+            MessageType::ReceiveMessageEnd => Self::parse_receive_message_end(input),
             msg_type => {
                 tracing::warn!(
                     target: LOG_TARGET,
@@ -725,4 +747,17 @@ mod tests {
 
         assert!(Message::parse(MessageType::CreateLeaseSet2, &message).is_some());
     }
+
+    #[test]
+    fn parse_receive_message_end() {
+        match Message::parse(MessageType::ReceiveMessageEnd, [0, 1, 0, 0, 0x05, 0x39]) {
+            Some(Message::ReceiveMessageEnd {
+                session_id: SessionId::Session(1),
+                message_id: 1337,
+            }) => {}
+            _ => panic!("invalid message"),
+        }
+
+        assert!(Message::parse(MessageType::ReceiveMessageEnd, [0, 1, 0]).is_none());
+    }
 }
@@ -25,11 +25,11 @@ use crate::{
     i2cp::{
         pending::{I2cpSessionContext, PendingI2cpSession},
         session::I2cpSession,
-        socket::I2cpSocket,
+        socket::{I2cpSocket, I2cpStream},
     },
     netdb::NetDbHandle,
     profile::ProfileStorage,
-    runtime::{AddressBook, JoinSet, Runtime, TcpListener},
+    runtime::{AddressBook, JoinSet, Runtime, TcpListener, UnixListener},
     tunnel::TunnelManagerHandle,
     util::AsyncReadExt,
 };
@@ -62,6 +62,9 @@ const I2CP_PROTOCOL_BYTE: u8 = 0x2a;
 ///
 /// Listens to incoming I2CP streams and dispatches them to a separate event loop
 /// after the I2CP protocol byte has been received.
+///
+/// Clients are accepted over TCP and, if configured, over a Unix domain socket which lets
+/// co-located applications bypass the TCP loopback stack.
 pub struct I2cpServer<R: Runtime> {
     /// Address book,
     address_book: Option<Arc<dyn AddressBook>>,
@@ -69,6 +72,9 @@ pub struct I2cpServer<R: Runtime> {
     /// TCP listener.
     listener: R::TcpListener,
 
+    /// Metrics handle.
+    metrics: R::MetricsHandle,
+
     /// Handle to `NetDb`.
     netdb_handle: NetDbHandle,
 
@@ -76,7 +82,7 @@ pub struct I2cpServer<R: Runtime> {
     next_session_id: u16,
 
     /// Pending connections.
-    pending_connections: R::JoinSet<crate::Result<R::TcpStream>>,
+    pending_connections: R::JoinSet<crate::Result<I2cpStream<R>>>,
 
     /// Pending sessions.
     pending_session: R::JoinSet<Option<I2cpSessionContext<R>>>,
@@ -86,6 +92,9 @@ pub struct I2cpServer<R: Runtime> {
 
     /// Handle to `TunnelManager`.
     tunnel_manager_handle: TunnelManagerHandle,
+
+    /// Unix domain socket listener, if enabled.
+    unix_listener: Option<R::UnixListener>,
 }
 
 impl<R: Runtime> I2cpServer<R> {
@@ -93,8 +102,10 @@ impl<R: Runtime> I2cpServer<R> {
     pub async fn new(
         host: String,
         port: u16,
+        unix_socket: Option<String>,
         netdb_handle: NetDbHandle,
         tunnel_manager_handle: TunnelManagerHandle,
+        metrics: R::MetricsHandle,
         address_book: Option<Arc<dyn AddressBook>>,
         profile_storage: ProfileStorage<R>,
     ) -> crate::Result<Self> {
@@ -109,15 +120,34 @@ impl<R: Runtime> I2cpServer<R> {
             .await
             .ok_or(Error::Connection(ConnectionError::BindFailure))?;
 
+        let unix_listener = match unix_socket {
+            None => None,
+            Some(path) => {
+                tracing::info!(
+                    target: LOG_TARGET,
+                    %path,
+                    "starting i2cp server on unix domain socket",
+                );
+
+                Some(
+                    R::UnixListener::bind(&path)
+                        .await
+                        .ok_or(Error::Connection(ConnectionError::BindFailure))?,
+                )
+            }
+        };
+
         Ok(Self {
             address_book,
             listener,
+            metrics,
             netdb_handle,
             next_session_id: 1u16,
             pending_connections: R::join_set(),
             pending_session: R::join_set(),
             profile_storage,
             tunnel_manager_handle,
+            unix_listener,
         })
     }
 
@@ -128,6 +158,31 @@ impl<R: Runtime> I2cpServer<R> {
 
         session_id
     }
+
+    /// Handle inbound connection.
+    ///
+    /// Complete handshake for the i2cp client session in the background by polling the connection
+    /// until the protocol byte is received and comparing it against the expected protocol byte.
+    fn on_inbound_connection(&mut self, mut stream: I2cpStream<R>) {
+        tracing::trace!(
+            target: LOG_TARGET,
+            "incoming connection, read protocol byte",
+        );
+
+        self.pending_connections.push(async move {
+            let mut protocol_byte = vec![0u8; 1];
+
+            stream.read_exact::<R>(&mut protocol_byte).await?;
+
+            if protocol_byte[0] != I2CP_PROTOCOL_BYTE {
+                return Err(Error::I2cp(I2cpError::InvalidProtocolByte(
+                    protocol_byte[0],
+                )));
+            }
+
+            Ok(stream)
+        });
+    }
 }
 
 impl<R: Runtime> Future for I2cpServer<R> {
@@ -145,29 +200,27 @@ impl<R: Runtime> Future for I2cpServer<R> {
 
                     return Poll::Ready(());
                 }
-                Poll::Ready(Some((mut stream, _))) => {
-                    tracing::trace!(
-                        target: LOG_TARGET,
-                        "incoming connection, read protocol byte",
-                    );
-
-                    // complete handshake for the i2cp client session in the background by polling
-                    // the connection until the protocol byte is received and comparing it against
-                    // the expected protocol byte
-                    self.pending_connections.push(async move {
-                        let mut protocol_byte = vec![0u8; 1];
+                Poll::Ready(Some((stream, _))) =>
+                    self.on_inbound_connection(I2cpStream::Tcp(stream)),
+            }
+        }
 
-                        stream.read_exact::<R>(&mut protocol_byte).await?;
+        loop {
+            let Some(listener) = self.unix_listener.as_mut() else {
+                break;
+            };
 
-                        if protocol_byte[0] != I2CP_PROTOCOL_BYTE {
-                            return Err(Error::I2cp(I2cpError::InvalidProtocolByte(
-                                protocol_byte[0],
-                            )));
-                        }
+            match listener.poll_accept(cx) {
+                Poll::Pending => break,
+                Poll::Ready(None) => {
+                    tracing::error!(
+                        target: LOG_TARGET,
+                        "ready `None` from i2cp unix domain socket",
+                    );
 
-                        Ok(stream)
-                    });
+                    return Poll::Ready(());
                 }
+                Poll::Ready(Some(stream)) => self.on_inbound_connection(I2cpStream::Unix(stream)),
             }
         }
 
@@ -221,7 +274,11 @@ impl<R: Runtime> Future for I2cpServer<R> {
                         "start active i2cp connection",
                     );
 
-                    R::spawn(I2cpSession::<R>::new(self.netdb_handle.clone(), context));
+                    R::spawn(I2cpSession::<R>::new(
+                        self.netdb_handle.clone(),
+                        self.metrics.clone(),
+                        context,
+                    ));
                 }
             }
         }
@@ -229,3 +286,81 @@ impl<R: Runtime> Future for I2cpServer<R> {
         Poll::Pending
     }
 }
+
+#[cfg(all(test, unix))]
+mod tests {
+    use super::*;
+    use crate::runtime::mock::MockRuntime;
+    use core::time::Duration;
+    use tokio::{io::AsyncWriteExt, net::UnixStream};
+
+    fn socket_path() -> String {
+        std::env::temp_dir()
+            .join(format!("emissary-i2cp-{}.sock", rand::random::<u64>()))
+            .to_str()
+            .unwrap()
+            .to_string()
+    }
+
+    async fn make_server(path: &str) -> crate::Result<I2cpServer<MockRuntime>> {
+        let (netdb_handle, _) = NetDbHandle::create();
+        let (tunnel_manager_handle, _) = TunnelManagerHandle::create();
+
+        I2cpServer::<MockRuntime>::new(
+            "127.0.0.1".to_string(),
+            0u16,
+            Some(path.to_string()),
+            netdb_handle,
+            tunnel_manager_handle,
+            MockRuntime::register_metrics(Vec::new(), None),
+            None,
+            ProfileStorage::new(&[], &[]),
+        )
+        .await
+    }
+
+    #[tokio::test]
+    async fn unix_socket_client_accepted() {
+        let path = socket_path();
+        let mut server = make_server(&path).await.unwrap();
+
+        let mut client = UnixStream::connect(&path).await.unwrap();
+        client.write_all(&[I2CP_PROTOCOL_BYTE]).await.unwrap();
+
+        // protocol byte is read and the connection is handed off to a pending session
+        tokio::time::timeout(Duration::from_secs(1), &mut server).await.unwrap_err();
+        assert!(server.pending_connections.is_empty());
+        assert_eq!(server.pending_session.len(), 1);
+
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[tokio::test]
+    async fn unix_socket_client_with_invalid_protocol_byte_rejected() {
+        let path = socket_path();
+        let mut server = make_server(&path).await.unwrap();
+
+        let mut client = UnixStream::connect(&path).await.unwrap();
+        client.write_all(&[0x00]).await.unwrap();
+
+        tokio::time::timeout(Duration::from_secs(1), &mut server).await.unwrap_err();
+        assert!(server.pending_connections.is_empty());
+        assert!(server.pending_session.is_empty());
+
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[tokio::test]
+    async fn unix_socket_bind_failure_is_reported() {
+        let path = socket_path();
+        std::fs::write(&path, b"hello, world").unwrap();
+
+        assert!(std::matches!(
+            make_server(&path).await,
+            Err(Error::Connection(ConnectionError::BindFailure))
+        ));
+        assert_eq!(std::fs::read(&path).unwrap(), b"hello, world");
+
+        let _ = std::fs::remove_file(&path);
+    }
+}
@@ -97,7 +97,11 @@ pub struct I2cpSession<R: Runtime> {
 
 impl<R: Runtime> I2cpSession<R> {
     /// Create new [`I2cpSession`] from `stream`.
-    pub fn new(netdb_handle: NetDbHandle, context: I2cpSessionContext<R>) -> Self {
+    pub fn new(
+        netdb_handle: NetDbHandle,
+        metrics: R::MetricsHandle,
+        context: I2cpSessionContext<R>,
+    ) -> Self {
         let I2cpSessionContext {
             address_book,
             destination_id,
@@ -125,6 +129,20 @@ impl<R: Runtime> I2cpSession<R> {
             tracing::info!("{key}={value}");
         }
 
+        // `MessagePayload`s are pushed to the client as soon as they're received, without
+        // announcing them first with `MessageStatus` and waiting for `ReceiveMessageBegin`
+        if !options
+            .get(&Str::from("i2cp.fastReceive"))
+            .map(|value| value.parse::<bool>().unwrap_or(false))
+            .unwrap_or(false)
+        {
+            tracing::debug!(
+                target: LOG_TARGET,
+                ?session_id,
+                "client didn't enable fast receive, delivering messages without acknowledgements",
+            );
+        }
+
         let mut destination = Destination::new(
             destination_id.clone(),
             private_keys[0].clone(),
@@ -138,6 +156,7 @@ impl<R: Runtime> I2cpSession<R> {
                 .map(|value| value.parse::<bool>().unwrap_or(true))
                 .unwrap_or(true),
             profile_storage,
+            metrics,
         );
         destination.publish_lease_set(leaseset);
 
@@ -401,6 +420,19 @@ impl<R: Runtime> I2cpSession<R> {
                     }
                 }
             }
+            Message::ReceiveMessageEnd {
+                session_id,
+                message_id,
+            } => {
+                // messages are always delivered in fast receive mode and acknowledgements sent by
+                // clients which didn't enable it are not waited on
+                tracing::trace!(
+                    target: LOG_TARGET,
+                    ?session_id,
+                    ?message_id,
+                    "message acknowledged by client",
+                );
+            }
             _ => {}
         }
     }
@@ -422,16 +454,16 @@ impl<R: Runtime> Future for I2cpSession<R> {
             match self.destination.poll_next_unpin(cx) {
                 Poll::Pending => break,
                 Poll::Ready(None) => return Poll::Ready(()),
-                Poll::Ready(Some(DestinationEvent::Messages { messages })) =>
-                    messages.into_iter().for_each(|message| {
-                        tracing::trace!(
-                            target: LOG_TARGET,
-                            session_id = ?self.session_id,
-                            "send messages to i2cp client",
-                        );
+                Poll::Ready(Some(DestinationEvent::Messages { messages })) => {
+                    tracing::trace!(
+                        target: LOG_TARGET,
+                        session_id = ?self.session_id,
+                        num_messages = ?messages.len(),
+                        "send messages to i2cp client",
+                    );
 
-                        self.send_payload_message(message)
-                    }),
+                    messages.into_iter().for_each(|message| self.send_payload_message(message));
+                }
                 Poll::Ready(Some(DestinationEvent::LeaseSetFound { destination_id })) =>
                     match self.pending_connections.remove(&destination_id) {
                         Some(messages) => messages.into_iter().for_each(|message| {
@@ -519,9 +551,6 @@ impl<R: Runtime> Future for I2cpSession<R> {
                 Poll::Ready(Some(DestinationEvent::CreateLeaseSet { leases })) => {
                     let session_id = self.session_id;
                     self.socket.send_message(RequestVariableLeaseSet::new(session_id, leases));
-
-                    // wake the task so that the socket is polled and the message is sent to client
-                    cx.waker().wake_by_ref();
                 }
                 Poll::Ready(Some(DestinationEvent::SessionTerminated { destination_id })) => {
                     tracing::info!(
@@ -563,6 +592,19 @@ impl<R: Runtime> Future for I2cpSession<R> {
             }
         }
 
+        // write all messages queued during this poll to the client, coalesced into as few
+        // writes as possible
+        if let Poll::Ready(Err(error)) = self.socket.poll_write_frames(cx) {
+            tracing::debug!(
+                target: LOG_TARGET,
+                session_id = ?self.session_id,
+                ?error,
+                "failed to write to i2cp client",
+            );
+
+            return Poll::Ready(());
+        }
+
         Poll::Pending
     }
 }
@@ -17,6 +17,7 @@
 // DEALINGS IN THE SOFTWARE.
 
 use crate::{
+    error::{ConnectionError, Error},
     i2cp::message::{Message, MessageType, I2CP_HEADER_SIZE},
     runtime::{AsyncRead, AsyncWrite, Runtime},
 };
@@ -26,7 +27,6 @@ use futures::Stream;
 
 use alloc::{collections::VecDeque, vec, vec::Vec};
 use core::{
-    mem,
     pin::Pin,
     task::{Context, Poll, Waker},
 };
@@ -34,6 +34,15 @@ use core::{
 /// Logging target for the file.
 const LOG_TARGET: &str = "emissary::i2cp::socket";
 
+/// Maximum size of a coalesced outbound frame.
+///
+/// Messages queued while the previous frame is still waiting to be written are appended to it
+/// so that bursts of small messages, such as `MessagePayload`s, don't each need their own write.
+const MAX_COALESCED_SIZE: usize = 16 * 1024;
+
+/// Maximum number of frames written to the socket with one vectored write.
+const MAX_VECTORED_FRAMES: usize = 4usize;
+
 /// Read state.
 enum ReadState {
     /// Read I2CP message header.
@@ -58,22 +67,64 @@ enum ReadState {
     },
 }
 
-/// Write state
-enum WriteState {
-    /// Read next outbound message from message buffer.
-    GetMessage,
+/// Stream of an I2CP client connection.
+pub enum I2cpStream<R: Runtime> {
+    /// TCP stream.
+    Tcp(R::TcpStream),
 
-    /// Send message.
-    SendMessage {
-        /// Write offset.
-        offset: usize,
+    /// Unix domain socket stream.
+    Unix(R::UnixStream),
+}
 
-        /// I2CP message, potentially partially written.
-        message: BytesMut,
-    },
+impl<R: Runtime> AsyncRead for I2cpStream<R> {
+    fn poll_read(
+        self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &mut [u8],
+    ) -> Poll<crate::Result<usize>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_read(cx, buf),
+            Self::Unix(stream) => Pin::new(stream).poll_read(cx, buf),
+        }
+    }
+}
+
+impl<R: Runtime> AsyncWrite for I2cpStream<R> {
+    fn poll_write(
+        self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &[u8],
+    ) -> Poll<crate::Result<usize>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_write(cx, buf),
+            Self::Unix(stream) => Pin::new(stream).poll_write(cx, buf),
+        }
+    }
+
+    fn poll_write_vectored(
+        self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        bufs: &[&[u8]],
+    ) -> Poll<crate::Result<usize>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_write_vectored(cx, bufs),
+            Self::Unix(stream) => Pin::new(stream).poll_write_vectored(cx, bufs),
+        }
+    }
+
+    fn poll_flush(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<crate::Result<()>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_flush(cx),
+            Self::Unix(stream) => Pin::new(stream).poll_flush(cx),
+        }
+    }
 
-    /// [`WriteState`] has been poisoned due to a bug.
-    Poisoned,
+    fn poll_close(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<crate::Result<()>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_close(cx),
+            Self::Unix(stream) => Pin::new(stream).poll_close(cx),
+        }
+    }
 }
 
 /// I2CP client socket.
@@ -87,37 +138,95 @@ pub struct I2cpSocket<R: Runtime> {
     /// Read state.
     read_state: ReadState,
 
-    /// TCP stream.
-    stream: R::TcpStream,
+    /// Client stream.
+    stream: I2cpStream<R>,
 
     /// Waker, if any.
     waker: Option<Waker>,
 
-    /// Write state.
-    write_state: WriteState,
+    /// How many bytes of the first pending frame have been written.
+    write_offset: usize,
 }
 
 impl<R: Runtime> I2cpSocket<R> {
     /// Create new [`I2cpSocket`].
-    pub fn new(stream: R::TcpStream) -> Self {
+    pub fn new(stream: I2cpStream<R>) -> Self {
         Self {
             pending_frames: VecDeque::new(),
             read_buffer: vec![0u8; 0xffff],
             read_state: ReadState::ReadHeader { offset: 0usize },
             stream,
-            write_state: WriteState::GetMessage,
             waker: None,
+            write_offset: 0usize,
         }
     }
 
     /// Attempt to send `message` to the connected I2CP client.
+    ///
+    /// If the last pending frame has room left, `message` is coalesced into it.
     pub fn send_message(&mut self, message: BytesMut) {
-        self.pending_frames.push_back(message);
+        match self.pending_frames.back_mut() {
+            Some(frame) if frame.len() + message.len() <= MAX_COALESCED_SIZE =>
+                frame.extend_from_slice(&message),
+            _ => self.pending_frames.push_back(message),
+        }
 
         if let Some(waker) = self.waker.take() {
             waker.wake_by_ref();
         }
     }
+
+    /// Write pending frames into the socket.
+    ///
+    /// Up to [`MAX_VECTORED_FRAMES`] frames are written with one vectored write. Returns
+    /// `Poll::Ready(Ok(()))` once all pending frames have been written.
+    pub fn poll_write_frames(&mut self, cx: &mut Context<'_>) -> Poll<crate::Result<()>> {
+        while !self.pending_frames.is_empty() {
+            let mut frames: [&[u8]; MAX_VECTORED_FRAMES] = [&[]; MAX_VECTORED_FRAMES];
+            let num_frames = self.pending_frames.len().min(MAX_VECTORED_FRAMES);
+
+            // first frame may have been partially written
+            for (i, (slot, frame)) in frames.iter_mut().zip(self.pending_frames.iter()).enumerate()
+            {
+                *slot = match i {
+                    0 => &frame[self.write_offset..],
+                    _ => &frame[..],
+                };
+            }
+
+            match Pin::new(&mut self.stream).poll_write_vectored(cx, &frames[..num_frames]) {
+                Poll::Pending => return Poll::Pending,
+                Poll::Ready(Err(error)) => return Poll::Ready(Err(error)),
+                Poll::Ready(Ok(0)) => {
+                    tracing::debug!(
+                        target: LOG_TARGET,
+                        "wrote zero bytes to socket",
+                    );
+
+                    return Poll::Ready(Err(Error::Connection(ConnectionError::SocketClosed)));
+                }
+                Poll::Ready(Ok(nwritten)) => self.consume(nwritten),
+            }
+        }
+
+        Poll::Ready(Ok(()))
+    }
+
+    /// Remove `nwritten` bytes from the front of pending frames after they've been written.
+    fn consume(&mut self, mut nwritten: usize) {
+        while let Some(frame) = self.pending_frames.front() {
+            let remaining = frame.len() - self.write_offset;
+
+            if nwritten < remaining {
+                self.write_offset += nwritten;
+                return;
+            }
+
+            nwritten -= remaining;
+            self.write_offset = 0usize;
+            self.pending_frames.pop_front();
+        }
+    }
 }
 
 impl<R: Runtime> Stream for I2cpSocket<R> {
@@ -274,59 +383,110 @@ impl<R: Runtime> Stream for I2cpSocket<R> {
             }
         }
 
-        loop {
-            match mem::replace(&mut this.write_state, WriteState::Poisoned) {
-                WriteState::GetMessage => match this.pending_frames.pop_front() {
-                    None => {
-                        this.write_state = WriteState::GetMessage;
-                        break;
-                    }
-                    Some(message) => {
-                        this.write_state = WriteState::SendMessage {
-                            offset: 0usize,
-                            message,
-                        };
-                    }
-                },
-                WriteState::SendMessage { offset, message } =>
-                    match stream.as_mut().poll_write(cx, &message[offset..]) {
-                        Poll::Pending => {
-                            this.write_state = WriteState::SendMessage { offset, message };
-                            break;
-                        }
-                        Poll::Ready(Err(_)) => return Poll::Ready(None),
-                        Poll::Ready(Ok(0)) => {
-                            tracing::debug!(
-                                target: LOG_TARGET,
-                                "wrote zero bytes to socket",
-                            );
+        if let Poll::Ready(Err(error)) = this.poll_write_frames(cx) {
+            tracing::debug!(
+                target: LOG_TARGET,
+                ?error,
+                "socket write error",
+            );
 
-                            return Poll::Ready(None);
-                        }
-                        Poll::Ready(Ok(nwritten)) => match nwritten + offset == message.len() {
-                            true => {
-                                this.write_state = WriteState::GetMessage;
-                            }
-                            false => {
-                                this.write_state = WriteState::SendMessage {
-                                    offset: offset + nwritten,
-                                    message,
-                                };
-                            }
-                        },
-                    },
-                WriteState::Poisoned => {
-                    tracing::warn!(
-                        target: LOG_TARGET,
-                        "write state is poisoned",
-                    );
-                    debug_assert!(false);
-                    return Poll::Ready(None);
-                }
-            }
+            return Poll::Ready(None);
         }
 
         self.waker = Some(cx.waker().clone());
         Poll::Pending
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::runtime::{
+        mock::{MockRuntime, MockTcpStream},
+        TcpStream as _,
+    };
+    use tokio::{io::AsyncReadExt, net::TcpListener};
+
+    #[tokio::test]
+    async fn small_frames_are_coalesced() {
+        let listener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let address = listener.local_addr().unwrap();
+        let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
+        let (mut stream, _) = stream1.unwrap();
+        let mut socket = I2cpSocket::<MockRuntime>::new(I2cpStream::Tcp(stream2.unwrap()));
+
+        (0..10u8).for_each(|i| socket.send_message(BytesMut::from(&[i; 100][..])));
+        assert_eq!(socket.pending_frames.len(), 1);
+
+        // frame too large to be coalesced with the previous frame
+        socket.send_message(BytesMut::from(&[0xaa; MAX_COALESCED_SIZE][..]));
+        socket.send_message(BytesMut::from(&[0xbb; 100][..]));
+        assert_eq!(socket.pending_frames.len(), 3);
+
+        futures::future::poll_fn(|cx| socket.poll_write_frames(cx)).await.unwrap();
+        assert!(socket.pending_frames.is_empty());
+        assert_eq!(socket.write_offset, 0usize);
+
+        let mut buffer = vec![0u8; 10 * 100 + MAX_COALESCED_SIZE + 100];
+        stream.read_exact(&mut buffer).await.unwrap();
+
+        (0..10usize)
+            .for_each(|i| assert!(buffer[i * 100..(i + 1) * 100].iter().all(|b| *b == i as u8)));
+        assert!(buffer[1000..1000 + MAX_COALESCED_SIZE].iter().all(|b| *b == 0xaa));
+        assert!(buffer[1000 + MAX_COALESCED_SIZE..].iter().all(|b| *b == 0xbb));
+    }
+
+    #[tokio::test]
+    async fn partially_written_frames_are_consumed() {
+        let listener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let address = listener.local_addr().unwrap();
+        let (_stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
+        let mut socket = I2cpSocket::<MockRuntime>::new(I2cpStream::Tcp(stream2.unwrap()));
+
+        socket.pending_frames.push_back(BytesMut::from(&[1u8; 10][..]));
+        socket.pending_frames.push_back(BytesMut::from(&[2u8; 10][..]));
+        socket.pending_frames.push_back(BytesMut::from(&[3u8; 10][..]));
+
+        socket.consume(5);
+        assert_eq!(socket.pending_frames.len(), 3);
+        assert_eq!(socket.write_offset, 5);
+
+        socket.consume(10);
+        assert_eq!(socket.pending_frames.len(), 2);
+        assert_eq!(socket.write_offset, 5);
+
+        socket.consume(15);
+        assert!(socket.pending_frames.is_empty());
+        assert_eq!(socket.write_offset, 0);
+    }
+
+    #[cfg(unix)]
+    #[tokio::test]
+    async fn frames_written_over_unix_socket() {
+        use crate::runtime::{mock::MockUnixListener, UnixListener as _};
+
+        let path =
+            std::env::temp_dir().join(format!("emissary-i2cp-{}.sock", rand::random::<u64>()));
+        let path = path.to_str().unwrap().to_string();
+
+        let mut listener = MockUnixListener::bind(&path).await.unwrap();
+        let (stream1, stream2) = tokio::join!(
+            futures::future::poll_fn(|cx| listener.poll_accept(cx)),
+            tokio::net::UnixStream::connect(&path),
+        );
+        let mut stream = stream2.unwrap();
+        let mut socket = I2cpSocket::<MockRuntime>::new(I2cpStream::Unix(stream1.unwrap()));
+
+        socket.send_message(BytesMut::from(&[0xaa; 100][..]));
+        socket.send_message(BytesMut::from(&[0xbb; 100][..]));
+        futures::future::poll_fn(|cx| socket.poll_write_frames(cx)).await.unwrap();
+
+        let mut buffer = vec![0u8; 200];
+        stream.read_exact(&mut buffer).await.unwrap();
+
+        assert!(buffer[..100].iter().all(|b| *b == 0xaa));
+        assert!(buffer[100..].iter().all(|b| *b == 0xbb));
+
+        let _ = std::fs::remove_file(&path);
+    }
+}
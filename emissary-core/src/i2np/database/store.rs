@@ -18,7 +18,7 @@
 
 use crate::{
     i2np::{database::DATABASE_KEY_SIZE, LOG_TARGET, ROUTER_HASH_LEN},
-    primitives::{LeaseSet2, RouterId, RouterInfo, TunnelId},
+    primitives::{EncryptedLeaseSet, LeaseSet2, RouterId, RouterInfo, TunnelId},
     runtime::Runtime,
 };
 
@@ -158,6 +158,12 @@ pub enum DatabaseStorePayload {
         /// Lease set.
         lease_set: LeaseSet2,
     },
+
+    /// Encrypted lease set.
+    EncryptedLeaseSet {
+        /// Encrypted lease set.
+        lease_set: EncryptedLeaseSet,
+    },
 }
 
 impl fmt::Display for DatabaseStorePayload {
@@ -173,6 +179,11 @@ impl fmt::Display for DatabaseStorePayload {
                 "DatabaseStorePayload::LeaseSet2 ({})",
                 lease_set.header.destination.id()
             ),
+            Self::EncryptedLeaseSet { lease_set } => write!(
+                f,
+                "DatabaseStorePayload::EncryptedLeaseSet ({:?})",
+                &lease_set.routing_key()[..4]
+            ),
         }
     }
 }
@@ -184,6 +195,7 @@ impl DatabaseStorePayload {
             // TODO: calculate actual size
             Self::RouterInfo { .. } => 2048usize,
             Self::LeaseSet2 { lease_set } => lease_set.serialized_len(),
+            Self::EncryptedLeaseSet { lease_set } => lease_set.serialized_len(),
         }
     }
 }
@@ -295,6 +307,19 @@ impl<R: Runtime> DatabaseStore<R> {
                     },
                 ))
             }
+            StoreType::EncryptedLeaseSet => {
+                let (rest, lease_set) = EncryptedLeaseSet::parse_frame(rest)?;
+
+                Ok((
+                    rest,
+                    Self {
+                        key: Bytes::from(key.to_vec()),
+                        payload: DatabaseStorePayload::EncryptedLeaseSet { lease_set },
+                        reply,
+                        _runtime: Default::default(),
+                    },
+                ))
+            }
             kind => {
                 tracing::warn!(
                     target: LOG_TARGET,
@@ -355,6 +380,7 @@ impl<R: Runtime> DatabaseStore<R> {
 }
 
 /// Database store kind.
+#[derive(Clone)]
 pub enum DatabaseStoreKind {
     /// [`RouterInfo`].
     RouterInfo {
@@ -367,6 +393,12 @@ pub enum DatabaseStoreKind {
         /// Serialized [`LeaseSet2`].
         lease_set: Bytes,
     },
+
+    /// [`EncryptedLeaseSet`].
+    EncryptedLeaseSet {
+        /// Serialized [`EncryptedLeaseSet`].
+        lease_set: Bytes,
+    },
 }
 
 impl DatabaseStoreKind {
@@ -375,6 +407,7 @@ impl DatabaseStoreKind {
         match self {
             Self::RouterInfo { router_info } => router_info.len(),
             Self::LeaseSet2 { lease_set } => lease_set.len(),
+            Self::EncryptedLeaseSet { lease_set } => lease_set.len(),
         }
     }
 }
@@ -422,6 +455,8 @@ impl DatabaseStoreBuilder {
         match &self.kind {
             DatabaseStoreKind::RouterInfo { .. } => out.put_u8(StoreType::RouterInfo.as_u8()),
             DatabaseStoreKind::LeaseSet2 { .. } => out.put_u8(StoreType::LeaseSet2.as_u8()),
+            DatabaseStoreKind::EncryptedLeaseSet { .. } =>
+                out.put_u8(StoreType::EncryptedLeaseSet.as_u8()),
         }
 
         match reply {
@@ -452,7 +487,8 @@ impl DatabaseStoreBuilder {
                 out.put_u16(router_info.len() as u16);
                 out.put_slice(&router_info);
             }
-            DatabaseStoreKind::LeaseSet2 { lease_set } => out.put_slice(&lease_set),
+            DatabaseStoreKind::LeaseSet2 { lease_set }
+            | DatabaseStoreKind::EncryptedLeaseSet { lease_set } => out.put_slice(&lease_set),
         }
 
         out
@@ -655,4 +691,44 @@ mod tests {
             _ => panic!("invalid payload"),
         }
     }
+
+    #[test]
+    fn serialize_and_parse_encrypted_lease_set_store() {
+        use crate::crypto::blinding::{blinding_date, BlindedSigningKey};
+
+        let (leaseset, signing_key) = LeaseSet2::random();
+        let blinded = BlindedSigningKey::new(
+            &signing_key,
+            &blinding_date(MockRuntime::time_since_epoch()),
+            None,
+        );
+        let encrypted = EncryptedLeaseSet::new::<MockRuntime>(
+            &leaseset.clone().serialize(&signing_key),
+            &blinded,
+            MockRuntime::time_since_epoch().as_secs() as u32,
+            600,
+        );
+        let key = encrypted.routing_key();
+
+        let serialized = DatabaseStoreBuilder::new(
+            key.clone(),
+            DatabaseStoreKind::EncryptedLeaseSet {
+                lease_set: Bytes::from(encrypted.serialize::<MockRuntime>(&blinded)),
+            },
+        )
+        .build();
+
+        let store = DatabaseStore::<MockRuntime>::parse(&serialized).unwrap();
+        assert_eq!(store.key, key);
+
+        match store.payload {
+            DatabaseStorePayload::EncryptedLeaseSet { lease_set } => {
+                assert_eq!(lease_set.routing_key(), key);
+
+                let parsed = lease_set.decrypt(blinded.public().subcredential()).unwrap();
+                assert_eq!(parsed.leases, leaseset.leases);
+            }
+            _ => panic!("invalid payload"),
+        }
+    }
 }
@@ -22,7 +22,7 @@ use crate::{
     primitives::MessageId,
 };
 
-use bytes::{BufMut, BytesMut};
+use bytes::BufMut;
 use nom::{
     bytes::complete::take,
     error::{make_error, ErrorKind},
@@ -43,6 +43,11 @@ const GARLIC_HEADER_LEN: usize = 3;
 /// Poly13055 tag, ephemeral key and garlic message length.
 pub const GARLIC_MESSAGE_OVERHEAD: usize = 16 + 32 + 4;
 
+/// Garlic clove overhead, excluding delivery instructions.
+///
+/// Block header, message type (1 byte), message ID (4 bytes) and expiration (4 bytes).
+pub const GARLIC_CLOVE_OVERHEAD: usize = GARLIC_HEADER_LEN + 1 + 4 + 4;
+
 /// Garlic message type.
 #[derive(Debug)]
 pub enum GarlicMessageType {
@@ -196,10 +201,8 @@ impl DeliveryInstructions<'_> {
         }
     }
 
-    /// Serialize [`DeliveryInstructions`] into a byte vector.
-    fn serialize(self) -> BytesMut {
-        let mut out = BytesMut::with_capacity(self.serialized_len());
-
+    /// Serialize [`DeliveryInstructions`] into `out`.
+    fn serialize_into(&self, out: &mut impl BufMut) {
         match self {
             Self::Local => out.put_u8(0x00),
             Self::Destination { hash } => {
@@ -213,11 +216,9 @@ impl DeliveryInstructions<'_> {
             Self::Tunnel { hash, tunnel_id } => {
                 out.put_u8(0x03 << 5);
                 out.put_slice(hash);
-                out.put_u32(tunnel_id);
+                out.put_u32(*tunnel_id);
             }
         }
-
-        out
     }
 }
 
@@ -697,11 +698,8 @@ impl<'a> GarlicMessageBuilder<'a> {
     ) -> Self {
         self.message_size = self
             .message_size
-            .saturating_add(GARLIC_HEADER_LEN)
+            .saturating_add(GARLIC_CLOVE_OVERHEAD)
             .saturating_add(delivery_instructions.serialized_len())
-            .saturating_add(1) // message type
-            .saturating_add(4) // message id
-            .saturating_add(4) // expiration
             .saturating_add(message_body.len());
 
         self.cloves.push(GarlicMessageBlock::GarlicClove {
@@ -738,10 +736,24 @@ impl<'a> GarlicMessageBuilder<'a> {
         self
     }
 
+    /// Get the exact serialized size of the message.
+    pub fn serialized_len(&self) -> usize {
+        self.message_size
+    }
+
     /// Serialize [`GarlicMessageBuilder`] into a byte vector.
     pub fn build(self) -> Vec<u8> {
-        let mut out = BytesMut::with_capacity(self.message_size);
+        let mut out = Vec::with_capacity(self.message_size);
+        self.build_into(&mut out);
+
+        out
+    }
 
+    /// Serialize [`GarlicMessageBuilder`] into `out`.
+    ///
+    /// Exactly [`GarlicMessageBuilder::serialized_len()`] bytes are written which allows the caller
+    /// to reserve space for its own headers and trailers and serialize the message in place.
+    pub fn build_into(self, out: &mut impl BufMut) {
         for clove in self.cloves {
             match clove {
                 GarlicMessageBlock::DateTime { timestamp } => {
@@ -765,7 +777,7 @@ impl<'a> GarlicMessageBuilder<'a> {
                             .saturating_add(4) // expiration
                             .saturating_add(message_body.len()) as u16,
                     );
-                    out.put_slice(&delivery_instructions.serialize());
+                    delivery_instructions.serialize_into(out);
                     out.put_u8(message_type.as_u8());
                     out.put_u32(*message_id);
                     out.put_u32(expiration.as_secs() as u32);
@@ -828,8 +840,6 @@ impl<'a> GarlicMessageBuilder<'a> {
                 block => todo!("unimplemented block: {block:?}"),
             }
         }
-
-        out.freeze().to_vec()
     }
 }
 
@@ -866,6 +876,7 @@ impl fmt::Debug for GarlicClove {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use bytes::BytesMut;
 
     #[test]
     fn unsupported_garlic_message_block() {
@@ -932,4 +943,59 @@ mod tests {
             _ => panic!("invalid garlic block"),
         }
     }
+
+    #[test]
+    fn build_into_writes_exact_size() {
+        let hash = [0xaa; 32];
+        let body = vec![0xbb; 128];
+        let builder = GarlicMessageBuilder::default()
+            .with_date_time(1337u32)
+            .with_garlic_clove(
+                MessageType::Data,
+                MessageId::from(1338u32),
+                Duration::from_secs(1339u64),
+                DeliveryInstructions::Tunnel {
+                    hash: &hash,
+                    tunnel_id: 1340u32,
+                },
+                &body,
+            )
+            .with_next_key(NextKeyKind::ReverseKey {
+                key_id: 1u16,
+                public_key: None,
+            })
+            .with_ack_request()
+            .with_ack(vec![(1u16, 2u16), (3u16, 4u16)]);
+
+        // reserve space for a header, as done by the session encryption path
+        let size = builder.serialized_len();
+        let mut out = Vec::with_capacity(4 + size);
+        out.put_u32(size as u32);
+        builder.build_into(&mut out);
+
+        assert_eq!(out.len(), 4 + size);
+
+        let message = GarlicMessage::parse(&out[4..]).unwrap();
+        assert_eq!(message.blocks.len(), 5);
+
+        match &message.blocks[1] {
+            GarlicMessageBlock::GarlicClove {
+                message_type,
+                delivery_instructions,
+                message_body,
+                ..
+            } => {
+                assert_eq!(message_type, &MessageType::Data);
+                assert!(std::matches!(
+                    delivery_instructions,
+                    DeliveryInstructions::Tunnel {
+                        tunnel_id: 1340u32,
+                        ..
+                    }
+                ));
+                assert_eq!(message_body, &body.as_slice());
+            }
+            _ => panic!("invalid garlic block"),
+        }
+    }
 }
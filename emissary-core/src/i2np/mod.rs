@@ -22,7 +22,7 @@
 
 use crate::{crypto::sha256::Sha256, runtime::Runtime, subsystem::SubsystemKind};
 
-use bytes::{BufMut, BytesMut};
+use bytes::BufMut;
 use nom::{
     bytes::complete::take,
     error::{make_error, ErrorKind},
@@ -214,6 +214,9 @@ pub enum MessageBuilder<'a> {
 
         /// Raw, unparsed payload.
         payload: Option<&'a [u8]>,
+
+        /// Should the payload checksum be calculated.
+        checksum: bool,
     },
 
     /// Short I2NP header (NTCP2/SSU2).
@@ -250,7 +253,23 @@ impl<'a> MessageBuilder<'a> {
             message_id: None,
             expiration: None,
             payload: None,
+            checksum: true,
+        }
+    }
+
+    /// Don't calculate payload checksum for a message with standard header.
+    ///
+    /// The checksum field is set to zero, saving a SHA-256 over the payload. Only to be used for
+    /// messages which are consumed by the local router as remote routers may verify the checksum.
+    pub fn without_checksum(mut self) -> Self {
+        if let Self::Standard {
+            ref mut checksum, ..
+        } = self
+        {
+            *checksum = false;
         }
+
+        self
     }
 
     /// Add expiration.
@@ -318,25 +337,43 @@ impl<'a> MessageBuilder<'a> {
     }
 
     /// Serialize I2NP message.
+    ///
+    /// The header and payload are written into an exactly-sized buffer which is returned as-is.
     pub fn build(self) -> Vec<u8> {
+        self.build_with_buffer(Vec::new())
+    }
+
+    /// Serialize I2NP message into `out`.
+    ///
+    /// `out` is cleared and grown if it's too small to hold the message, allowing the caller to
+    /// serialize the message into a buffer taken from a [`BufferPool`].
+    ///
+    /// [`BufferPool`]: crate::pool::BufferPool
+    pub fn build_with_buffer(self, mut out: Vec<u8>) -> Vec<u8> {
+        out.clear();
+
         match self {
             Self::Standard {
                 message_type,
                 message_id,
                 expiration,
                 mut payload,
+                checksum,
             } => {
                 let payload = payload.take().expect("to exist");
-                let mut out = BytesMut::with_capacity(payload.len() + I2NP_STANDARD_HEADER_LEN);
+                out.reserve_exact(payload.len() + I2NP_STANDARD_HEADER_LEN);
 
                 out.put_u8(message_type.expect("to exist").as_u8());
                 out.put_u32(message_id.expect("to exist"));
                 out.put_u64(expiration.expect("to exist").as_millis() as u64);
                 out.put_u16(payload.len() as u16);
-                out.put_u8(Sha256::new().update(payload).finalize()[0]); // checksum
+                out.put_u8(match checksum {
+                    true => Sha256::new().update(payload).finalize_new()[0],
+                    false => 0u8,
+                });
                 out.put_slice(payload);
 
-                out.freeze().to_vec()
+                out
             }
             Self::Short {
                 message_type,
@@ -347,7 +384,7 @@ impl<'a> MessageBuilder<'a> {
                 let payload = payload.take().expect("to exist");
 
                 // two extra bytes for the length field
-                let mut out = BytesMut::with_capacity(payload.len() + I2NP_SHORT_HEADER_LEN + 2);
+                out.reserve_exact(payload.len() + I2NP_SHORT_HEADER_LEN + 2);
 
                 out.put_u16((payload.len() + I2NP_SHORT_HEADER_LEN) as u16);
                 out.put_u8(message_type.expect("to exist").as_u8());
@@ -355,7 +392,7 @@ impl<'a> MessageBuilder<'a> {
                 out.put_u32(expiration.expect("to exist").as_secs() as u32);
                 out.put_slice(payload);
 
-                out.freeze().to_vec()
+                out
             }
         }
     }
@@ -377,6 +414,8 @@ pub struct Message {
     pub expiration: Duration,
 
     /// Raw, unparsed payload.
+    //
+    // TODO: share the payload with the transport's receive buffer instead of copying it
     pub payload: Vec<u8>,
 }
 
@@ -519,6 +558,7 @@ impl Message {
 mod tests {
     use super::*;
     use crate::runtime::mock::MockRuntime;
+    use bytes::BytesMut;
 
     #[test]
     fn parse_short_as_standard() {
@@ -544,6 +584,62 @@ mod tests {
         assert!(Message::parse_short(&message).is_none());
     }
 
+    #[test]
+    fn built_message_lengths() {
+        let short = MessageBuilder::short()
+            .with_message_type(MessageType::DeliveryStatus)
+            .with_message_id(1337u32)
+            .with_expiration(Duration::from_secs(0xdeadbeefu64))
+            .with_payload(&vec![1u8; 1337])
+            .build();
+        let standard = MessageBuilder::standard()
+            .with_message_type(MessageType::DeliveryStatus)
+            .with_message_id(1337u32)
+            .with_expiration(Duration::from_secs(0xdeadbeefu64))
+            .with_payload(&vec![1u8; 1337])
+            .build();
+
+        let message = Message::parse_short(&short).unwrap();
+        assert_eq!(short.len(), message.serialized_len_short());
+        assert_eq!(message.payload, vec![1u8; 1337]);
+
+        let message = Message::parse_standard(&standard).unwrap();
+        assert_eq!(standard.len(), message.serialized_len_long());
+        assert_eq!(message.payload, vec![1u8; 1337]);
+    }
+
+    #[test]
+    fn standard_header_checksum() {
+        let payload = vec![1u8; 1337];
+        let checksum = Sha256::new().update(&payload).finalize_new()[0];
+
+        let message = MessageBuilder::standard()
+            .with_message_type(MessageType::Data)
+            .with_message_id(1337u32)
+            .with_expiration(Duration::from_secs(0xdeadbeefu64))
+            .with_payload(&payload)
+            .build();
+        assert_eq!(message[I2NP_STANDARD_HEADER_LEN - 1], checksum);
+
+        let unchecked = MessageBuilder::standard()
+            .with_message_type(MessageType::Data)
+            .with_message_id(1337u32)
+            .with_expiration(Duration::from_secs(0xdeadbeefu64))
+            .with_payload(&payload)
+            .without_checksum()
+            .build();
+        assert_eq!(unchecked[I2NP_STANDARD_HEADER_LEN - 1], 0u8);
+        assert_eq!(
+            message[I2NP_STANDARD_HEADER_LEN..],
+            unchecked[I2NP_STANDARD_HEADER_LEN..]
+        );
+
+        // checksum is not verified by the parser
+        let parsed = Message::parse_standard(&unchecked).unwrap();
+        assert_eq!(parsed.message_id, 1337u32);
+        assert_eq!(parsed.payload, payload);
+    }
+
     #[test]
     fn invalid_message_type() {
         let mut out = BytesMut::with_capacity(4 + I2NP_SHORT_HEADER_LEN + 2);
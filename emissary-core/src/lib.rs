@@ -46,6 +46,7 @@ mod destination;
 mod error;
 mod i2cp;
 mod netdb;
+mod pool;
 mod profile;
 mod sam;
 mod shutdown;
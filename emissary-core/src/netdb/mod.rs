@@ -33,7 +33,7 @@ use crate::{
         Message, MessageBuilder, MessageType, I2NP_MESSAGE_EXPIRATION,
     },
     netdb::{handle::NetDbActionRecycle, metrics::*, query::*},
-    primitives::{LeaseSet2, RouterId, RouterInfo},
+    primitives::{EncryptedLeaseSet, LeaseSet2, RouterId, RouterInfo},
     profile::Bucket,
     router::context::RouterContext,
     runtime::{Counter, Gauge, JoinSet, MetricType, MetricsHandle, Runtime},
@@ -171,10 +171,10 @@ pub struct NetDb<R: Runtime> {
     /// RX channel for receiving queries from other subsystems.
     handle_rx: mpsc::Receiver<NetDbAction, NetDbActionRecycle>,
 
-    /// Serialized [`LeasSet2`]s received via `DatabaseStore` messages.
+    /// Serialized [`LeasSet2`]s and [`EncryptedLeaseSet`]s received via `DatabaseStore` messages.
     ///
     /// This contains entries only if `floodfill` is true.
-    lease_sets: HashMap<Bytes, (Bytes, Duration)>,
+    lease_sets: HashMap<Bytes, (DatabaseStoreKind, Duration)>,
 
     /// `NetDb` maintenance timer.
     maintenance_timer: R::Timer,
@@ -657,9 +657,76 @@ impl<R: Runtime> NetDb<R> {
         // parse the raw lease set from the database store, store it in the set of leases we keep
         // track of and flood it to three floodfills closest to `key`
         let raw_lease_set = DatabaseStore::<R>::extract_raw_lease_set(message);
-        let expires = lease_set.expires();
 
-        self.lease_sets.insert(key.clone(), (raw_lease_set.clone(), expires));
+        self.store_lease_set(
+            key,
+            reply,
+            DatabaseStoreKind::LeaseSet2 {
+                lease_set: raw_lease_set,
+            },
+            lease_set.expires(),
+        );
+    }
+
+    /// Handle [`DatabaseStore`] for [`EncryptedLeaseSet`] if the local router is run as a
+    /// floodfill.
+    ///
+    /// The contents of the lease set cannot be decrypted by the floodfill but the signature of the
+    /// blinded key has been verified and the lease set must be stored under the blinded key.
+    fn on_encrypted_lease_set_store(
+        &mut self,
+        key: Bytes,
+        reply: StoreReplyType,
+        message: &[u8],
+        lease_set: EncryptedLeaseSet,
+    ) {
+        tracing::trace!(
+            target: LOG_TARGET,
+            key = ?key[..4],
+            "encrypted lease set store",
+        );
+
+        if lease_set.routing_key() != key {
+            tracing::warn!(
+                target: LOG_TARGET,
+                key = ?key[..4],
+                "encrypted lease set stored under invalid key, ignoring",
+            );
+            return;
+        }
+
+        if lease_set.is_expired::<R>() {
+            tracing::warn!(
+                target: LOG_TARGET,
+                key = ?key[..4],
+                expired = ?lease_set.expires,
+                "received an expired encrypted lease set, ignoring",
+            );
+            return;
+        }
+
+        let raw_lease_set = DatabaseStore::<R>::extract_raw_lease_set(message);
+
+        self.store_lease_set(
+            key,
+            reply,
+            DatabaseStoreKind::EncryptedLeaseSet {
+                lease_set: raw_lease_set,
+            },
+            lease_set.expires(),
+        );
+    }
+
+    /// Store verified lease set under `key`, acknowledge the store and flood the lease set to three
+    /// floodfills closest to `key`.
+    fn store_lease_set(
+        &mut self,
+        key: Bytes,
+        reply: StoreReplyType,
+        lease_set: DatabaseStoreKind,
+        expires: Duration,
+    ) {
+        self.lease_sets.insert(key.clone(), (lease_set.clone(), expires));
 
         match reply {
             StoreReplyType::None => {
@@ -731,19 +798,13 @@ impl<R: Runtime> NetDb<R> {
         if floodfills.is_empty() {
             tracing::debug!(
                 target: LOG_TARGET,
-                %destination_id,
+                key = ?key[..4],
                 "cannot flood lease set, no floodfills",
             );
             return;
         }
 
-        let message = DatabaseStoreBuilder::new(
-            key,
-            DatabaseStoreKind::LeaseSet2 {
-                lease_set: raw_lease_set,
-            },
-        )
-        .build();
+        let message = DatabaseStoreBuilder::new(key, lease_set).build();
 
         let message_id = R::rng().next_u32();
         let message = MessageBuilder::short()
@@ -802,13 +863,7 @@ impl<R: Runtime> NetDb<R> {
 
                 (
                     MessageType::DatabaseStore,
-                    DatabaseStoreBuilder::new(
-                        key,
-                        DatabaseStoreKind::LeaseSet2 {
-                            lease_set: lease_set.clone(),
-                        },
-                    )
-                    .build(),
+                    DatabaseStoreBuilder::new(key, lease_set.clone()).build(),
                 )
             }
         };
@@ -1059,6 +1114,14 @@ impl<R: Runtime> NetDb<R> {
                     destination_id = %lease_set.header.destination.id(),
                     "ignoring lease set database store",
                 ),
+                DatabaseStorePayload::EncryptedLeaseSet { lease_set } if self.floodfill => {
+                    self.on_encrypted_lease_set_store(key, reply, &message.payload, lease_set);
+                }
+                DatabaseStorePayload::EncryptedLeaseSet { .. } => tracing::trace!(
+                    target: LOG_TARGET,
+                    key = ?key[..4],
+                    "ignoring encrypted lease set database store",
+                ),
             },
             Some(kind) => match (payload, kind) {
                 (DatabaseStorePayload::LeaseSet2 { lease_set }, QueryKind::LeaseSet { query }) => {
@@ -2994,7 +3057,10 @@ mod tests {
             (Bytes::from(id.to_vec()), lease_set, expires)
         };
 
-        netdb.lease_sets.insert(key.clone(), (lease_set, expires));
+        netdb.lease_sets.insert(
+            key.clone(),
+            (DatabaseStoreKind::LeaseSet2 { lease_set }, expires),
+        );
 
         let tunnel_id = TunnelId::random();
         let router_id = RouterId::random();
@@ -4494,6 +4560,7 @@ mod tests {
                             true
                         }
                         DatabaseStorePayload::LeaseSet2 { .. } => false,
+                        DatabaseStorePayload::EncryptedLeaseSet { .. } => false,
                     }
                 }
                 _ => false,
@@ -0,0 +1,407 @@
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//! Buffer pool for fixed-size network buffers.
+//!
+//! Nearly all traffic of a transit router consists of 1028-byte `TunnelData` messages which are
+//! decrypted, wrapped in an I2NP header and handed off to a transport, and each of these steps
+//! used to allocate a fresh buffer. [`BufferPool`] keeps free lists of tunnel-sized and MTU-sized
+//! buffers so that the hot path can reuse buffers instead of going through the allocator.
+//!
+//! Buffers are taken from the pool with [`BufferPool::get()`] and returned with
+//! [`BufferPool::put()`] once the owner is done with them. Buffers that are not returned are
+//! simply freed, so returning a buffer is always optional.
+//!
+//! With `std`, each thread has its own free lists so taking and returning a buffer never contends
+//! with other threads. A buffer returned by, e.g., an NTCP2 session is reused by the next task that
+//! runs on the same thread. `no_std` has no thread-local storage so one set of free lists is shared
+//! behind a spin lock.
+
+use crate::runtime::{Counter, MetricType, MetricsHandle, Runtime};
+
+#[cfg(feature = "std")]
+use core::cell::RefCell;
+#[cfg(feature = "no_std")]
+use spin::rwlock::RwLock;
+
+use alloc::vec::Vec;
+use core::mem;
+
+/// Capacity of a tunnel-sized buffer.
+///
+/// Fits a 1028-byte `TunnelData` message wrapped in an I2NP short header and an NTCP2 block,
+/// including the Poly1305 tag.
+pub const TUNNEL_BUFFER_SIZE: usize = 1088usize;
+
+/// Capacity of an MTU-sized buffer.
+pub const MTU_BUFFER_SIZE: usize = 1536usize;
+
+/// Maximum number of free buffers kept per size class.
+///
+/// With `std` the limit is per thread.
+const MAX_POOLED_BUFFERS: usize = 512usize;
+
+/// How many pool operations are counted locally before the counts are published as metrics.
+const METRICS_FLUSH_INTERVAL: usize = 1024usize;
+
+/// How many buffers were served from the pool.
+const POOL_HIT_COUNT: &str = "buffer_pool_hit_count";
+
+/// How many buffers had to be allocated because the pool was empty.
+const POOL_MISS_COUNT: &str = "buffer_pool_miss_count";
+
+/// How many returned buffers were freed instead of being pooled.
+const POOL_DISCARD_COUNT: &str = "buffer_pool_discard_count";
+
+/// Size class of a pooled buffer.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum SizeClass {
+    /// Buffer for a tunnel message.
+    Tunnel,
+
+    /// Buffer for an MTU-sized datagram.
+    Mtu,
+}
+
+impl SizeClass {
+    /// Get the smallest size class which can hold `len` bytes.
+    fn for_len(len: usize) -> Option<Self> {
+        match len {
+            len if len <= TUNNEL_BUFFER_SIZE => Some(Self::Tunnel),
+            len if len <= MTU_BUFFER_SIZE => Some(Self::Mtu),
+            _ => None,
+        }
+    }
+
+    /// Get the size class a returned buffer of `capacity` belongs to.
+    ///
+    /// Buffers which grew past twice the class size are not pooled so that an occasional large
+    /// message doesn't pin memory for the lifetime of the router.
+    fn for_capacity(capacity: usize) -> Option<Self> {
+        match capacity {
+            capacity if capacity < TUNNEL_BUFFER_SIZE => None,
+            capacity if capacity < MTU_BUFFER_SIZE => Some(Self::Tunnel),
+            capacity if capacity < 2 * MTU_BUFFER_SIZE => Some(Self::Mtu),
+            _ => None,
+        }
+    }
+
+    /// Get capacity of buffers allocated for the size class.
+    fn capacity(&self) -> usize {
+        match self {
+            Self::Tunnel => TUNNEL_BUFFER_SIZE,
+            Self::Mtu => MTU_BUFFER_SIZE,
+        }
+    }
+}
+
+/// Pool operation counts which haven't been published yet.
+#[derive(Default)]
+struct PoolStats {
+    /// Number of buffers served from the pool.
+    hits: usize,
+
+    /// Number of buffers allocated because the pool was empty.
+    misses: usize,
+
+    /// Number of returned buffers that were freed.
+    discards: usize,
+}
+
+/// Free lists of the buffer pool.
+struct FreeLists {
+    /// Free tunnel-sized buffers.
+    tunnel: Vec<Vec<u8>>,
+
+    /// Free MTU-sized buffers.
+    mtu: Vec<Vec<u8>>,
+
+    /// Unpublished operation counts.
+    stats: PoolStats,
+}
+
+impl FreeLists {
+    /// Create new, empty [`FreeLists`].
+    const fn new() -> Self {
+        Self {
+            tunnel: Vec::new(),
+            mtu: Vec::new(),
+            stats: PoolStats {
+                hits: 0usize,
+                misses: 0usize,
+                discards: 0usize,
+            },
+        }
+    }
+
+    /// Get free list for `class`.
+    fn list(&mut self, class: SizeClass) -> &mut Vec<Vec<u8>> {
+        match class {
+            SizeClass::Tunnel => &mut self.tunnel,
+            SizeClass::Mtu => &mut self.mtu,
+        }
+    }
+
+    /// Take the operation counts if enough operations have been counted since the last flush.
+    fn take_stats(&mut self) -> Option<PoolStats> {
+        let num_ops = self.stats.hits + self.stats.misses + self.stats.discards;
+
+        (num_ops >= METRICS_FLUSH_INTERVAL).then(|| mem::take(&mut self.stats))
+    }
+}
+
+#[cfg(feature = "std")]
+std::thread_local! {
+    /// Free lists of the current thread.
+    static FREE_LISTS: RefCell<FreeLists> = const { RefCell::new(FreeLists::new()) };
+}
+
+/// Free lists shared by all tasks.
+#[cfg(feature = "no_std")]
+static FREE_LISTS: RwLock<FreeLists> = RwLock::new(FreeLists::new());
+
+/// Call `f` with the free lists of the current thread.
+#[cfg(feature = "std")]
+fn with_free_lists<T>(f: impl FnOnce(&mut FreeLists) -> T) -> T {
+    FREE_LISTS.with(|lists| f(&mut lists.borrow_mut()))
+}
+
+/// Call `f` with the shared free lists.
+#[cfg(feature = "no_std")]
+fn with_free_lists<T>(f: impl FnOnce(&mut FreeLists) -> T) -> T {
+    f(&mut FREE_LISTS.write())
+}
+
+/// Buffer pool.
+///
+/// Handle to the free lists, shared by all subsystems of the router through [`RouterContext`].
+///
+/// Hit, miss and discard counts are accumulated in the free lists and published once every
+/// [`METRICS_FLUSH_INTERVAL`] operations so the metrics backend isn't called for every buffer.
+///
+/// [`RouterContext`]: crate::router::context::RouterContext
+#[derive(Clone)]
+pub struct BufferPool<R: Runtime> {
+    /// Metrics handle.
+    metrics: R::MetricsHandle,
+}
+
+impl<R: Runtime> BufferPool<R> {
+    /// Create new [`BufferPool`].
+    pub fn new(metrics: R::MetricsHandle) -> Self {
+        Self { metrics }
+    }
+
+    /// Register buffer pool metrics.
+    pub fn metrics(mut metrics: Vec<MetricType>) -> Vec<MetricType> {
+        metrics.push(MetricType::Counter {
+            name: POOL_HIT_COUNT,
+            description: "how many buffers were reused from the buffer pool",
+        });
+        metrics.push(MetricType::Counter {
+            name: POOL_MISS_COUNT,
+            description: "how many buffers were allocated because the buffer pool was empty",
+        });
+        metrics.push(MetricType::Counter {
+            name: POOL_DISCARD_COUNT,
+            description: "how many returned buffers were freed instead of pooled",
+        });
+
+        metrics
+    }
+
+    /// Publish operation counts if any were taken from the free lists.
+    fn publish_stats(&self, stats: Option<PoolStats>) {
+        let Some(PoolStats {
+            hits,
+            misses,
+            discards,
+        }) = stats
+        else {
+            return;
+        };
+
+        self.metrics.counter(POOL_HIT_COUNT).increment(hits);
+        self.metrics.counter(POOL_MISS_COUNT).increment(misses);
+        self.metrics.counter(POOL_DISCARD_COUNT).increment(discards);
+    }
+
+    /// Get an empty buffer with capacity for at least `len` bytes.
+    ///
+    /// Requests larger than the largest size class are allocated directly.
+    pub fn get(&self, len: usize) -> Vec<u8> {
+        let Some(class) = SizeClass::for_len(len) else {
+            return Vec::with_capacity(len);
+        };
+
+        // every buffer in a free list is at least as large as the capacity of its size class
+        let (buffer, stats) = with_free_lists(|lists| {
+            let buffer = lists.list(class).pop();
+
+            match buffer {
+                Some(_) => lists.stats.hits += 1,
+                None => lists.stats.misses += 1,
+            }
+
+            (buffer, lists.take_stats())
+        });
+        self.publish_stats(stats);
+
+        buffer.unwrap_or_else(|| Vec::with_capacity(class.capacity()))
+    }
+
+    /// Return `buffer` to the pool.
+    ///
+    /// The buffer is cleared before it's pooled and freed if it doesn't belong to any size class
+    /// or if the free list of its size class is full.
+    pub fn put(&self, mut buffer: Vec<u8>) {
+        let class = SizeClass::for_capacity(buffer.capacity());
+
+        let stats = with_free_lists(|lists| {
+            match class {
+                Some(class) if lists.list(class).len() < MAX_POOLED_BUFFERS => {
+                    buffer.clear();
+                    lists.list(class).push(buffer);
+                }
+                _ => lists.stats.discards += 1,
+            }
+
+            lists.take_stats()
+        });
+        self.publish_stats(stats);
+    }
+
+    /// Get number of free buffers in size class.
+    #[cfg(test)]
+    fn num_free(&self, class: SizeClass) -> usize {
+        with_free_lists(|lists| lists.list(class).len())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::runtime::mock::MockRuntime;
+
+    #[test]
+    fn size_classes() {
+        assert_eq!(SizeClass::for_len(0), Some(SizeClass::Tunnel));
+        assert_eq!(SizeClass::for_len(1028), Some(SizeClass::Tunnel));
+        assert_eq!(
+            SizeClass::for_len(TUNNEL_BUFFER_SIZE + 1),
+            Some(SizeClass::Mtu)
+        );
+        assert_eq!(SizeClass::for_len(MTU_BUFFER_SIZE), Some(SizeClass::Mtu));
+        assert_eq!(SizeClass::for_len(MTU_BUFFER_SIZE + 1), None);
+
+        assert_eq!(SizeClass::for_capacity(64), None);
+        assert_eq!(
+            SizeClass::for_capacity(TUNNEL_BUFFER_SIZE),
+            Some(SizeClass::Tunnel)
+        );
+        assert_eq!(
+            SizeClass::for_capacity(MTU_BUFFER_SIZE),
+            Some(SizeClass::Mtu)
+        );
+        assert_eq!(SizeClass::for_capacity(2 * MTU_BUFFER_SIZE), None);
+    }
+
+    #[tokio::test]
+    async fn buffers_are_reused() {
+        let pool = BufferPool::<MockRuntime>::new(MockRuntime::register_metrics(vec![], None));
+
+        // pool is empty so the buffer is allocated
+        let mut buffer = pool.get(1028);
+        assert_eq!(buffer.capacity(), TUNNEL_BUFFER_SIZE);
+
+        buffer.extend_from_slice(&[0xaa; 1028]);
+        let ptr = buffer.as_ptr();
+        pool.put(buffer);
+        assert_eq!(pool.num_free(SizeClass::Tunnel), 1);
+
+        // returned buffer is cleared and reused
+        let buffer = pool.get(512);
+        assert!(buffer.is_empty());
+        assert_eq!(buffer.as_ptr(), ptr);
+        assert_eq!(pool.num_free(SizeClass::Tunnel), 0);
+
+        // mtu-sized request doesn't use tunnel-sized buffers
+        pool.put(buffer);
+        assert_eq!(pool.get(1400).capacity(), MTU_BUFFER_SIZE);
+        assert_eq!(pool.num_free(SizeClass::Tunnel), 1);
+    }
+
+    #[tokio::test]
+    async fn foreign_buffers_are_discarded() {
+        let pool = BufferPool::<MockRuntime>::new(MockRuntime::register_metrics(vec![], None));
+
+        pool.put(Vec::with_capacity(16));
+        pool.put(Vec::with_capacity(0xffff));
+        assert_eq!(pool.num_free(SizeClass::Tunnel), 0);
+        assert_eq!(pool.num_free(SizeClass::Mtu), 0);
+
+        // oversized requests bypass the pool
+        assert!(pool.get(0xffff).capacity() >= 0xffff);
+        assert_eq!(pool.num_free(SizeClass::Mtu), 0);
+    }
+
+    #[tokio::test]
+    async fn free_list_is_bounded() {
+        let pool = BufferPool::<MockRuntime>::new(MockRuntime::register_metrics(vec![], None));
+
+        (0..MAX_POOLED_BUFFERS + 10).for_each(|_| pool.put(Vec::with_capacity(MTU_BUFFER_SIZE)));
+        assert_eq!(pool.num_free(SizeClass::Mtu), MAX_POOLED_BUFFERS);
+    }
+
+    #[tokio::test]
+    async fn free_lists_are_per_thread() {
+        let pool = BufferPool::<MockRuntime>::new(MockRuntime::register_metrics(vec![], None));
+
+        pool.put(Vec::with_capacity(TUNNEL_BUFFER_SIZE));
+        assert_eq!(pool.num_free(SizeClass::Tunnel), 1);
+
+        // buffers returned on another thread are not visible to this thread
+        let handle = pool.clone();
+        std::thread::spawn(move || {
+            assert_eq!(handle.num_free(SizeClass::Tunnel), 0);
+            handle.put(Vec::with_capacity(TUNNEL_BUFFER_SIZE));
+            handle.put(Vec::with_capacity(TUNNEL_BUFFER_SIZE));
+            assert_eq!(handle.num_free(SizeClass::Tunnel), 2);
+        })
+        .join()
+        .unwrap();
+
+        assert_eq!(pool.num_free(SizeClass::Tunnel), 1);
+    }
+
+    #[tokio::test]
+    async fn metrics_are_published_in_batches() {
+        let pool = BufferPool::<MockRuntime>::new(MockRuntime::register_metrics(vec![], None));
+
+        (0..METRICS_FLUSH_INTERVAL - 1).for_each(|_| {
+            let _ = pool.get(TUNNEL_BUFFER_SIZE);
+        });
+        assert_eq!(MockRuntime::get_counter_value(POOL_MISS_COUNT), None);
+
+        let _ = pool.get(TUNNEL_BUFFER_SIZE);
+        assert_eq!(
+            MockRuntime::get_counter_value(POOL_MISS_COUNT),
+            Some(METRICS_FLUSH_INTERVAL)
+        );
+    }
+}
@@ -272,6 +272,11 @@ impl Destination {
         self.destination_id.clone()
     }
 
+    /// Get identity hash of the [`Destination`].
+    pub fn identity_hash(&self) -> &Bytes {
+        &self.identity_hash
+    }
+
     /// Get reference to `SigningPublicKey` of the [`Destination`].
     pub fn verifying_key(&self) -> &SigningPublicKey {
         &self.verifying_key
@@ -0,0 +1,435 @@
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+use crate::{
+    crypto::{
+        blinding::{BlindedSigningKey, SIG_TYPE_REDDSA},
+        chachapoly::ChaCha,
+        hmac::hkdf,
+        sha256::Sha256,
+        SigningPublicKey,
+    },
+    primitives::{LeaseSet2, OfflineSignature, LOG_TARGET},
+    runtime::Runtime,
+};
+
+use bytes::{BufMut, Bytes, BytesMut};
+use nom::{
+    bytes::complete::take,
+    error::{make_error, ErrorKind},
+    number::complete::{be_u16, be_u32},
+    Err, IResult,
+};
+use rand_core::RngCore;
+
+use alloc::vec::Vec;
+use core::time::Duration;
+
+/// Store type of [`EncryptedLeaseSet`], prepended to the signed data.
+const ENCRYPTED_LEASE_SET: u8 = 5u8;
+
+/// Store type of [`LeaseSet2`], prepended to the inner plaintext.
+const LEASE_SET2: u8 = 3u8;
+
+/// [`EncryptedLeaseSet`] contains an offline signature.
+const OFFLINE_SIGNATURE: u16 = 1u16;
+
+/// [`EncryptedLeaseSet`] is unpublished.
+const UNPUBLISHED: u16 = 1u16 << 1;
+
+/// Per-client authorization flag of the first layer plaintext.
+const PER_CLIENT_AUTH: u8 = 1u8;
+
+/// Length of the salt prepended to each layer's ciphertext.
+const SALT_LEN: usize = 32usize;
+
+/// Blinded public key length.
+const BLINDED_KEY_LEN: usize = 32usize;
+
+/// Derive ChaCha20 key and IV for one encryption layer.
+fn layer_keys(
+    salt: &[u8],
+    subcredential: &[u8; 32],
+    published: u32,
+    info: &[u8],
+) -> ([u8; 32], [u8; 12]) {
+    let mut input = [0u8; 36];
+    input[..32].copy_from_slice(subcredential);
+    input[32..].copy_from_slice(&published.to_be_bytes());
+
+    let (key, rest) = hkdf(salt, &input, info);
+    let mut iv = [0u8; 12];
+    iv.copy_from_slice(&rest[..12]);
+
+    (key, iv)
+}
+
+/// Encrypt `plaintext` with a random salt and return `salt || ciphertext`.
+fn encrypt_layer<R: Runtime>(
+    plaintext: &[u8],
+    subcredential: &[u8; 32],
+    published: u32,
+    info: &[u8],
+) -> Vec<u8> {
+    let mut out = alloc::vec![0u8; SALT_LEN + plaintext.len()];
+    R::rng().fill_bytes(&mut out[..SALT_LEN]);
+
+    let (salt, ciphertext) = out.split_at_mut(SALT_LEN);
+    let (key, iv) = layer_keys(salt, subcredential, published, info);
+
+    ciphertext.copy_from_slice(plaintext);
+    ChaCha::with_iv(key, iv).encrypt_ref(ciphertext);
+
+    out
+}
+
+/// Decrypt `salt || ciphertext` and return the plaintext.
+fn decrypt_layer(
+    input: &[u8],
+    subcredential: &[u8; 32],
+    published: u32,
+    info: &[u8],
+) -> Option<Vec<u8>> {
+    if input.len() <= SALT_LEN {
+        return None;
+    }
+
+    let (salt, ciphertext) = input.split_at(SALT_LEN);
+    let (key, iv) = layer_keys(salt, subcredential, published, info);
+    let mut plaintext = ciphertext.to_vec();
+    ChaCha::with_iv(key, iv).decrypt_ref(&mut plaintext);
+
+    Some(plaintext)
+}
+
+/// Encrypted lease set.
+///
+/// The lease set is stored under the blinded key of the destination and its contents can only be
+/// decrypted by those who know the destination's public key.
+///
+/// Per-client authorization is not supported.
+///
+/// https://geti2p.net/spec/common-structures#encryptedleaseset
+#[derive(Debug, Clone)]
+pub struct EncryptedLeaseSet {
+    /// Blinded public key of the destination.
+    pub blinded_key: SigningPublicKey,
+
+    /// Outer ciphertext, including the salt.
+    pub ciphertext: Vec<u8>,
+
+    /// When does the lease set expire, in seconds since epoch.
+    pub expires: u32,
+
+    /// Is the lease set unpublished.
+    pub is_unpublished: bool,
+
+    /// Transient verifying key, if the lease set was signed with an offline signature.
+    pub offline_signature: Option<SigningPublicKey>,
+
+    /// When was the lease set published, in seconds since epoch.
+    pub published: u32,
+}
+
+impl EncryptedLeaseSet {
+    /// Encrypt serialized `lease_set` for the destination whose blinded key is `signing_key`.
+    ///
+    /// `lease_set` must be a serialized [`LeaseSet2`].
+    pub fn new<R: Runtime>(
+        lease_set: &[u8],
+        signing_key: &BlindedSigningKey,
+        published: u32,
+        expires: u32,
+    ) -> Self {
+        let subcredential = signing_key.public().subcredential();
+
+        // inner layer: lease set type followed by the lease set
+        let mut plaintext = Vec::with_capacity(lease_set.len() + 1);
+        plaintext.push(LEASE_SET2);
+        plaintext.extend_from_slice(lease_set);
+
+        let inner = encrypt_layer::<R>(&plaintext, subcredential, published, b"ELS2_L2K");
+
+        // outer layer: authorization flags followed by the inner ciphertext
+        let mut plaintext = Vec::with_capacity(inner.len() + 1);
+        plaintext.push(0u8);
+        plaintext.extend_from_slice(&inner);
+
+        Self {
+            blinded_key: signing_key.public().verifying_key().expect("valid blinded key"),
+            ciphertext: encrypt_layer::<R>(&plaintext, subcredential, published, b"ELS2_L1K"),
+            expires: published.saturating_add(expires),
+            is_unpublished: false,
+            offline_signature: None,
+            published,
+        }
+    }
+
+    /// Attempt to parse [`EncryptedLeaseSet`] from `input` and verify its signature.
+    ///
+    /// Returns the parsed message and rest of `input` on success.
+    pub fn parse_frame(input: &[u8]) -> IResult<&[u8], Self> {
+        let (rest, sig_type) = be_u16(input)?;
+
+        if sig_type != SIG_TYPE_REDDSA {
+            tracing::warn!(
+                target: LOG_TARGET,
+                ?sig_type,
+                "unsupported blinded key type for encrypted lease set",
+            );
+            return Err(Err::Error(make_error(input, ErrorKind::Fail)));
+        }
+
+        let (rest, key) = take(BLINDED_KEY_LEN)(rest)?;
+        let blinded_key = TryInto::<[u8; 32]>::try_into(key)
+            .ok()
+            .and_then(|key| SigningPublicKey::from_bytes(&key))
+            .ok_or_else(|| Err::Error(make_error(input, ErrorKind::Fail)))?;
+
+        let (rest, published) = be_u32(rest)?;
+        let (rest, expires) = be_u16(rest)?;
+        let (rest, flags) = be_u16(rest)?;
+
+        let (rest, offline_signature) = match flags & OFFLINE_SIGNATURE == 0 {
+            true => (rest, None),
+            false => {
+                let (rest, verifying_key) = OfflineSignature::parse_frame(rest, &blinded_key)?;
+                (rest, Some(verifying_key))
+            }
+        };
+
+        let (rest, size) = be_u16(rest)?;
+
+        if (size as usize) <= SALT_LEN + 1 {
+            tracing::warn!(
+                target: LOG_TARGET,
+                ?size,
+                "encrypted lease set is too short",
+            );
+            return Err(Err::Error(make_error(input, ErrorKind::Fail)));
+        }
+
+        let (rest, ciphertext) = take(size)(rest)?;
+        let verifying_key = offline_signature.as_ref().unwrap_or(&blinded_key);
+        let (rest, signature) = take(verifying_key.signature_len())(rest)?;
+
+        let signed_len = input.len() - rest.len() - signature.len();
+        let mut bytes = Vec::with_capacity(signed_len + 1);
+        bytes.push(ENCRYPTED_LEASE_SET);
+        bytes.extend_from_slice(&input[..signed_len]);
+
+        verifying_key.verify(&bytes, signature).map_err(|error| {
+            tracing::warn!(
+                target: LOG_TARGET,
+                ?error,
+                "invalid signature for encrypted lease set",
+            );
+
+            Err::Error(make_error(input, ErrorKind::Fail))
+        })?;
+
+        Ok((
+            rest,
+            Self {
+                blinded_key,
+                ciphertext: ciphertext.to_vec(),
+                expires: published.saturating_add(expires as u32),
+                is_unpublished: flags & UNPUBLISHED == UNPUBLISHED,
+                offline_signature,
+                published,
+            },
+        ))
+    }
+
+    /// Attempt to parse `input` into [`EncryptedLeaseSet`].
+    pub fn parse(input: &[u8]) -> Option<Self> {
+        Some(Self::parse_frame(input).ok()?.1)
+    }
+
+    /// Get serialized length of [`EncryptedLeaseSet`].
+    pub fn serialized_len(&self) -> usize {
+        // sig type + blinded key + published + expires + flags + length + ciphertext + signature
+        2usize
+            + BLINDED_KEY_LEN
+            + 4usize
+            + 2usize
+            + 2usize
+            + 2usize
+            + self.ciphertext.len()
+            + 64usize
+    }
+
+    /// Serialize [`EncryptedLeaseSet`] and sign it with the blinded `signing_key`.
+    ///
+    /// Offline signatures are not supported for local lease sets.
+    pub fn serialize<R: Runtime>(self, signing_key: &BlindedSigningKey) -> Vec<u8> {
+        let mut out = BytesMut::with_capacity(self.serialized_len() + 1);
+
+        out.put_u8(ENCRYPTED_LEASE_SET);
+        out.put_u16(SIG_TYPE_REDDSA);
+        out.put_slice(self.blinded_key.as_ref());
+        out.put_u32(self.published);
+        out.put_u16(self.expires.saturating_sub(self.published) as u16);
+        out.put_u16(if self.is_unpublished {
+            UNPUBLISHED
+        } else {
+            0u16
+        });
+        out.put_u16(self.ciphertext.len() as u16);
+        out.put_slice(&self.ciphertext);
+
+        let signature = signing_key.sign(&out, R::rng());
+        out.put_slice(&signature);
+
+        out[1..].to_vec()
+    }
+
+    /// Decrypt the lease set using `subcredential` of the destination.
+    ///
+    /// Returns `None` if decryption fails, if the lease set requires per-client authorization
+    /// or if the decrypted lease set is not a valid [`LeaseSet2`].
+    pub fn decrypt(&self, subcredential: &[u8; 32]) -> Option<LeaseSet2> {
+        let outer = decrypt_layer(&self.ciphertext, subcredential, self.published, b"ELS2_L1K")?;
+        let (flags, inner) = outer.split_first()?;
+
+        if flags & PER_CLIENT_AUTH != 0 {
+            tracing::debug!(
+                target: LOG_TARGET,
+                ?flags,
+                "per-client authorization not supported for encrypted lease sets",
+            );
+            return None;
+        }
+
+        let inner = decrypt_layer(inner, subcredential, self.published, b"ELS2_L2K")?;
+
+        match inner.split_first()? {
+            (&LEASE_SET2, lease_set) => LeaseSet2::parse(lease_set),
+            (kind, _) => {
+                tracing::debug!(
+                    target: LOG_TARGET,
+                    ?kind,
+                    "unsupported inner lease set type",
+                );
+                None
+            }
+        }
+    }
+
+    /// Get `NetDb` key of the [`EncryptedLeaseSet`].
+    pub fn routing_key(&self) -> Bytes {
+        Bytes::from(
+            Sha256::new()
+                .update(SIG_TYPE_REDDSA.to_be_bytes())
+                .update(self.blinded_key.as_ref())
+                .finalize(),
+        )
+    }
+
+    /// Has the [`EncryptedLeaseSet`] expired.
+    pub fn is_expired<R: Runtime>(&self) -> bool {
+        self.expires < R::time_since_epoch().as_secs() as u32
+    }
+
+    /// When does the [`EncryptedLeaseSet`] expire, from seconds since epoch.
+    pub fn expires(&self) -> Duration {
+        Duration::from_secs(self.expires as u64)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{
+        crypto::{
+            blinding::{blinding_date, BlindedPublicKey},
+            SigningPrivateKey,
+        },
+        runtime::mock::MockRuntime,
+    };
+
+    fn encrypted_lease_set() -> (Vec<u8>, LeaseSet2, SigningPrivateKey) {
+        let (lease_set, signing_key) = LeaseSet2::random();
+        let serialized = lease_set.clone().serialize(&signing_key);
+        let blinded = BlindedSigningKey::new(
+            &signing_key,
+            &blinding_date(MockRuntime::time_since_epoch()),
+            None,
+        );
+        let published = MockRuntime::time_since_epoch().as_secs() as u32;
+
+        (
+            EncryptedLeaseSet::new::<MockRuntime>(&serialized, &blinded, published, 600)
+                .serialize::<MockRuntime>(&blinded),
+            lease_set,
+            signing_key,
+        )
+    }
+
+    #[test]
+    fn encrypt_and_decrypt() {
+        let (serialized, lease_set, signing_key) = encrypted_lease_set();
+        let encrypted = EncryptedLeaseSet::parse(&serialized).unwrap();
+
+        // lease set is stored under the blinded key, not the destination id
+        let blinded = BlindedPublicKey::new(
+            &signing_key.public(),
+            &blinding_date(MockRuntime::time_since_epoch()),
+            None,
+        )
+        .unwrap();
+        assert_eq!(&encrypted.routing_key(), blinded.routing_key());
+        assert_ne!(
+            encrypted.routing_key(),
+            Bytes::from(lease_set.header.destination.id().to_vec())
+        );
+        assert!(!encrypted.is_expired::<MockRuntime>());
+
+        let decrypted = encrypted.decrypt(blinded.subcredential()).unwrap();
+        assert_eq!(
+            decrypted.header.destination.id(),
+            lease_set.header.destination.id()
+        );
+        assert_eq!(decrypted.leases, lease_set.leases);
+    }
+
+    #[test]
+    fn wrong_subcredential() {
+        let (serialized, _, _) = encrypted_lease_set();
+        let encrypted = EncryptedLeaseSet::parse(&serialized).unwrap();
+
+        let other = SigningPrivateKey::random(MockRuntime::rng());
+        let blinded = BlindedPublicKey::new(
+            &other.public(),
+            &blinding_date(MockRuntime::time_since_epoch()),
+            None,
+        )
+        .unwrap();
+
+        assert!(encrypted.decrypt(blinded.subcredential()).is_none());
+    }
+
+    #[test]
+    fn invalid_signature() {
+        let (mut serialized, _, _) = encrypted_lease_set();
+        let len = serialized.len();
+        serialized[len - 70] ^= 0xff;
+
+        assert!(EncryptedLeaseSet::parse(&serialized).is_none());
+    }
+}
@@ -21,6 +21,7 @@ use core::{fmt, ops::Deref};
 pub use capabilities::Capabilities;
 pub use date::Date;
 pub use destination::{Destination, DestinationId};
+pub use encrypted_lease_set::EncryptedLeaseSet;
 pub use lease_set::{Lease, LeaseSet2, LeaseSet2Header};
 pub use mapping::Mapping;
 pub use offline_signature::OfflineSignature;
@@ -35,6 +36,7 @@ pub use router_info::RouterInfoBuilder;
 mod capabilities;
 mod date;
 mod destination;
+mod encrypted_lease_set;
 mod lease_set;
 mod mapping;
 mod offline_signature;
@@ -27,6 +27,9 @@ pub enum Protocol {
 
     /// Raw datagrams.
     Anonymous,
+
+    /// Repliable datagrams with replay protection (`DATAGRAM2`).
+    Datagram2,
 }
 
 impl Protocol {
@@ -36,6 +39,7 @@ impl Protocol {
             6u8 => Some(Self::Streaming),
             17u8 => Some(Self::Datagram),
             18u8 => Some(Self::Anonymous),
+            19u8 => Some(Self::Datagram2),
             _ => {
                 tracing::warn!(?protocol, "unknown i2cp protocol");
                 None
@@ -49,6 +53,7 @@ impl Protocol {
             Self::Streaming => 6u8,
             Self::Datagram => 17u8,
             Self::Anonymous => 18u8,
+            Self::Datagram2 => 19u8,
         }
     }
 }
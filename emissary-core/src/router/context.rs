@@ -19,6 +19,7 @@
 use crate::{
     crypto::{SigningPrivateKey, StaticPrivateKey},
     events::EventHandle,
+    pool::BufferPool,
     primitives::RouterId,
     profile::ProfileStorage,
     runtime::Runtime,
@@ -36,6 +37,9 @@ use alloc::sync::Arc;
 
 /// Inner router context.
 struct InnerRouterContext<R: Runtime> {
+    /// Buffer pool.
+    buffer_pool: BufferPool<R>,
+
     /// Metrics handle.
     metrics_handle: R::MetricsHandle,
 
@@ -93,6 +97,7 @@ impl<R: Runtime> RouterContext<R> {
         Self {
             event_handle,
             inner: Arc::new(InnerRouterContext {
+                buffer_pool: BufferPool::new(metrics_handle.clone()),
                 metrics_handle,
                 net_id,
                 noise: NoiseContext::new(static_key.clone(), Bytes::from(router_id.to_vec())),
@@ -133,6 +138,11 @@ impl<R: Runtime> RouterContext<R> {
         &self.inner.metrics_handle
     }
 
+    /// Get reference to [`BufferPool`].
+    pub fn buffer_pool(&self) -> &BufferPool<R> {
+        &self.inner.buffer_pool
+    }
+
     /// Get reference to [`ProfileStorage`].
     pub fn profile_storage(&self) -> &ProfileStorage<R> {
         &self.profile_storage
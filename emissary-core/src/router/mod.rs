@@ -19,10 +19,12 @@
 use crate::{
     config::{Config, I2cpConfig, MetricsConfig, SamConfig},
     crypto::{SigningPrivateKey, StaticPrivateKey},
+    destination::Destination,
     error::Error,
     events::{EventManager, EventSubscriber},
     i2cp::I2cpServer,
     netdb::NetDb,
+    pool::BufferPool,
     primitives::RouterInfo,
     profile::ProfileStorage,
     router::context::RouterContext,
@@ -258,6 +260,9 @@ impl<R: Runtime> Router<R> {
                 let metrics = TransportManager::<R>::metrics(Vec::new());
                 let metrics = TunnelManager::<R>::metrics(metrics);
                 let metrics = NetDb::<R>::metrics(metrics);
+                let metrics = SamServer::<R>::metrics(metrics);
+                let metrics = Destination::<R>::metrics(metrics);
+                let metrics = BufferPool::<R>::metrics(metrics);
 
                 R::register_metrics(metrics, Some(port))
             }
@@ -344,12 +349,19 @@ impl<R: Runtime> Router<R> {
         transport_manager_builder.register_netdb_handle(netdb_handle.clone());
 
         // initialize i2cp server if it was enabled
-        if let Some(I2cpConfig { host, port }) = i2cp_config {
+        if let Some(I2cpConfig {
+            host,
+            port,
+            unix_socket,
+        }) = i2cp_config
+        {
             let i2cp_server = I2cpServer::<R>::new(
                 host,
                 port,
+                unix_socket,
                 netdb_handle.clone(),
                 tunnel_manager_handle.clone(),
+                metrics_handle.clone(),
                 address_book.clone(),
                 profile_storage.clone(),
             )
@@ -362,12 +374,14 @@ impl<R: Runtime> Router<R> {
             tcp_port,
             udp_port,
             host,
+            unix_socket,
         }) = samv3_config
         {
             let sam_server = SamServer::<R>::new(
                 tcp_port,
                 udp_port,
                 host,
+                unix_socket,
                 netdb_handle.clone(),
                 tunnel_manager_handle.clone(),
                 metrics_handle,
@@ -20,7 +20,7 @@ use crate::{
     error::{ConnectionError, Error},
     runtime::{
         AsyncRead, AsyncWrite, Counter, Gauge, Histogram, Instant as InstantT, JoinSet,
-        MetricsHandle, Runtime, TcpListener, UdpSocket,
+        MetricsHandle, Runtime, TcpListener, UdpSocket, UnixListener, UnixStream,
     },
 };
 
@@ -38,7 +38,7 @@ use tokio_util::compat::{Compat, TokioAsyncReadCompatExt, TokioAsyncWriteCompatE
 use std::{
     collections::HashMap,
     future::Future,
-    io::Write,
+    io::{IoSlice, Write},
     net::SocketAddr,
     pin::{pin, Pin},
     sync::{Arc, LazyLock},
@@ -46,6 +46,9 @@ use std::{
     time::{Duration, Instant, SystemTime},
 };
 
+/// Maximum number of buffers passed to a single vectored write.
+const MAX_IO_SLICES: usize = 4usize;
+
 pub struct MockTcpStream(Compat<net::TcpStream>);
 
 impl MockTcpStream {
@@ -86,6 +89,26 @@ impl AsyncWrite for MockTcpStream {
         }
     }
 
+    fn poll_write_vectored(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        bufs: &[&[u8]],
+    ) -> Poll<crate::Result<usize>> {
+        let mut slices = [IoSlice::new(&[]); MAX_IO_SLICES];
+        let num_slices = bufs.len().min(MAX_IO_SLICES);
+
+        for (slice, buf) in slices.iter_mut().zip(bufs) {
+            *slice = IoSlice::new(buf);
+        }
+
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_write_vectored(cx, &slices[..num_slices])) {
+            Ok(nwritten) => Poll::Ready(Ok(nwritten)),
+            Err(_) => Poll::Ready(Err(Error::Connection(ConnectionError::SocketClosed))),
+        }
+    }
+
     fn poll_flush(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<crate::Result<()>> {
         let pinned = pin!(&mut self.0);
 
@@ -137,6 +160,111 @@ impl TcpListener<MockTcpStream> for MockTcpListener {
     }
 }
 
+#[cfg(unix)]
+pub struct MockUnixStream(Compat<net::UnixStream>);
+
+#[cfg(unix)]
+impl MockUnixStream {
+    pub fn new(stream: net::UnixStream) -> Self {
+        let stream = TokioAsyncReadCompatExt::compat(stream).into_inner();
+        let stream = TokioAsyncWriteCompatExt::compat_write(stream);
+
+        Self(stream)
+    }
+
+    /// Connect to Unix domain socket at `path`.
+    pub async fn connect(path: &str) -> Option<Self> {
+        net::UnixStream::connect(path).await.ok().map(Self::new)
+    }
+}
+
+#[cfg(unix)]
+impl AsyncRead for MockUnixStream {
+    fn poll_read(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &mut [u8],
+    ) -> Poll<crate::Result<usize>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_read(cx, buf)) {
+            Ok(nread) => Poll::Ready(Ok(nread)),
+            Err(_) => Poll::Ready(Err(Error::Connection(ConnectionError::SocketClosed))),
+        }
+    }
+}
+
+#[cfg(unix)]
+impl AsyncWrite for MockUnixStream {
+    fn poll_write(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &[u8],
+    ) -> Poll<crate::Result<usize>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_write(cx, buf)) {
+            Ok(nwritten) => Poll::Ready(Ok(nwritten)),
+            Err(_) => Poll::Ready(Err(Error::Connection(ConnectionError::SocketClosed))),
+        }
+    }
+
+    fn poll_flush(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<crate::Result<()>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_flush(cx)) {
+            Ok(()) => Poll::Ready(Ok(())),
+            Err(_) => Poll::Ready(Err(Error::Connection(ConnectionError::SocketClosed))),
+        }
+    }
+
+    fn poll_close(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<crate::Result<()>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_close(cx)) {
+            Ok(()) => Poll::Ready(Ok(())),
+            Err(_) => Poll::Ready(Err(Error::Connection(ConnectionError::SocketClosed))),
+        }
+    }
+}
+
+#[cfg(unix)]
+impl UnixStream for MockUnixStream {}
+
+#[cfg(not(unix))]
+impl UnixStream for MockTcpStream {}
+
+#[cfg(unix)]
+pub struct MockUnixListener(net::UnixListener);
+
+#[cfg(unix)]
+impl UnixListener<MockUnixStream> for MockUnixListener {
+    async fn bind(path: &str) -> Option<Self> {
+        net::UnixListener::bind(path).ok().map(MockUnixListener)
+    }
+
+    fn poll_accept(&mut self, cx: &mut Context<'_>) -> Poll<Option<MockUnixStream>> {
+        match futures::ready!(self.0.poll_accept(cx)) {
+            Err(_) => Poll::Ready(None),
+            Ok((stream, _)) => Poll::Ready(Some(MockUnixStream::new(stream))),
+        }
+    }
+}
+
+#[cfg(not(unix))]
+pub struct MockUnixListener(());
+
+#[cfg(not(unix))]
+impl UnixListener<MockTcpStream> for MockUnixListener {
+    async fn bind(_path: &str) -> Option<Self> {
+        None
+    }
+
+    fn poll_accept(&mut self, _cx: &mut Context<'_>) -> Poll<Option<MockTcpStream>> {
+        Poll::Pending
+    }
+}
+
 pub struct MockUdpSocket(net::UdpSocket);
 
 impl UdpSocket for MockUdpSocket {
@@ -309,6 +437,11 @@ impl Runtime for MockRuntime {
     type TcpStream = MockTcpStream;
     type UdpSocket = MockUdpSocket;
     type TcpListener = MockTcpListener;
+    #[cfg(unix)]
+    type UnixStream = MockUnixStream;
+    #[cfg(not(unix))]
+    type UnixStream = MockTcpStream;
+    type UnixListener = MockUnixListener;
     type JoinSet<T: Send + 'static> = MockJoinSet<T>;
     type MetricsHandle = MockMetricsHandle;
     type Instant = MockInstant;
@@ -50,6 +50,20 @@ pub trait AsyncWrite {
         cx: &mut Context<'_>,
         buf: &[u8],
     ) -> Poll<crate::Result<usize>>;
+
+    /// Write data from `bufs` into the stream, in order, with a single write if possible.
+    ///
+    /// The default implementation writes only the first non-empty buffer.
+    fn poll_write_vectored(
+        self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        bufs: &[&[u8]],
+    ) -> Poll<crate::Result<usize>> {
+        let buf = bufs.iter().find(|buf| !buf.is_empty()).copied().unwrap_or_default();
+
+        self.poll_write(cx, buf)
+    }
+
     fn poll_flush(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<crate::Result<()>>;
     fn poll_close(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<crate::Result<()>>;
 }
@@ -65,6 +79,22 @@ pub trait TcpListener<TcpStream>: Unpin + Send + Sized + 'static {
     fn local_address(&self) -> Option<SocketAddr>;
 }
 
+/// Unix domain socket stream.
+///
+/// Runtimes for platforms without Unix domain sockets may use their TCP stream type as long as
+/// their [`UnixListener`] never binds.
+pub trait UnixStream: AsyncRead + AsyncWrite + Unpin + Send + Sync + Sized + 'static {}
+
+pub trait UnixListener<UnixStream>: Unpin + Send + Sized + 'static {
+    /// Bind to a Unix domain socket at `path`.
+    ///
+    /// Returns `None` if binding failed or if the platform doesn't support Unix domain sockets.
+    fn bind(path: &str) -> impl Future<Output = Option<Self>>;
+
+    /// Poll next inbound connection.
+    fn poll_accept(&mut self, cx: &mut Context<'_>) -> Poll<Option<UnixStream>>;
+}
+
 pub trait UdpSocket: Unpin + Send + Sized {
     fn bind(address: SocketAddr) -> impl Future<Output = Option<Self>>;
     fn poll_send_to(
@@ -156,6 +186,8 @@ pub trait Runtime: Clone + Unpin + Send + 'static {
     type TcpStream: TcpStream;
     type UdpSocket: UdpSocket;
     type TcpListener: TcpListener<Self::TcpStream>;
+    type UnixStream: UnixStream;
+    type UnixListener: UnixListener<Self::UnixStream>;
     type JoinSet<T: Send + 'static>: JoinSet<T>;
     type MetricsHandle: MetricsHandle;
     type Instant: Instant;
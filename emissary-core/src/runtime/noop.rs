@@ -18,7 +18,7 @@
 
 use crate::runtime::{
     AsyncRead, AsyncWrite, Counter, Gauge, Histogram, Instant as InstantT, JoinSet, MetricsHandle,
-    Runtime, TcpListener, UdpSocket,
+    Runtime, TcpListener, UdpSocket, UnixListener, UnixStream,
 };
 
 use futures::Stream;
@@ -92,6 +92,21 @@ impl TcpListener<NoopTcpStream> for NoopTcpListener {
     }
 }
 
+impl UnixStream for NoopTcpStream {}
+
+#[derive(Debug)]
+pub struct NoopUnixListener {}
+
+impl UnixListener<NoopTcpStream> for NoopUnixListener {
+    fn bind(_path: &str) -> impl Future<Output = Option<Self>> {
+        std::future::pending()
+    }
+
+    fn poll_accept(&mut self, _cx: &mut Context<'_>) -> Poll<Option<NoopTcpStream>> {
+        Poll::Pending
+    }
+}
+
 pub struct NoopUdpSocket();
 
 impl UdpSocket for NoopUdpSocket {
@@ -220,6 +235,8 @@ impl Runtime for NoopRuntime {
     type TcpStream = NoopTcpStream;
     type UdpSocket = NoopUdpSocket;
     type TcpListener = NoopTcpListener;
+    type UnixStream = NoopTcpStream;
+    type UnixListener = NoopUnixListener;
     type JoinSet<T: Send + 'static> = NoopJoinSet<T>;
     type MetricsHandle = NoopMetricsHandle;
     type Instant = NoopInstant;
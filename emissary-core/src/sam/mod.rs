@@ -27,15 +27,16 @@ use crate::{
     netdb::NetDbHandle,
     primitives::{DestinationId, Str},
     profile::ProfileStorage,
-    runtime::{AddressBook, JoinSet, Runtime, TcpListener, UdpSocket},
+    runtime::{AddressBook, JoinSet, MetricType, Runtime, TcpListener, UdpSocket, UnixListener},
     sam::{
-        parser::{Datagram, HostKind, SessionKind},
+        parser::{Datagram, HostKind, SessionKind, StreamOptions},
         pending::{
             connection::{ConnectionKind, PendingSamConnection},
             session::{PendingSamSession, SamSessionContext},
         },
+        protocol::streaming::StreamManager,
         session::{SamSession, SamSessionCommand, SamSessionCommandRecycle},
-        socket::SamSocket,
+        socket::{SamSocket, SamStream},
     },
     tunnel::{TunnelManagerHandle, TunnelPoolConfig},
 };
@@ -239,14 +240,13 @@ pub struct SamServer<R: Runtime> {
     host_lookups: R::JoinSet<(
         Arc<str>,
         SamSocket<R>,
-        Option<(DestinationId, HashMap<String, String>)>,
+        Option<(DestinationId, StreamOptions)>,
     )>,
 
     /// TCP listener.
     listener: R::TcpListener,
 
     /// Metrics handle.
-    #[allow(unused)]
     metrics: R::MetricsHandle,
 
     /// Handle to `NetDb`.
@@ -282,6 +282,9 @@ pub struct SamServer<R: Runtime> {
 
     /// Handle to `TunnelManager`.
     tunnel_manager_handle: TunnelManagerHandle,
+
+    /// Unix domain socket listener, if enabled.
+    unix_listener: Option<R::UnixListener>,
 }
 
 impl<R: Runtime> SamServer<R> {
@@ -290,6 +293,7 @@ impl<R: Runtime> SamServer<R> {
         tcp_port: u16,
         udp_port: u16,
         host: String,
+        unix_socket: Option<String>,
         netdb_handle: NetDbHandle,
         tunnel_manager_handle: TunnelManagerHandle,
         metrics: R::MetricsHandle,
@@ -319,6 +323,23 @@ impl<R: Runtime> SamServer<R> {
             "starting sam server",
         );
 
+        let unix_listener = match unix_socket {
+            None => None,
+            Some(path) => {
+                tracing::info!(
+                    target: LOG_TARGET,
+                    %path,
+                    "starting sam server on unix domain socket",
+                );
+
+                Some(
+                    R::UnixListener::bind(&path)
+                        .await
+                        .ok_or(Error::Connection(ConnectionError::BindFailure))?,
+                )
+            }
+        };
+
         let (datagram_tx, datagram_rx) = channel(1024);
         let (sub_session_tx, sub_session_rx) = channel(64);
 
@@ -343,9 +364,15 @@ impl<R: Runtime> SamServer<R> {
             sub_session_rx,
             sub_session_tx,
             tunnel_manager_handle,
+            unix_listener,
         })
     }
 
+    /// Collect SAMv3-related metric counters, gauges and histograms.
+    pub fn metrics(metrics: Vec<MetricType>) -> Vec<MetricType> {
+        StreamManager::<R>::metrics(metrics)
+    }
+
     /// Get address of the SAMv3 TCP listener.
     pub fn tcp_local_address(&self) -> Option<SocketAddr> {
         self.listener.local_address()
@@ -368,7 +395,23 @@ impl<R: Runtime> Future for SamServer<R> {
                 Poll::Pending => break,
                 Poll::Ready(None) => return Poll::Ready(()),
                 Poll::Ready(Some((stream, _))) => {
-                    this.pending_inbound_connections.push(PendingSamConnection::new(stream));
+                    this.pending_inbound_connections
+                        .push(PendingSamConnection::new(SamStream::Tcp(stream)));
+                }
+            }
+        }
+
+        loop {
+            let Some(listener) = this.unix_listener.as_mut() else {
+                break;
+            };
+
+            match listener.poll_accept(cx) {
+                Poll::Pending => break,
+                Poll::Ready(None) => return Poll::Ready(()),
+                Poll::Ready(Some(stream)) => {
+                    this.pending_inbound_connections
+                        .push(PendingSamConnection::new(SamStream::Unix(stream)));
                 }
             }
         }
@@ -572,6 +615,7 @@ impl<R: Runtime> Future for SamServer<R> {
                                 this.profile_storage.clone(),
                                 core::matches!(session_kind, SessionKind::Primary)
                                     .then(|| this.sub_session_tx.clone()),
+                                this.metrics.clone(),
                             )
                             .run(),
                         );
@@ -874,3 +918,80 @@ impl<R: Runtime> Future for SamServer<R> {
         Poll::Pending
     }
 }
+
+#[cfg(all(test, unix))]
+mod tests {
+    use super::*;
+    use crate::{events::EventManager, runtime::mock::MockRuntime};
+    use core::time::Duration;
+    use tokio::{
+        io::{AsyncBufReadExt, AsyncWriteExt, BufReader},
+        net::UnixStream,
+    };
+
+    fn socket_path() -> String {
+        std::env::temp_dir()
+            .join(format!("emissary-sam-{}.sock", rand::random::<u64>()))
+            .to_str()
+            .unwrap()
+            .to_string()
+    }
+
+    async fn make_server(path: &str) -> crate::Result<SamServer<MockRuntime>> {
+        let (netdb_handle, _) = NetDbHandle::create();
+        let (tunnel_manager_handle, _) = TunnelManagerHandle::create();
+        let (_event_mgr, _event_subscriber, event_handle) = EventManager::<MockRuntime>::new(None);
+
+        SamServer::<MockRuntime>::new(
+            0u16,
+            0u16,
+            "127.0.0.1".to_string(),
+            Some(path.to_string()),
+            netdb_handle,
+            tunnel_manager_handle,
+            MockRuntime::register_metrics(Vec::new(), None),
+            None,
+            event_handle,
+            ProfileStorage::new(&[], &[]),
+        )
+        .await
+    }
+
+    #[tokio::test]
+    async fn unix_socket_client_handshaked() {
+        let path = socket_path();
+        let mut server = make_server(&path).await.unwrap();
+
+        let mut client = UnixStream::connect(&path).await.unwrap();
+        client.write_all(b"HELLO VERSION\n").await.unwrap();
+
+        tokio::time::timeout(Duration::from_secs(1), &mut server).await.unwrap_err();
+
+        let mut reader = BufReader::new(client);
+        let mut response = String::new();
+        tokio::time::timeout(Duration::from_secs(1), reader.read_line(&mut response))
+            .await
+            .unwrap()
+            .unwrap();
+        assert_eq!(response, "HELLO REPLY RESULT=OK VERSION=3.2\n");
+
+        // connection is waiting for the client to send a command
+        assert_eq!(server.pending_inbound_connections.len(), 1);
+
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[tokio::test]
+    async fn unix_socket_bind_failure_is_reported() {
+        let path = socket_path();
+        std::fs::write(&path, b"hello, world").unwrap();
+
+        assert!(std::matches!(
+            make_server(&path).await,
+            Err(Error::Connection(ConnectionError::BindFailure))
+        ));
+        assert_eq!(std::fs::read(&path).unwrap(), b"hello, world");
+
+        let _ = std::fs::remove_file(&path);
+    }
+}
@@ -29,7 +29,7 @@ use nom::{
     character::complete::{alpha1, alphanumeric1, char, multispace0},
     combinator::{map, opt, recognize},
     error::{make_error, ErrorKind},
-    multi::{many0, many0_count},
+    multi::many0_count,
     sequence::{delimited, pair, preceded, separated_pair, tuple},
     Err, IResult, Parser,
 };
@@ -45,6 +45,96 @@ use core::{fmt, marker::PhantomData};
 /// Logging target for the file.
 const LOG_TARGET: &str = "emissary::sam::parser";
 
+/// Maximum number of key-value pairs accepted in a single command.
+const MAX_KEY_VALUE_PAIRS: usize = 64usize;
+
+/// Key-value pairs of a command.
+///
+/// Commands carry only a handful of options so the pairs are stored inline and looked up with a
+/// linear scan, avoiding a heap-allocated map for every command read from the control socket.
+///
+/// Like a map, inserting a key that already exists overwrites its value.
+struct KeyValuePairs<'a> {
+    /// Key-value pairs, only the first `len` entries are valid.
+    pairs: [(&'a str, &'a str); MAX_KEY_VALUE_PAIRS],
+
+    /// Number of valid key-value pairs.
+    len: usize,
+}
+
+impl<'a> KeyValuePairs<'a> {
+    /// Create new, empty [`KeyValuePairs`].
+    fn new() -> Self {
+        Self {
+            pairs: [("", ""); MAX_KEY_VALUE_PAIRS],
+            len: 0usize,
+        }
+    }
+
+    /// Get index of `key`, if it exists.
+    fn position(&self, key: &str) -> Option<usize> {
+        self.pairs[..self.len].iter().position(|(k, _)| *k == key)
+    }
+
+    /// Get value of `key`.
+    fn get(&self, key: &str) -> Option<&&'a str> {
+        self.position(key).map(|index| &self.pairs[index].1)
+    }
+
+    /// Insert `key` with `value`, overwriting the previous value of `key` if it exists.
+    ///
+    /// Returns `false` if the pair couldn't be inserted because the storage is full.
+    fn insert(&mut self, key: &'a str, value: &'a str) -> bool {
+        if let Some(index) = self.position(key) {
+            self.pairs[index].1 = value;
+            return true;
+        }
+
+        if self.len == MAX_KEY_VALUE_PAIRS {
+            return false;
+        }
+
+        self.pairs[self.len] = (key, value);
+        self.len += 1;
+
+        true
+    }
+
+    /// Remove `key` and return its value, if it exists.
+    fn remove(&mut self, key: &str) -> Option<&'a str> {
+        let index = self.position(key)?;
+        let (_, value) = self.pairs[index];
+
+        self.len -= 1;
+        self.pairs.swap(index, self.len);
+
+        Some(value)
+    }
+}
+
+impl<'a> IntoIterator for KeyValuePairs<'a> {
+    type Item = (&'a str, &'a str);
+    type IntoIter =
+        core::iter::Take<core::array::IntoIter<(&'a str, &'a str), MAX_KEY_VALUE_PAIRS>>;
+
+    fn into_iter(self) -> Self::IntoIter {
+        self.pairs.into_iter().take(self.len)
+    }
+}
+
+#[cfg(test)]
+impl<'a, const N: usize> From<[(&'a str, &'a str); N]> for KeyValuePairs<'a> {
+    fn from(pairs: [(&'a str, &'a str); N]) -> Self {
+        let mut key_value_pairs = KeyValuePairs::new();
+
+        for (key, value) in pairs {
+            assert!(key_value_pairs.insert(key, value));
+        }
+
+        key_value_pairs
+    }
+}
+
 /// Parsed command.
 ///
 /// Represent a command that had value form but isn't necessarily
@@ -61,7 +151,7 @@ struct ParsedCommand<'a, R: Runtime> {
     subcommand: Option<&'a str>,
 
     /// Parsed key-value pairs.
-    key_value_pairs: HashMap<&'a str, &'a str>,
+    key_value_pairs: KeyValuePairs<'a>,
 
     /// Marker for `Runtime.`
     _runtime: PhantomData<R>,
@@ -79,10 +169,20 @@ pub enum SessionKind {
     /// Anonymous datagrams.
     Anonymous,
 
+    /// Repliable datagram with replay protection (`DATAGRAM2`).
+    Datagram2,
+
     /// Primary sessions.
     Primary,
 }
 
+impl SessionKind {
+    /// Is this a datagram session kind.
+    pub fn is_datagram(&self) -> bool {
+        core::matches!(self, Self::Datagram | Self::Anonymous | Self::Datagram2)
+    }
+}
+
 /// Supported SAM versions.
 #[derive(Debug, PartialEq, Eq, Clone, Copy)]
 pub enum SamVersion {
@@ -197,6 +297,41 @@ impl PartialEq for HostKind {
 
 impl Eq for HostKind {}
 
+/// Options of `STREAM CONNECT`, `STREAM ACCEPT` and `STREAM FORWARD`.
+///
+/// Stream commands only recognize a fixed set of options so they're parsed when the command is
+/// read and unrecognized options are ignored.
+#[derive(Debug, Default, PartialEq, Eq, Clone, Copy)]
+pub struct StreamOptions {
+    /// Whether the stream is silent (`SILENT`).
+    pub silent: bool,
+
+    /// Source port of the stream (`FROM_PORT`).
+    pub from_port: u16,
+
+    /// Destination port of the stream (`TO_PORT`).
+    pub to_port: u16,
+}
+
+impl StreamOptions {
+    /// Parse [`StreamOptions`] from `key_value_pairs`.
+    ///
+    /// Invalid values are replaced with defaults.
+    fn from_key_value_pairs(key_value_pairs: &KeyValuePairs<'_>) -> Self {
+        Self {
+            silent: key_value_pairs
+                .get("SILENT")
+                .is_some_and(|value| value.parse::<bool>().unwrap_or(false)),
+            from_port: key_value_pairs
+                .get("FROM_PORT")
+                .map_or(0u16, |value| value.parse::<u16>().unwrap_or(0u16)),
+            to_port: key_value_pairs
+                .get("TO_PORT")
+                .map_or(0u16, |value| value.parse::<u16>().unwrap_or(0u16)),
+        }
+    }
+}
+
 /// SAMv3 commands received from the client.
 #[derive(Debug, PartialEq, Eq, Clone)]
 pub enum SamCommand {
@@ -244,8 +379,8 @@ pub enum SamCommand {
         /// Host where to connect to.
         host: HostKind,
 
-        /// Session options.
-        options: HashMap<String, String>,
+        /// Stream options.
+        options: StreamOptions,
     },
 
     /// `STREAM ACCEPT` message.
@@ -253,8 +388,8 @@ pub enum SamCommand {
         /// Session ID.
         session_id: String,
 
-        /// Session options.
-        options: HashMap<String, String>,
+        /// Stream options.
+        options: StreamOptions,
     },
 
     /// `STREAM FORWARD` message.
@@ -265,10 +400,15 @@ pub enum SamCommand {
         /// Port where the TCP listener is listening on.
         port: u16,
 
-        /// Session options.
-        options: HashMap<String, String>,
+        /// Stream options.
+        options: StreamOptions,
     },
 
+    /// `STREAM STATS` message.
+    ///
+    /// Sent on the control socket of an active session to dump diagnostics of its streams.
+    StreamStats,
+
     /// `NAMING LOOKUP` message.
     NamingLookup {
         /// Hostname to lookup.
@@ -300,6 +440,7 @@ impl fmt::Display for SamCommand {
                 write!(f, "SamCommand::StreamConnect({session_id})"),
             Self::Accept { session_id, .. } => write!(f, "SamCommand::StreamAccept({session_id})"),
             Self::Forward { session_id, .. } => write!(f, "SamCommand::Forward({session_id})"),
+            Self::StreamStats => write!(f, "SamCommand::StreamStats"),
             Self::NamingLookup { name } => write!(f, "SamCommand::NamingLookup({name})"),
             Self::GenerateDestination => write!(f, "SamCommand::GenerateDestination"),
             Self::Dummy => unreachable!(),
@@ -372,7 +513,7 @@ impl<'a, R: Runtime> TryFrom<ParsedCommand<'a, R>> for SamCommand {
                 let session_kind = match parsed_cmd.key_value_pairs.remove("STYLE") {
                     Some("STREAM") => SessionKind::Stream,
                     Some("PRIMARY") => SessionKind::Primary,
-                    style @ (Some("RAW") | Some("DATAGRAM")) => {
+                    style @ (Some("RAW") | Some("DATAGRAM") | Some("DATAGRAM2")) => {
                         // currently only forwarded datagrams are supported
                         let _ = parsed_cmd.key_value_pairs.get("PORT").ok_or_else(|| {
                             tracing::warn!(
@@ -389,6 +530,7 @@ impl<'a, R: Runtime> TryFrom<ParsedCommand<'a, R>> for SamCommand {
                         match style {
                             Some("RAW") => SessionKind::Anonymous,
                             Some("DATAGRAM") => SessionKind::Datagram,
+                            Some("DATAGRAM2") => SessionKind::Datagram2,
                             _ => unreachable!(),
                         }
                     }
@@ -478,7 +620,7 @@ impl<'a, R: Runtime> TryFrom<ParsedCommand<'a, R>> for SamCommand {
                         );
                         return Err(());
                     }
-                    style @ (Some("RAW") | Some("DATAGRAM")) => {
+                    style @ (Some("RAW") | Some("DATAGRAM") | Some("DATAGRAM2")) => {
                         // currently only forwarded datagrams are supported
                         let _ = parsed_cmd.key_value_pairs.get("PORT").ok_or_else(|| {
                             tracing::warn!(
@@ -495,6 +637,7 @@ impl<'a, R: Runtime> TryFrom<ParsedCommand<'a, R>> for SamCommand {
                         match style {
                             Some("RAW") => SessionKind::Anonymous,
                             Some("DATAGRAM") => SessionKind::Datagram,
+                            Some("DATAGRAM2") => SessionKind::Datagram2,
                             _ => unreachable!(),
                         }
                     }
@@ -589,11 +732,7 @@ impl<'a, R: Runtime> TryFrom<ParsedCommand<'a, R>> for SamCommand {
                 Ok(SamCommand::Connect {
                     host,
                     session_id: session_id.to_string(),
-                    options: parsed_cmd
-                        .key_value_pairs
-                        .into_iter()
-                        .map(|(key, value)| (key.to_string(), value.to_string()))
-                        .collect(),
+                    options: StreamOptions::from_key_value_pairs(&parsed_cmd.key_value_pairs),
                 })
             }
             ("STREAM", Some("ACCEPT")) => {
@@ -606,11 +745,7 @@ impl<'a, R: Runtime> TryFrom<ParsedCommand<'a, R>> for SamCommand {
 
                 Ok(SamCommand::Accept {
                     session_id: session_id.to_string(),
-                    options: parsed_cmd
-                        .key_value_pairs
-                        .into_iter()
-                        .map(|(key, value)| (key.to_string(), value.to_string()))
-                        .collect(),
+                    options: StreamOptions::from_key_value_pairs(&parsed_cmd.key_value_pairs),
                 })
             }
             ("STREAM", Some("FORWARD")) => {
@@ -635,13 +770,10 @@ impl<'a, R: Runtime> TryFrom<ParsedCommand<'a, R>> for SamCommand {
                 Ok(SamCommand::Forward {
                     session_id: session_id.to_string(),
                     port,
-                    options: parsed_cmd
-                        .key_value_pairs
-                        .into_iter()
-                        .map(|(key, value)| (key.to_string(), value.to_string()))
-                        .collect(),
+                    options: StreamOptions::from_key_value_pairs(&parsed_cmd.key_value_pairs),
                 })
             }
+            ("STREAM", Some("STATS")) => Ok(SamCommand::StreamStats),
             ("NAMING", Some("LOOKUP")) => Ok(SamCommand::NamingLookup {
                 name: parsed_cmd.key_value_pairs.get("NAME").ok_or(())?.to_string(),
             }),
@@ -699,6 +831,7 @@ impl SamCommand {
                 tag("CONNECT"),
                 tag("ACCEPT"),
                 tag("FORWARD"),
+                tag("STATS"),
                 tag("LOOKUP"),
                 tag("GENERATE"),
             ))),
@@ -711,7 +844,7 @@ impl SamCommand {
             SamCommand::try_from(ParsedCommand::<R> {
                 command,
                 subcommand,
-                key_value_pairs: key_value_pairs.unwrap_or(HashMap::new()),
+                key_value_pairs: key_value_pairs.unwrap_or_else(KeyValuePairs::new),
                 _runtime: Default::default(),
             })
             .map_err(|_| Err::Error(make_error(input, ErrorKind::Fail)))?,
@@ -771,9 +904,30 @@ impl Datagram {
     }
 }
 
-fn parse_key_value_pairs(input: &str) -> IResult<&str, HashMap<&str, &str>> {
-    let (input, key_value_pairs) = many0(preceded(multispace0, parse_key_value))(input)?;
-    Ok((input, key_value_pairs.into_iter().collect()))
+fn parse_key_value_pairs(mut input: &str) -> IResult<&str, KeyValuePairs<'_>> {
+    let mut key_value_pairs = KeyValuePairs::new();
+
+    loop {
+        // a recoverable error ends the key-value pairs but failures must be propagated
+        let (rest, (key, value)) = match preceded(multispace0, parse_key_value)(input) {
+            Ok(result) => result,
+            Err(Err::Error(_)) => break,
+            Err(error) => return Err(error),
+        };
+
+        if !key_value_pairs.insert(key, value) {
+            tracing::warn!(
+                target: LOG_TARGET,
+                max = ?MAX_KEY_VALUE_PAIRS,
+                "too many key-value pairs in command",
+            );
+            return Err(Err::Failure(make_error(input, ErrorKind::TooLarge)));
+        }
+
+        input = rest;
+    }
+
+    Ok((input, key_value_pairs))
 }
 
 fn parse_key_value(input: &str) -> IResult<&str, (&str, &str)> {
@@ -915,7 +1069,7 @@ mod tests {
             let invalid_cmd = ParsedCommand::<MockRuntime> {
                 command: "SESSION",
                 subcommand: Some("CREATE"),
-                key_value_pairs: HashMap::from([
+                key_value_pairs: KeyValuePairs::from([
                     ("STYLE", "STREAM"),
                     ("ID", "test"),
                     ("DESTINATION", "TRANSIENT"),
@@ -941,7 +1095,7 @@ mod tests {
             let invalid_cmd = ParsedCommand::<MockRuntime> {
                 command: "SESSION",
                 subcommand: Some("CREATE"),
-                key_value_pairs: HashMap::from([
+                key_value_pairs: KeyValuePairs::from([
                     ("STYLE", "STREAM"),
                     ("ID", "test"),
                     ("DESTINATION", "TRANSIENT"),
@@ -967,7 +1121,7 @@ mod tests {
             let invalid_cmd = ParsedCommand::<MockRuntime> {
                 command: "SESSION",
                 subcommand: Some("CREATE"),
-                key_value_pairs: HashMap::from([
+                key_value_pairs: KeyValuePairs::from([
                     ("STYLE", "STREAM"),
                     ("ID", "test"),
                     ("DESTINATION", "TRANSIENT"),
@@ -1002,7 +1156,34 @@ mod tests {
                 host: HostKind::Destination { .. },
             }) => {
                 assert_eq!(session_id.as_str(), "MM9z52ZwnTTPwfeD");
-                assert_eq!(options.get("SILENT"), Some(&"false".to_string()));
+                assert_eq!(options, StreamOptions::default());
+            }
+            response => panic!("invalid response: {response:?}"),
+        }
+
+        // ports and silent stream
+        match SamCommand::parse::<MockRuntime>(&format!(
+            "STREAM CONNECT ID=MM9z52ZwnTTPwfeD DESTINATION={destination} \
+            SILENT=true FROM_PORT=1337 TO_PORT=8080 i2p.streaming.foo=bar"
+        )) {
+            Some(SamCommand::Connect { options, .. }) => assert_eq!(
+                options,
+                StreamOptions {
+                    silent: true,
+                    from_port: 1337,
+                    to_port: 8080,
+                }
+            ),
+            response => panic!("invalid response: {response:?}"),
+        }
+
+        // invalid ports are ignored
+        match SamCommand::parse::<MockRuntime>(&format!(
+            "STREAM CONNECT ID=MM9z52ZwnTTPwfeD DESTINATION={destination} \
+            FROM_PORT=hello TO_PORT=1000000"
+        )) {
+            Some(SamCommand::Connect { options, .. }) => {
+                assert_eq!(options, StreamOptions::default());
             }
             response => panic!("invalid response: {response:?}"),
         }
@@ -1020,7 +1201,7 @@ mod tests {
                 host: HostKind::B32Host { destination_id },
             }) => {
                 assert_eq!(session_id.as_str(), "MM9z52ZwnTTPwfeD");
-                assert_eq!(options.get("SILENT"), Some(&"false".to_string()));
+                assert!(!options.silent);
                 assert_eq!(
                     destination_id,
                     DestinationId::from(
@@ -1045,7 +1226,7 @@ mod tests {
                 host: HostKind::B32Host { destination_id },
             }) => {
                 assert_eq!(session_id.as_str(), "MM9z52ZwnTTPwfeD");
-                assert_eq!(options.get("SILENT"), Some(&"false".to_string()));
+                assert!(!options.silent);
                 assert_eq!(
                     destination_id,
                     DestinationId::from(
@@ -1070,7 +1251,7 @@ mod tests {
                 host: HostKind::B32Host { destination_id },
             }) => {
                 assert_eq!(session_id.as_str(), "MM9z52ZwnTTPwfeD");
-                assert_eq!(options.get("SILENT"), Some(&"false".to_string()));
+                assert!(!options.silent);
                 assert_eq!(
                     destination_id,
                     DestinationId::from(
@@ -1095,7 +1276,7 @@ mod tests {
                 host: HostKind::Host { host },
             }) => {
                 assert_eq!(session_id.as_str(), "MM9z52ZwnTTPwfeD");
-                assert_eq!(options.get("SILENT"), Some(&"false".to_string()));
+                assert!(!options.silent);
                 assert_eq!(host.as_str(), "host.i2p");
             }
             response => panic!("invalid response: {response:?}"),
@@ -1114,7 +1295,7 @@ mod tests {
                 host: HostKind::Host { host },
             }) => {
                 assert_eq!(session_id.as_str(), "MM9z52ZwnTTPwfeD");
-                assert_eq!(options.get("SILENT"), Some(&"false".to_string()));
+                assert!(!options.silent);
                 assert_eq!(host.as_str(), "host.i2p");
             }
             response => panic!("invalid response: {response:?}"),
@@ -1133,7 +1314,7 @@ mod tests {
                 host: HostKind::Host { host },
             }) => {
                 assert_eq!(session_id.as_str(), "MM9z52ZwnTTPwfeD");
-                assert_eq!(options.get("SILENT"), Some(&"false".to_string()));
+                assert!(!options.silent);
                 assert_eq!(host.as_str(), "host.i2p");
             }
             response => panic!("invalid response: {response:?}"),
@@ -1166,11 +1347,16 @@ mod tests {
                 options,
             }) => {
                 assert_eq!(session_id.as_str(), "MM9z52ZwnTTPwfeD");
-                assert_eq!(options.get("SILENT"), Some(&"false".to_string()));
+                assert!(!options.silent);
             }
             response => panic!("invalid response: {response:?}"),
         }
 
+        match SamCommand::parse::<MockRuntime>("STREAM ACCEPT ID=MM9z52ZwnTTPwfeD SILENT=true") {
+            Some(SamCommand::Accept { options, .. }) => assert!(options.silent),
+            response => panic!("invalid response: {response:?}"),
+        }
+
         // session id missing
         assert!(SamCommand::parse::<MockRuntime>("STREAM ACCEPT SILENT=false").is_none());
     }
@@ -1187,7 +1373,7 @@ mod tests {
             }) => {
                 assert_eq!(session_id.as_str(), "MM9z52ZwnTTPwfeD");
                 assert_eq!(port, 8888);
-                assert_eq!(options.get("SILENT"), Some(&"false".to_string()));
+                assert!(!options.silent);
             }
             response => panic!("invalid response: {response:?}"),
         }
@@ -1204,6 +1390,20 @@ mod tests {
         .is_none());
     }
 
+    #[test]
+    fn parse_stream_stats() {
+        match SamCommand::parse::<MockRuntime>("STREAM STATS") {
+            Some(SamCommand::StreamStats) => {}
+            response => panic!("invalid response: {response:?}"),
+        }
+
+        // options are ignored
+        match SamCommand::parse::<MockRuntime>("STREAM STATS ID=MM9z52ZwnTTPwfeD") {
+            Some(SamCommand::StreamStats) => {}
+            response => panic!("invalid response: {response:?}"),
+        }
+    }
+
     #[test]
     fn parse_naming_lookup() {
         match SamCommand::parse::<MockRuntime>("NAMING LOOKUP NAME=host.i2p") {
@@ -1607,4 +1807,75 @@ mod tests {
     fn parse_sub_session_id_missing() {
         assert!(SamCommand::parse::<MockRuntime>("SESSION ADD STYLE=STREAM").is_none());
     }
+
+    #[test]
+    fn parse_datagram2_sessions() {
+        match SamCommand::parse::<MockRuntime>(
+            "SESSION CREATE STYLE=DATAGRAM2 ID=test PORT=8888 DESTINATION=TRANSIENT\n",
+        ) {
+            Some(SamCommand::CreateSession {
+                session_id,
+                session_kind,
+                options,
+                ..
+            }) => {
+                assert_eq!(session_id, "test");
+                assert_eq!(session_kind, SessionKind::Datagram2);
+                assert_eq!(options.get("HOST"), Some(&"127.0.0.1".to_string()));
+            }
+            response => panic!("invalid response: {response:?}"),
+        }
+
+        match SamCommand::parse::<MockRuntime>(
+            "SESSION ADD STYLE=DATAGRAM2 ID=sub-session PORT=8888",
+        ) {
+            Some(SamCommand::CreateSubSession { session_kind, .. }) =>
+                assert_eq!(session_kind, SessionKind::Datagram2),
+            response => panic!("invalid response: {response:?}"),
+        }
+    }
+
+    #[test]
+    fn datagram3_sessions_rejected() {
+        assert!(SamCommand::parse::<MockRuntime>(
+            "SESSION CREATE STYLE=DATAGRAM3 ID=test PORT=8888 DESTINATION=TRANSIENT\n",
+        )
+        .is_none());
+        assert!(SamCommand::parse::<MockRuntime>(
+            "SESSION ADD STYLE=DATAGRAM3 ID=sub-session PORT=8888"
+        )
+        .is_none());
+    }
+
+    #[test]
+    fn key_value_pairs_behave_like_map() {
+        let (rest, mut pairs) =
+            parse_key_value_pairs(" ID=test SILENT=false ID=\"other id\" PORT=8888").unwrap();
+
+        assert!(rest.is_empty());
+        assert_eq!(pairs.get("ID"), Some(&"other id"));
+        assert_eq!(pairs.get("SILENT"), Some(&"false"));
+        assert_eq!(pairs.remove("SILENT"), Some("false"));
+        assert_eq!(pairs.get("SILENT"), None);
+        assert_eq!(pairs.get("PORT"), Some(&"8888"));
+
+        let mut pairs = pairs.into_iter().collect::<Vec<_>>();
+        pairs.sort();
+        assert_eq!(pairs, vec![("ID", "other id"), ("PORT", "8888")]);
+    }
+
+    #[test]
+    fn too_many_key_value_pairs() {
+        let options = (0..MAX_KEY_VALUE_PAIRS + 1)
+            .map(|i| alloc::format!(" option{i}=value"))
+            .collect::<String>();
+
+        assert!(SamCommand::parse::<MockRuntime>(&alloc::format!(
+            "STREAM ACCEPT ID=test{options}"
+        ))
+        .is_none());
+        assert!(
+            SamCommand::parse::<MockRuntime>(&alloc::format!("HELLO VERSION{options}")).is_none()
+        );
+    }
 }
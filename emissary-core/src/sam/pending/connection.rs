@@ -22,8 +22,10 @@ use crate::{
     primitives::Destination,
     runtime::Runtime,
     sam::{
-        parser::{DestinationContext, HostKind, SamCommand, SamVersion, SessionKind},
-        socket::SamSocket,
+        parser::{
+            DestinationContext, HostKind, SamCommand, SamVersion, SessionKind, StreamOptions,
+        },
+        socket::{SamSocket, SamStream},
     },
 };
 
@@ -84,8 +86,8 @@ pub enum ConnectionKind<R: Runtime> {
         /// Host kind.
         host: HostKind,
 
-        /// Options.
-        options: HashMap<String, String>,
+        /// Stream options.
+        options: StreamOptions,
     },
 
     /// Accept inbond virtual stream over this connection.
@@ -99,8 +101,8 @@ pub enum ConnectionKind<R: Runtime> {
         /// Negotiated version.
         version: SamVersion,
 
-        /// Options.
-        options: HashMap<String, String>,
+        /// Stream options.
+        options: StreamOptions,
     },
 
     /// Forward incoming virtual streams to a TCP listener listening to `port`.
@@ -117,8 +119,8 @@ pub enum ConnectionKind<R: Runtime> {
         /// Port which the TCP listener is listening.
         port: u16,
 
-        /// Options.
-        options: HashMap<String, String>,
+        /// Stream options.
+        options: StreamOptions,
     },
 }
 
@@ -221,7 +223,7 @@ pub struct PendingSamConnection<R: Runtime> {
 
 impl<R: Runtime> PendingSamConnection<R> {
     /// Create new [`PendingSamConnection`].
-    pub fn new(stream: R::TcpStream) -> Self {
+    pub fn new(stream: SamStream<R>) -> Self {
         Self {
             state: PendingConnectionState::AwaitingHandshake {
                 socket: SamSocket::new(stream),
@@ -489,7 +491,7 @@ mod tests {
 
         stream1.unwrap().0.shutdown().await.unwrap();
 
-        match PendingSamConnection::<MockRuntime>::new(stream2.unwrap()).await {
+        match PendingSamConnection::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap())).await {
             Err(Error::Connection(ConnectionError::SocketClosed)) => {}
             _ => panic!("invalid result"),
         }
@@ -501,7 +503,7 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (_stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
 
-        match PendingSamConnection::<MockRuntime>::new(stream2.unwrap()).await {
+        match PendingSamConnection::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap())).await {
             Err(Error::Connection(ConnectionError::KeepAliveTimeout)) => {}
             _ => panic!("invalid result"),
         }
@@ -513,7 +515,8 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
 
-        let mut connection = PendingSamConnection::<MockRuntime>::new(stream2.unwrap());
+        let mut connection =
+            PendingSamConnection::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
         let mut stream = stream1.unwrap().0;
 
         // send handshake
@@ -558,7 +561,8 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
 
-        let mut connection = PendingSamConnection::<MockRuntime>::new(stream2.unwrap());
+        let mut connection =
+            PendingSamConnection::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
         let mut stream = stream1.unwrap().0;
 
         // send handshake
@@ -597,7 +601,8 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
 
-        let mut connection = PendingSamConnection::<MockRuntime>::new(stream2.unwrap());
+        let mut connection =
+            PendingSamConnection::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
         let mut stream = stream1.unwrap().0;
 
         // send handshake
@@ -636,7 +641,8 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
 
-        let mut connection = PendingSamConnection::<MockRuntime>::new(stream2.unwrap());
+        let mut connection =
+            PendingSamConnection::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
         let mut stream = stream1.unwrap().0;
 
         // send handshake
@@ -675,7 +681,8 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
 
-        let mut connection = PendingSamConnection::<MockRuntime>::new(stream2.unwrap());
+        let mut connection =
+            PendingSamConnection::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
         let mut stream = stream1.unwrap().0;
 
         // send handshake
@@ -734,7 +741,7 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
 
-        let connection = PendingSamConnection::<MockRuntime>::new(stream2.unwrap());
+        let connection = PendingSamConnection::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
         let mut stream = stream1.unwrap().0;
 
         stream
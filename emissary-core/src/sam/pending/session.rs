@@ -62,6 +62,9 @@ pub struct SamSessionContext<R: Runtime> {
     /// Active inbound tunnels and their leases.
     pub inbound: HashMap<TunnelId, Lease>,
 
+    /// Metrics handle.
+    pub metrics: R::MetricsHandle,
+
     /// Handle to `NetDb`.
     pub netdb_handle: NetDbHandle,
 
@@ -114,6 +117,9 @@ pub struct PendingSamSession<R: Runtime> {
     /// Active inbound tunnels and their leases.
     inbound: HashMap<TunnelId, Lease>,
 
+    /// Metrics handle.
+    metrics: R::MetricsHandle,
+
     /// Handle to `NetDb`.
     netdb_handle: NetDbHandle,
 
@@ -163,6 +169,7 @@ impl<R: Runtime> PendingSamSession<R> {
         event_handle: EventHandle<R>,
         profile_storage: ProfileStorage<R>,
         sub_session_tx: Option<Sender<SubSessionCommand>>,
+        metrics: R::MetricsHandle,
     ) -> Self {
         Self {
             address_book,
@@ -170,6 +177,7 @@ impl<R: Runtime> PendingSamSession<R> {
             destination,
             event_handle,
             inbound: HashMap::new(),
+            metrics,
             netdb_handle,
             options,
             outbound: HashSet::new(),
@@ -268,6 +276,7 @@ impl<R: Runtime> PendingSamSession<R> {
             destination: self.destination,
             event_handle: self.event_handle,
             inbound: self.inbound,
+            metrics: self.metrics,
             netdb_handle: self.netdb_handle,
             options: self.options,
             outbound: self.outbound,
@@ -20,22 +20,70 @@ use crate::{
     crypto::{base64_encode, SigningPrivateKey, SigningPublicKey},
     error::Error,
     i2cp::I2cpPayload,
-    primitives::Destination,
+    primitives::{Destination, DestinationId},
     protocol::Protocol,
     runtime::Runtime,
 };
 
-use bytes::{BufMut, BytesMut};
-use hashbrown::HashMap;
-use nom::bytes::complete::take;
+use hashbrown::{HashMap, HashSet};
+use nom::{bytes::complete::take, number::complete::be_u16};
 use thingbuf::mpsc::Sender;
 
 use alloc::{format, string::String, vec::Vec};
-use core::marker::PhantomData;
+use core::{marker::PhantomData, mem};
 
 /// Logging target for the file.
 const LOG_TARGET: &str = "emissary::datagram";
 
+/// Format version of `Datagram2`.
+const DATAGRAM2_VERSION: u16 = 0x0002;
+
+/// Mask for the version bits of `Datagram2` flags.
+const VERSION_MASK: u16 = 0x000f;
+
+/// Flag bit indicating that options are present.
+const FLAG_OPTIONS: u16 = 1 << 4;
+
+/// Flag bit indicating that an offline signature is present.
+const FLAG_OFFLINE_SIGNATURE: u16 = 1 << 5;
+
+/// How many signatures one generation of [`ReplayFilter`] holds.
+const REPLAY_FILTER_GENERATION_SIZE: usize = 4096usize;
+
+/// Replay filter for `Datagram2`.
+///
+/// Recently received datagrams are identified by the first eight bytes of their signature and
+/// stored in two generations. Once the current generation is full, it replaces the previous
+/// generation which bounds the memory usage while still rejecting recently seen datagrams.
+#[derive(Default)]
+struct ReplayFilter {
+    /// Current generation.
+    current: HashSet<u64>,
+
+    /// Previous generation.
+    previous: HashSet<u64>,
+}
+
+impl ReplayFilter {
+    /// Insert `signature` into [`ReplayFilter`].
+    ///
+    /// Returns `false` if `signature` has been seen recently.
+    fn insert(&mut self, signature: &[u8]) -> bool {
+        let key = u64::from_le_bytes(signature[..8].try_into().expect("to succeed"));
+
+        if self.current.contains(&key) || self.previous.contains(&key) {
+            return false;
+        }
+
+        if self.current.len() == REPLAY_FILTER_GENERATION_SIZE {
+            self.previous = mem::take(&mut self.current);
+        }
+        self.current.insert(key);
+
+        true
+    }
+}
+
 /// Datagram manager.
 pub struct DatagramManager<R: Runtime> {
     /// TX channel which can be used to send datagrams to clients.
@@ -47,9 +95,15 @@ pub struct DatagramManager<R: Runtime> {
     /// Listeners.
     listeners: HashMap<u16, u16>,
 
+    /// Replay filter for inbound `Datagram2`s.
+    replay_filter: ReplayFilter,
+
     /// Signing key.
     signing_key: SigningPrivateKey,
 
+    /// Scratch buffer for messages that are signed or verified.
+    signature_buffer: Vec<u8>,
+
     /// Marker for `Runtime`
     _runtime: PhantomData<R>,
 }
@@ -74,35 +128,106 @@ impl<R: Runtime> DatagramManager<R> {
                     HashMap::from_iter([(dst_port.unwrap_or(0), port)])
                 })
             },
+            replay_filter: ReplayFilter::default(),
             signing_key,
+            signature_buffer: Vec::new(),
             _runtime: Default::default(),
         }
     }
 
-    /// Make repliable datagram.
+    /// Make datagram for remote destination identified by `destination_id`.
+    ///
+    /// Repliable datagrams (`Datagram`) are signed and carry the full local destination.
+    ///
+    /// `Datagram2` also carries the full local destination but the signature covers the hash of
+    /// the remote destination so the datagram can't be replayed to other destinations.
     ///
     /// Caller must ensure to call this function with correct `protocol`.
-    pub fn make_datagram(&mut self, protocol: Protocol, datagram: Vec<u8>) -> Vec<u8> {
+    pub fn make_datagram(
+        &mut self,
+        protocol: Protocol,
+        destination_id: &DestinationId,
+        datagram: Vec<u8>,
+    ) -> Vec<u8> {
         match protocol {
             Protocol::Datagram => {
                 let signature = self.signing_key.sign(&datagram);
-                let destination = self.destination.serialize();
+                let destination = self.destination.serialized();
 
                 let mut out =
-                    BytesMut::with_capacity(destination.len() + signature.len() + datagram.len());
-                out.put_slice(&destination);
-                out.put_slice(&signature);
-                out.put_slice(&datagram);
+                    Vec::with_capacity(destination.len() + signature.len() + datagram.len());
+                out.extend_from_slice(destination);
+                out.extend_from_slice(&signature);
+                out.extend_from_slice(&datagram);
 
-                out.to_vec()
+                out
+            }
+            Protocol::Datagram2 => {
+                let flags = DATAGRAM2_VERSION.to_be_bytes();
+
+                self.signature_buffer.clear();
+                self.signature_buffer.extend_from_slice(&destination_id.to_vec());
+                self.signature_buffer.extend_from_slice(&flags);
+                self.signature_buffer.extend_from_slice(&datagram);
+
+                let signature = self.signing_key.sign(&self.signature_buffer);
+                let destination = self.destination.serialized();
+
+                let mut out = Vec::with_capacity(
+                    destination.len() + flags.len() + datagram.len() + signature.len(),
+                );
+                out.extend_from_slice(destination);
+                out.extend_from_slice(&flags);
+                out.extend_from_slice(&datagram);
+                out.extend_from_slice(&signature);
+
+                out
             }
             Protocol::Anonymous => datagram,
             Protocol::Streaming => unreachable!(),
         }
     }
 
+    /// Parse flags of `Datagram2` from `input`, skip the options if they're present and return
+    /// the flags and the data following them.
+    fn parse_flags(input: &[u8]) -> crate::Result<(u16, &[u8])> {
+        let (rest, flags) = be_u16::<_, ()>(input).map_err(|_| Error::InvalidData)?;
+
+        if flags & VERSION_MASK != DATAGRAM2_VERSION {
+            tracing::debug!(
+                target: LOG_TARGET,
+                ?flags,
+                "unsupported datagram version",
+            );
+            return Err(Error::NotSupported);
+        }
+
+        if flags & FLAG_OPTIONS == 0 {
+            return Ok((flags, rest));
+        }
+
+        let (rest, size) = be_u16::<_, ()>(rest).map_err(|_| Error::InvalidData)?;
+        let (rest, _options) = take::<_, _, ()>(size)(rest).map_err(|_| Error::InvalidData)?;
+
+        Ok((flags, rest))
+    }
+
+    /// Send `datagram` received from `source` to the client listening on `port`.
+    fn send_to_client(&self, port: u16, source: &[u8], src_port: u16, dst_port: u16, data: &[u8]) {
+        let info = format!(
+            "{} FROM_PORT={src_port} TO_PORT={dst_port}\n",
+            base64_encode(source)
+        );
+
+        let mut out = Vec::with_capacity(info.len() + data.len());
+        out.extend_from_slice(info.as_bytes());
+        out.extend_from_slice(data);
+
+        let _ = self.datagram_tx.try_send((port, out));
+    }
+
     /// Handle inbound datagram.
-    pub fn on_datagram(&self, payload: I2cpPayload) -> crate::Result<()> {
+    pub fn on_datagram(&mut self, payload: I2cpPayload) -> crate::Result<()> {
         let I2cpPayload {
             dst_port,
             payload,
@@ -110,7 +235,7 @@ impl<R: Runtime> DatagramManager<R> {
             src_port,
         } = payload;
 
-        let Some(port) = self.listeners.get(&dst_port) else {
+        let Some(port) = self.listeners.get(&dst_port).copied() else {
             tracing::warn!(
                 target: LOG_TARGET,
                 ?dst_port,
@@ -132,23 +257,55 @@ impl<R: Runtime> DatagramManager<R> {
                     verifying_key => verifying_key.verify(rest, signature)?,
                 }
 
-                let info = format!(
-                    "{} FROM_PORT={src_port} TO_PORT={dst_port}\n",
-                    base64_encode(destination.serialize())
-                );
+                self.send_to_client(port, destination.serialized(), src_port, dst_port, rest);
+
+                Ok(())
+            }
+            Protocol::Datagram2 => {
+                let (rest, destination) =
+                    Destination::parse_frame(&payload).map_err(|_| Error::InvalidData)?;
+                let signed = rest
+                    .len()
+                    .checked_sub(destination.verifying_key().signature_len())
+                    .ok_or(Error::InvalidData)?;
+                let (signed, signature) = rest.split_at(signed);
+                let (flags, data) = Self::parse_flags(signed)?;
+
+                if flags & FLAG_OFFLINE_SIGNATURE != 0 {
+                    tracing::debug!(
+                        target: LOG_TARGET,
+                        "offline signatures are not supported for datagram2",
+                    );
+                    return Err(Error::NotSupported);
+                }
+
+                // signature covers the hash of the local destination, followed by flags, options
+                // and payload which prevents the datagram from being replayed to other
+                // destinations and the replay filter rejects datagrams received recently
+                self.signature_buffer.clear();
+                self.signature_buffer.extend_from_slice(self.destination.identity_hash());
+                self.signature_buffer.extend_from_slice(signed);
 
-                let info = info.as_bytes();
+                match destination.verifying_key() {
+                    SigningPublicKey::DsaSha1(_) => return Err(Error::NotSupported),
+                    verifying_key => verifying_key.verify(&self.signature_buffer, signature)?,
+                }
 
-                let mut out = BytesMut::with_capacity(info.len() + rest.len());
-                out.put_slice(info);
-                out.put_slice(rest);
+                if !self.replay_filter.insert(signature) {
+                    tracing::debug!(
+                        target: LOG_TARGET,
+                        source = %destination.id(),
+                        "replayed datagram2",
+                    );
+                    return Err(Error::Duplicate);
+                }
 
-                let _ = self.datagram_tx.try_send((*port, out.to_vec()));
+                self.send_to_client(port, destination.serialized(), src_port, dst_port, data);
 
                 Ok(())
             }
             Protocol::Anonymous => {
-                let _ = self.datagram_tx.try_send((*port, payload));
+                let _ = self.datagram_tx.try_send((port, payload));
 
                 Ok(())
             }
@@ -208,7 +365,7 @@ impl<R: Runtime> DatagramManager<R> {
 #[cfg(test)]
 mod tests {
     use super::*;
-    use crate::runtime::mock::MockRuntime;
+    use crate::{i2cp::I2cpPayloadBuilder, runtime::mock::MockRuntime};
     use thingbuf::mpsc::channel;
 
     #[test]
@@ -260,7 +417,7 @@ mod tests {
         let (destination, signing_key) = Destination::random();
         let (tx, _rx) = channel(16);
 
-        let manager =
+        let mut manager =
             DatagramManager::<MockRuntime>::new(destination, tx, HashMap::new(), signing_key);
 
         match manager.on_datagram(I2cpPayload {
@@ -377,4 +534,195 @@ mod tests {
             .is_err());
         assert_eq!(manager.listeners.get(&0), Some(&1337));
     }
+
+    #[test]
+    fn repliable_datagram_round_trip() {
+        let (destination, signing_key) = Destination::random();
+        let (tx, rx) = channel(16);
+
+        let mut manager = DatagramManager::<MockRuntime>::new(
+            destination.clone(),
+            tx,
+            HashMap::from_iter([("PORT".to_string(), "8888".to_string())]),
+            signing_key,
+        );
+
+        let payload = manager.make_datagram(
+            Protocol::Datagram,
+            &DestinationId::random(),
+            b"hello, world".to_vec(),
+        );
+        assert_eq!(payload.len(), destination.serialized_len() + 64 + 12);
+
+        manager
+            .on_datagram(I2cpPayload {
+                dst_port: 0,
+                payload,
+                protocol: Protocol::Datagram,
+                src_port: 0,
+            })
+            .unwrap();
+
+        let (port, datagram) = rx.try_recv().unwrap();
+        assert_eq!(port, 8888);
+        assert!(datagram.starts_with(base64_encode(destination.serialize()).as_bytes()));
+        assert!(datagram.ends_with(b"\nhello, world"));
+    }
+
+    /// Create a sender and a receiver with a datagram listener on port 8888.
+    fn sender_and_receiver() -> (
+        DatagramManager<MockRuntime>,
+        DatagramManager<MockRuntime>,
+        Destination,
+        thingbuf::mpsc::Receiver<(u16, Vec<u8>)>,
+    ) {
+        let (sender_destination, sender_signing_key) = Destination::random();
+        let (receiver_destination, receiver_signing_key) = Destination::random();
+        let (sender_tx, _sender_rx) = channel(16);
+        let (receiver_tx, receiver_rx) = channel(16);
+
+        let sender = DatagramManager::<MockRuntime>::new(
+            sender_destination.clone(),
+            sender_tx,
+            HashMap::new(),
+            sender_signing_key,
+        );
+        let receiver = DatagramManager::<MockRuntime>::new(
+            receiver_destination,
+            receiver_tx,
+            HashMap::from_iter([("PORT".to_string(), "8888".to_string())]),
+            receiver_signing_key,
+        );
+
+        (sender, receiver, sender_destination, receiver_rx)
+    }
+
+    #[test]
+    fn datagram2_round_trip() {
+        let (mut sender, mut receiver, sender_destination, rx) = sender_and_receiver();
+
+        let payload = sender.make_datagram(
+            Protocol::Datagram2,
+            &receiver.destination.id(),
+            b"hello, world".to_vec(),
+        );
+        assert_eq!(
+            payload.len(),
+            sender_destination.serialized_len() + 2 + 12 + 64
+        );
+
+        receiver
+            .on_datagram(I2cpPayload {
+                dst_port: 0,
+                payload: payload.clone(),
+                protocol: Protocol::Datagram2,
+                src_port: 0,
+            })
+            .unwrap();
+
+        let (port, datagram) = rx.try_recv().unwrap();
+        assert_eq!(port, 8888);
+        assert!(datagram.starts_with(base64_encode(sender_destination.serialize()).as_bytes()));
+        assert!(datagram.ends_with(b"\nhello, world"));
+
+        // replayed datagram is rejected
+        match receiver.on_datagram(I2cpPayload {
+            dst_port: 0,
+            payload,
+            protocol: Protocol::Datagram2,
+            src_port: 0,
+        }) {
+            Err(Error::Duplicate) => {}
+            result => panic!("invalid result: {result:?}"),
+        }
+    }
+
+    #[test]
+    fn datagram2_for_other_destination_rejected() {
+        let (mut sender, mut receiver, _, rx) = sender_and_receiver();
+
+        let payload = sender.make_datagram(
+            Protocol::Datagram2,
+            &DestinationId::random(),
+            b"hello, world".to_vec(),
+        );
+
+        assert!(receiver
+            .on_datagram(I2cpPayload {
+                dst_port: 0,
+                payload,
+                protocol: Protocol::Datagram2,
+                src_port: 0,
+            })
+            .is_err());
+        assert!(rx.try_recv().is_err());
+    }
+
+    #[test]
+    fn datagram_version_mismatch() {
+        let (mut sender, mut receiver, sender_destination, rx) = sender_and_receiver();
+
+        let mut payload = sender.make_datagram(
+            Protocol::Datagram2,
+            &receiver.destination.id(),
+            b"hello, world".to_vec(),
+        );
+        let offset = sender_destination.serialized_len();
+        payload[offset..offset + 2].copy_from_slice(&0x0003u16.to_be_bytes());
+
+        match receiver.on_datagram(I2cpPayload {
+            dst_port: 0,
+            payload,
+            protocol: Protocol::Datagram2,
+            src_port: 0,
+        }) {
+            Err(Error::NotSupported) => {}
+            result => panic!("invalid result: {result:?}"),
+        }
+        assert!(rx.try_recv().is_err());
+    }
+
+    // datagram send path benchmark, run with:
+    // `cargo test --release datagram_throughput -- --ignored --nocapture`
+    #[test]
+    #[ignore]
+    fn datagram_throughput() {
+        const NUM_DATAGRAMS: usize = 10_000;
+        const MIN_DATAGRAMS_PER_SECOND: f64 = 5_000f64;
+
+        let (destination, signing_key) = Destination::random();
+        let (tx, _rx) = channel(16);
+        let mut manager =
+            DatagramManager::<MockRuntime>::new(destination, tx, HashMap::new(), signing_key);
+
+        let destination_id = DestinationId::random();
+
+        for (protocol, size) in [
+            (Protocol::Datagram, 64usize),
+            (Protocol::Datagram, 1024usize),
+            (Protocol::Datagram2, 1024usize),
+            (Protocol::Anonymous, 1024usize),
+        ] {
+            let started = std::time::Instant::now();
+
+            for _ in 0..NUM_DATAGRAMS {
+                let datagram = manager.make_datagram(protocol, &destination_id, vec![0xaa; size]);
+
+                assert!(I2cpPayloadBuilder::<MockRuntime>::new(&datagram)
+                    .with_protocol(protocol)
+                    .build()
+                    .is_some());
+            }
+            let elapsed = started.elapsed();
+            let datagrams_per_second = NUM_DATAGRAMS as f64 / elapsed.as_secs_f64();
+
+            println!(
+                "{protocol:?}, {size} bytes: {elapsed:?} ({datagrams_per_second:.0} datagrams/s)"
+            );
+            assert!(
+                datagrams_per_second >= MIN_DATAGRAMS_PER_SECOND,
+                "{protocol:?}, {size} bytes: {datagrams_per_second:.0} datagrams/s",
+            );
+        }
+    }
 }
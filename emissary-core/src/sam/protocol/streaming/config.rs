@@ -18,11 +18,19 @@
 
 #![allow(unused)]
 
+use hashbrown::HashMap;
+
 use alloc::string::String;
 use core::{num::NonZeroUsize, time::Duration};
 
+/// Initial window size.
+pub const INITIAL_WINDOW_SIZE: usize = 1usize;
+
+/// Maximum window size in packets.
+pub const MAX_WINDOW_SIZE: usize = 128usize;
+
 /// Inactivity action.
-#[derive(Debug)]
+#[derive(Debug, Clone)]
 pub enum InactivityAction {
     /// Do nothing,
     DoNothing,
@@ -35,7 +43,7 @@ pub enum InactivityAction {
 }
 
 /// Limit action.
-#[derive(Debug)]
+#[derive(Debug, Clone)]
 pub enum LimitAction {
     /// Reset connection.
     Reset,
@@ -52,7 +60,7 @@ pub enum LimitAction {
 /// See section `i2p.streaming.profile Notes` in the docs [1]
 ///
 /// [1]: https://geti2p.net/en/docs/api/streaming
-#[derive(Debug)]
+#[derive(Debug, Clone)]
 pub enum Profile {
     /// Bulk.
     Bulk,
@@ -61,8 +69,19 @@ pub enum Profile {
     Interactive,
 }
 
+/// Congestion control algorithm.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub enum CongestionAlgorithm {
+    /// Exponential growth until the slow start threshold, linear growth afterwards.
+    #[default]
+    Reno,
+
+    /// CUBIC (RFC 8312).
+    Cubic,
+}
+
 /// Streaming protocol configuration.
-#[derive(Debug)]
+#[derive(Debug, Clone)]
 pub struct StreamConfig {
     /// Whether to respond to incoming pings
     pub answer_pings: bool,
@@ -82,6 +101,9 @@ pub struct StreamConfig {
     /// sizes are in messages. A higher number means slower growth.
     pub congestion_avoidance_growth_rate_factor: usize,
 
+    /// Congestion control algorithm.
+    pub congestion_control: CongestionAlgorithm,
+
     /// How long to wait after instantiating a new con before actually attempting to connect. If
     /// this is <= 0, connect immediately with no initial data. If greater than 0, wait until the
     /// output stream is flushed, the buffer fills, or that many milliseconds pass, and include any
@@ -204,6 +226,7 @@ impl Default for StreamConfig {
             blacklist: String::from(""),
             buffer_size: 64 * 1000,
             congestion_avoidance_growth_rate_factor: 1,
+            congestion_control: CongestionAlgorithm::Reno,
             connect_delay: None,
             connect_timeout: Some(Duration::from_secs(5 * 60)),
             dsa_list: String::from(""),
@@ -214,7 +237,7 @@ impl Default for StreamConfig {
             initial_resend_delay: Duration::from_secs(1),
             initial_rto: Duration::from_secs(9),
             initial_rtt: Duration::from_secs(8),
-            initial_window_size: 6,
+            initial_window_size: INITIAL_WINDOW_SIZE,
             limit_action: LimitAction::Reset,
             max_concurrent_streams: None,
             max_conns_per_minute: None,
@@ -225,7 +248,7 @@ impl Default for StreamConfig {
             max_total_conns_per_minute: None,
             max_total_conns_per_hour: None,
             max_total_conns_per_day: None,
-            max_window_size: 12,
+            max_window_size: MAX_WINDOW_SIZE,
             profile: Profile::Bulk,
             read_timeout: None,
             slow_start_growth_rate_factor: 1,
@@ -236,3 +259,67 @@ impl Default for StreamConfig {
         }
     }
 }
+
+impl StreamConfig {
+    /// Create new [`StreamConfig`] from session options.
+    ///
+    /// Unknown and malformed options are ignored and the default values are used instead.
+    pub fn from_options(options: &HashMap<String, String>) -> Self {
+        let mut config = Self::default();
+
+        if let Some(value) = options
+            .get("i2p.streaming.initialWindowSize")
+            .and_then(|value| value.parse::<usize>().ok())
+        {
+            config.initial_window_size = value;
+        }
+
+        if let Some(value) = options
+            .get("i2p.streaming.maxWindowSize")
+            .and_then(|value| value.parse::<usize>().ok())
+        {
+            config.max_window_size = value;
+        }
+
+        match options.get("i2p.streaming.congestionControl").map(|value| value.as_str()) {
+            Some("cubic") => config.congestion_control = CongestionAlgorithm::Cubic,
+            Some("reno") => config.congestion_control = CongestionAlgorithm::Reno,
+            _ => {}
+        }
+
+        config
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn config_from_options() {
+        let config = StreamConfig::from_options(&HashMap::from_iter([
+            (
+                "i2p.streaming.initialWindowSize".to_string(),
+                "12".to_string(),
+            ),
+            ("i2p.streaming.maxWindowSize".to_string(), "256".to_string()),
+            (
+                "i2p.streaming.congestionControl".to_string(),
+                "cubic".to_string(),
+            ),
+        ]));
+
+        assert_eq!(config.initial_window_size, 12);
+        assert_eq!(config.max_window_size, 256);
+        assert_eq!(config.congestion_control, CongestionAlgorithm::Cubic);
+
+        let config = StreamConfig::from_options(&HashMap::from_iter([(
+            "i2p.streaming.initialWindowSize".to_string(),
+            "invalid".to_string(),
+        )]));
+
+        assert_eq!(config.initial_window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(config.max_window_size, MAX_WINDOW_SIZE);
+        assert_eq!(config.congestion_control, CongestionAlgorithm::Reno);
+    }
+}
@@ -20,24 +20,39 @@ use crate::{
     destination::routing_path::{PendingRoutingPathHandle, RoutingPathHandle},
     error::StreamingError,
     primitives::DestinationId,
-    runtime::{JoinSet, Runtime, TcpStream},
-    sam::socket::SamSocket,
+    runtime::{Instant, JoinSet, Runtime, TcpStream},
+    sam::socket::{SamSocket, SamStream},
     util::AsyncWriteExt,
 };
 
-use futures::{future::BoxFuture, StreamExt};
+use futures::{future::BoxFuture, FutureExt, StreamExt};
 
 use alloc::{boxed::Box, collections::VecDeque};
 use core::{
-    fmt, mem,
+    fmt,
+    future::Future,
+    mem,
     net::{IpAddr, Ipv4Addr, SocketAddr},
     pin::Pin,
     task::{Context, Poll, Waker},
+    time::Duration,
 };
 
 /// Logging target for the file.
 const LOG_TARGET: &str = "emissary::streaming::listener";
 
+/// How many connections to the forwarded TCP listener are kept open in advance during a burst.
+const FORWARD_POOL_SIZE: usize = 4usize;
+
+/// How long can a pooled connection to the forwarded TCP listener stay idle before it's closed.
+///
+/// The forwarded service may close connections on which no data is received so pooled connections
+/// are only handed out for a short period of time after they've been opened.
+///
+/// Inbound streams arriving within this interval of each other are considered a burst and only
+/// then is the pool refilled.
+const FORWARD_POOL_IDLE_TIMEOUT: Duration = Duration::from_secs(5);
+
 /// Events emitted by [`StreamListener`].
 pub enum StreamListenerEvent {
     /// Listener is ready.
@@ -98,8 +113,8 @@ impl<R: Runtime> fmt::Debug for ListenerKind<R> {
 pub enum SocketKind<R: Runtime> {
     /// Direct connection opened with `STREAM CONNECT`.
     Connect {
-        /// Underlying TCP stream of the SAMv3 socket.
-        socket: R::TcpStream,
+        /// Underlying stream of the SAMv3 socket.
+        socket: SamStream<R>,
 
         /// Has the stream configured to be silent.
         silent: bool,
@@ -113,8 +128,8 @@ pub enum SocketKind<R: Runtime> {
         /// Pending routing path handle.
         pending_routing_path_handle: PendingRoutingPathHandle,
 
-        /// Underlying TCP stream of the SAMv3 socket.
-        socket: R::TcpStream,
+        /// Underlying stream of the SAMv3 socket.
+        socket: SamStream<R>,
 
         /// Has the stream configured to be silent.
         silent: bool,
@@ -211,6 +226,12 @@ enum ListenerState<R: Runtime> {
         /// Socket that was used to send the `STREAM FORWARD` command.
         #[allow(unused)]
         socket: SamSocket<R>,
+
+        /// Idle connections to the TCP listener and the time they were opened.
+        idle: VecDeque<(R::TcpStream, R::Instant)>,
+
+        /// When was the previous inbound stream handed a connection.
+        last_pop: Option<R::Instant>,
     },
 
     /// Listener state has been poisoned.
@@ -244,6 +265,12 @@ pub struct StreamListener<R: Runtime> {
     /// Pending sockets.
     pending_sockets: R::JoinSet<crate::Result<(SamSocket<R>, PendingRoutingPathHandle)>>,
 
+    /// Pending connections to the forwarded TCP listener.
+    pending_connections: R::JoinSet<Option<R::TcpStream>>,
+
+    /// Expiration timer for idle connections to the forwarded TCP listener.
+    expiration_timer: Option<R::Timer>,
+
     /// Listener state.
     state: ListenerState<R>,
 
@@ -257,6 +284,8 @@ impl<R: Runtime> StreamListener<R> {
         Self {
             destination_id,
             pending_sockets: R::join_set(),
+            pending_connections: R::join_set(),
+            expiration_timer: None,
             state: ListenerState::Uninitialized,
             waker: None,
         }
@@ -270,6 +299,12 @@ impl<R: Runtime> StreamListener<R> {
     /// used to register the listener is also used for data path whereas if the listener was
     /// persistent, the caller must first poll a future which opens a new TCP stream to the
     /// forwarded TCP listener before starting the actual stream event loop.
+    ///
+    /// Connections to the forwarded TCP listener are pooled: if there is a recently opened idle
+    /// connection, the returned future resolves to it immediately. If inbound streams arrive in a
+    /// burst, the pool is refilled in the background so that the rest of the burst doesn't wait
+    /// for a TCP handshake per stream. Idle connections are closed by [`StreamListener`] after
+    /// [`FORWARD_POOL_IDLE_TIMEOUT`].
     pub fn pop_socket(&mut self) -> Option<SocketKind<R>> {
         match &mut self.state {
             ListenerState::Ephemeral { ref mut sockets } => {
@@ -291,21 +326,41 @@ impl<R: Runtime> StreamListener<R> {
                 port,
                 silent,
                 pending_routing_path_handle,
+                idle,
+                last_pop,
                 ..
             } => {
                 let port = *port;
                 let silent = *silent;
+                let burst = last_pop
+                    .replace(R::now())
+                    .is_some_and(|previous| previous.elapsed() < FORWARD_POOL_IDLE_TIMEOUT);
+
+                Self::expire_idle(idle);
+
+                let future: BoxFuture<'static, Option<R::TcpStream>> = match idle.pop_back() {
+                    Some((stream, _)) => Box::pin(async move { Some(stream) }),
+                    None => Box::pin(Self::connect(port)),
+                };
+
+                // refill the pool only if streams are arriving faster than pooled connections
+                // expire as otherwise the pooled connections would be closed before they're used
+                if burst {
+                    let num_pending = idle.len() + self.pending_connections.len();
+
+                    for _ in num_pending..FORWARD_POOL_SIZE {
+                        self.pending_connections.push(Self::connect(port));
+                    }
+
+                    if let Some(waker) = self.waker.take() {
+                        waker.wake_by_ref();
+                    }
+                }
 
                 Some(SocketKind::Forwarded {
                     pending_routing_path_handle: pending_routing_path_handle.clone(),
                     silent,
-                    future: Box::pin(async move {
-                        R::TcpStream::connect(SocketAddr::new(
-                            IpAddr::V4(Ipv4Addr::new(127, 0, 0, 1)),
-                            port,
-                        ))
-                        .await
-                    }),
+                    future,
                 })
             }
             state => {
@@ -320,6 +375,27 @@ impl<R: Runtime> StreamListener<R> {
         }
     }
 
+    /// Close connections which have been idle for too long, oldest first.
+    fn expire_idle(idle: &mut VecDeque<(R::TcpStream, R::Instant)>) {
+        while idle
+            .front()
+            .is_some_and(|(_, opened)| opened.elapsed() >= FORWARD_POOL_IDLE_TIMEOUT)
+        {
+            idle.pop_front();
+        }
+    }
+
+    /// Open new connection to the forwarded TCP listener at `port`.
+    fn connect(port: u16) -> impl Future<Output = Option<R::TcpStream>> + Send + 'static {
+        async move {
+            R::TcpStream::connect(SocketAddr::new(
+                IpAddr::V4(Ipv4Addr::new(127, 0, 0, 1)),
+                port,
+            ))
+            .await
+        }
+    }
+
     /// Validate that `kind` is an approriate listener kind with the current state.
     ///
     /// `STREAM ACCEPT` and `STREAM FORWARD` are mutually exclusive and the second socket for the
@@ -560,6 +636,45 @@ impl<R: Runtime> futures::Stream for StreamListener<R> {
     type Item = StreamListenerEvent;
 
     fn poll_next(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Option<Self::Item>> {
+        let this = &mut *self;
+
+        loop {
+            match this.pending_connections.poll_next_unpin(cx) {
+                Poll::Pending | Poll::Ready(None) => break,
+                Poll::Ready(Some(None)) => tracing::debug!(
+                    target: LOG_TARGET,
+                    local = %this.destination_id,
+                    "failed to open pooled connection to forwarded listener",
+                ),
+                Poll::Ready(Some(Some(stream))) => match &mut this.state {
+                    ListenerState::Persistent { idle, .. } if idle.len() < FORWARD_POOL_SIZE =>
+                        idle.push_back((stream, R::now())),
+                    _ => {}
+                },
+            }
+        }
+
+        // close idle connections when the oldest of them expires
+        if let ListenerState::Persistent { idle, .. } = &mut this.state {
+            loop {
+                let Some((_, opened)) = idle.front() else {
+                    this.expiration_timer = None;
+                    break;
+                };
+
+                let timer = this.expiration_timer.get_or_insert_with(|| {
+                    R::timer(FORWARD_POOL_IDLE_TIMEOUT.saturating_sub(opened.elapsed()))
+                });
+
+                if timer.poll_unpin(cx).is_pending() {
+                    break;
+                }
+
+                this.expiration_timer = None;
+                Self::expire_idle(idle);
+            }
+        }
+
         loop {
             match self.pending_sockets.poll_next_unpin(cx) {
                 Poll::Pending => break,
@@ -603,6 +718,8 @@ impl<R: Runtime> futures::Stream for StreamListener<R> {
                                     port,
                                     silent,
                                     pending_routing_path_handle,
+                                    idle: VecDeque::new(),
+                                    last_pop: None,
                                 };
                             }
                         },
@@ -647,7 +764,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -656,7 +773,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Persistent {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 port: 1337,
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
@@ -675,7 +792,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Persistent {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 port: 1337,
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
@@ -685,7 +802,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -703,7 +820,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -719,7 +836,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -744,7 +861,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 silent: true,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -758,7 +875,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 silent: true,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -781,7 +898,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Persistent {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 port: 1337,
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
@@ -791,7 +908,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Persistent {
-                socket: SamSocket::new(NoopTcpStream::new()),
+                socket: SamSocket::new(SamStream::Tcp(NoopTcpStream::new())),
                 port: 1338,
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
@@ -814,7 +931,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Persistent {
-                socket: SamSocket::new(stream2.unwrap()),
+                socket: SamSocket::new(SamStream::Tcp(stream2.unwrap())),
                 port: 1337,
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
@@ -862,7 +979,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(eph1.unwrap()),
+                socket: SamSocket::new(SamStream::Tcp(eph1.unwrap())),
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -879,7 +996,7 @@ mod tests {
         // register another ephemeral listener but this time it's silent
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(eph2.unwrap()),
+                socket: SamSocket::new(SamStream::Tcp(eph2.unwrap())),
                 silent: true,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -918,7 +1035,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(eph1.unwrap()),
+                socket: SamSocket::new(SamStream::Tcp(eph1.unwrap())),
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -935,7 +1052,7 @@ mod tests {
         // register another ephemeral listener but this time it's silent
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(eph2.unwrap()),
+                socket: SamSocket::new(SamStream::Tcp(eph2.unwrap())),
                 silent: true,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -980,7 +1097,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(eph1.unwrap()),
+                socket: SamSocket::new(SamStream::Tcp(eph1.unwrap())),
                 silent: true,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -994,7 +1111,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Ephemeral {
-                socket: SamSocket::new(eph2.unwrap()),
+                socket: SamSocket::new(SamStream::Tcp(eph2.unwrap())),
                 silent: true,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
             }),
@@ -1033,7 +1150,7 @@ mod tests {
 
         assert_eq!(
             listener.register_listener(ListenerKind::Persistent {
-                socket: SamSocket::new(stream2.unwrap()),
+                socket: SamSocket::new(SamStream::Tcp(stream2.unwrap())),
                 port: 1337,
                 silent: false,
                 pending_routing_path_handle: PendingRoutingPathHandle::create(),
@@ -1079,4 +1196,146 @@ mod tests {
             }
         }
     }
+
+    #[tokio::test]
+    async fn forwarded_connections_are_pooled_during_bursts() {
+        let listener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let address = listener.local_addr().unwrap();
+        let (_stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
+
+        // tcp listener of the forwarded service
+        let forwarded = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let port = forwarded.local_addr().unwrap().port();
+
+        let mut listener = StreamListener::<MockRuntime>::new(DestinationId::random());
+        assert_eq!(
+            listener.register_listener(ListenerKind::Persistent {
+                socket: SamSocket::new(SamStream::Tcp(stream2.unwrap())),
+                port,
+                silent: false,
+                pending_routing_path_handle: PendingRoutingPathHandle::create(),
+            }),
+            Ok(false)
+        );
+
+        let Some(StreamListenerEvent::ListenerReady) = listener.next().await else {
+            panic!("stream listener exited");
+        };
+
+        // first stream opens a new connection and doesn't fill the pool
+        let Some(SocketKind::Forwarded { future, .. }) = listener.pop_socket() else {
+            panic!("invalid socket kind");
+        };
+        assert!(future.await.is_some());
+        assert_eq!(listener.pending_connections.len(), 0);
+
+        // second stream arrives right after the first one and the pool is filled in the background
+        let Some(SocketKind::Forwarded { future, .. }) = listener.pop_socket() else {
+            panic!("invalid socket kind");
+        };
+        assert!(future.await.is_some());
+        assert_eq!(listener.pending_connections.len(), FORWARD_POOL_SIZE);
+
+        tokio::time::timeout(Duration::from_secs(5), async {
+            loop {
+                futures::future::poll_fn(|cx| {
+                    let _ = listener.poll_next_unpin(cx);
+                    Poll::Ready(())
+                })
+                .await;
+
+                match &listener.state {
+                    ListenerState::Persistent { idle, .. } if idle.len() == FORWARD_POOL_SIZE =>
+                        break,
+                    _ => tokio::time::sleep(Duration::from_millis(10)).await,
+                }
+            }
+        })
+        .await
+        .expect("pool to be filled");
+        assert!(listener.expiration_timer.is_some());
+
+        // third stream is given a pooled connection and the pool is refilled
+        let Some(SocketKind::Forwarded { future, .. }) = listener.pop_socket() else {
+            panic!("invalid socket kind");
+        };
+        assert!(futures::FutureExt::now_or_never(future).flatten().is_some());
+
+        match &listener.state {
+            ListenerState::Persistent { idle, .. } if idle.len() == FORWARD_POOL_SIZE - 1 => {}
+            _ => panic!("invalid state"),
+        }
+        assert_eq!(listener.pending_connections.len(), 1);
+    }
+
+    #[tokio::test]
+    async fn idle_forwarded_connections_expire() {
+        let listener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let address = listener.local_addr().unwrap();
+        let (_stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
+
+        // tcp listener of the forwarded service
+        let forwarded = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let port = forwarded.local_addr().unwrap().port();
+
+        let mut listener = StreamListener::<MockRuntime>::new(DestinationId::random());
+        assert_eq!(
+            listener.register_listener(ListenerKind::Persistent {
+                socket: SamSocket::new(SamStream::Tcp(stream2.unwrap())),
+                port,
+                silent: false,
+                pending_routing_path_handle: PendingRoutingPathHandle::create(),
+            }),
+            Ok(false)
+        );
+
+        let Some(StreamListenerEvent::ListenerReady) = listener.next().await else {
+            panic!("stream listener exited");
+        };
+
+        // add idle connections, one of which was opened before the idle timeout
+        for age in [FORWARD_POOL_IDLE_TIMEOUT, Duration::ZERO] {
+            let stream = MockTcpStream::connect(forwarded.local_addr().unwrap()).await.unwrap();
+
+            match &mut listener.state {
+                ListenerState::Persistent { idle, .. } =>
+                    idle.push_back((stream, MockRuntime::now().subtract(age))),
+                _ => panic!("invalid state"),
+            }
+        }
+
+        // stale connection is closed without any streams arriving
+        futures::future::poll_fn(|cx| {
+            let _ = listener.poll_next_unpin(cx);
+            Poll::Ready(())
+        })
+        .await;
+
+        match &listener.state {
+            ListenerState::Persistent { idle, .. } if idle.len() == 1 => {}
+            _ => panic!("invalid state"),
+        }
+        assert!(listener.expiration_timer.is_some());
+
+        // connection is closed once it also expires
+        match &mut listener.state {
+            ListenerState::Persistent { idle, .. } => idle
+                .iter_mut()
+                .for_each(|(_, opened)| *opened = opened.subtract(FORWARD_POOL_IDLE_TIMEOUT)),
+            _ => panic!("invalid state"),
+        }
+        listener.expiration_timer = None;
+
+        futures::future::poll_fn(|cx| {
+            let _ = listener.poll_next_unpin(cx);
+            Poll::Ready(())
+        })
+        .await;
+
+        match &listener.state {
+            ListenerState::Persistent { idle, .. } if idle.is_empty() => {}
+            _ => panic!("invalid state"),
+        }
+        assert!(listener.expiration_timer.is_none());
+    }
 }
@@ -0,0 +1,88 @@
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+use crate::runtime::MetricType;
+
+use alloc::{vec, vec::Vec};
+
+// general
+pub const NUM_STREAMS: &str = "streaming_stream_count";
+pub const RETRANSMISSION_COUNT: &str = "streaming_retransmission_count";
+
+// active stream
+pub const RTT: &str = "streaming_rtt_buckets";
+pub const STREAM_RETRANSMISSIONS: &str = "streaming_stream_retransmissions_buckets";
+pub const WINDOW_SIZE: &str = "streaming_window_size_buckets";
+pub const BYTES_IN_FLIGHT: &str = "streaming_bytes_in_flight_buckets";
+pub const WINDOW_BLOCKED_DURATION: &str = "streaming_window_blocked_duration_buckets";
+
+/// Register streaming metrics.
+pub fn register_metrics(mut metrics: Vec<MetricType>) -> Vec<MetricType> {
+    // counters
+    metrics.push(MetricType::Counter {
+        name: RETRANSMISSION_COUNT,
+        description: "how many streaming packets have been resent",
+    });
+
+    // gauges
+    metrics.push(MetricType::Gauge {
+        name: NUM_STREAMS,
+        description: "how many active streams there are",
+    });
+
+    // histograms
+    metrics.push(MetricType::Histogram {
+        name: RTT,
+        description: "measured stream round-trip times",
+        buckets: vec![
+            100f64, 200f64, 300f64, 400f64, 500f64, 600f64, 700f64, 800f64, 900f64, 1000f64,
+            1250f64, 1500f64, 2000f64, 2500f64, 3000f64, 4000f64, 5000f64, 8000f64, 10_000f64,
+        ],
+    });
+    metrics.push(MetricType::Histogram {
+        name: STREAM_RETRANSMISSIONS,
+        description: "how many packets a stream resent during its lifetime",
+        buckets: vec![
+            0f64, 1f64, 2f64, 3f64, 5f64, 10f64, 20f64, 50f64, 100f64, 200f64, 500f64, 1000f64,
+        ],
+    });
+    metrics.push(MetricType::Histogram {
+        name: WINDOW_SIZE,
+        description: "congestion window sizes of streams, in packets",
+        buckets: vec![
+            1f64, 2f64, 4f64, 6f64, 8f64, 12f64, 16f64, 24f64, 32f64, 48f64, 64f64, 96f64, 128f64,
+        ],
+    });
+    metrics.push(MetricType::Histogram {
+        name: BYTES_IN_FLIGHT,
+        description: "how many unacked bytes streams have in flight",
+        buckets: vec![
+            1812f64, 3624f64, 7248f64, 14_496f64, 28_992f64, 57_984f64, 115_968f64, 231_936f64,
+        ],
+    });
+    metrics.push(MetricType::Histogram {
+        name: WINDOW_BLOCKED_DURATION,
+        description: "how long streams were blocked on a full congestion window, in milliseconds",
+        buckets: vec![
+            10f64, 50f64, 100f64, 200f64, 300f64, 500f64, 750f64, 1000f64, 2000f64, 3000f64,
+            5000f64, 10_000f64,
+        ],
+    });
+
+    metrics
+}
@@ -22,18 +22,19 @@ use crate::{
     error::StreamingError,
     i2cp::I2cpPayload,
     primitives::{Destination, DestinationId},
-    runtime::{Instant, JoinSet, Runtime},
+    runtime::{Gauge, Instant, JoinSet, MetricType, MetricsHandle, Runtime},
     sam::{
+        parser::StreamOptions,
         protocol::streaming::{
-            config::StreamConfig,
             listener::{SocketKind, StreamListener, StreamListenerEvent},
+            metrics::*,
             packet::{Packet, PacketBuilder},
             stream::{
-                active::{Stream, StreamContext, StreamEvent, StreamKind},
+                active::{Stream, StreamContext, StreamEvent, StreamKind, MTU_SIZE},
                 pending::{PendingStream, PendingStreamResult},
             },
         },
-        socket::SamSocket,
+        socket::{SamSocket, SamStream},
     },
 };
 
@@ -43,8 +44,9 @@ use hashbrown::{HashMap, HashSet};
 use rand_core::RngCore;
 use thingbuf::mpsc::{channel, Receiver, Sender};
 
-use alloc::{collections::VecDeque, format, string::String, vec, vec::Vec};
+use alloc::{collections::VecDeque, format, vec, vec::Vec};
 use core::{
+    cmp,
     future::Future,
     pin::Pin,
     task::{Context, Poll},
@@ -53,10 +55,13 @@ use core::{
 
 mod config;
 mod listener;
+mod metrics;
 mod packet;
 mod stream;
 
+pub use config::StreamConfig;
 pub use listener::ListenerKind;
+pub use stream::active::StreamStats;
 
 /// Logging target for the file.
 const LOG_TARGET: &str = "emissary::streaming";
@@ -75,8 +80,20 @@ const STREAM_CHANNEL_SIZE: usize = 512;
 const PENDING_STREAM_PRUNE_THRESHOLD: Duration = Duration::from_secs(30);
 
 /// How long should a pending outbound stream wait before sending another `SYN`.
+///
+/// Used if the RTT of the remote destination is not known and as an upper bound for the
+/// RTT-based timeout.
 const SYN_RETRY_TIMEOUT: Duration = Duration::from_secs(10);
 
+/// Minimum timeout for sending another `SYN` when the RTT of the remote destination is known.
+const MIN_SYN_RETRY_TIMEOUT: Duration = Duration::from_secs(2);
+
+/// How many RTTs should a pending outbound stream wait before sending another `SYN`.
+const SYN_RETRY_RTT_MULTIPLIER: u32 = 3u32;
+
+/// Maximum number of remote destinations whose `SYN` RTTs are tracked.
+const MAX_SYN_RTTS: usize = 1024usize;
+
 /// Timeout for graceful shutdown.
 const GRACEFUL_SHUTDOWN_TIMEOUT: Duration = Duration::from_secs(60);
 
@@ -130,6 +147,13 @@ pub enum StreamManagerEvent {
         src_port: u16,
     },
 
+    /// Transmission state snapshots of active streams.
+    StreamStats {
+        /// (receive stream ID, remote destination ID, snapshot) tuples, sorted by receive stream
+        /// ID.
+        stats: Vec<(u32, DestinationId, StreamStats)>,
+    },
+
     /// [`StreamManager`] has been shut down.
     ShutDown,
 }
@@ -220,9 +244,15 @@ struct PendingOutboundStream<R: Runtime> {
     /// Serialised `SYN` packet.
     packet: Vec<u8>,
 
+    /// Serialised packets sent before the `SYN` has been ACKed.
+    pre_ack_packets: Vec<Vec<u8>>,
+
     /// Routing path handle.
     routing_path_handle: RoutingPathHandle<R>,
 
+    /// When was the first `SYN` sent.
+    sent: R::Instant,
+
     /// Has the stream configured to be silent.
     silent: bool,
 
@@ -231,6 +261,24 @@ struct PendingOutboundStream<R: Runtime> {
 
     /// Source port.
     src_port: u16,
+
+    /// Client data that didn't fit into the initial window.
+    unsent: Vec<u8>,
+}
+
+/// Pending query for transmission state snapshots of active streams.
+struct StatsQuery {
+    /// Number of active streams that haven't responded yet.
+    num_pending: usize,
+
+    /// Number of `STREAM STATS` requests the query is answering.
+    num_requests: usize,
+
+    /// RX channel for receiving snapshots from active streams.
+    rx: Receiver<(u32, StreamStats)>,
+
+    /// Snapshots received so far.
+    stats: Vec<(u32, DestinationId, StreamStats)>,
 }
 
 /// I2P virtual stream manager.
@@ -252,6 +300,9 @@ pub struct StreamManager<R: Runtime> {
     /// Stream listener.
     listener: StreamListener<R>,
 
+    /// Metrics handle.
+    metrics: R::MetricsHandle,
+
     /// RX channel for receiving [`Packet`]s from active streams.
     outbound_rx: Receiver<(DeliveryStyle, Vec<u8>, u16, u16)>,
 
@@ -275,19 +326,35 @@ pub struct StreamManager<R: Runtime> {
     /// Timer for pruning stale pending streams.
     prune_timer: R::Timer,
 
+    /// Smoothed `SYN` RTTs of remote destinations.
+    ///
+    /// Used to calculate the `SYN` retry timeout for new outbound streams.
+    rtts: HashMap<DestinationId, Duration>,
+
     /// Shutdown handler.
     shutdown_handler: ShutdownHandler<R>,
 
     /// Signing key.
     signing_key: SigningPrivateKey,
 
+    /// Pending query for transmission state snapshots, if any.
+    stats_query: Option<StatsQuery>,
+
     /// Active streams.
     streams: R::JoinSet<u32>,
+
+    /// Streaming configuration used for new streams.
+    stream_config: StreamConfig,
 }
 
 impl<R: Runtime> StreamManager<R> {
     /// Create new [`StreamManager`].
-    pub fn new(destination: Destination, signing_key: SigningPrivateKey) -> Self {
+    pub fn new(
+        destination: Destination,
+        signing_key: SigningPrivateKey,
+        stream_config: StreamConfig,
+        metrics: R::MetricsHandle,
+    ) -> Self {
         let (outbound_tx, outbound_rx) = channel(STREAM_MANAGER_CHANNEL_SIZE);
         let destination_id = destination.id();
 
@@ -297,6 +364,7 @@ impl<R: Runtime> StreamManager<R> {
             destination_id: destination_id.clone(),
             destination_streams: HashMap::new(),
             listener: StreamListener::new(destination_id),
+            metrics,
             outbound_rx,
             outbound_timers: R::join_set(),
             outbound_tx,
@@ -304,12 +372,50 @@ impl<R: Runtime> StreamManager<R> {
             pending_inbound: HashMap::new(),
             pending_outbound: HashMap::new(),
             prune_timer: R::timer(PENDING_STREAM_PRUNE_THRESHOLD),
+            rtts: HashMap::new(),
             shutdown_handler: ShutdownHandler::new(),
             signing_key,
+            stats_query: None,
             streams: R::join_set(),
+            stream_config,
         }
     }
 
+    /// Collect streaming-related metric counters, gauges and histograms.
+    pub fn metrics(metrics: Vec<MetricType>) -> Vec<MetricType> {
+        metrics::register_metrics(metrics)
+    }
+
+    /// Query transmission state snapshots of all active streams.
+    ///
+    /// Each active stream builds its snapshot when it receives the query and the snapshots are
+    /// returned in [`StreamManagerEvent::StreamStats`] after all streams have responded.
+    ///
+    /// If a query is already in progress, its result is returned for this request as well.
+    pub fn query_stream_stats(&mut self) {
+        if let Some(query) = &mut self.stats_query {
+            query.num_requests += 1;
+            return;
+        }
+
+        // each stream sends at most one snapshot so sending never fails for lack of space
+        let (tx, rx) = channel(cmp::max(self.active.len(), 1));
+        let num_pending = self
+            .active
+            .values()
+            .filter(|(_, stream_tx)| {
+                stream_tx.try_send(StreamEvent::QueryStats { tx: tx.clone() }).is_ok()
+            })
+            .count();
+
+        self.stats_query = Some(StatsQuery {
+            num_pending,
+            num_requests: 1usize,
+            rx,
+            stats: Vec::with_capacity(num_pending),
+        });
+    }
+
     /// Handle message with `SYN`.
     ///
     /// If this a response to an outbound stream sent by us, convert the pending stream to an active
@@ -415,18 +521,31 @@ impl<R: Runtime> StreamManager<R> {
             dst_port,
             src_port,
             routing_path_handle,
+            num_sent,
+            pre_ack_packets,
+            sent,
+            unsent,
             ..
         }) = self.pending_outbound.remove(&send_stream_id)
         {
+            // RTT is sampled only if the `SYN` wasn't retransmitted as it's otherwise unknown which
+            // of the `SYN`s the remote responded to
+            let rtt = (num_sent == 1).then(|| sent.elapsed());
+
             tracing::trace!(
                 target: LOG_TARGET,
                 local = %self.destination_id,
                 remote = %destination_id,
                 ?recv_stream_id,
                 ?send_stream_id,
+                ?rtt,
                 "outbound stream accepted",
             );
 
+            if let Some(sample) = rtt {
+                self.register_syn_rtt(&destination_id, sample);
+            }
+
             self.spawn_stream(
                 SocketKind::Connect {
                     routing_path_handle,
@@ -435,11 +554,15 @@ impl<R: Runtime> StreamManager<R> {
                 },
                 recv_stream_id,
                 destination_id.clone(),
+                flags.max_packet_size(),
                 StreamKind::Outbound {
                     dst_port,
                     send_stream_id,
                     src_port,
                     payload: payload.to_vec(),
+                    pre_ack_packets,
+                    rtt,
+                    unsent,
                 },
             );
 
@@ -490,6 +613,7 @@ impl<R: Runtime> StreamManager<R> {
                 socket,
                 recv_stream_id,
                 destination.id(),
+                flags.max_packet_size(),
                 StreamKind::Inbound {
                     payload: payload.to_vec(),
                 },
@@ -512,6 +636,7 @@ impl<R: Runtime> StreamManager<R> {
                     destination_id.clone(),
                     recv_stream_id,
                     payload.to_vec(),
+                    flags.max_packet_size(),
                     &self.signing_key,
                 );
                 let _ = self.outbound_tx.try_send((
@@ -546,6 +671,7 @@ impl<R: Runtime> StreamManager<R> {
         socket: SocketKind<R>,
         recv_stream_id: u32,
         destination_id: DestinationId,
+        max_packet_size: Option<u16>,
         stream_kind: StreamKind,
     ) {
         // create context for the stream
@@ -562,6 +688,7 @@ impl<R: Runtime> StreamManager<R> {
             recv_stream_id,
             remote: destination_id.clone(),
             signing_key: self.signing_key.clone(),
+            max_packet_size,
         };
 
         // if the socket wasn't configured to be silent, send the remote's destination
@@ -579,6 +706,7 @@ impl<R: Runtime> StreamManager<R> {
         // `StreamManager` sends all inbound messages with `recv_stream_id` to this stream and all
         // outbound messages from the stream to remote peer are send through `event_tx`
         self.active.insert(recv_stream_id, (destination_id.clone(), tx));
+        self.metrics.gauge(NUM_STREAMS).increment(1);
         self.destination_streams
             .entry(destination_id.clone())
             .or_default()
@@ -609,6 +737,9 @@ impl<R: Runtime> StreamManager<R> {
         // if the listener was created with `STREAM FORWARD`, a new tcp connection must be opened to
         // the forwarded listener before the stream can be started and if the listener is not
         // active, the stream is closed immediately
+        let stream_config = self.stream_config.clone();
+        let metrics = self.metrics.clone();
+
         match socket {
             SocketKind::Connect {
                 socket,
@@ -618,9 +749,10 @@ impl<R: Runtime> StreamManager<R> {
                 socket,
                 initial_message,
                 context,
-                StreamConfig::default(),
+                stream_config,
                 stream_kind,
                 routing_path_handle,
+                metrics,
             )),
             SocketKind::Accept {
                 pending_routing_path_handle,
@@ -642,9 +774,10 @@ impl<R: Runtime> StreamManager<R> {
                         socket,
                         initial_message,
                         context,
-                        StreamConfig::default(),
+                        stream_config,
                         stream_kind,
                         routing_path_handle,
+                        metrics,
                     )
                     .await
                 });
@@ -673,12 +806,13 @@ impl<R: Runtime> StreamManager<R> {
                 };
 
                 Stream::<R>::new(
-                    stream,
+                    SamStream::Tcp(stream),
                     initial_message,
                     context,
-                    StreamConfig::default(),
+                    stream_config,
                     stream_kind,
                     routing_path_handle,
+                    metrics,
                 )
                 .await
             }),
@@ -720,6 +854,7 @@ impl<R: Runtime> StreamManager<R> {
             // stream must exist since it was checked earlier that it's in the map
             let PendingStream {
                 destination_id,
+                max_packet_size,
                 send_stream_id,
                 packets,
                 seq_nro,
@@ -731,6 +866,7 @@ impl<R: Runtime> StreamManager<R> {
                 socket,
                 stream_id,
                 destination_id,
+                max_packet_size,
                 StreamKind::InboundPending {
                     send_stream_id,
                     seq_nro,
@@ -895,28 +1031,55 @@ impl<R: Runtime> StreamManager<R> {
         Ok(())
     }
 
+    /// Calculate `SYN` retry timeout for `destination_id`.
+    ///
+    /// If the RTT of the remote destination is known, the timeout is a multiple of the RTT and
+    /// otherwise [`SYN_RETRY_TIMEOUT`] is used.
+    fn syn_retry_timeout(&self, destination_id: &DestinationId) -> Duration {
+        self.rtts.get(destination_id).map_or(SYN_RETRY_TIMEOUT, |rtt| {
+            (*rtt * SYN_RETRY_RTT_MULTIPLIER).clamp(MIN_SYN_RETRY_TIMEOUT, SYN_RETRY_TIMEOUT)
+        })
+    }
+
+    /// Register `SYN` RTT `sample` for `destination_id`.
+    fn register_syn_rtt(&mut self, destination_id: &DestinationId, sample: Duration) {
+        if let Some(rtt) = self.rtts.get_mut(destination_id) {
+            *rtt = (*rtt * 7 + sample) / 8;
+            return;
+        }
+
+        if self.rtts.len() >= MAX_SYN_RTTS {
+            if let Some(key) = self.rtts.keys().next().cloned() {
+                self.rtts.remove(&key);
+            }
+        }
+
+        self.rtts.insert(destination_id.clone(), sample);
+    }
+
     /// Create outbound stream to remote peer identfied by `destination_id`.
     ///
     /// Construct initial `SYN` packet and create pending outbound stream.
     ///
+    /// Any data the client has already sent after `STREAM CONNECT` is carried in the `SYN` and,
+    /// if the initial window allows it, in additional packets sent before the `SYN` is ACKed. If
+    /// there is another routing path to remote destination available, a copy of the `SYN` is also
+    /// sent over that path, allowing the stream to be opened over whichever path is faster.
+    ///
     /// Returns the initial packet and the selected receive stream ID which the caller
     /// can use to remove the pending stream if the session is rejected at a lower layer.
     pub fn create_stream(
         &mut self,
         destination_id: DestinationId,
         mut routing_path_handle: RoutingPathHandle<R>,
-        socket: SamSocket<R>,
-        options: HashMap<String, String>,
+        mut socket: SamSocket<R>,
+        options: StreamOptions,
     ) -> (u32, BytesMut, DeliveryStyle, u16, u16) {
-        let silent = options
-            .get("SILENT")
-            .is_some_and(|value| value.parse::<bool>().unwrap_or(false));
-        let src_port = options
-            .get("FROM_PORT")
-            .map_or(0u16, |value| value.parse::<u16>().unwrap_or(0u16));
-        let dst_port = options
-            .get("TO_PORT")
-            .map_or(0u16, |value| value.parse::<u16>().unwrap_or(0u16));
+        let StreamOptions {
+            silent,
+            from_port: src_port,
+            to_port: dst_port,
+        } = options;
 
         // generate free receive stream id
         let recv_stream_id = {
@@ -933,19 +1096,48 @@ impl<R: Runtime> StreamManager<R> {
             }
         };
 
+        // split data the client has sent before the stream was opened into the `SYN` payload,
+        // packets that fit into the initial window and data that is sent after the stream is open
+        let data = socket.take_buffered();
+        let (syn_payload, rest) = data.split_at(cmp::min(data.len(), MTU_SIZE));
+        let (pre_ack_data, unsent) = rest.split_at(cmp::min(
+            rest.len(),
+            self.stream_config
+                .initial_window_size
+                .saturating_sub(1)
+                .saturating_mul(MTU_SIZE),
+        ));
+
         let packet = PacketBuilder::new(recv_stream_id)
             .with_send_stream_id(0u32)
             .with_replay_protection(&destination_id)
             .with_synchronize()
             .with_signature()
             .with_from_included(self.destination.clone())
+            .with_payload(syn_payload)
             .build_and_sign(&self.signing_key);
 
+        let pre_ack_packets = pre_ack_data
+            .chunks(MTU_SIZE)
+            .zip(1u32..)
+            .map(|(payload, seq_nro)| {
+                PacketBuilder::new(recv_stream_id)
+                    .with_send_stream_id(0u32)
+                    .with_seq_nro(seq_nro)
+                    .with_payload(payload)
+                    .build()
+                    .to_vec()
+            })
+            .collect::<Vec<_>>();
+
         tracing::debug!(
             target: LOG_TARGET,
             local = %self.destination_id,
             remote = %destination_id,
             ?recv_stream_id,
+            syn_payload_len = ?syn_payload.len(),
+            num_pre_ack_packets = ?pre_ack_packets.len(),
+            unsent_len = ?unsent.len(),
             "open stream",
         );
 
@@ -956,6 +1148,29 @@ impl<R: Runtime> StreamManager<R> {
             Some(routing_path) => DeliveryStyle::ViaRoute { routing_path },
         };
 
+        // send a copy of the `SYN` over another routing path, if available, and the packets
+        // following the `SYN` over the primary routing path
+        //
+        // the packets are sent through the channel used by active streams so they're sent after
+        // the `SYN` which is returned to the caller
+        if let Some(routing_path) = routing_path_handle.alternative_routing_path() {
+            let _ = self.outbound_tx.try_send((
+                DeliveryStyle::ViaRoute { routing_path },
+                packet.to_vec(),
+                src_port,
+                dst_port,
+            ));
+        }
+
+        for packet in &pre_ack_packets {
+            let _ = self.outbound_tx.try_send((
+                delivery_style.clone(),
+                packet.clone(),
+                src_port,
+                dst_port,
+            ));
+        }
+
         // create pending stream and start timer for retrying `SYN` if the remote doesn't respond to
         // the first packet
         //
@@ -967,18 +1182,23 @@ impl<R: Runtime> StreamManager<R> {
                 dst_port,
                 num_sent: 1usize,
                 packet: packet.clone().to_vec(),
+                pre_ack_packets,
                 routing_path_handle,
+                sent: R::now(),
                 silent,
                 socket,
                 src_port,
+                unsent: unsent.to_vec(),
             },
         );
+
+        let timeout = self.syn_retry_timeout(&destination_id);
         self.destination_streams
             .entry(destination_id)
             .or_default()
             .insert(recv_stream_id);
         self.outbound_timers.push(async move {
-            R::delay(SYN_RETRY_TIMEOUT).await;
+            R::delay(timeout).await;
             recv_stream_id
         });
 
@@ -1073,6 +1293,44 @@ impl<R: Runtime> futures::Stream for StreamManager<R> {
             Poll::Ready(ShutdownEvent::AlreadyShutDown) => return Poll::Pending,
         }
 
+        if let Some(mut query) = self.stats_query.take() {
+            // the channel is closed once every stream that received the query has either responded
+            // or exited
+            while query.num_pending > 0 {
+                match query.rx.poll_recv(cx) {
+                    Poll::Pending => break,
+                    Poll::Ready(None) => query.num_pending = 0,
+                    Poll::Ready(Some((stream_id, stats))) => {
+                        query.num_pending -= 1;
+
+                        if let Some((destination_id, _)) = self.active.get(&stream_id) {
+                            query.stats.push((stream_id, destination_id.clone(), stats));
+                        }
+                    }
+                }
+            }
+
+            match query.num_pending {
+                0 => {
+                    let StatsQuery {
+                        num_requests,
+                        mut stats,
+                        ..
+                    } = query;
+                    stats.sort_unstable_by_key(|(stream_id, _, _)| *stream_id);
+
+                    for _ in 1..num_requests {
+                        self.pending_events.push_back(StreamManagerEvent::StreamStats {
+                            stats: stats.clone(),
+                        });
+                    }
+
+                    return Poll::Ready(Some(StreamManagerEvent::StreamStats { stats }));
+                }
+                _ => self.stats_query = Some(query),
+            }
+        }
+
         match self.outbound_rx.poll_recv(cx) {
             Poll::Pending => {}
             Poll::Ready(None) => return Poll::Ready(None),
@@ -1097,6 +1355,8 @@ impl<R: Runtime> futures::Stream for StreamManager<R> {
                         "stream closed"
                     );
 
+                    self.metrics.gauge(NUM_STREAMS).decrement(1);
+
                     // active stream may not exist if it was removed by calling
                     // `StreamManager::remove_session()`
                     let Some((destination_id, _)) = self.active.remove(&stream_id) else {
@@ -1138,6 +1398,13 @@ impl<R: Runtime> futures::Stream for StreamManager<R> {
                 Poll::Pending => break,
                 Poll::Ready(None) => return Poll::Ready(None),
                 Poll::Ready(Some(stream_id)) => {
+                    let Some(timeout) = self
+                        .pending_outbound
+                        .get(&stream_id)
+                        .map(|stream| self.syn_retry_timeout(&stream.destination_id))
+                    else {
+                        continue;
+                    };
                     let Some(PendingOutboundStream {
                         destination_id,
                         packet,
@@ -1145,6 +1412,7 @@ impl<R: Runtime> futures::Stream for StreamManager<R> {
                         dst_port,
                         src_port,
                         routing_path_handle,
+                        pre_ack_packets,
                         ..
                     }) = self.pending_outbound.get_mut(&stream_id)
                     else {
@@ -1157,6 +1425,7 @@ impl<R: Runtime> futures::Stream for StreamManager<R> {
                         let dst_port = *dst_port;
                         let src_port = *src_port;
                         let packet = packet.clone();
+                        let pre_ack_packets = pre_ack_packets.clone();
                         *num_sent += 1;
 
                         // poll routing path to get any tunnel updates
@@ -1171,7 +1440,7 @@ impl<R: Runtime> futures::Stream for StreamManager<R> {
                             );
 
                             self.outbound_timers.push(async move {
-                                R::delay(SYN_RETRY_TIMEOUT).await;
+                                R::delay(timeout).await;
                                 stream_id
                             });
 
@@ -1185,11 +1454,24 @@ impl<R: Runtime> futures::Stream for StreamManager<R> {
                             "resend `SYN`",
                         );
 
+                        // packets sent before the `SYN` was ACKed were ignored by remote if they
+                        // arrived before the `SYN` so resend them after the new `SYN`
+                        pre_ack_packets.into_iter().for_each(|packet| {
+                            self.pending_events.push_back(StreamManagerEvent::SendPacket {
+                                delivery_style: DeliveryStyle::ViaRoute {
+                                    routing_path: routing_path.clone(),
+                                },
+                                dst_port,
+                                packet,
+                                src_port,
+                            });
+                        });
+
                         // create new timer for the new syn packet
                         //
                         // the future is guaranteed to be polled as we return from this branch
                         self.outbound_timers.push(async move {
-                            R::delay(SYN_RETRY_TIMEOUT).await;
+                            R::delay(timeout).await;
                             stream_id
                         });
 
@@ -1275,8 +1557,9 @@ mod tests {
         },
         sam::{protocol::streaming::packet::PacketBuilder, socket::SamSocket},
     };
+    use alloc::string::String;
     use tokio::{
-        io::{AsyncBufReadExt, AsyncReadExt, BufReader},
+        io::{AsyncBufReadExt, AsyncReadExt, AsyncWriteExt, BufReader},
         net::TcpListener,
     };
 
@@ -1297,7 +1580,7 @@ mod tests {
                 tokio::join!(self.listener.accept(), MockTcpStream::connect(address));
             let (stream, _) = stream1.unwrap();
 
-            (SamSocket::new(stream2.unwrap()), stream)
+            (SamSocket::new(SamStream::Tcp(stream2.unwrap())), stream)
         }
     }
 
@@ -1308,11 +1591,16 @@ mod tests {
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
 
         let (_stream, _) = stream1.unwrap();
-        let socket = SamSocket::<MockRuntime>::new(stream2.unwrap());
+        let socket = SamSocket::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
 
         let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
         let destination = Destination::new::<MockRuntime>(signing_key.public());
-        let mut manager = StreamManager::<MockRuntime>::new(destination, signing_key);
+        let mut manager = StreamManager::<MockRuntime>::new(
+            destination,
+            signing_key,
+            StreamConfig::default(),
+            MockRuntime::register_metrics(vec![], None),
+        );
 
         assert!(manager
             .register_listener(ListenerKind::Ephemeral {
@@ -1328,7 +1616,12 @@ mod tests {
         let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
         let destination = Destination::new::<MockRuntime>(signing_key.public());
         let destination_id = destination.id();
-        let mut manager = StreamManager::<MockRuntime>::new(destination, signing_key);
+        let mut manager = StreamManager::<MockRuntime>::new(
+            destination,
+            signing_key,
+            StreamConfig::default(),
+            MockRuntime::register_metrics(vec![], None),
+        );
 
         let mut packets = (0..3)
             .into_iter()
@@ -1429,7 +1722,12 @@ mod tests {
         let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
         let destination = Destination::new::<MockRuntime>(signing_key.public());
         let destination_id = destination.id();
-        let mut manager = StreamManager::<MockRuntime>::new(destination, signing_key);
+        let mut manager = StreamManager::<MockRuntime>::new(
+            destination,
+            signing_key,
+            StreamConfig::default(),
+            MockRuntime::register_metrics(vec![], None),
+        );
 
         // register new inbound stream and since there are no listener, the stream will be pending
         let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
@@ -1459,7 +1757,7 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
         let (_stream, _) = stream1.unwrap();
-        let socket = SamSocket::<MockRuntime>::new(stream2.unwrap());
+        let socket = SamSocket::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
 
         assert!(manager
             .register_listener(ListenerKind::Ephemeral {
@@ -1507,7 +1805,12 @@ mod tests {
         let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
         let destination = Destination::new::<MockRuntime>(signing_key.public());
         let destination_id = destination.id();
-        let mut manager = StreamManager::<MockRuntime>::new(destination, signing_key);
+        let mut manager = StreamManager::<MockRuntime>::new(
+            destination,
+            signing_key,
+            StreamConfig::default(),
+            MockRuntime::register_metrics(vec![], None),
+        );
 
         // register new inbound stream and since there are no listener, the stream will be pending
         let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
@@ -1537,7 +1840,7 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
         let (_stream, _) = stream1.unwrap();
-        let socket = SamSocket::<MockRuntime>::new(stream2.unwrap());
+        let socket = SamSocket::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
 
         assert!(manager
             .register_listener(ListenerKind::Ephemeral {
@@ -1580,7 +1883,12 @@ mod tests {
         let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
         let destination = Destination::new::<MockRuntime>(signing_key.public());
         let destination_id = destination.id();
-        let mut manager = StreamManager::<MockRuntime>::new(destination, signing_key);
+        let mut manager = StreamManager::<MockRuntime>::new(
+            destination,
+            signing_key,
+            StreamConfig::default(),
+            MockRuntime::register_metrics(vec![], None),
+        );
 
         // register new inbound stream and since there are no listener, the stream will be pending
         let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
@@ -1611,7 +1919,7 @@ mod tests {
         let port = address.port();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
         let (stream, _) = stream1.unwrap();
-        let socket = SamSocket::<MockRuntime>::new(stream2.unwrap());
+        let socket = SamSocket::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
 
         assert!(manager
             .register_listener(ListenerKind::Persistent {
@@ -1661,7 +1969,12 @@ mod tests {
         let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
         let destination = Destination::new::<MockRuntime>(signing_key.public());
         let destination_id = destination.id();
-        let mut manager = StreamManager::<MockRuntime>::new(destination, signing_key);
+        let mut manager = StreamManager::<MockRuntime>::new(
+            destination,
+            signing_key,
+            StreamConfig::default(),
+            MockRuntime::register_metrics(vec![], None),
+        );
 
         // register new inbound stream and since there are no listener, the stream will be pending
         let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
@@ -1776,7 +2089,7 @@ mod tests {
         let address = listener.local_addr().unwrap();
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
         let (mut stream, _) = stream1.unwrap();
-        let socket = SamSocket::<MockRuntime>::new(stream2.unwrap());
+        let socket = SamSocket::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
 
         let outbound = TunnelId::random();
         let inbound = Lease::random();
@@ -1813,13 +2126,23 @@ mod tests {
         let mut manager1 = {
             let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let mut manager2 = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let outbound1 = TunnelId::random();
@@ -1865,7 +2188,7 @@ mod tests {
             manager1.destination_id.clone(),
             handle,
             socket,
-            HashMap::new(),
+            StreamOptions::default(),
         );
 
         assert!(manager1
@@ -1922,6 +2245,178 @@ mod tests {
         assert_eq!(response.as_str(), "STREAM STATUS RESULT=OK\n");
     }
 
+    #[tokio::test]
+    async fn buffered_client_data_sent_before_syn_is_acked() {
+        let socket_factory = SocketFactory::new().await;
+
+        let mut manager1 = {
+            let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
+            let destination = Destination::new::<MockRuntime>(signing_key.public());
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
+        };
+
+        let mut manager2 = {
+            let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
+            let destination = Destination::new::<MockRuntime>(signing_key.public());
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig {
+                    initial_window_size: 2usize,
+                    ..Default::default()
+                },
+                MockRuntime::register_metrics(vec![], None),
+            )
+        };
+
+        let mut path_manager1 = RoutingPathManager::<MockRuntime>::new(
+            manager1.destination_id.clone(),
+            vec![TunnelId::random()],
+        );
+        let pending_handle = path_manager1.pending_handle();
+        path_manager1.register_leases(&manager2.destination_id, Ok(vec![Lease::random()]));
+
+        let mut path_manager2 = RoutingPathManager::<MockRuntime>::new(
+            manager2.destination_id.clone(),
+            vec![TunnelId::random()],
+        );
+        path_manager2.register_leases(&manager1.destination_id, Ok(vec![Lease::random()]));
+        let handle = path_manager2.handle(manager1.destination_id.clone());
+
+        tokio::spawn(async move {
+            loop {
+                tokio::select! {
+                    _ = &mut path_manager1.next() => {}
+                    _ = &mut path_manager2.next() => {}
+                }
+            }
+        });
+
+        // register listener for `manager1`
+        let (socket, mut listener_stream) = socket_factory.socket().await;
+        assert!(manager1
+            .register_listener(ListenerKind::Ephemeral {
+                socket,
+                silent: true,
+                pending_routing_path_handle: pending_handle,
+            })
+            .is_ok());
+
+        // client sends data right after the command
+        let data = (0..2 * MTU_SIZE + 10).map(|i| i as u8).collect::<Vec<_>>();
+        let (mut socket, mut client_stream) = socket_factory.socket().await;
+        client_stream
+            .write_all(&[&b"HELLO VERSION\n"[..], &data[..]].concat())
+            .await
+            .unwrap();
+        assert!(socket.next().await.is_some());
+
+        let (stream_id, packet, _, _, _) = manager2.create_stream(
+            manager1.destination_id.clone(),
+            handle,
+            socket,
+            StreamOptions::default(),
+        );
+
+        // first chunk is carried in the syn, second one in a packet sent before the syn is acked
+        // and the rest is sent after the stream has been opened
+        {
+            let syn = Packet::parse(&packet).unwrap();
+            assert!(syn.flags.synchronize());
+            assert_eq!(syn.payload, &data[..MTU_SIZE]);
+
+            let pending = manager2.pending_outbound.get(&stream_id).unwrap();
+            assert_eq!(pending.pre_ack_packets.len(), 1);
+            assert_eq!(pending.unsent, &data[2 * MTU_SIZE..]);
+        }
+
+        let pre_ack_packet = match tokio::time::timeout(Duration::from_secs(1), manager2.next())
+            .await
+            .expect("no timeout")
+            .expect("to succeed")
+        {
+            StreamManagerEvent::SendPacket { packet, .. } => {
+                let parsed = Packet::parse(&packet).unwrap();
+
+                assert_eq!(parsed.send_stream_id, 0u32);
+                assert_eq!(parsed.recv_stream_id, stream_id);
+                assert_eq!(parsed.seq_nro, 1u32);
+                assert_eq!(parsed.payload, &data[MTU_SIZE..2 * MTU_SIZE]);
+
+                packet
+            }
+            _ => panic!("invalid event"),
+        };
+
+        for packet in [packet.to_vec(), pre_ack_packet] {
+            assert!(manager1
+                .on_packet(I2cpPayload {
+                    src_port: 0u16,
+                    dst_port: 0u16,
+                    protocol: Protocol::Streaming,
+                    payload: packet,
+                })
+                .is_ok());
+        }
+
+        assert!(std::matches!(
+            manager1.next().await,
+            Some(StreamManagerEvent::StreamOpened { .. })
+        ));
+
+        let packet = match tokio::time::timeout(Duration::from_secs(5), manager1.next())
+            .await
+            .unwrap()
+            .unwrap()
+        {
+            StreamManagerEvent::SendPacket { packet, .. } => packet,
+            _ => panic!("invalid event"),
+        };
+
+        assert!(manager2.rtts.is_empty());
+        assert!(manager2
+            .on_packet(I2cpPayload {
+                src_port: 0u16,
+                dst_port: 0u16,
+                protocol: Protocol::Streaming,
+                payload: packet
+            })
+            .is_ok());
+
+        // rtt of the syn has been measured and is used for the next streams
+        assert!(manager2.rtts.contains_key(&manager1.destination_id));
+        assert_eq!(
+            manager2.syn_retry_timeout(&manager1.destination_id),
+            MIN_SYN_RETRY_TIMEOUT
+        );
+
+        tokio::spawn(async move {
+            loop {
+                tokio::select! {
+                    _ = manager1.next() => {}
+                    _ = manager2.next() => {}
+                }
+            }
+        });
+
+        // verify that the listener receives all data in order
+        let mut received = vec![0u8; data.len()];
+        tokio::time::timeout(
+            Duration::from_secs(10),
+            listener_stream.read_exact(&mut received),
+        )
+        .await
+        .expect("no timeout")
+        .unwrap();
+
+        assert_eq!(received, data);
+    }
+
     #[tokio::test]
     async fn outbound_stream_rejected() {
         let socket_factory = SocketFactory::new().await;
@@ -1930,7 +2425,12 @@ mod tests {
         let mut manager2 = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let mut path_manager = RoutingPathManager::<MockRuntime>::new(
@@ -1945,7 +2445,7 @@ mod tests {
             remote.clone(),
             path_manager.handle(remote.clone()),
             socket,
-            HashMap::new(),
+            StreamOptions::default(),
         );
 
         // verify the syn packet is sent twice more
@@ -1993,7 +2493,12 @@ mod tests {
         let mut manager = {
             let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
@@ -2051,6 +2556,93 @@ mod tests {
         assert_eq!(&buffer, b"hello, world");
     }
 
+    #[tokio::test]
+    async fn packets_honor_syn_max_packet_size() {
+        let socket_factory = SocketFactory::new().await;
+
+        let mut manager = {
+            let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
+            let destination = Destination::new::<MockRuntime>(signing_key.public());
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig {
+                    initial_window_size: 8,
+                    ..Default::default()
+                },
+                MockRuntime::register_metrics(vec![], None),
+            )
+        };
+
+        // remote advertises 1000 bytes as its maximum packet size in the syn
+        let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
+        let destination = Destination::new::<MockRuntime>(signing_key.public());
+        let packet = PacketBuilder::new(1337u32)
+            .with_synchronize()
+            .with_send_stream_id(0u32)
+            .with_replay_protection(&manager.destination.id())
+            .with_from_included(destination.clone())
+            .with_max_packet_size(1000)
+            .with_signature()
+            .build_and_sign(&signing_key)
+            .to_vec();
+
+        let outbound = TunnelId::random();
+        let inbound = Lease::random();
+        let mut path_manager =
+            RoutingPathManager::<MockRuntime>::new(manager.destination_id.clone(), vec![outbound]);
+        let pending_handle = path_manager.pending_handle();
+        path_manager.register_leases(&destination.id(), Ok(vec![inbound]));
+
+        tokio::spawn(async move { while let Some(_) = path_manager.next().await {} });
+
+        let (socket, mut client_socket) = socket_factory.socket().await;
+        assert!(manager
+            .register_listener(ListenerKind::Ephemeral {
+                socket,
+                silent: true,
+                pending_routing_path_handle: pending_handle,
+            })
+            .is_ok());
+
+        assert!(manager
+            .on_packet(I2cpPayload {
+                src_port: 0u16,
+                dst_port: 0u16,
+                protocol: Protocol::Streaming,
+                payload: packet
+            })
+            .is_ok());
+
+        client_socket.write_all(&vec![1u8; 2500]).await.unwrap();
+
+        // collect data packets sent by the stream and verify they're split at 1000 bytes
+        let mut payloads = Vec::new();
+
+        while payloads.len() < 3 {
+            match tokio::time::timeout(Duration::from_secs(5), manager.next())
+                .await
+                .expect("no timeout")
+                .expect("to succeed")
+            {
+                StreamManagerEvent::SendPacket { packet, .. } => {
+                    let packet = Packet::parse(&packet).unwrap();
+
+                    if !packet.payload.is_empty() {
+                        payloads.push(packet.payload.to_vec());
+                    }
+                }
+                _ => {}
+            }
+        }
+
+        assert_eq!(
+            payloads.iter().map(|payload| payload.len()).collect::<Vec<_>>(),
+            vec![1000, 1000, 500]
+        );
+        assert!(payloads.iter().flatten().all(|byte| *byte == 1u8));
+    }
+
     #[tokio::test]
     async fn data_in_syn_packet_non_silent_ephemeral() {
         let socket_factory = SocketFactory::new().await;
@@ -2058,7 +2650,12 @@ mod tests {
         let mut manager = {
             let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
@@ -2130,7 +2727,12 @@ mod tests {
         let mut manager = {
             let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
@@ -2203,7 +2805,12 @@ mod tests {
         let mut manager = {
             let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
@@ -2266,13 +2873,23 @@ mod tests {
         let mut manager1 = {
             let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let mut manager2 = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let outbound1 = TunnelId::random();
@@ -2318,7 +2935,7 @@ mod tests {
             manager1.destination_id.clone(),
             handle,
             socket,
-            HashMap::new(),
+            StreamOptions::default(),
         );
 
         assert!(manager1
@@ -2382,12 +2999,166 @@ mod tests {
         assert_eq!(listener_stream.read(&mut buffer).await.unwrap(), 0);
     }
 
+    #[tokio::test]
+    async fn stream_stats_tracked() {
+        async fn query_stream_stats(
+            manager: &mut StreamManager<MockRuntime>,
+        ) -> Vec<(u32, DestinationId, StreamStats)> {
+            manager.query_stream_stats();
+
+            loop {
+                if let StreamManagerEvent::StreamStats { stats } =
+                    tokio::time::timeout(Duration::from_secs(5), manager.next())
+                        .await
+                        .unwrap()
+                        .unwrap()
+                {
+                    return stats;
+                }
+            }
+        }
+
+        let socket_factory = SocketFactory::new().await;
+
+        let mut manager1 = {
+            let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
+            let destination = Destination::new::<MockRuntime>(signing_key.public());
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
+        };
+
+        let mut manager2 = {
+            let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
+            let destination = Destination::new::<MockRuntime>(signing_key.public());
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
+        };
+
+        let outbound1 = TunnelId::random();
+        let inbound1 = Lease::random();
+        let mut path_manager1 = RoutingPathManager::<MockRuntime>::new(
+            manager1.destination_id.clone(),
+            vec![outbound1],
+        );
+        let pending_handle = path_manager1.pending_handle();
+        path_manager1.register_leases(&manager2.destination_id, Ok(vec![inbound1]));
+
+        let outbound2 = TunnelId::random();
+        let inbound2 = Lease::random();
+        let mut path_manager2 = RoutingPathManager::<MockRuntime>::new(
+            manager2.destination_id.clone(),
+            vec![outbound2],
+        );
+        path_manager2.register_leases(&manager1.destination_id, Ok(vec![inbound2]));
+        let handle = path_manager2.handle(manager1.destination_id.clone());
+
+        tokio::spawn(async move {
+            loop {
+                tokio::select! {
+                    _ = &mut path_manager1.next() => {}
+                    _ = &mut path_manager2.next() => {}
+                }
+            }
+        });
+
+        let (socket, _listener_stream) = socket_factory.socket().await;
+        assert!(manager1
+            .register_listener(ListenerKind::Ephemeral {
+                socket,
+                silent: true,
+                pending_routing_path_handle: pending_handle,
+            })
+            .is_ok());
+        assert!(query_stream_stats(&mut manager1).await.is_empty());
+
+        let (socket, _client_stream) = socket_factory.socket().await;
+        let (_stream_id, packet, _, _, _) = manager2.create_stream(
+            manager1.destination_id.clone(),
+            handle,
+            socket,
+            StreamOptions::default(),
+        );
+
+        assert!(manager1
+            .on_packet(I2cpPayload {
+                src_port: 0u16,
+                dst_port: 0u16,
+                protocol: Protocol::Streaming,
+                payload: packet.to_vec(),
+            })
+            .is_ok());
+
+        assert!(std::matches!(
+            manager1.next().await,
+            Some(StreamManagerEvent::StreamOpened { .. })
+        ));
+
+        // wait until the stream has sent `SYN-ACK`
+        match tokio::time::timeout(Duration::from_secs(5), manager1.next())
+            .await
+            .unwrap()
+            .unwrap()
+        {
+            StreamManagerEvent::SendPacket { .. } => {}
+            _ => panic!("invalid event"),
+        }
+
+        let stats = query_stream_stats(&mut manager1).await;
+        assert_eq!(stats.len(), 1);
+
+        let (_, destination_id, stats) = &stats[0];
+        assert_eq!(destination_id, &manager2.destination_id);
+        assert!(stats.window_size > 0);
+        assert!(!stats.rto.is_zero());
+        assert_eq!(stats.num_unacked, 0);
+        assert_eq!(stats.bytes_in_flight, 0);
+        assert_eq!(stats.num_retransmissions, 0);
+        assert!(!stats.choked);
+
+        // concurrent requests are answered by the same query
+        manager1.query_stream_stats();
+        manager1.query_stream_stats();
+
+        let mut num_responses = 0usize;
+
+        while num_responses < 2 {
+            if let StreamManagerEvent::StreamStats { stats } =
+                tokio::time::timeout(Duration::from_secs(5), manager1.next())
+                    .await
+                    .unwrap()
+                    .unwrap()
+            {
+                assert_eq!(stats.len(), 1);
+                num_responses += 1;
+            }
+        }
+
+        // destroy the session and verify the stream is no longer reported
+        manager1.remove_session(&manager2.destination_id);
+        let _ = tokio::time::timeout(Duration::from_secs(2), manager1.next()).await;
+
+        assert!(query_stream_stats(&mut manager1).await.is_empty());
+    }
+
     #[tokio::test]
     async fn signature_missing_inbound_stream() {
         let mut manager = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         // build syn packet without signature
@@ -2421,7 +3192,12 @@ mod tests {
         let mut manager = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         // build syn packet without replay protection
@@ -2473,7 +3249,12 @@ mod tests {
 
             Destination::parse(&out).unwrap()
         };
-        let mut manager = StreamManager::<MockRuntime>::new(destination, signing_key);
+        let mut manager = StreamManager::<MockRuntime>::new(
+            destination,
+            signing_key,
+            StreamConfig::default(),
+            MockRuntime::register_metrics(vec![], None),
+        );
 
         let payload = vec![
             0, 0, 0, 0, 7, 170, 162, 225, 0, 0, 0, 0, 0, 0, 0, 0, 8, 92, 237, 166, 51, 230, 31, 2,
@@ -2540,7 +3321,12 @@ mod tests {
 
             Destination::parse(&out).unwrap()
         };
-        let mut manager = StreamManager::<MockRuntime>::new(destination, signing_key);
+        let mut manager = StreamManager::<MockRuntime>::new(
+            destination,
+            signing_key,
+            StreamConfig::default(),
+            MockRuntime::register_metrics(vec![], None),
+        );
 
         let payload = vec![
             0, 0, 0, 0, 7, 170, 162, 225, 0, 0, 0, 0, 0, 0, 0, 0, 8, 92, 237, 166, 51, 230, 31, 2,
@@ -2588,7 +3374,12 @@ mod tests {
         let mut manager = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let packet = {
@@ -2621,7 +3412,12 @@ mod tests {
     async fn offline() {
         let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
         let destination = Destination::new::<MockRuntime>(signing_key.public());
-        let mut manager = StreamManager::<MockRuntime>::new(destination, signing_key);
+        let mut manager = StreamManager::<MockRuntime>::new(
+            destination,
+            signing_key,
+            StreamConfig::default(),
+            MockRuntime::register_metrics(vec![], None),
+        );
 
         let input = vec![
             226, 27, 26, 214, 19, 0, 72, 226, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 8, 233, 2, 49, 0, 0,
@@ -2675,13 +3471,23 @@ mod tests {
         let mut manager1 = {
             let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let mut manager2 = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         // register listener for `manager1`
@@ -2706,7 +3512,7 @@ mod tests {
             manager1.destination_id.clone(),
             path_manager.handle(manager1.destination_id.clone()),
             socket,
-            HashMap::new(),
+            StreamOptions::default(),
         );
 
         // verify there's one outbound timer active
@@ -2738,13 +3544,23 @@ mod tests {
         let mut manager1 = {
             let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let mut manager2 = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let outbound1 = TunnelId::random();
@@ -2790,10 +3606,11 @@ mod tests {
             manager1.destination_id.clone(),
             handle,
             socket,
-            HashMap::from_iter([
-                (String::from("FROM_PORT"), String::from("1337")),
-                (String::from("TO_PORT"), String::from("1338")),
-            ]),
+            StreamOptions {
+                from_port: 1337,
+                to_port: 1338,
+                ..Default::default()
+            },
         );
         assert_eq!(src_port, 1337);
         assert_eq!(dst_port, 1338);
@@ -2860,7 +3677,12 @@ mod tests {
         let mut manager2 = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let mut outbound = (0..3).map(|_| TunnelId::random()).collect::<HashSet<_>>();
@@ -2884,7 +3706,7 @@ mod tests {
             remote.clone(),
             path_manager.handle(remote.clone()),
             socket,
-            HashMap::new(),
+            StreamOptions::default(),
         );
 
         match delivery_style {
@@ -2895,6 +3717,24 @@ mod tests {
             _ => panic!("invalid delivery style"),
         }
 
+        // verify that a copy of the syn is sent over a disjoint routing path
+        match tokio::time::timeout(Duration::from_secs(1), manager2.next())
+            .await
+            .expect("no timeout")
+            .expect("to succeed")
+        {
+            StreamManagerEvent::SendPacket {
+                delivery_style: DeliveryStyle::ViaRoute { routing_path },
+                packet,
+                ..
+            } if routing_path.destination_id == remote => {
+                assert!(Packet::parse(&packet).unwrap().flags.synchronize());
+                assert!(outbound.contains(&routing_path.outbound));
+                assert!(inbound.contains_key(&routing_path.inbound));
+            }
+            _ => panic!("invalid event"),
+        }
+
         // verify the syn packet is sent twice more
         match tokio::time::timeout(Duration::from_secs(15), manager2.next())
             .await
@@ -2950,13 +3790,23 @@ mod tests {
         let mut manager1 = {
             let signing_key = SigningPrivateKey::from_bytes(&[0u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let mut manager2 = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let outbound1 = TunnelId::random();
@@ -3017,7 +3867,7 @@ mod tests {
             manager1.destination_id.clone(),
             handle,
             socket,
-            HashMap::new(),
+            StreamOptions::default(),
         );
 
         assert!(manager1
@@ -3093,7 +3943,12 @@ mod tests {
         let mut manager2 = {
             let signing_key = SigningPrivateKey::from_bytes(&[1u8; 32]).unwrap();
             let destination = Destination::new::<MockRuntime>(signing_key.public());
-            StreamManager::<MockRuntime>::new(destination, signing_key)
+            StreamManager::<MockRuntime>::new(
+                destination,
+                signing_key,
+                StreamConfig::default(),
+                MockRuntime::register_metrics(vec![], None),
+            )
         };
 
         let mut path_manager = RoutingPathManager::<MockRuntime>::new(
@@ -3107,7 +3962,7 @@ mod tests {
             remote.clone(),
             path_manager.handle(remote.clone()),
             socket,
-            HashMap::new(),
+            StreamOptions::default(),
         );
 
         // verify that stream rejection is emitted
@@ -703,17 +703,41 @@ impl<'a> PacketBuilder<'a> {
 
     /// Build [`PacketBuilder`] into [`Packet`].
     pub fn build(self) -> BytesMut {
+        let payload = self.payload;
+        let mut out = BytesMut::with_capacity(
+            MIN_HEADER_SIZE
+                .wrapping_add(self.flags_builder.options_len)
+                .wrapping_add(self.nacks.as_ref().map_or(0usize, |nacks| nacks.len() * 4))
+                .wrapping_add(payload.map_or(0usize, |payload| payload.len())),
+        );
+
+        self.build_header_into(&mut out);
+
+        if let Some(payload) = payload {
+            out.put_slice(payload);
+        }
+
+        out
+    }
+
+    /// Serialize the header of the packet into `out`.
+    ///
+    /// Payload, if specified, is not serialized and must be appended by the caller. This allows
+    /// the caller to keep the payload in a separate buffer and serialize headers into a reusable
+    /// scratch buffer.
+    ///
+    /// Panics if signature was specified.
+    pub fn build_header_into(self, out: &mut BytesMut) {
         let (flags, options) = self.flags_builder.build();
 
         if (flags >> 3) & 1 == 1 {
-            panic!("`PacketBuilder::build()` called but signature specified");
+            panic!("`PacketBuilder::build_header_into()` called but signature specified");
         }
 
-        let mut out = BytesMut::with_capacity(
+        out.reserve(
             MIN_HEADER_SIZE
                 .wrapping_add(options.as_ref().map_or(0usize, |options| options.len()))
-                .wrapping_add(self.nacks.as_ref().map_or(0usize, |nacks| nacks.len() * 4))
-                .wrapping_add(self.payload.as_ref().map_or(0usize, |payload| payload.len())),
+                .wrapping_add(self.nacks.as_ref().map_or(0usize, |nacks| nacks.len() * 4)),
         );
 
         out.put_u32(self.send_stream_id.expect("to exist"));
@@ -742,12 +766,6 @@ impl<'a> PacketBuilder<'a> {
                 out.put_slice(&options);
             }
         }
-
-        if let Some(payload) = self.payload {
-            out.put_slice(payload);
-        }
-
-        out
     }
 
     /// Build [`PacketBuilder`] into [`Packet`] with signature.
@@ -1060,4 +1078,39 @@ mod tests {
         assert!(info.synchronize());
         assert!(info.reset());
     }
+
+    #[test]
+    fn build_header_into_scratch_buffer() {
+        let payload = vec![0xaau8; 1337];
+        let mut scratch = BytesMut::with_capacity(64);
+
+        for seq_nro in 1..=3u32 {
+            PacketBuilder::new(1338u32)
+                .with_send_stream_id(1337u32)
+                .with_seq_nro(seq_nro)
+                .with_ack_through(seq_nro - 1)
+                .with_nacks(vec![seq_nro + 1])
+                .with_delay_requested(1000)
+                .build_header_into(&mut scratch);
+
+            let header = scratch.split().freeze();
+            let mut serialized = header.to_vec();
+            serialized.extend_from_slice(&payload);
+
+            let expected = PacketBuilder::new(1338u32)
+                .with_send_stream_id(1337u32)
+                .with_seq_nro(seq_nro)
+                .with_ack_through(seq_nro - 1)
+                .with_nacks(vec![seq_nro + 1])
+                .with_delay_requested(1000)
+                .with_payload(&payload)
+                .build();
+            assert_eq!(serialized, expected.to_vec());
+
+            let packet = Packet::parse(&serialized).unwrap();
+            assert_eq!(packet.seq_nro, seq_nro);
+            assert_eq!(packet.nacks, vec![seq_nro + 1]);
+            assert_eq!(packet.payload, payload);
+        }
+    }
 }
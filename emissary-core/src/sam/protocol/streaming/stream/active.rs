@@ -21,19 +21,26 @@ use crate::{
     destination::{routing_path::RoutingPathHandle, DeliveryStyle},
     error::StreamingError,
     primitives::{Destination, DestinationId},
-    runtime::{AsyncRead, AsyncWrite, Instant, Runtime},
-    sam::protocol::streaming::{
-        config::StreamConfig,
-        packet::{Packet, PacketBuilder},
+    runtime::{AsyncRead, AsyncWrite, Counter, Histogram, Instant, MetricsHandle, Runtime},
+    sam::{
+        protocol::streaming::{
+            config::{StreamConfig, MAX_WINDOW_SIZE},
+            metrics::*,
+            packet::{Packet, PacketBuilder},
+            stream::congestion::{congestion_control, CongestionControl},
+        },
+        socket::SamStream,
     },
 };
 
+use bytes::{Bytes, BytesMut};
 use futures::FutureExt;
 use rand_core::RngCore;
 use thingbuf::mpsc::{Receiver, Sender};
 
 use alloc::{
-    collections::{BTreeMap, BTreeSet, VecDeque},
+    boxed::Box,
+    collections::{BTreeMap, VecDeque},
     vec,
     vec::Vec,
 };
@@ -53,21 +60,34 @@ const LOG_TARGET: &str = "emissary::streaming::active";
 /// Read buffer size.
 const READ_BUFFER_SIZE: usize = 0xffff;
 
+/// Size of the scratch buffer used for serializing packet headers.
+const HEADER_BUFFER_SIZE: usize = 4096;
+
 /// Initial ACK delay.
+///
+/// Also the minimum ACK delay.
 const INITIAL_ACK_DELAY: Duration = Duration::from_millis(200);
 
-/// Sequence number for a plain ACK message.
-const PLAIN_ACK: u32 = 0u32;
+/// Maximum ACK delay.
+const MAX_ACK_DELAY: Duration = Duration::from_millis(1000);
+
+/// How many received packets trigger an immediate ACK.
+const ACK_THRESHOLD: usize = 16usize;
 
-/// Initial window size.
-const INITIAL_WINDOW_SIZE: usize = 1usize;
+/// Largest requested delay that isn't a choke request.
+const MAX_DELAY_REQUEST: u16 = 60_000u16;
 
-/// Maximum window size in packets.
-const MAX_WINDOW_SIZE: usize = 128usize;
+/// Sequence number for a plain ACK message.
+const PLAIN_ACK: u32 = 0u32;
 
 /// How far ahead of the current highest received sequence number is a packet accepted.
 const MAX_WINDOW_LOOKAHEAD: usize = 4 * MAX_WINDOW_SIZE;
 
+/// How many packets past the next in-order packet can be buffered.
+///
+/// Must be a multiple of 64.
+const RECEIVE_WINDOW: usize = 2 * MAX_WINDOW_LOOKAHEAD;
+
 /// Delay request which indicates choking.
 const CHOKING_REQUEST: u16 = 60_001u16;
 
@@ -86,11 +106,13 @@ const RTT_DAMPENING_FACTOR: f64 = 0.125f64;
 /// RTTDEV dampening factor (beta).
 const RTTDEV_DAMPENING_FACTOR: f64 = 0.25;
 
-/// Threshold for stopping exponential growth of the window size.
-const EXP_GROWTH_STOP_THRESHOLD: usize = 64;
+/// How many times a packet must be NACKed before it's retransmitted without waiting for RTO.
+const FAST_RETRANSMIT_THRESHOLD: usize = 3usize;
 
-/// MTU size.
-const MTU_SIZE: usize = 1812;
+/// Maximum payload size of an outbound packet.
+///
+/// Smaller if remote advertised a lower maximum packet size.
+pub const MTU_SIZE: usize = 1812;
 
 /// Stream event.
 #[derive(Default, Debug, Clone)]
@@ -101,6 +123,12 @@ pub enum StreamEvent {
         packet: Vec<u8>,
     },
 
+    /// [`StreamManager`] has asked for a snapshot of the stream's transmission state.
+    QueryStats {
+        /// TX channel for sending the snapshot, tagged with the receive stream ID.
+        tx: Sender<(u32, StreamStats)>,
+    },
+
     /// [`StreamManager`] has asked the stream to be shut down.
     #[default]
     ShutDown,
@@ -243,14 +271,59 @@ pub enum StreamKind {
         /// Payload received in `SYN`.
         payload: Vec<u8>,
 
+        /// Packets sent before the `SYN` was ACKed.
+        ///
+        /// Sequence numbers of the packets start from 1.
+        pre_ack_packets: Vec<Vec<u8>>,
+
+        /// RTT of the `SYN`, if it was ACKed without retransmissions.
+        rtt: Option<Duration>,
+
         /// Selected send stream ID.
         send_stream_id: u32,
 
         /// Source port.
         src_port: u16,
+
+        /// Client data read before the stream was opened that didn't fit into the initial window.
+        unsent: Vec<u8>,
     },
 }
 
+/// Snapshot of the transmission state of an active [`Stream`].
+///
+/// Built by the stream only when `StreamManager` queries it on behalf of a client that has
+/// requested stream diagnostics.
+#[derive(Debug, Default, Clone)]
+pub struct StreamStats {
+    /// Total time the stream has spent with data queued but the congestion window full.
+    pub blocked: Duration,
+
+    /// Number of unACKed bytes.
+    pub bytes_in_flight: usize,
+
+    /// Has remote choked the stream.
+    pub choked: bool,
+
+    /// Number of packets waiting for room in the congestion window.
+    pub num_pending: usize,
+
+    /// Number of packets retransmitted, either due to RTO or NACKs.
+    pub num_retransmissions: usize,
+
+    /// Number of unACKed packets.
+    pub num_unacked: usize,
+
+    /// Current RTO.
+    pub rto: Duration,
+
+    /// Current smoothed RTT.
+    pub rtt: Duration,
+
+    /// Current congestion window size.
+    pub window_size: usize,
+}
+
 /// Context needed to initialize [`Stream`].
 pub struct StreamContext {
     /// Local destination.
@@ -273,6 +346,9 @@ pub struct StreamContext {
 
     /// Signing key.
     pub signing_key: SigningPrivateKey,
+
+    /// Maximum packet size advertised by remote in its `SYN`, if any.
+    pub max_packet_size: Option<u16>,
 }
 
 /// Pending outbound packet.
@@ -283,8 +359,37 @@ pub struct PendingPacket<R: Runtime> {
     /// Sequence number of the packet.
     seq_nro: u32,
 
-    /// Serialized packet.
-    packet: Vec<u8>,
+    /// Serialized packet header.
+    header: Bytes,
+
+    /// Payload of the packet.
+    ///
+    /// Slice of the buffer the client's data was read into.
+    payload: Bytes,
+
+    /// How many times the packet has been NACKed by remote.
+    num_nacks: usize,
+
+    /// Has the packet been retransmitted.
+    ///
+    /// ACKs of retransmitted packets are ambiguous and aren't used as RTT samples (Karn's rule).
+    retransmitted: bool,
+}
+
+impl<R: Runtime> PendingPacket<R> {
+    /// Get the serialized size of the packet.
+    fn len(&self) -> usize {
+        self.header.len() + self.payload.len()
+    }
+
+    /// Serialize the packet for sending.
+    fn serialize(&self) -> Vec<u8> {
+        let mut out = Vec::with_capacity(self.header.len() + self.payload.len());
+        out.extend_from_slice(&self.header);
+        out.extend_from_slice(&self.payload);
+
+        out
+    }
 }
 
 /// Write state.
@@ -301,6 +406,9 @@ enum WriteState {
         message: Vec<u8>,
     },
 
+    /// Send data received in order from the inbound context into the socket.
+    WriteReady,
+
     /// Socket has been closed.
     Closed,
 
@@ -324,148 +432,267 @@ enum SocketState {
 }
 
 /// Inbound context.
+///
+/// In-order payloads are appended to a contiguous byte ring from which they are written into the
+/// client socket. Out-of-order payloads are stored into a ring of packet slots indexed by their
+/// sequence number and a bitmap tracks which slots hold a received packet. Slot buffers are reused
+/// when the ring wraps around so steady-state reception doesn't allocate.
 pub struct InboundContext<R: Runtime> {
+    /// ACK delay, derived from the measured RTT of the stream.
+    ack_delay: Duration,
+
+    /// Should an ACK be sent without waiting for the ACK timer.
+    ack_now: bool,
+
     /// ACK timer.
     ack_timer: Option<R::Timer>,
 
-    /// Missing packets.
-    missing: BTreeSet<u32>,
+    /// Close requested, either by client or remote peer.
+    close_requested: bool,
+
+    /// Sequence number of the next packet that is delivered in order.
+    next_seq_nro: u32,
+
+    /// Number of packets received since the last ACK was sent.
+    num_unacked: usize,
 
-    /// Pending packets.
-    pending: BTreeMap<u32, Vec<u8>>,
+    /// Payload bytes received in order but not yet written into the client socket.
+    ready: VecDeque<u8>,
 
-    /// Ready packets.
-    ready: VecDeque<Vec<u8>>,
+    /// Bitmap of received out-of-order packets, indexed by slot.
+    received: [u64; RECEIVE_WINDOW / 64],
 
-    /// Measured RTT.
-    rtt: Duration,
+    /// ACK delay requested by remote in the last received packet, if any.
+    requested_delay: Option<Duration>,
 
     /// Highest received sequence number from remote destination.
     seq_nro: u32,
 
-    /// Close requested, either by client or remote peer.
-    close_requested: bool,
+    /// Payloads of out-of-order packets, indexed by `seq_nro % RECEIVE_WINDOW`.
+    ///
+    /// Allocated when the first out-of-order packet is received.
+    slots: Vec<Vec<u8>>,
 }
 
 impl<R: Runtime> InboundContext<R> {
     /// Create new [`InboundContext`] with highest received `seq_nro`.
     fn new(seq_nro: u32) -> Self {
         Self {
+            ack_delay: INITIAL_ACK_DELAY,
+            ack_now: false,
             ack_timer: None,
-            missing: BTreeSet::new(),
-            pending: BTreeMap::new(),
-            ready: VecDeque::new(),
-            rtt: INITIAL_ACK_DELAY,
             close_requested: false,
+            next_seq_nro: seq_nro.wrapping_add(1),
+            num_unacked: 0usize,
+            ready: VecDeque::new(),
+            received: [0u64; RECEIVE_WINDOW / 64],
+            requested_delay: None,
             seq_nro,
+            slots: Vec::new(),
         }
     }
 
-    // TODO: so ugly
-    fn handle_packet(&mut self, seq_nro: u32, payload: &[u8]) -> Result<(), StreamingError> {
-        // packet received in order
-        if seq_nro == self.seq_nro + 1 {
-            self.missing.remove(&seq_nro);
-            if self.missing.is_empty() {
-                if !payload.is_empty() {
-                    self.ready.push_back(payload.to_vec());
-                }
-            } else if !payload.is_empty() {
-                self.pending.insert(seq_nro, payload.to_vec());
-            }
-            self.seq_nro = seq_nro;
+    /// Update ACK delay from the measured `rtt` of the stream.
+    ///
+    /// ACKs are delayed by half of the RTT so that multiple packets are ACKed with one message.
+    fn set_rtt(&mut self, rtt: Duration) {
+        self.ack_delay = (rtt / 2).clamp(INITIAL_ACK_DELAY, MAX_ACK_DELAY);
+    }
 
-            if self.ack_timer.is_none() {
-                self.ack_timer = Some(R::timer(self.rtt));
+    /// Set ACK delay requested by remote in the packet that is about to be handled.
+    ///
+    /// Zero delay requests an immediate ACK. Choke requests are not ACK delays and are ignored.
+    fn set_requested_delay(&mut self, delay: Option<u16>) {
+        self.requested_delay = match delay {
+            Some(0) => {
+                self.ack_now = true;
+                None
             }
+            Some(delay) if delay <= MAX_DELAY_REQUEST =>
+                Some(cmp::min(Duration::from_millis(delay as u64), MAX_ACK_DELAY)),
+            _ => None,
+        };
+    }
 
-            return Ok(());
+    /// Schedule an ACK for a received packet.
+    ///
+    /// An ACK is sent immediately after [`ACK_THRESHOLD`] packets, otherwise after the ACK delay.
+    fn schedule_ack(&mut self) {
+        self.num_unacked += 1;
+
+        if self.num_unacked >= ACK_THRESHOLD {
+            self.ack_now = true;
+        } else if self.ack_timer.is_none() {
+            self.ack_timer = Some(R::timer(self.requested_delay.unwrap_or(self.ack_delay)));
         }
+    }
 
-        if seq_nro > self.seq_nro + 1 {
-            if (seq_nro - self.seq_nro - 1) as usize > MAX_WINDOW_LOOKAHEAD {
-                tracing::warn!(
-                    target: LOG_TARGET,
-                    ?seq_nro,
-                    next_seq_nro = ?(self.seq_nro + 1),
-                    "packet is too far in the future",
-                );
+    /// Mark received packets as ACKed.
+    ///
+    /// Called when an ACK has been sent, either as a plain ACK or piggybacked on outbound data.
+    fn ack_sent(&mut self) {
+        self.ack_now = false;
+        self.ack_timer = None;
+        self.num_unacked = 0;
+    }
 
-                return Err(StreamingError::SequenceNumberTooHigh);
-            }
+    /// Has an out-of-order packet with `seq_nro` been received.
+    fn is_received(&self, seq_nro: u32) -> bool {
+        let slot = seq_nro as usize % RECEIVE_WINDOW;
 
+        self.received[slot / 64] & (1u64 << (slot % 64)) != 0
+    }
+
+    /// Take payload of a buffered packet `seq_nro` and append it to ready data.
+    fn take_slot(&mut self, seq_nro: u32) {
+        let slot = seq_nro as usize % RECEIVE_WINDOW;
+
+        self.received[slot / 64] &= !(1u64 << (slot % 64));
+        self.ready.extend(&self.slots[slot]);
+    }
+
+    /// Store payload of an out-of-order packet `seq_nro`.
+    fn store_slot(&mut self, seq_nro: u32, payload: &[u8]) {
+        if self.slots.is_empty() {
+            self.slots.resize_with(RECEIVE_WINDOW, Vec::new);
+        }
+
+        let slot = seq_nro as usize % RECEIVE_WINDOW;
+
+        self.received[slot / 64] |= 1u64 << (slot % 64);
+        self.slots[slot].clear();
+        self.slots[slot].extend_from_slice(payload);
+    }
+
+    /// Handle received packet.
+    ///
+    /// Packets that create a new gap, duplicates and packets that close the last gap are ACKed
+    /// immediately so that remote can retransmit lost packets and move its send window without
+    /// waiting for the ACK delay.
+    fn handle_packet(&mut self, seq_nro: u32, payload: &[u8]) -> Result<(), StreamingError> {
+        // duplicate of a packet that has already been delivered, the previous ACK may have been
+        // lost
+        if seq_nro < self.next_seq_nro {
             tracing::trace!(
                 target: LOG_TARGET,
                 ?seq_nro,
-                expected = ?self.seq_nro + 1,
-                "received out-of-order packet",
+                next_seq_nro = ?self.next_seq_nro,
+                "duplicate packet",
             );
+            self.ack_now = true;
+            return Ok(());
+        }
 
-            (self.seq_nro + 1..seq_nro).for_each(|seq_nro| {
-                tracing::trace!(
-                    target: LOG_TARGET,
-                    ?seq_nro,
-                    "marking packet as missing",
-                );
+        if seq_nro > self.seq_nro && (seq_nro - self.seq_nro - 1) as usize > MAX_WINDOW_LOOKAHEAD {
+            tracing::warn!(
+                target: LOG_TARGET,
+                ?seq_nro,
+                next_seq_nro = ?(self.seq_nro + 1),
+                "packet is too far in the future",
+            );
 
-                if !self.pending.contains_key(&seq_nro) {
-                    self.missing.insert(seq_nro);
-                }
-            });
+            return Err(StreamingError::SequenceNumberTooHigh);
+        }
 
-            if !payload.is_empty() {
-                self.pending.insert(seq_nro, payload.to_vec());
-            }
-            self.missing.remove(&seq_nro);
-            self.seq_nro = seq_nro;
+        // the packet cannot be buffered until the missing packets before it have been received,
+        // drop it and let the remote retransmit it
+        if (seq_nro - self.next_seq_nro) as usize >= RECEIVE_WINDOW {
+            tracing::debug!(
+                target: LOG_TARGET,
+                ?seq_nro,
+                next_seq_nro = ?self.next_seq_nro,
+                "receive window full, dropping packet",
+            );
+            return Ok(());
+        }
 
-            if self.ack_timer.is_none() {
-                self.ack_timer = Some(R::timer(self.rtt));
-            }
-        } else if self.missing.first() == Some(&seq_nro) {
-            if !payload.is_empty() {
-                self.ready.push_back(payload.to_vec());
-            }
-            self.missing.remove(&seq_nro);
+        self.schedule_ack();
 
-            let mut next_seq = seq_nro + 1;
+        // packet opens a new gap
+        if seq_nro > self.seq_nro.wrapping_add(1) {
+            self.ack_now = true;
+        }
+        self.seq_nro = cmp::max(self.seq_nro, seq_nro);
 
-            while let Some(payload) = self.pending.remove(&next_seq) {
-                self.ready.push_back(payload);
-                next_seq += 1;
-            }
+        if seq_nro != self.next_seq_nro {
+            tracing::trace!(
+                target: LOG_TARGET,
+                ?seq_nro,
+                expected = ?self.next_seq_nro,
+                "received out-of-order packet",
+            );
 
-            if self.ack_timer.is_none() {
-                self.ack_timer = Some(R::timer(self.rtt));
-            }
-        } else {
-            self.missing.remove(&seq_nro);
-            if !payload.is_empty() {
-                self.pending.insert(seq_nro, payload.to_vec());
+            // duplicate of a buffered packet, the previous ACK may have been lost
+            if self.is_received(seq_nro) {
+                self.ack_now = true;
+            } else {
+                self.store_slot(seq_nro, payload);
             }
+            return Ok(());
+        }
 
-            if self.ack_timer.is_none() {
-                self.ack_timer = Some(R::timer(self.rtt));
-            }
+        // packet received in order, deliver it and any buffered packets that follow it
+        let had_gaps = self.seq_nro > seq_nro;
+
+        self.ready.extend(payload);
+        self.next_seq_nro += 1;
+
+        while self.next_seq_nro <= self.seq_nro && self.is_received(self.next_seq_nro) {
+            self.take_slot(self.next_seq_nro);
+            self.next_seq_nro += 1;
+        }
+
+        if had_gaps && self.next_seq_nro > self.seq_nro {
+            self.ack_now = true;
         }
 
         Ok(())
     }
 
-    fn pop_message(&mut self) -> Option<Vec<u8>> {
-        self.ready.pop_front()
+    /// Get missing sequence numbers in ascending order.
+    fn missing(&self) -> impl Iterator<Item = u32> + '_ {
+        (self.next_seq_nro..=self.seq_nro).filter(|seq_nro| !self.is_received(*seq_nro))
+    }
+
+    /// Get number of missing packets.
+    fn num_missing(&self) -> usize {
+        let window = (self.seq_nro.wrapping_add(1)).wrapping_sub(self.next_seq_nro) as usize;
+        let received =
+            self.received.iter().fold(0usize, |acc, word| acc + word.count_ones() as usize);
+
+        window - received
+    }
+
+    /// Does the context have data ready to be written into the client socket.
+    fn has_ready_data(&self) -> bool {
+        !self.ready.is_empty()
+    }
+
+    /// Get data ready to be written into the client socket.
+    ///
+    /// The data is returned as the two contiguous halves of the ring buffer so both can be
+    /// written into the socket with one vectored write.
+    fn ready_data(&self) -> [&[u8]; 2] {
+        let (first, second) = self.ready.as_slices();
+
+        [first, second]
+    }
+
+    /// Consume `num_bytes` of ready data after it has been written into the client socket.
+    fn consume(&mut self, num_bytes: usize) {
+        self.ready.drain(..num_bytes);
     }
 
     fn close(&mut self) {
         self.close_requested = true;
 
         if self.ack_timer.is_none() {
-            self.ack_timer = Some(R::timer(self.rtt));
+            self.ack_timer = Some(R::timer(self.ack_delay));
         }
     }
 
     fn can_close(&self) -> bool {
-        self.close_requested && self.missing.is_empty()
+        self.close_requested && self.num_missing() == 0
     }
 }
 
@@ -473,9 +700,14 @@ impl<R: Runtime> Future for InboundContext<R> {
     type Output = ();
 
     fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        if self.ack_now {
+            self.ack_sent();
+            return Poll::Ready(());
+        }
+
         if let Some(timer) = &mut self.ack_timer {
             if timer.poll_unpin(cx).is_ready() {
-                self.ack_timer = None;
+                self.ack_sent();
                 return Poll::Ready(());
             }
         }
@@ -489,9 +721,28 @@ impl<R: Runtime> Future for InboundContext<R> {
 /// Implements a `Future` which returns the send stream ID after the virtual stream has been shut
 /// down, either by the client or by the remote participant.
 pub struct Stream<R: Runtime> {
+    /// Total time the stream has spent blocked on a full congestion window.
+    blocked: Duration,
+
+    /// When did the stream last get blocked on a full congestion window, if it's blocked.
+    blocked_since: Option<R::Instant>,
+
+    /// Number of unACKed bytes.
+    ///
+    /// Kept in sync with `unacked` so it doesn't have to be recalculated for each sent packet.
+    bytes_in_flight: usize,
+
+    /// Has remote choked the stream.
+    ///
+    /// No new packets are sent while the stream is choked.
+    choked: bool,
+
     /// Close requested.
     close_requested: bool,
 
+    /// Congestion controller.
+    congestion: Box<dyn CongestionControl>,
+
     /// RX channel for receiving [`StreamEvent`]s from the network.
     cmd_rx: Receiver<StreamEvent>,
 
@@ -504,20 +755,44 @@ pub struct Stream<R: Runtime> {
     /// TX channel for sending [`Packet`]s to the network.
     event_tx: Sender<(DeliveryStyle, Vec<u8>, u16, u16)>,
 
+    /// Scratch buffer for serializing headers of outbound packets.
+    header_buffer: BytesMut,
+
     /// Inbound context for packets received from the network.
     inbound_context: InboundContext<R>,
 
     /// ID of the local destination.
     local: DestinationId,
 
+    /// Metrics handle.
+    metrics: R::MetricsHandle,
+
+    /// Maximum payload size of an outbound packet.
+    mtu: usize,
+
     /// Next sequence number.
     next_seq_nro: u32,
 
+    /// Number of packets retransmitted, either due to RTO or NACKs.
+    num_retransmissions: usize,
+
     /// Pending (unsent) outbound packets.
     pending: BTreeMap<u32, PendingPacket<R>>,
 
+    /// Sequence number of the last packet sent before the `SYN` was ACKed, if any.
+    ///
+    /// The stream doesn't know when these packets were sent so they're not used as RTT samples.
+    pre_ack_seq_nro: u32,
+
     /// Read buffer.
-    read_buffer: Vec<u8>,
+    ///
+    /// Payloads of outbound packets are refcounted slices of this buffer.
+    read_buffer: BytesMut,
+
+    /// Sequence number of the first packet sent after the last window reduction.
+    ///
+    /// NACKed packets older than this do not reduce the window again.
+    recovery_seq_nro: u32,
 
     /// Socket state.
     read_state: SocketState,
@@ -550,15 +825,12 @@ pub struct Stream<R: Runtime> {
     /// Source port.
     src_port: u16,
 
-    /// Underlying TCP stream used to communicate with the client.
-    stream: R::TcpStream,
+    /// Underlying stream used to communicate with the client.
+    stream: SamStream<R>,
 
     /// Pending (unACKed) outbound packets.
     unacked: BTreeMap<u32, PendingPacket<R>>,
 
-    /// Window size.
-    window_size: usize,
-
     /// Write state.
     write_state: WriteState,
 }
@@ -566,12 +838,13 @@ pub struct Stream<R: Runtime> {
 impl<R: Runtime> Stream<R> {
     /// Create new [`Stream`]
     pub fn new(
-        stream: R::TcpStream,
+        stream: SamStream<R>,
         initial_message: Option<Vec<u8>>,
         context: StreamContext,
-        _: StreamConfig,
-        state: StreamKind,
+        config: StreamConfig,
+        mut state: StreamKind,
         mut routing_path_handle: RoutingPathHandle<R>,
+        metrics: R::MetricsHandle,
     ) -> Self {
         let StreamContext {
             local,
@@ -581,8 +854,20 @@ impl<R: Runtime> Stream<R> {
             recv_stream_id,
             signing_key,
             destination,
+            max_packet_size,
         } = context;
 
+        // data the client sent before an outbound stream was opened
+        let (pre_ack_packets, unsent, syn_rtt) = match &mut state {
+            StreamKind::Outbound {
+                pre_ack_packets,
+                unsent,
+                rtt,
+                ..
+            } => (mem::take(pre_ack_packets), mem::take(unsent), *rtt),
+            _ => (Vec::new(), Vec::new(), None),
+        };
+
         let (send_stream_id, initial_message, highest_ack, src_port, dst_port) = match state {
             StreamKind::Inbound { payload } => {
                 let send_stream_id = R::rng().next_u32();
@@ -666,6 +951,7 @@ impl<R: Runtime> Stream<R> {
                 payload,
                 send_stream_id,
                 src_port,
+                ..
             } => (
                 send_stream_id,
                 match (initial_message, payload.is_empty()) {
@@ -683,30 +969,77 @@ impl<R: Runtime> Stream<R> {
             ),
         };
 
-        Self {
+        let sent = R::now();
+        let unacked = pre_ack_packets
+            .into_iter()
+            .zip(1u32..)
+            .map(|(packet, seq_nro)| {
+                (
+                    seq_nro,
+                    PendingPacket::<R> {
+                        sent,
+                        seq_nro,
+                        header: Bytes::from(packet),
+                        payload: Bytes::new(),
+                        num_nacks: 0usize,
+                        retransmitted: false,
+                    },
+                )
+            })
+            .collect::<BTreeMap<_, _>>();
+        let bytes_in_flight = unacked.values().map(PendingPacket::len).sum();
+
+        // seed RTT and RTO with the round trip of the `SYN` so the first retransmissions aren't
+        // delayed by the conservative initial values
+        let (rtt, rto) = {
+            let mut rtt = Rtt::new();
+            let mut rto = Rto::new();
+
+            if let Some(sample) = syn_rtt {
+                rtt.calculate_rtt(sample);
+                rto.calculate_rto(&rtt, sample);
+            }
+
+            (rtt, rto)
+        };
+
+        let mut stream = Self {
+            blocked: Duration::ZERO,
+            blocked_since: None,
+            bytes_in_flight,
+            choked: false,
             close_requested: false,
+            congestion: congestion_control(&config, MAX_WINDOW_LOOKAHEAD),
             cmd_rx,
             destination,
             dst_port,
             event_tx,
+            header_buffer: BytesMut::with_capacity(HEADER_BUFFER_SIZE),
             inbound_context: InboundContext::new(highest_ack),
             local,
-            next_seq_nro: 1u32,
+            metrics,
+            mtu: match max_packet_size {
+                Some(size) if size > 0 => cmp::min(size as usize, MTU_SIZE),
+                _ => MTU_SIZE,
+            },
+            next_seq_nro: unacked.len() as u32 + 1,
+            num_retransmissions: 0usize,
             pending: BTreeMap::new(),
-            read_buffer: vec![0u8; READ_BUFFER_SIZE],
+            pre_ack_seq_nro: unacked.len() as u32,
+            read_buffer: BytesMut::zeroed(READ_BUFFER_SIZE),
             read_state: SocketState::ReadMessage,
+            recovery_seq_nro: 0u32,
             recv_stream_id,
             remote,
             routing_path_handle,
-            rto: Rto::new(),
-            rto_timer: None,
-            rtt: Rtt::new(),
+            rto_timer: (!unacked.is_empty()).then(|| R::timer(*rto)),
+            rto,
+            rtt,
             send_stream_id,
             signing_key,
             src_port,
             stream,
-            unacked: BTreeMap::new(),
-            window_size: INITIAL_WINDOW_SIZE,
+            unacked,
             write_state: match initial_message {
                 None => WriteState::GetMessage,
                 Some(message) => WriteState::WriteMessage {
@@ -714,7 +1047,18 @@ impl<R: Runtime> Stream<R> {
                     message,
                 },
             },
+        };
+
+        if syn_rtt.is_some() {
+            stream.inbound_context.set_rtt(*stream.rtt);
+        }
+
+        if !unsent.is_empty() {
+            stream.read_buffer[..unsent.len()].copy_from_slice(&unsent);
+            stream.packetize(unsent.len());
         }
+
+        stream
     }
 
     /// Handle acknowledgements.
@@ -732,7 +1076,7 @@ impl<R: Runtime> Stream<R> {
             seq = ?(self.next_seq_nro - 1),
             rtt = ?*self.rtt,
             rto = ?*self.rto,
-            wnd = ?self.window_size,
+            wnd = ?self.congestion.window_size(),
             "handle acks",
         );
 
@@ -762,14 +1106,92 @@ impl<R: Runtime> Stream<R> {
             .map(|seq_nro| (seq_nro, self.unacked.remove(&seq_nro).expect("to exist")))
             .collect::<Vec<_>>();
 
-        for (_, packet) in acked {
-            self.rtt.calculate_rtt(packet.sent.elapsed());
-            self.rto.calculate_rto(&self.rtt, packet.sent.elapsed());
+        for (seq_nro, packet) in acked {
+            self.bytes_in_flight -= packet.len();
+
+            // send time of packets sent before the `SYN` was ACKed isn't known and an ACK of a
+            // retransmitted packet can't be matched to a transmission
+            if seq_nro > self.pre_ack_seq_nro && !packet.retransmitted {
+                self.rtt.calculate_rtt(packet.sent.elapsed());
+                self.rto.calculate_rto(&self.rtt, packet.sent.elapsed());
+                self.routing_path_handle.register_rtt(packet.sent.elapsed());
+                self.metrics.histogram(RTT).record(packet.sent.elapsed().as_millis() as f64);
+            }
+
+            self.congestion.on_ack(R::time_since_epoch(), *self.rtt);
+            self.inbound_context.set_rtt(*self.rtt);
+        }
+
+        if !nacks.is_empty() {
+            self.fast_retransmit(nacks);
+        }
+    }
+
+    /// Resend packets which have been NACKed at least [`FAST_RETRANSMIT_THRESHOLD`] times without
+    /// waiting for the RTO to expire.
+    ///
+    /// The window is reduced at most once per window of data.
+    fn fast_retransmit(&mut self, nacks: &[u32]) {
+        let lost = nacks
+            .iter()
+            .filter_map(|seq_nro| {
+                let packet = self.unacked.get_mut(seq_nro)?;
+                packet.num_nacks += 1;
+
+                (packet.num_nacks == FAST_RETRANSMIT_THRESHOLD).then_some(*seq_nro)
+            })
+            .collect::<Vec<_>>();
+
+        if lost.is_empty() {
+            return;
+        }
+
+        self.num_retransmissions += lost.len();
+        self.metrics.counter(RETRANSMISSION_COUNT).increment(lost.len());
+
+        if lost.iter().any(|seq_nro| *seq_nro >= self.recovery_seq_nro) {
+            self.congestion.on_loss(R::time_since_epoch());
+            self.recovery_seq_nro = self.next_seq_nro;
+        }
+
+        let delivery_style = match self.routing_path_handle.routing_path() {
+            None => DeliveryStyle::Unspecified {
+                destination_id: self.remote.clone(),
+            },
+            Some(routing_path) => DeliveryStyle::ViaRoute { routing_path },
+        };
+
+        for seq_nro in lost {
+            let packet = self.unacked.get_mut(&seq_nro).expect("to exist");
+            packet.sent = R::now();
+            packet.retransmitted = true;
+
+            tracing::trace!(
+                target: LOG_TARGET,
+                local = %self.local,
+                remote = %self.remote,
+                recv_id = ?self.recv_stream_id,
+                send_id = ?self.send_stream_id,
+                ?seq_nro,
+                wnd = ?self.congestion.window_size(),
+                "fast retransmit",
+            );
 
-            if self.window_size < EXP_GROWTH_STOP_THRESHOLD {
-                self.window_size *= 2;
-            } else if self.window_size < MAX_WINDOW_SIZE {
-                self.window_size += 1;
+            if let Err(error) = self.event_tx.try_send((
+                delivery_style.clone(),
+                packet.serialize(),
+                self.src_port,
+                self.dst_port,
+            )) {
+                tracing::warn!(
+                    target: LOG_TARGET,
+                    local = %self.local,
+                    remote = %self.remote,
+                    recv_id = ?self.recv_stream_id,
+                    send_id = ?self.send_stream_id,
+                    ?error,
+                    "failed to send packet",
+                );
             }
         }
     }
@@ -777,6 +1199,7 @@ impl<R: Runtime> Stream<R> {
     /// Handle `packet` received from the network.
     fn on_packet(&mut self, packet: Vec<u8>) -> Result<(), StreamingError> {
         let Packet {
+            send_stream_id,
             seq_nro,
             ack_through,
             nacks,
@@ -785,7 +1208,10 @@ impl<R: Runtime> Stream<R> {
             ..
         } = Packet::parse(&packet).ok_or(StreamingError::Malformed)?;
 
-        if flags.synchronize() {
+        // duplicate `SYN` from the stream initiator, e.g., a `SYN` that was sent over more than one
+        // routing path, is answered with another `SYN` whereas a duplicate reply to our own `SYN`
+        // is treated as a regular duplicate packet so the streams don't keep echoing `SYN`s
+        if flags.synchronize() && send_stream_id == 0 {
             tracing::warn!(
                 target: LOG_TARGET,
                 local = %self.local,
@@ -853,6 +1279,23 @@ impl<R: Runtime> Stream<R> {
             self.handle_acks(ack_through, &nacks);
         }
 
+        // remote chokes the stream by requesting a delay larger than `MAX_DELAY_REQUEST` and
+        // unchokes it by sending a packet without one
+        let choked = flags.delay_requested().is_some_and(|delay| delay > MAX_DELAY_REQUEST);
+
+        if choked != self.choked {
+            tracing::debug!(
+                target: LOG_TARGET,
+                local = %self.local,
+                remote = %self.remote,
+                recv_id = ?self.recv_stream_id,
+                send_id = ?self.send_stream_id,
+                ?choked,
+                "choke state changed",
+            );
+            self.choked = choked;
+        }
+
         // handle packet
         //
         // packet is handled even if it's payload is empty as it may contain, e.g., `CLOSE` with a
@@ -862,6 +1305,7 @@ impl<R: Runtime> Stream<R> {
         // if the sequnce number is zero and `SYN` is not set, the packet is a plain ack which can
         // be ignored
         if seq_nro != PLAIN_ACK || flags.synchronize() {
+            self.inbound_context.set_requested_delay(flags.delay_requested());
             self.inbound_context.handle_packet(seq_nro, payload)?;
         }
 
@@ -880,47 +1324,48 @@ impl<R: Runtime> Stream<R> {
         Ok(())
     }
 
-    fn packetize(&mut self, offset: usize) {
+    /// Split `nread` bytes read from the client socket into packets and send them.
+    ///
+    /// Payloads are not copied: each packet holds a refcounted slice of the read buffer and its
+    /// header is serialized into a shared scratch buffer.
+    fn packetize(&mut self, nread: usize) {
         let sent = R::now();
+        let data = self.read_buffer.split_to(nread).freeze();
 
-        let packets = self.read_buffer[..offset]
-            .chunks(MTU_SIZE)
-            .map(|chunk| {
+        let packets = (0..nread)
+            .step_by(self.mtu)
+            .map(|start| {
+                let payload = data.slice(start..cmp::min(start + self.mtu, nread));
                 let seq_nro = {
                     let seq_nro = self.next_seq_nro;
                     self.next_seq_nro += 1;
                     seq_nro
                 };
                 let ack_through = self.inbound_context.seq_nro;
-                let nacks = self
-                    .inbound_context
-                    .missing
-                    .iter()
-                    .copied()
-                    .take(MAX_NACKS)
-                    .collect::<Vec<_>>();
+                let nacks = self.inbound_context.missing().take(MAX_NACKS).collect::<Vec<_>>();
 
                 let builder = PacketBuilder::new(self.send_stream_id)
                     .with_send_stream_id(self.recv_stream_id)
                     .with_ack_through(ack_through)
                     .with_nacks(nacks)
-                    .with_seq_nro(seq_nro)
-                    .with_payload(chunk);
+                    .with_seq_nro(seq_nro);
 
-                let packet = if self.inbound_context.missing.len() >= MAX_NACKS {
+                if self.inbound_context.num_missing() >= MAX_NACKS {
                     builder.with_delay_requested(CHOKING_REQUEST)
                 } else {
                     builder
                 }
-                .build()
-                .to_vec();
+                .build_header_into(&mut self.header_buffer);
 
                 (
                     seq_nro,
                     PendingPacket::<R> {
                         sent,
                         seq_nro,
-                        packet,
+                        header: self.header_buffer.split().freeze(),
+                        payload,
+                        num_nacks: 0usize,
+                        retransmitted: false,
                     },
                 )
             })
@@ -933,12 +1378,14 @@ impl<R: Runtime> Stream<R> {
             recv_id = ?self.recv_stream_id,
             send_id = ?self.send_stream_id,
             num_packets = ?packets.len(),
-            windows_size = %self.window_size,
+            windows_size = %self.congestion.window_size(),
             "send packets",
         );
 
+        let mut ack_sent = false;
+
         packets.into_iter().for_each(|(seq_nro, packet)| {
-            if self.unacked.len() >= self.window_size {
+            if self.choked || self.unacked.len() >= self.congestion.window_size() {
                 self.pending.insert(seq_nro, packet);
             } else {
                 match self.event_tx.try_send((
@@ -948,7 +1395,7 @@ impl<R: Runtime> Stream<R> {
                         },
                         Some(routing_path) => DeliveryStyle::ViaRoute { routing_path },
                     },
-                    packet.packet.clone(),
+                    packet.serialize(),
                     self.src_port,
                     self.dst_port,
                 )) {
@@ -956,12 +1403,19 @@ impl<R: Runtime> Stream<R> {
                         self.pending.insert(seq_nro, packet);
                     }
                     Ok(()) => {
+                        self.bytes_in_flight += packet.len();
                         self.unacked.insert(seq_nro, packet);
+                        ack_sent = true;
                     }
                 }
             }
         });
 
+        // the packets carry an ACK for everything received so far
+        if ack_sent {
+            self.inbound_context.ack_sent();
+        }
+
         if self.rto_timer.is_none() {
             self.rto_timer = Some(R::timer(*self.rto));
         }
@@ -974,11 +1428,12 @@ impl<R: Runtime> Stream<R> {
             return;
         }
 
+        let window_size = self.congestion.window_size();
         let expired = self
             .unacked
             .values_mut()
             .take_while(|packet| packet.sent.elapsed() > *self.rto)
-            .take(self.window_size)
+            .take(window_size)
             .collect::<Vec<_>>();
 
         // no expired packetes
@@ -1019,8 +1474,11 @@ impl<R: Runtime> Stream<R> {
             }
         };
 
+        let num_expired = expired.len();
+
         for packet in expired {
             packet.sent = R::now();
+            packet.retransmitted = true;
 
             tracing::trace!(
                 target: LOG_TARGET,
@@ -1036,7 +1494,7 @@ impl<R: Runtime> Stream<R> {
                 DeliveryStyle::ViaRoute {
                     routing_path: routing_path.clone(),
                 },
-                packet.packet.clone(),
+                packet.serialize(),
                 self.src_port,
                 self.dst_port,
             )) {
@@ -1052,10 +1510,27 @@ impl<R: Runtime> Stream<R> {
             }
         }
 
+        self.num_retransmissions += num_expired;
+        self.metrics.counter(RETRANSMISSION_COUNT).increment(num_expired);
         self.rto_timer = Some(R::timer(self.rto.exponential_backoff()));
+        self.congestion.on_timeout();
+    }
 
-        if self.window_size > 1 {
-            self.window_size -= 1;
+    /// Build a snapshot of the stream's transmission state.
+    fn stats(&self) -> StreamStats {
+        StreamStats {
+            blocked: match self.blocked_since {
+                Some(blocked_since) => self.blocked + blocked_since.elapsed(),
+                None => self.blocked,
+            },
+            bytes_in_flight: self.bytes_in_flight,
+            choked: self.choked,
+            num_pending: self.pending.len(),
+            num_retransmissions: self.num_retransmissions,
+            num_unacked: self.unacked.len(),
+            rto: *self.rto,
+            rtt: *self.rtt,
+            window_size: self.congestion.window_size(),
         }
     }
 
@@ -1092,16 +1567,16 @@ impl<R: Runtime> Stream<R> {
             .with_from_included(self.destination.clone())
             .with_signature()
             .build_and_sign(&self.signing_key)
-            .to_vec();
+            .freeze();
 
-        if self.window_size.saturating_sub(self.unacked.len()) == 0 {
+        if self.congestion.window_size().saturating_sub(self.unacked.len()) == 0 {
             tracing::info!(
                 target: LOG_TARGET,
                 local = %self.local,
                 remote = %self.remote,
                 recv_id = ?self.recv_stream_id,
                 send_id = ?self.send_stream_id,
-                wnd = ?self.window_size,
+                wnd = ?self.congestion.window_size(),
                 "postponing `CLOSE`, send window is full",
             );
 
@@ -1110,7 +1585,10 @@ impl<R: Runtime> Stream<R> {
                 PendingPacket::<R> {
                     sent: R::now(),
                     seq_nro,
-                    packet,
+                    header: packet,
+                    payload: Bytes::new(),
+                    num_nacks: 0usize,
+                    retransmitted: false,
                 },
             );
         } else {
@@ -1121,7 +1599,7 @@ impl<R: Runtime> Stream<R> {
                     },
                     Some(routing_path) => DeliveryStyle::ViaRoute { routing_path },
                 },
-                packet.clone(),
+                packet.to_vec(),
                 self.src_port,
                 self.dst_port,
             )) {
@@ -1131,17 +1609,24 @@ impl<R: Runtime> Stream<R> {
                         PendingPacket::<R> {
                             sent: R::now(),
                             seq_nro,
-                            packet,
+                            header: packet,
+                            payload: Bytes::new(),
+                            num_nacks: 0usize,
+                            retransmitted: false,
                         },
                     );
                 }
                 Ok(()) => {
+                    self.bytes_in_flight += packet.len();
                     self.unacked.insert(
                         seq_nro,
                         PendingPacket::<R> {
                             sent: R::now(),
                             seq_nro,
-                            packet,
+                            header: packet,
+                            payload: Bytes::new(),
+                            num_nacks: 0usize,
+                            retransmitted: false,
                         },
                     );
                 }
@@ -1176,16 +1661,12 @@ impl<R: Runtime> Future for Stream<R> {
         loop {
             match mem::replace(&mut this.write_state, WriteState::Poisoned) {
                 WriteState::GetMessage => match this.cmd_rx.poll_recv(cx) {
-                    Poll::Pending => match this.inbound_context.pop_message() {
-                        None => {
+                    Poll::Pending => match this.inbound_context.has_ready_data() {
+                        false => {
                             this.write_state = WriteState::GetMessage;
                             break;
                         }
-                        Some(message) =>
-                            this.write_state = WriteState::WriteMessage {
-                                offset: 0usize,
-                                message,
-                            },
+                        true => this.write_state = WriteState::WriteReady,
                     },
                     Poll::Ready(None) => return Poll::Ready(this.recv_stream_id),
                     Poll::Ready(Some(StreamEvent::ShutDown)) => {
@@ -1193,6 +1674,10 @@ impl<R: Runtime> Future for Stream<R> {
                         this.read_state = SocketState::Closed;
                         this.shutdown();
                     }
+                    Poll::Ready(Some(StreamEvent::QueryStats { tx })) => {
+                        let _ = tx.try_send((this.recv_stream_id, this.stats()));
+                        this.write_state = WriteState::GetMessage;
+                    }
                     Poll::Ready(Some(StreamEvent::Packet { packet })) => {
                         match this.on_packet(packet) {
                             Err(StreamingError::Closed | StreamingError::SequenceNumberTooHigh) =>
@@ -1209,13 +1694,9 @@ impl<R: Runtime> Future for Stream<R> {
                                 );
                                 this.write_state = WriteState::GetMessage;
                             }
-                            Ok(()) => match this.inbound_context.pop_message() {
-                                Some(message) =>
-                                    this.write_state = WriteState::WriteMessage {
-                                        offset: 0usize,
-                                        message,
-                                    },
-                                None => this.write_state = WriteState::GetMessage,
+                            Ok(()) => match this.inbound_context.has_ready_data() {
+                                true => this.write_state = WriteState::WriteReady,
+                                false => this.write_state = WriteState::GetMessage,
                             },
                         }
                     }
@@ -1245,6 +1726,31 @@ impl<R: Runtime> Future for Stream<R> {
                         },
                     }
                 }
+                WriteState::WriteReady => {
+                    match Pin::new(&mut this.stream)
+                        .as_mut()
+                        .poll_write_vectored(cx, &this.inbound_context.ready_data())
+                    {
+                        Poll::Pending => {
+                            this.write_state = WriteState::WriteReady;
+                            break;
+                        }
+                        Poll::Ready(Err(_)) | Poll::Ready(Ok(0)) => {
+                            this.write_state = WriteState::Closed;
+                            this.read_state = SocketState::Closed;
+                            this.shutdown();
+                            continue;
+                        }
+                        Poll::Ready(Ok(nwritten)) => {
+                            this.inbound_context.consume(nwritten);
+
+                            this.write_state = match this.inbound_context.has_ready_data() {
+                                true => WriteState::WriteReady,
+                                false => WriteState::GetMessage,
+                            };
+                        }
+                    }
+                }
                 WriteState::Closed => match this.cmd_rx.poll_recv(cx) {
                     Poll::Pending => {
                         this.write_state = WriteState::Closed;
@@ -1256,6 +1762,10 @@ impl<R: Runtime> Future for Stream<R> {
                         this.read_state = SocketState::Closed;
                         break;
                     }
+                    Poll::Ready(Some(StreamEvent::QueryStats { tx })) => {
+                        let _ = tx.try_send((this.recv_stream_id, this.stats()));
+                        this.write_state = WriteState::Closed;
+                    }
                     Poll::Ready(Some(StreamEvent::Packet { packet })) => {
                         match this.on_packet(packet) {
                             Err(StreamingError::Closed | StreamingError::SequenceNumberTooHigh) =>
@@ -1299,20 +1809,35 @@ impl<R: Runtime> Future for Stream<R> {
                 SocketState::ReadMessage | SocketState::Closed => match this.pending.is_empty() {
                     false => {
                         let outstanding = this.unacked.len();
-                        let available = this.window_size.saturating_sub(outstanding);
+                        let available = match this.choked {
+                            true => 0usize,
+                            false => this.congestion.window_size().saturating_sub(outstanding),
+                        };
 
                         // cannot send more data for now
                         if available == 0 {
+                            if this.blocked_since.is_none() {
+                                this.blocked_since = Some(R::now());
+                            }
                             break;
                         }
 
+                        if let Some(blocked_since) = this.blocked_since.take() {
+                            let blocked = blocked_since.elapsed();
+
+                            this.blocked += blocked;
+                            this.metrics
+                                .histogram(WINDOW_BLOCKED_DURATION)
+                                .record(blocked.as_millis() as f64);
+                        }
+
                         tracing::info!(
                             target: LOG_TARGET,
                             local = %this.local,
                             remote = %this.remote,
                             recv_id = ?this.recv_stream_id,
                             send_id = ?this.send_stream_id,
-                            window_size = this.window_size,
+                            window_size = this.congestion.window_size(),
                             num_unacked = ?this.unacked.len(),
                             num_pending = ?this.pending.len(),
                             "send pending packets",
@@ -1334,7 +1859,7 @@ impl<R: Runtime> Future for Stream<R> {
                                     },
                                     Some(routing_path) => DeliveryStyle::ViaRoute { routing_path },
                                 },
-                                packet.packet.clone(),
+                                packet.serialize(),
                                 this.src_port,
                                 this.dst_port,
                             )) {
@@ -1344,6 +1869,7 @@ impl<R: Runtime> Future for Stream<R> {
                                 }
                                 Ok(()) => {
                                     packet.sent = now;
+                                    this.bytes_in_flight += packet.len();
                                     this.unacked.insert(seq_nro, packet);
 
                                     count + 1
@@ -1351,11 +1877,28 @@ impl<R: Runtime> Future for Stream<R> {
                             }
                         });
 
-                        if num_sent > 0 && this.rto_timer.is_none() {
-                            this.rto_timer = Some(R::timer(*this.rto));
+                        if num_sent > 0 {
+                            this.metrics
+                                .histogram(WINDOW_SIZE)
+                                .record(this.congestion.window_size() as f64);
+                            this.metrics
+                                .histogram(BYTES_IN_FLIGHT)
+                                .record(this.bytes_in_flight as f64);
+
+                            if this.rto_timer.is_none() {
+                                this.rto_timer = Some(R::timer(*this.rto));
+                            }
                         }
                     }
-                    true if !core::matches!(this.read_state, SocketState::Closed) =>
+                    true if !core::matches!(this.read_state, SocketState::Closed) => {
+                        // the read buffer is shared with unacked packets, grow it back once the
+                        // remaining space can't hold a full packet
+                        //
+                        // this reclaims the original allocation if all packets have been ACKed
+                        if this.read_buffer.len() < this.mtu {
+                            this.read_buffer.resize(READ_BUFFER_SIZE, 0u8);
+                        }
+
                         match Pin::new(&mut this.stream)
                             .as_mut()
                             .poll_read(cx, &mut this.read_buffer)
@@ -1373,7 +1916,8 @@ impl<R: Runtime> Future for Stream<R> {
                             Poll::Ready(Ok(nread)) => {
                                 this.read_state = SocketState::SendMessage { offset: nread };
                             }
-                        },
+                        }
+                    }
                     true => break,
                 },
                 SocketState::SendMessage { offset } => {
@@ -1394,8 +1938,7 @@ impl<R: Runtime> Future for Stream<R> {
         // send plain ack
         if this.inbound_context.poll_unpin(cx).is_ready() {
             let ack_through = this.inbound_context.seq_nro;
-            let nacks =
-                this.inbound_context.missing.iter().copied().take(MAX_NACKS).collect::<Vec<_>>();
+            let nacks = this.inbound_context.missing().take(MAX_NACKS).collect::<Vec<_>>();
 
             tracing::trace!(
                 target: LOG_TARGET,
@@ -1416,7 +1959,7 @@ impl<R: Runtime> Future for Stream<R> {
                 .with_nacks(nacks)
                 .with_seq_nro(PLAIN_ACK);
 
-            builder = if this.inbound_context.missing.len() >= MAX_NACKS {
+            builder = if this.inbound_context.num_missing() >= MAX_NACKS {
                 builder.with_delay_requested(CHOKING_REQUEST)
             } else {
                 builder
@@ -1464,6 +2007,14 @@ impl<R: Runtime> Future for Stream<R> {
     }
 }
 
+impl<R: Runtime> Drop for Stream<R> {
+    fn drop(&mut self) {
+        self.metrics
+            .histogram(STREAM_RETRANSMISSIONS)
+            .record(self.num_retransmissions as f64);
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -1475,6 +2026,7 @@ mod tests {
             mock::{MockRuntime, MockTcpStream},
             TcpStream,
         },
+        sam::protocol::streaming::config::{CongestionAlgorithm, INITIAL_WINDOW_SIZE},
     };
     use futures::StreamExt;
     use rand::{
@@ -1485,6 +2037,119 @@ mod tests {
     use thingbuf::mpsc::channel;
     use tokio::io::{AsyncBufReadExt, AsyncReadExt, AsyncWriteExt, BufReader};
 
+    #[tokio::test]
+    async fn inbound_context_reassembles_out_of_order_packets() {
+        let mut context = InboundContext::<MockRuntime>::new(0u32);
+
+        // packets 3, 5 and 2 arrive before packet 1
+        context.handle_packet(3, &[3u8; 4]).unwrap();
+        context.handle_packet(5, &[5u8; 4]).unwrap();
+        context.handle_packet(2, &[2u8; 4]).unwrap();
+
+        assert!(!context.has_ready_data());
+        assert_eq!(context.missing().collect::<Vec<_>>(), vec![1, 4]);
+        assert_eq!(context.num_missing(), 2);
+
+        // duplicate of a buffered packet is ignored
+        context.handle_packet(3, &[0xffu8; 4]).unwrap();
+
+        // packet 1 releases packets 1-3
+        context.handle_packet(1, &[1u8; 4]).unwrap();
+        assert_eq!(context.missing().collect::<Vec<_>>(), vec![4]);
+
+        let mut delivered = Vec::new();
+        while context.has_ready_data() {
+            let chunk = context.ready_data().concat();
+            context.consume(chunk.len());
+            delivered.extend_from_slice(&chunk);
+        }
+        assert_eq!(
+            delivered,
+            [[1u8; 4], [2u8; 4], [3u8; 4]].into_iter().flatten().collect::<Vec<_>>()
+        );
+
+        // packet 4 releases packets 4-5 and nothing is missing anymore
+        context.handle_packet(4, &[4u8; 4]).unwrap();
+        assert_eq!(context.num_missing(), 0);
+        assert_eq!(context.ready.len(), 8);
+
+        // packets that were already delivered are ignored
+        context.handle_packet(2, &[2u8; 4]).unwrap();
+        assert_eq!(context.ready.len(), 8);
+
+        // packet at the edge of the lookahead window is buffered
+        let seq_nro = 5 + 1 + MAX_WINDOW_LOOKAHEAD as u32;
+        context.handle_packet(seq_nro, &[6u8; 4]).unwrap();
+        assert_eq!(context.num_missing(), MAX_WINDOW_LOOKAHEAD);
+        assert_eq!(context.slots.len(), RECEIVE_WINDOW);
+
+        // packet beyond it is rejected
+        assert!(context.handle_packet(seq_nro + 1 + MAX_WINDOW_LOOKAHEAD as u32, &[]).is_err());
+    }
+
+    #[tokio::test]
+    async fn inbound_context_coalesces_acks() {
+        async fn poll_ack(context: &mut InboundContext<MockRuntime>) -> bool {
+            core::future::poll_fn(|cx| Poll::Ready(context.poll_unpin(cx).is_ready())).await
+        }
+
+        let mut context = InboundContext::<MockRuntime>::new(0u32);
+
+        // in-order packets are acked after the delay until the threshold is reached
+        for seq_nro in 1..ACK_THRESHOLD as u32 {
+            context.handle_packet(seq_nro, b"data").unwrap();
+            assert!(!poll_ack(&mut context).await);
+        }
+        context.handle_packet(ACK_THRESHOLD as u32, b"data").unwrap();
+        assert!(poll_ack(&mut context).await);
+        assert!(context.ack_timer.is_none());
+        assert_eq!(context.num_unacked, 0);
+
+        // ack timer fires after the delay
+        context.handle_packet(ACK_THRESHOLD as u32 + 1, b"data").unwrap();
+        assert!(!poll_ack(&mut context).await);
+        tokio::time::sleep(INITIAL_ACK_DELAY + Duration::from_millis(50)).await;
+        assert!(poll_ack(&mut context).await);
+
+        // packet opening a gap is acked immediately
+        let seq_nro = ACK_THRESHOLD as u32 + 3;
+        context.handle_packet(seq_nro, b"data").unwrap();
+        assert!(poll_ack(&mut context).await);
+
+        // packet closing the last gap is acked immediately
+        context.handle_packet(seq_nro - 1, b"data").unwrap();
+        assert!(poll_ack(&mut context).await);
+
+        // duplicates and packets requesting zero delay are acked immediately
+        context.handle_packet(1, b"data").unwrap();
+        assert!(poll_ack(&mut context).await);
+
+        context.set_requested_delay(Some(0));
+        context.handle_packet(seq_nro + 1, b"data").unwrap();
+        assert!(poll_ack(&mut context).await);
+
+        // duplicate of a buffered out-of-order packet is acked immediately
+        context.handle_packet(seq_nro + 3, b"data").unwrap();
+        assert!(poll_ack(&mut context).await);
+        context.handle_packet(seq_nro + 3, b"data").unwrap();
+        assert!(poll_ack(&mut context).await);
+
+        // rejected packets don't count toward the ack threshold
+        let too_far = seq_nro + 3 + MAX_WINDOW_LOOKAHEAD as u32 + 2;
+        assert!(context.handle_packet(too_far, b"data").is_err());
+        assert_eq!(context.num_unacked, 0);
+        assert!(context.ack_timer.is_none());
+        assert!(!poll_ack(&mut context).await);
+
+        // ack delay follows the measured rtt
+        context.set_rtt(Duration::from_secs(1));
+        assert_eq!(context.ack_delay, Duration::from_millis(500));
+        context.set_rtt(Duration::from_secs(10));
+        assert_eq!(context.ack_delay, MAX_ACK_DELAY);
+        context.set_rtt(Duration::from_millis(10));
+        assert_eq!(context.ack_delay, INITIAL_ACK_DELAY);
+    }
+
     struct StreamBuilder {
         cmd_tx: Sender<StreamEvent>,
         event_rx: Receiver<(DeliveryStyle, Vec<u8>, u16, u16)>,
@@ -1495,6 +2160,17 @@ mod tests {
 
     impl StreamBuilder {
         async fn build_stream() -> (Stream<MockRuntime>, Self) {
+            Self::build_stream_with_config(StreamConfig::default()).await
+        }
+
+        async fn build_stream_with_config(config: StreamConfig) -> (Stream<MockRuntime>, Self) {
+            Self::build_stream_with_kind(config, StreamKind::Inbound { payload: vec![] }).await
+        }
+
+        async fn build_stream_with_kind(
+            config: StreamConfig,
+            kind: StreamKind,
+        ) -> (Stream<MockRuntime>, Self) {
             let listener = tokio::net::TcpListener::bind("127.0.0.1:0").await.unwrap();
             let signing_key = SigningPrivateKey::random(MockRuntime::rng());
             let destination = Destination::new::<MockRuntime>(signing_key.public());
@@ -1520,7 +2196,7 @@ mod tests {
 
             (
                 Stream::new(
-                    stream2.unwrap(),
+                    SamStream::Tcp(stream2.unwrap()),
                     None,
                     StreamContext {
                         destination,
@@ -1530,10 +2206,12 @@ mod tests {
                         recv_stream_id: 1337u32,
                         remote: DestinationId::random(),
                         signing_key,
+                        max_packet_size: None,
                     },
-                    Default::default(),
-                    StreamKind::Inbound { payload: vec![] },
+                    config,
+                    kind,
                     handle,
+                    MockRuntime::register_metrics(vec![], None),
                 ),
                 Self {
                     cmd_tx,
@@ -1546,6 +2224,17 @@ mod tests {
         }
 
         async fn build_connected_streams(
+        ) -> ((Stream<MockRuntime>, Self), (Stream<MockRuntime>, Self)) {
+            Self::build_connected_streams_with_config(
+                StreamConfig::default(),
+                StreamConfig::default(),
+            )
+            .await
+        }
+
+        async fn build_connected_streams_with_config(
+            outbound_config: StreamConfig,
+            inbound_config: StreamConfig,
         ) -> ((Stream<MockRuntime>, Self), (Stream<MockRuntime>, Self)) {
             let listener = tokio::net::TcpListener::bind("127.0.0.1:0").await.unwrap();
             let address = listener.local_addr().unwrap();
@@ -1617,7 +2306,7 @@ mod tests {
             (
                 (
                     Stream::new(
-                        outbound_server_stream.unwrap(),
+                        SamStream::Tcp(outbound_server_stream.unwrap()),
                         None,
                         StreamContext {
                             destination: outbound_destination,
@@ -1627,15 +2316,20 @@ mod tests {
                             recv_stream_id: 1337u32,
                             remote: inbound_destination_id.clone(),
                             signing_key: outbound_signing_key,
+                            max_packet_size: None,
                         },
-                        Default::default(),
+                        outbound_config,
                         StreamKind::Outbound {
                             dst_port: 0,
                             payload: Vec::new(),
+                            pre_ack_packets: Vec::new(),
+                            rtt: None,
                             send_stream_id: 1338u32,
                             src_port: 0u16,
+                            unsent: Vec::new(),
                         },
                         outbound_path_handle,
+                        MockRuntime::register_metrics(vec![], None),
                     ),
                     Self {
                         cmd_tx: outbound_cmd_tx,
@@ -1647,7 +2341,7 @@ mod tests {
                 ),
                 (
                     Stream::new(
-                        inbound_server_stream.unwrap(),
+                        SamStream::Tcp(inbound_server_stream.unwrap()),
                         None,
                         StreamContext {
                             destination: inbound_destination,
@@ -1657,10 +2351,12 @@ mod tests {
                             recv_stream_id: 1338u32,
                             remote: outbound_destination_id,
                             signing_key: inbound_signing_key,
+                            max_packet_size: None,
                         },
-                        Default::default(),
+                        inbound_config,
                         StreamKind::Inbound { payload: vec![] },
                         inbound_path_handle,
+                        MockRuntime::register_metrics(vec![], None),
                     ),
                     Self {
                         cmd_tx: inbound_cmd_tx,
@@ -2380,7 +3076,7 @@ mod tests {
         ) = StreamBuilder::build_stream().await;
 
         // verify initial state
-        assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
         assert_eq!(*stream.rtt, INITIAL_RTT);
         assert_eq!(*stream.rto, INITIAL_RTO);
 
@@ -2412,6 +3108,10 @@ mod tests {
         assert_eq!(stream.next_seq_nro, 2);
         assert!(stream.pending.is_empty());
         assert!(stream.rto_timer.is_some());
+        assert_eq!(
+            stream.bytes_in_flight,
+            stream.unacked.get(&1).unwrap().len()
+        );
 
         // send ack for the packet
         cmd_tx
@@ -2429,9 +3129,121 @@ mod tests {
         // poll stream and handle ack
         tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
 
-        assert_eq!(stream.window_size, 2);
+        assert_eq!(stream.congestion.window_size(), 2);
         assert_ne!(*stream.rtt, INITIAL_RTT);
         assert_ne!(*stream.rto, INITIAL_RTO);
+        assert_eq!(stream.bytes_in_flight, 0);
+    }
+
+    #[tokio::test]
+    async fn stats_built_on_query() {
+        let (
+            mut stream,
+            StreamBuilder {
+                cmd_tx,
+                stream: mut client,
+                event_rx,
+                ..
+            },
+        ) = StreamBuilder::build_stream().await;
+
+        tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
+
+        // ignore syn
+        let _ = event_rx.recv().await.unwrap();
+
+        client.write_all(b"hello, world\n").await.unwrap();
+        tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
+        let _ = event_rx.recv().await.unwrap();
+
+        let (tx, rx) = channel(1);
+        cmd_tx.send(StreamEvent::QueryStats { tx }).await.unwrap();
+        tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
+
+        let (stream_id, stats) = rx.recv().await.unwrap();
+        assert_eq!(stream_id, 1337u32);
+        assert_eq!(stats.num_unacked, 1);
+        assert_eq!(stats.bytes_in_flight, stream.bytes_in_flight);
+        assert_eq!(stats.window_size, stream.congestion.window_size());
+        assert_eq!(stats.num_retransmissions, 0);
+        assert!(!stats.choked);
+    }
+
+    #[tokio::test]
+    async fn outbound_stream_inherits_pre_ack_packets() {
+        let pre_ack_packets = (1..=2u32)
+            .map(|seq_nro| {
+                PacketBuilder::new(1338u32)
+                    .with_send_stream_id(0u32)
+                    .with_seq_nro(seq_nro)
+                    .with_payload(b"early data")
+                    .build()
+                    .to_vec()
+            })
+            .collect::<Vec<_>>();
+
+        let (
+            mut stream,
+            StreamBuilder {
+                cmd_tx,
+                stream: _client,
+                event_rx,
+                ..
+            },
+        ) = StreamBuilder::build_stream_with_kind(
+            StreamConfig::default(),
+            StreamKind::Outbound {
+                dst_port: 0u16,
+                payload: Vec::new(),
+                pre_ack_packets,
+                rtt: Some(Duration::from_millis(500)),
+                send_stream_id: 1338u32,
+                src_port: 0u16,
+                unsent: b"late data".to_vec(),
+            },
+        )
+        .await;
+
+        // rtt and rto are seeded with the round trip of the syn
+        assert_eq!(*stream.rtt, Duration::from_millis(500));
+        assert_eq!(*stream.rto, Duration::from_millis(1000));
+
+        // pre-ack packets are waiting for an ack and unsent data is queued after them
+        assert_eq!(
+            stream.unacked.keys().copied().collect::<Vec<_>>(),
+            vec![1, 2]
+        );
+        assert_eq!(stream.pending.keys().copied().collect::<Vec<_>>(), vec![3]);
+        assert_eq!(stream.next_seq_nro, 4);
+        assert!(stream.rto_timer.is_some());
+
+        // ack the pre-ack packets, allowing the unsent data to be sent
+        cmd_tx
+            .send(StreamEvent::Packet {
+                packet: PacketBuilder::new(1338u32)
+                    .with_ack_through(2u32)
+                    .with_send_stream_id(1337u32)
+                    .with_seq_nro(PLAIN_ACK)
+                    .build()
+                    .to_vec(),
+            })
+            .await
+            .unwrap();
+
+        tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
+
+        // pre-ack packets are not used as rtt samples
+        assert_eq!(*stream.rtt, Duration::from_millis(500));
+
+        let (_, packet, _, _) = tokio::time::timeout(Duration::from_secs(5), event_rx.recv())
+            .await
+            .expect("no timeout")
+            .expect("to succeed");
+
+        let packet = Packet::parse(&packet).unwrap();
+        assert_eq!(packet.seq_nro, 3);
+        assert_eq!(packet.payload, b"late data");
+        assert!(stream.pending.is_empty());
     }
 
     #[tokio::test]
@@ -2447,7 +3259,7 @@ mod tests {
         ) = StreamBuilder::build_stream().await;
 
         // verify initial state
-        assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
         assert_eq!(*stream.rtt, INITIAL_RTT);
         assert_eq!(*stream.rto, INITIAL_RTO);
 
@@ -2499,7 +3311,7 @@ mod tests {
         // verify state is unchanged
         assert_eq!(stream.unacked.len(), 1);
         assert_eq!(stream.next_seq_nro, 2);
-        assert_eq!(stream.window_size, 1);
+        assert_eq!(stream.congestion.window_size(), 1);
         assert!(stream.pending.is_empty());
         assert!(stream.rto_timer.is_some());
     }
@@ -2517,7 +3329,7 @@ mod tests {
         ) = StreamBuilder::build_stream().await;
 
         // verify initial state
-        assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
         assert_eq!(*stream.rtt, INITIAL_RTT);
         assert_eq!(*stream.rto, INITIAL_RTO);
 
@@ -2560,7 +3372,7 @@ mod tests {
         // poll stream and handle ack
         tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
 
-        assert_eq!(stream.window_size, 2);
+        assert_eq!(stream.congestion.window_size(), 2);
         assert_ne!(*stream.rtt, INITIAL_RTT);
         assert_ne!(*stream.rto, INITIAL_RTO);
 
@@ -2580,7 +3392,7 @@ mod tests {
         // verify there's one pending packet and that the rto timer is active
         assert_eq!(stream.unacked.len(), 1);
         assert_eq!(stream.next_seq_nro, 3);
-        assert_eq!(stream.window_size, 2);
+        assert_eq!(stream.congestion.window_size(), 2);
         assert!(stream.pending.is_empty());
         assert!(stream.rto_timer.is_some());
 
@@ -2603,7 +3415,7 @@ mod tests {
         // verify state is unchanged
         assert_eq!(stream.unacked.len(), 1);
         assert_eq!(stream.next_seq_nro, 3);
-        assert_eq!(stream.window_size, 1);
+        assert_eq!(stream.congestion.window_size(), 1);
         assert!(stream.pending.is_empty());
         assert!(stream.rto_timer.is_some());
     }
@@ -2621,7 +3433,7 @@ mod tests {
         ) = StreamBuilder::build_stream().await;
 
         // verify initial state
-        assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
         assert_eq!(*stream.rtt, INITIAL_RTT);
         assert_eq!(*stream.rto, INITIAL_RTO);
 
@@ -2652,7 +3464,7 @@ mod tests {
 
         let packet = Packet::parse(&first_packet).unwrap();
         assert_eq!(packet.payload, vec![1u8; MTU_SIZE]);
-        assert_eq!(stream.window_size, 1);
+        assert_eq!(stream.congestion.window_size(), 1);
         assert_eq!(stream.unacked.len(), INITIAL_WINDOW_SIZE);
         assert_eq!(stream.pending.len(), 2);
 
@@ -2672,7 +3484,7 @@ mod tests {
         // poll stream and handle ack
         tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
 
-        assert_eq!(stream.window_size, 2);
+        assert_eq!(stream.congestion.window_size(), 2);
         assert_ne!(*stream.rtt, INITIAL_RTT);
         assert_ne!(*stream.rto, INITIAL_RTO);
 
@@ -2750,7 +3562,7 @@ mod tests {
         ) = StreamBuilder::build_stream().await;
 
         // verify initial state
-        assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
         assert_eq!(*stream.rtt, INITIAL_RTT);
         assert_eq!(*stream.rto, INITIAL_RTO);
 
@@ -2867,7 +3679,7 @@ mod tests {
 
             tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
 
-            assert_eq!(stream.window_size, 32);
+            assert_eq!(stream.congestion.window_size(), 32);
             assert!(stream.unacked.is_empty());
             assert!(stream.pending.is_empty());
         }
@@ -2921,7 +3733,7 @@ mod tests {
 
         tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
 
-        assert_eq!(stream.window_size, 67);
+        assert_eq!(stream.congestion.window_size(), 67);
         assert_eq!(stream.unacked.len(), 2);
         assert!(stream.pending.is_empty());
 
@@ -2946,7 +3758,102 @@ mod tests {
 
         assert_eq!(first_missing.payload, vec![8u8; MTU_SIZE]);
         assert_eq!(second_missing.payload, vec![0xau8; MTU_SIZE]);
-        assert_eq!(stream.window_size, 66);
+        assert_eq!(stream.congestion.window_size(), 66);
+    }
+
+    #[tokio::test]
+    async fn fast_retransmit() {
+        let (
+            mut stream,
+            StreamBuilder {
+                cmd_tx,
+                stream: mut client,
+                event_rx,
+                ..
+            },
+        ) = StreamBuilder::build_stream_with_config(StreamConfig {
+            initial_window_size: 8,
+            ..Default::default()
+        })
+        .await;
+
+        // ignore syn
+        let _ = event_rx.recv().await.unwrap();
+
+        // send four packets
+        client
+            .write_all(&{
+                let mut data = Vec::new();
+                data.extend_from_slice(&vec![1u8; MTU_SIZE]);
+                data.extend_from_slice(&vec![2u8; MTU_SIZE]);
+                data.extend_from_slice(&vec![3u8; MTU_SIZE]);
+                data.extend_from_slice(&vec![4u8; MTU_SIZE]);
+
+                data
+            })
+            .await
+            .unwrap();
+
+        tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
+
+        let mut seq_nros = Vec::new();
+        for _ in 0..4 {
+            let (_, packet, _, _) = event_rx.recv().await.unwrap();
+            seq_nros.push(Packet::parse(&packet).unwrap().seq_nro);
+        }
+        assert_eq!(stream.unacked.len(), 4);
+
+        // nack the second packet until it's retransmitted
+        for _ in 0..FAST_RETRANSMIT_THRESHOLD {
+            cmd_tx
+                .send(StreamEvent::Packet {
+                    packet: PacketBuilder::new(1338u32)
+                        .with_ack_through(seq_nros[3])
+                        .with_nacks(vec![seq_nros[1]])
+                        .with_send_stream_id(1337u32)
+                        .with_seq_nro(PLAIN_ACK)
+                        .build()
+                        .to_vec(),
+                })
+                .await
+                .unwrap();
+
+            tokio::time::timeout(Duration::from_millis(200), &mut stream).await.unwrap_err();
+        }
+
+        // verify the packet was resent before rto and the window was halved once
+        let (_, packet, _, _) = tokio::time::timeout(Duration::from_secs(1), event_rx.recv())
+            .await
+            .expect("no timeout")
+            .expect("to succeed");
+        let packet = Packet::parse(&packet).unwrap();
+
+        assert_eq!(packet.seq_nro, seq_nros[1]);
+        assert_eq!(packet.payload, vec![2u8; MTU_SIZE]);
+        assert_eq!(stream.unacked.len(), 1);
+        assert_eq!(stream.congestion.window_size(), 32);
+        assert!(stream.unacked.get(&seq_nros[1]).unwrap().retransmitted);
+
+        // ack of the retransmitted packet is not used as an rtt sample
+        let (rtt, rto) = (*stream.rtt, *stream.rto);
+        tokio::time::sleep(Duration::from_millis(300)).await;
+
+        cmd_tx
+            .send(StreamEvent::Packet {
+                packet: PacketBuilder::new(1338u32)
+                    .with_ack_through(seq_nros[3])
+                    .with_send_stream_id(1337u32)
+                    .with_seq_nro(PLAIN_ACK)
+                    .build()
+                    .to_vec(),
+            })
+            .await
+            .unwrap();
+        tokio::time::timeout(Duration::from_millis(200), &mut stream).await.unwrap_err();
+
+        assert!(stream.unacked.is_empty());
+        assert_eq!(*stream.rtt, rtt);
+        assert_eq!(*stream.rto, rto);
     }
 
     #[tokio::test]
@@ -3018,7 +3925,7 @@ mod tests {
         // ignore syn
         let (_, _, _, _) = event_rx.recv().await.unwrap();
 
-        assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
 
         // verify window is first grown to 2 and then decreased back to 1
         {
@@ -3056,7 +3963,7 @@ mod tests {
 
             // verify that window size is doubled
             tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
-            assert_eq!(stream.window_size, 2);
+            assert_eq!(stream.congestion.window_size(), 2);
 
             // send another packet but this time allow rto to expire
             client.write_all(&vec![1 as u8; 256]).await.unwrap();
@@ -3093,7 +4000,7 @@ mod tests {
             assert_eq!(ignored, packet);
 
             // verify that window size is decreased back to 1
-            assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+            assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
 
             let packet = Packet::parse(&packet).unwrap();
             cmd_tx
@@ -3145,7 +4052,7 @@ mod tests {
 
             tokio::time::timeout(Duration::from_secs(1), &mut stream).await.unwrap_err();
         }
-        assert_eq!(stream.window_size, EXP_GROWTH_STOP_THRESHOLD);
+        assert_eq!(stream.congestion.window_size(), EXP_GROWTH_STOP_THRESHOLD);
 
         let handle = tokio::spawn(async move {
             loop {
@@ -3176,7 +4083,7 @@ mod tests {
                 .unwrap();
         }
         let stream = handle.await.unwrap();
-        assert_eq!(stream.window_size, MAX_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), MAX_WINDOW_SIZE);
     }
 
     #[test]
@@ -3222,7 +4129,7 @@ mod tests {
         ) = StreamBuilder::build_stream().await;
 
         // verify initial state
-        assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
         assert_eq!(*stream.rtt, INITIAL_RTT);
         assert_eq!(*stream.rto, INITIAL_RTO);
 
@@ -3310,7 +4217,7 @@ mod tests {
         ) = StreamBuilder::build_stream().await;
 
         // verify initial state
-        assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
         assert_eq!(*stream.rtt, INITIAL_RTT);
         assert_eq!(*stream.rto, INITIAL_RTO);
 
@@ -3406,7 +4313,7 @@ mod tests {
         ) = StreamBuilder::build_stream().await;
 
         // verify initial state
-        assert_eq!(stream.window_size, INITIAL_WINDOW_SIZE);
+        assert_eq!(stream.congestion.window_size(), INITIAL_WINDOW_SIZE);
         assert_eq!(*stream.rtt, INITIAL_RTT);
         assert_eq!(*stream.rto, INITIAL_RTO);
 
@@ -3756,4 +4663,110 @@ mod tests {
             response.clear();
         }
     }
+
+    /// Transfer `num_bytes` between two connected streams over a simulated tunnel with a fixed
+    /// one-way delay and return how long it took.
+    async fn measure_throughput(
+        config: StreamConfig,
+        num_bytes: usize,
+        delay: Duration,
+    ) -> Duration {
+        let (
+            (
+                outbound_stream,
+                StreamBuilder {
+                    cmd_tx: outbound_cmd_tx,
+                    event_rx: outbound_event_rx,
+                    stream: mut outbound_client_stream,
+                    ..
+                },
+            ),
+            (
+                inbound_stream,
+                StreamBuilder {
+                    cmd_tx: inbound_cmd_tx,
+                    event_rx: inbound_event_rx,
+                    stream: mut inbound_client_stream,
+                    ..
+                },
+            ),
+        ) = StreamBuilder::build_connected_streams_with_config(config.clone(), config).await;
+
+        // ignore syn
+        let _ = inbound_event_rx.recv().await.unwrap();
+
+        tokio::spawn(outbound_stream);
+        tokio::spawn(inbound_stream);
+        tokio::spawn(async move {
+            loop {
+                let (tx, packet) = tokio::select! {
+                    event = outbound_event_rx.recv() => match event {
+                        None => break,
+                        Some((_, packet, _, _)) => (inbound_cmd_tx.clone(), packet),
+                    },
+                    event = inbound_event_rx.recv() => match event {
+                        None => break,
+                        Some((_, packet, _, _)) => (outbound_cmd_tx.clone(), packet),
+                    },
+                };
+
+                tokio::spawn(async move {
+                    tokio::time::sleep(delay).await;
+                    let _ = tx.send(StreamEvent::Packet { packet }).await;
+                });
+            }
+        });
+
+        let started = std::time::Instant::now();
+        let writer = tokio::spawn(async move {
+            outbound_client_stream.write_all(&vec![0xaau8; num_bytes]).await.unwrap();
+            outbound_client_stream
+        });
+
+        let mut data = vec![0u8; num_bytes];
+        inbound_client_stream.read_exact(&mut data).await.unwrap();
+        let elapsed = started.elapsed();
+
+        drop(writer.await.unwrap());
+        elapsed
+    }
+
+    // streaming throughput benchmark over simulated 250ms one-way tunnel delay, run with:
+    // `cargo test --release stream_throughput -- --ignored --nocapture`
+    #[tokio::test]
+    #[ignore]
+    async fn stream_throughput() {
+        const NUM_BYTES: usize = 2 * 1024 * 1024;
+        const MIN_KB_PER_SECOND: f64 = 128f64;
+
+        for (name, config) in [
+            ("reno", StreamConfig::default()),
+            (
+                "reno, initial window 16",
+                StreamConfig {
+                    initial_window_size: 16,
+                    ..Default::default()
+                },
+            ),
+            (
+                "cubic, initial window 16",
+                StreamConfig {
+                    initial_window_size: 16,
+                    congestion_control: CongestionAlgorithm::Cubic,
+                    ..Default::default()
+                },
+            ),
+        ] {
+            let elapsed = measure_throughput(config, NUM_BYTES, Duration::from_millis(250)).await;
+            let kb_per_second = NUM_BYTES as f64 / 1024f64 / elapsed.as_secs_f64();
+
+            println!(
+                "{name}: transferred {NUM_BYTES} bytes in {elapsed:?} ({kb_per_second:.0} KB/s)"
+            );
+            assert!(
+                kb_per_second >= MIN_KB_PER_SECOND,
+                "{name}: {kb_per_second:.0} KB/s, expected at least {MIN_KB_PER_SECOND} KB/s",
+            );
+        }
+    }
 }
@@ -0,0 +1,347 @@
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//! Congestion control for I2P streaming.
+//!
+//! Window sizes are counted in packets, not bytes.
+
+use crate::sam::protocol::streaming::config::{CongestionAlgorithm, StreamConfig};
+
+use alloc::boxed::Box;
+use core::{cmp, time::Duration};
+
+/// Initial slow start threshold.
+///
+/// The window grows exponentially until it reaches this threshold.
+const INITIAL_SLOW_START_THRESHOLD: usize = 64usize;
+
+/// Minimum slow start threshold.
+const MIN_SLOW_START_THRESHOLD: usize = 2usize;
+
+/// CUBIC scaling constant.
+const CUBIC_C: f64 = 0.4f64;
+
+/// CUBIC multiplicative decrease factor.
+const CUBIC_BETA: f64 = 0.7f64;
+
+/// Congestion controller of a stream.
+pub trait CongestionControl: Send {
+    /// Get the current congestion window.
+    fn window_size(&self) -> usize;
+
+    /// Packet was ACKed.
+    ///
+    /// `now` is the time since UNIX epoch and `rtt` is the smoothed RTT of the stream.
+    fn on_ack(&mut self, now: Duration, rtt: Duration);
+
+    /// Packet loss was detected from NACKs.
+    ///
+    /// Called at most once per window of outbound data.
+    fn on_loss(&mut self, now: Duration);
+
+    /// Retransmission timer expired.
+    fn on_timeout(&mut self);
+}
+
+/// Create congestion controller for a stream from `config`.
+///
+/// `max_window_size` is the upper bound for the configured maximum window size.
+pub fn congestion_control(
+    config: &StreamConfig,
+    max_window_size: usize,
+) -> Box<dyn CongestionControl> {
+    let max_window_size = config.max_window_size.clamp(1, max_window_size);
+    let initial_window_size = config.initial_window_size.clamp(1, max_window_size);
+
+    match config.congestion_control {
+        CongestionAlgorithm::Reno => Box::new(Reno::new(initial_window_size, max_window_size)),
+        CongestionAlgorithm::Cubic => Box::new(Cubic::new(initial_window_size, max_window_size)),
+    }
+}
+
+/// Loss-based controller which doubles the window on each ACK during slow start and grows it
+/// linearly afterwards.
+pub struct Reno {
+    /// Maximum window size.
+    max_window_size: usize,
+
+    /// Slow start threshold.
+    slow_start_threshold: usize,
+
+    /// Window size.
+    window_size: usize,
+}
+
+impl Reno {
+    /// Create new [`Reno`].
+    pub fn new(initial_window_size: usize, max_window_size: usize) -> Self {
+        Self {
+            max_window_size,
+            slow_start_threshold: INITIAL_SLOW_START_THRESHOLD,
+            window_size: initial_window_size,
+        }
+    }
+}
+
+impl CongestionControl for Reno {
+    fn window_size(&self) -> usize {
+        self.window_size
+    }
+
+    fn on_ack(&mut self, _: Duration, _: Duration) {
+        if self.window_size < self.slow_start_threshold {
+            self.window_size = cmp::min(self.window_size * 2, self.max_window_size);
+        } else if self.window_size < self.max_window_size {
+            self.window_size += 1;
+        }
+    }
+
+    fn on_loss(&mut self, _: Duration) {
+        self.window_size = cmp::max(self.window_size / 2, 1);
+        self.slow_start_threshold = cmp::max(self.window_size, MIN_SLOW_START_THRESHOLD);
+    }
+
+    fn on_timeout(&mut self) {
+        if self.window_size > 1 {
+            self.window_size -= 1;
+        }
+    }
+}
+
+/// CUBIC congestion controller.
+///
+/// During congestion avoidance the window follows a cubic function of the time elapsed since the
+/// last loss, which lets it recover the pre-loss window quickly on high-RTT tunnel paths.
+///
+/// See RFC 8312 for more details.
+pub struct Cubic {
+    /// Start of the current congestion avoidance epoch.
+    epoch_start: Option<Duration>,
+
+    /// Time it takes for the window to grow back to `window_max`, in seconds.
+    k: f64,
+
+    /// Maximum window size.
+    max_window_size: usize,
+
+    /// Slow start threshold.
+    slow_start_threshold: f64,
+
+    /// Window size.
+    window: f64,
+
+    /// Window size estimate of a standard TCP flow, used as the lower bound for the window.
+    window_estimate: f64,
+
+    /// Window size before the last reduction.
+    window_max: f64,
+}
+
+impl Cubic {
+    /// Create new [`Cubic`].
+    pub fn new(initial_window_size: usize, max_window_size: usize) -> Self {
+        Self {
+            epoch_start: None,
+            k: 0f64,
+            max_window_size,
+            slow_start_threshold: INITIAL_SLOW_START_THRESHOLD as f64,
+            window: initial_window_size as f64,
+            window_estimate: initial_window_size as f64,
+            window_max: 0f64,
+        }
+    }
+
+    /// Start new congestion avoidance epoch at `now`.
+    fn start_epoch(&mut self, now: Duration) -> Duration {
+        if self.window < self.window_max {
+            self.k = cube_root((self.window_max - self.window) / CUBIC_C);
+        } else {
+            self.k = 0f64;
+            self.window_max = self.window;
+        }
+        self.window_estimate = self.window;
+        self.epoch_start = Some(now);
+
+        now
+    }
+
+    /// Reduce the window after packet loss.
+    fn reduce(&mut self) {
+        self.epoch_start = None;
+
+        // fast convergence: release bandwidth for new flows if the window didn't recover
+        self.window_max = if self.window < self.window_max {
+            self.window * (1f64 + CUBIC_BETA) / 2f64
+        } else {
+            self.window
+        };
+        self.slow_start_threshold =
+            f64::max(self.window * CUBIC_BETA, MIN_SLOW_START_THRESHOLD as f64);
+    }
+}
+
+impl CongestionControl for Cubic {
+    fn window_size(&self) -> usize {
+        cmp::max(self.window as usize, 1)
+    }
+
+    fn on_ack(&mut self, now: Duration, rtt: Duration) {
+        let max_window = self.max_window_size as f64;
+
+        if self.window < self.slow_start_threshold {
+            self.window = f64::min(self.window + 1f64, max_window);
+            return;
+        }
+
+        let epoch_start = match self.epoch_start {
+            Some(epoch_start) => epoch_start,
+            None => self.start_epoch(now),
+        };
+
+        let elapsed = (now.saturating_sub(epoch_start) + rtt).as_secs_f64() - self.k;
+        let target = CUBIC_C * elapsed * elapsed * elapsed + self.window_max;
+
+        self.window += match target > self.window {
+            true => (target - self.window) / self.window,
+            false => 0.01f64 / self.window,
+        };
+        self.window_estimate +=
+            3f64 * (1f64 - CUBIC_BETA) / (1f64 + CUBIC_BETA) / self.window_estimate;
+        self.window = f64::max(self.window, self.window_estimate).min(max_window);
+    }
+
+    fn on_loss(&mut self, _: Duration) {
+        self.reduce();
+        self.window = f64::max(self.window * CUBIC_BETA, 1f64);
+    }
+
+    fn on_timeout(&mut self) {
+        self.reduce();
+        self.window = 1f64;
+    }
+}
+
+/// Calculate cube root of `value` using Newton's method.
+///
+/// `f64::cbrt()` is not available in `core`.
+fn cube_root(value: f64) -> f64 {
+    if value <= 0f64 {
+        return 0f64;
+    }
+
+    let mut root = f64::max(value, 1f64);
+
+    for _ in 0..64 {
+        let next = (2f64 * root + value / (root * root)) / 3f64;
+
+        if f64::max(root - next, next - root) < 1e-9 {
+            return next;
+        }
+        root = next;
+    }
+
+    root
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn cube_root_works() {
+        assert_eq!(cube_root(0f64), 0f64);
+        assert!((cube_root(27f64) - 3f64).abs() < 1e-6);
+        assert!((cube_root(0.125f64) - 0.5f64).abs() < 1e-6);
+        assert!((cube_root(1000f64) - 10f64).abs() < 1e-6);
+    }
+
+    #[test]
+    fn reno_slow_start_and_loss() {
+        let mut reno = Reno::new(1, 128);
+
+        for expected in [2, 4, 8, 16, 32, 64, 65, 66] {
+            reno.on_ack(Duration::ZERO, Duration::ZERO);
+            assert_eq!(reno.window_size(), expected);
+        }
+
+        reno.on_loss(Duration::ZERO);
+        assert_eq!(reno.window_size(), 33);
+
+        // linear growth after loss
+        reno.on_ack(Duration::ZERO, Duration::ZERO);
+        assert_eq!(reno.window_size(), 34);
+
+        reno.on_timeout();
+        assert_eq!(reno.window_size(), 33);
+    }
+
+    #[test]
+    fn reno_window_is_clamped() {
+        let mut reno = Reno::new(1, 8);
+
+        for _ in 0..16 {
+            reno.on_ack(Duration::ZERO, Duration::ZERO);
+        }
+        assert_eq!(reno.window_size(), 8);
+    }
+
+    #[test]
+    fn cubic_recovers_window_after_loss() {
+        let rtt = Duration::from_secs(2);
+        let mut cubic = Cubic::new(10, 256);
+        let mut now = Duration::from_secs(1_000);
+
+        // exit slow start
+        while cubic.window_size() < INITIAL_SLOW_START_THRESHOLD {
+            cubic.on_ack(now, rtt);
+        }
+        assert_eq!(cubic.window_size(), INITIAL_SLOW_START_THRESHOLD);
+
+        cubic.on_loss(now);
+        let reduced = cubic.window_size();
+        assert_eq!(
+            reduced,
+            (INITIAL_SLOW_START_THRESHOLD as f64 * CUBIC_BETA) as usize
+        );
+
+        // window is grown back to the pre-loss size within a few rtts
+        for _ in 0..5 {
+            now += rtt;
+
+            for _ in 0..cubic.window_size() {
+                cubic.on_ack(now, rtt);
+            }
+        }
+        assert!(cubic.window_size() >= INITIAL_SLOW_START_THRESHOLD);
+        assert!(cubic.window_size() <= 256);
+    }
+
+    #[test]
+    fn cubic_timeout_resets_window() {
+        let mut cubic = Cubic::new(32, 128);
+
+        cubic.on_timeout();
+        assert_eq!(cubic.window_size(), 1);
+
+        // slow start up to the new threshold
+        for _ in 0..64 {
+            cubic.on_ack(Duration::from_secs(1), Duration::from_secs(1));
+        }
+        assert!(cubic.window_size() >= (32f64 * CUBIC_BETA) as usize);
+    }
+}
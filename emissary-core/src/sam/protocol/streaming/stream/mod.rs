@@ -17,4 +17,5 @@
 // DEALINGS IN THE SOFTWARE.
 
 pub mod active;
+pub mod congestion;
 pub mod pending;
@@ -71,6 +71,9 @@ pub struct PendingStream<R: Runtime> {
     /// When was the stream established.
     pub established: R::Instant,
 
+    /// Maximum packet size advertised by remote in its `SYN`, if any.
+    pub max_packet_size: Option<u16>,
+
     /// Pending packets.
     ///
     /// Packets that have been received and ACKed while the stream was pending.
@@ -95,6 +98,7 @@ impl<R: Runtime> PendingStream<R> {
         remote_destination_id: DestinationId,
         recv_stream_id: u32,
         syn_payload: Vec<u8>,
+        max_packet_size: Option<u16>,
         signing_key: &SigningPrivateKey,
     ) -> (Self, Vec<u8>) {
         let send_stream_id = R::rng().next_u32();
@@ -111,6 +115,7 @@ impl<R: Runtime> PendingStream<R> {
             Self {
                 destination_id: remote_destination_id,
                 established: R::now(),
+                max_packet_size,
                 packets: match syn_payload.is_empty() {
                     true => VecDeque::new(),
                     false => VecDeque::from_iter([syn_payload]),
@@ -215,6 +220,7 @@ mod tests {
             DestinationId::random(),
             1337u32,
             vec![],
+            None,
             &SigningPrivateKey::random(NoopRuntime::rng()),
         );
 
@@ -238,6 +244,7 @@ mod tests {
             DestinationId::random(),
             1337u32,
             vec![],
+            None,
             &SigningPrivateKey::random(NoopRuntime::rng()),
         );
 
@@ -262,6 +269,7 @@ mod tests {
             DestinationId::random(),
             1337u32,
             vec![],
+            None,
             &SigningPrivateKey::random(NoopRuntime::rng()),
         );
 
@@ -286,6 +294,7 @@ mod tests {
             DestinationId::random(),
             1337u32,
             vec![],
+            None,
             &SigningPrivateKey::random(NoopRuntime::rng()),
         );
 
@@ -332,6 +341,7 @@ mod tests {
             DestinationId::random(),
             1337u32,
             vec![],
+            None,
             &SigningPrivateKey::random(NoopRuntime::rng()),
         );
 
@@ -349,6 +359,7 @@ mod tests {
             DestinationId::random(),
             1337u32,
             vec![],
+            None,
             &SigningPrivateKey::random(NoopRuntime::rng()),
         );
 
@@ -397,6 +408,7 @@ mod tests {
             DestinationId::random(),
             1337u32,
             vec![1, 2, 3, 4],
+            None,
             &SigningPrivateKey::random(NoopRuntime::rng()),
         );
 
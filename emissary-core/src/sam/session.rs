@@ -17,7 +17,10 @@
 // DEALINGS IN THE SOFTWARE.
 
 use crate::{
-    crypto::{base32_decode, base32_encode, base64_encode, SigningPrivateKey, StaticPrivateKey},
+    crypto::{
+        base32_decode, base32_encode, base64_encode, blinding::LeaseSetBlinder, SigningPrivateKey,
+        StaticPrivateKey,
+    },
     destination::{DeliveryStyle, Destination, DestinationEvent, LeaseSetStatus},
     error::QueryError,
     events::EventHandle,
@@ -26,11 +29,14 @@ use crate::{
     protocol::Protocol,
     runtime::{AddressBook, JoinSet, Runtime},
     sam::{
-        parser::{DestinationContext, SamCommand, SessionKind},
+        parser::{DestinationContext, SamCommand, SessionKind, StreamOptions},
         pending::session::SamSessionContext,
         protocol::{
             datagram::DatagramManager,
-            streaming::{Direction, ListenerKind, StreamManager, StreamManagerEvent},
+            streaming::{
+                Direction, ListenerKind, StreamConfig, StreamManager, StreamManagerEvent,
+                StreamStats,
+            },
         },
         socket::SamSocket,
         SubSessionCommand,
@@ -84,8 +90,8 @@ pub enum SamSessionCommand<R: Runtime> {
         /// Destination ID.
         destination_id: DestinationId,
 
-        /// Options.
-        options: HashMap<String, String>,
+        /// Stream options.
+        options: StreamOptions,
 
         /// Session ID.
         session_id: Arc<str>,
@@ -96,8 +102,8 @@ pub enum SamSessionCommand<R: Runtime> {
         /// SAMv3 socket associated with the inbound stream.
         socket: SamSocket<R>,
 
-        /// Options.
-        options: HashMap<String, String>,
+        /// Stream options.
+        options: StreamOptions,
 
         /// Session ID.
         session_id: Arc<str>,
@@ -111,8 +117,8 @@ pub enum SamSessionCommand<R: Runtime> {
         /// Port which the TCP listener is listening.
         port: u16,
 
-        /// Options.
-        options: HashMap<String, String>,
+        /// Stream options.
+        options: StreamOptions,
 
         /// Session ID.
         session_id: Arc<str>,
@@ -148,7 +154,7 @@ enum PendingSessionState<R: Runtime> {
         socket: SamSocket<R>,
 
         /// Stream options.
-        options: HashMap<String, String>,
+        options: StreamOptions,
     },
 
     /// Awaiting session to be created
@@ -241,9 +247,8 @@ impl SamSessionKind {
         match self {
             Self::Stream => false,
             Self::Datagram { .. } => true,
-            Self::Primary { sub_sessions } => sub_sessions.get(session_id).is_some_and(|kind| {
-                core::matches!(kind, SessionKind::Datagram | SessionKind::Anonymous)
-            }),
+            Self::Primary { sub_sessions } =>
+                sub_sessions.get(session_id).is_some_and(|kind| kind.is_datagram()),
         }
     }
 
@@ -256,6 +261,7 @@ impl SamSessionKind {
             Self::Datagram { kind } => match kind {
                 SessionKind::Datagram => Protocol::Datagram,
                 SessionKind::Anonymous => Protocol::Anonymous,
+                SessionKind::Datagram2 => Protocol::Datagram2,
                 _ => unreachable!(),
             },
             Self::Primary { sub_sessions } => match sub_sessions.get(session_id).expect("to exist")
@@ -263,6 +269,7 @@ impl SamSessionKind {
                 SessionKind::Stream => Protocol::Streaming,
                 SessionKind::Datagram => Protocol::Datagram,
                 SessionKind::Anonymous => Protocol::Anonymous,
+                SessionKind::Datagram2 => Protocol::Datagram2,
                 _ => unreachable!(),
             },
         }
@@ -370,6 +377,7 @@ impl<R: Runtime> SamSession<R> {
             destination,
             event_handle,
             inbound,
+            metrics,
             mut socket,
             netdb_handle,
             options,
@@ -447,7 +455,17 @@ impl<R: Runtime> SamSession<R> {
                 inbound.into_values().collect(),
                 is_unpublished,
                 profile_storage,
+                metrics.clone(),
             );
+
+            // publish the lease set as an encrypted lease set if the client requested it
+            if options.get("i2cp.leaseSetType").is_some_and(|value| value == "5") {
+                session_destination.enable_encrypted_lease_set(LeaseSetBlinder::new(
+                    *signing_key.clone(),
+                    options.get("i2cp.leaseSetSecret").map(|secret| secret.as_bytes().to_vec()),
+                ));
+            }
+
             // // TODO: not needed anymore?
             session_destination.publish_lease_set(local_leaseset.clone());
 
@@ -471,6 +489,8 @@ impl<R: Runtime> SamSession<R> {
             format!("SESSION STATUS RESULT=OK DESTINATION={privkey}\n").as_bytes().to_vec(),
         );
 
+        let stream_config = StreamConfig::from_options(&options);
+
         Self {
             address_book,
             datagram_manager: DatagramManager::new(
@@ -491,19 +511,16 @@ impl<R: Runtime> SamSession<R> {
             session_id,
             session_kind: match session_kind {
                 SessionKind::Stream => SamSessionKind::Stream,
-                SessionKind::Datagram => SamSessionKind::Datagram {
-                    kind: SessionKind::Datagram,
-                },
-                SessionKind::Anonymous => SamSessionKind::Datagram {
-                    kind: SessionKind::Anonymous,
-                },
+                kind
+                @ (SessionKind::Datagram | SessionKind::Anonymous | SessionKind::Datagram2) =>
+                    SamSessionKind::Datagram { kind },
                 SessionKind::Primary => SamSessionKind::Primary {
                     sub_sessions: HashMap::new(),
                 },
             },
             signing_key: *signing_key.clone(),
             socket: Some(socket),
-            stream_manager: StreamManager::new(dest, *signing_key),
+            stream_manager: StreamManager::new(dest, *signing_key, stream_config, metrics),
             sub_session_tx,
             waker: None,
         }
@@ -517,7 +534,7 @@ impl<R: Runtime> SamSession<R> {
         &mut self,
         destination_id: DestinationId,
         socket: SamSocket<R>,
-        options: HashMap<String, String>,
+        options: StreamOptions,
     ) {
         let handle = self.destination.routing_path_handle(destination_id.clone());
         let (stream_id, packet, delivery_style, src_port, dst_port) = self
@@ -574,7 +591,7 @@ impl<R: Runtime> SamSession<R> {
         &mut self,
         mut socket: SamSocket<R>,
         destination_id: DestinationId,
-        options: HashMap<String, String>,
+        options: StreamOptions,
         session_id: Arc<str>,
     ) {
         if !self.session_kind.supports_streams(&session_id) {
@@ -646,7 +663,7 @@ impl<R: Runtime> SamSession<R> {
     fn on_stream_accept(
         &mut self,
         socket: SamSocket<R>,
-        options: HashMap<String, String>,
+        options: StreamOptions,
         session_id: Arc<str>,
     ) {
         if !self.session_kind.supports_streams(&session_id) {
@@ -663,9 +680,7 @@ impl<R: Runtime> SamSession<R> {
         if let Err(error) = self.stream_manager.register_listener(ListenerKind::Ephemeral {
             pending_routing_path_handle: self.destination.pending_routing_path_handle(),
             socket,
-            silent: options
-                .get("SILENT")
-                .is_some_and(|value| value.parse::<bool>().unwrap_or(false)),
+            silent: options.silent,
         }) {
             tracing::warn!(
                 target: LOG_TARGET,
@@ -685,7 +700,7 @@ impl<R: Runtime> SamSession<R> {
         &mut self,
         socket: SamSocket<R>,
         port: u16,
-        options: HashMap<String, String>,
+        options: StreamOptions,
         session_id: Arc<str>,
     ) {
         if !self.session_kind.supports_streams(&session_id) {
@@ -703,9 +718,7 @@ impl<R: Runtime> SamSession<R> {
             pending_routing_path_handle: self.destination.pending_routing_path_handle(),
             socket,
             port,
-            silent: options
-                .get("SILENT")
-                .is_some_and(|value| value.parse::<bool>().unwrap_or(false)),
+            silent: options.silent,
         }) {
             tracing::warn!(
                 target: LOG_TARGET,
@@ -730,7 +743,7 @@ impl<R: Runtime> SamSession<R> {
             return;
         }
 
-        tracing::info!(
+        tracing::trace!(
             target: LOG_TARGET,
             session_id = %self.session_id,
             destination_id = %destination.id(),
@@ -741,26 +754,7 @@ impl<R: Runtime> SamSession<R> {
         let protocol = self.session_kind.as_protocol(&session_id);
 
         match self.destination.query_lease_set(&destination_id) {
-            LeaseSetStatus::Found => {
-                let datagram = self.datagram_manager.make_datagram(protocol, datagram);
-
-                if let Some(message) =
-                    I2cpPayloadBuilder::<R>::new(&datagram).with_protocol(protocol).build()
-                {
-                    if let Err(error) = self
-                        .destination
-                        .send_message(DeliveryStyle::Unspecified { destination_id }, message)
-                    {
-                        tracing::warn!(
-                            target: LOG_TARGET,
-                            session_id = %self.session_id,
-                            destination_id = %destination.id(),
-                            ?error,
-                            "failed to send repliable datagram",
-                        )
-                    }
-                };
-            }
+            LeaseSetStatus::Found => self.send_datagrams(&destination_id, [(protocol, datagram)]),
             LeaseSetStatus::NotFound => {
                 tracing::trace!(
                     target: LOG_TARGET,
@@ -816,6 +810,50 @@ impl<R: Runtime> SamSession<R> {
         }
     }
 
+    /// Send `datagrams` to remote destination.
+    ///
+    /// The datagrams are queued in [`Destination`] rather than sent immediately, so all datagrams
+    /// sent to the same remote destination before [`Destination`] is polled again are coalesced
+    /// into as few garlic messages as possible.
+    ///
+    /// Lease set of the remote destination must exist.
+    fn send_datagrams(
+        &mut self,
+        destination_id: &DestinationId,
+        datagrams: impl IntoIterator<Item = (Protocol, Vec<u8>)>,
+    ) {
+        for (protocol, datagram) in datagrams {
+            let datagram = self.datagram_manager.make_datagram(protocol, destination_id, datagram);
+
+            let Some(message) =
+                I2cpPayloadBuilder::<R>::new(&datagram).with_protocol(protocol).build()
+            else {
+                tracing::warn!(
+                    target: LOG_TARGET,
+                    session_id = %self.session_id,
+                    %destination_id,
+                    "failed to create i2cp payload",
+                );
+                continue;
+            };
+
+            if let Err(error) = self.destination.queue_message(
+                DeliveryStyle::Unspecified {
+                    destination_id: destination_id.clone(),
+                },
+                message,
+            ) {
+                tracing::warn!(
+                    target: LOG_TARGET,
+                    session_id = %self.session_id,
+                    %destination_id,
+                    ?error,
+                    "failed to send datagram",
+                )
+            }
+        }
+    }
+
     /// Handle succeeded lease set query result.
     ///
     /// For each of the pending streams, create a new outbound stream which allocates context in
@@ -853,29 +891,8 @@ impl<R: Runtime> SamSession<R> {
                 }
             });
 
-            if let Some((destination, datagrams)) = datagrams {
-                datagrams.into_iter().for_each(|(protocol, datagram)| {
-                    let datagram = self.datagram_manager.make_datagram(protocol, datagram);
-
-                    if let Some(message) =
-                        I2cpPayloadBuilder::<R>::new(&datagram).with_protocol(protocol).build()
-                    {
-                        if let Err(error) = self.destination.send_message(
-                            DeliveryStyle::Unspecified {
-                                destination_id: destination_id.clone(),
-                            },
-                            message,
-                        ) {
-                            tracing::warn!(
-                                target: LOG_TARGET,
-                                session_id = %self.session_id,
-                                destination_id = %destination.id(),
-                                ?error,
-                                "failed to send repliable datagram",
-                            )
-                        }
-                    };
-                });
+            if let Some((_, datagrams)) = datagrams {
+                self.send_datagrams(&destination_id, datagrams);
             }
         } else {
             tracing::debug!(
@@ -1232,6 +1249,34 @@ impl<R: Runtime> SamSession<R> {
         }
     }
 
+    /// Handle transmission state snapshots queried for `STREAM STATS`.
+    ///
+    /// Returns a dump of the transmission state of each active stream of the session, which must
+    /// be sent to the client. The dump starts with a status line containing the number of streams,
+    /// followed by one `STREAM STAT` line per stream. Durations are in milliseconds.
+    fn on_stream_stats(stats: Vec<(u32, DestinationId, StreamStats)>) -> Vec<u8> {
+        let mut message = format!("STREAM STATS RESULT=OK COUNT={}\n", stats.len());
+
+        for (stream_id, destination_id, stats) in stats {
+            message.push_str(&format!(
+                "STREAM STAT ID={stream_id} DESTINATION={}.b32.i2p RTT={} RTO={} WINDOW={} \
+                UNACKED={} PENDING={} IN_FLIGHT={} RETRANSMITS={} BLOCKED={} CHOKED={}\n",
+                base32_encode(destination_id.to_vec()),
+                stats.rtt.as_millis(),
+                stats.rto.as_millis(),
+                stats.window_size,
+                stats.num_unacked,
+                stats.num_pending,
+                stats.bytes_in_flight,
+                stats.num_retransmissions,
+                stats.blocked.as_millis(),
+                stats.choked,
+            ));
+        }
+
+        message.into_bytes()
+    }
+
     /// Attempt to create new sub-session.
     ///
     /// The sub-session is rejected if [`SamSessionKind`] is not `Primary`, if there already exists
@@ -1294,7 +1339,7 @@ impl<R: Runtime> SamSession<R> {
         }
 
         // if session kind indicated datagrams, attempt to add listener into `DatagramManager`
-        if core::matches!(session_kind, SessionKind::Datagram | SessionKind::Anonymous) {
+        if session_kind.is_datagram() {
             if let Err(()) = self.datagram_manager.add_listener(options) {
                 return b"SESSION STATUS RESULT=I2P_ERROR MESSAGE=\"invalid datagram configuration\"\n".to_vec();
             }
@@ -1342,6 +1387,7 @@ impl<R: Runtime> Future for SamSession<R> {
 
             match command {
                 SamCommand::NamingLookup { name } => self.on_naming_lookup(name),
+                SamCommand::StreamStats => self.stream_manager.query_stream_stats(),
                 SamCommand::CreateSubSession {
                     session_id,
                     session_kind,
@@ -1420,7 +1466,9 @@ impl<R: Runtime> Future for SamSession<R> {
                         continue;
                     };
 
-                    if let Err(error) = self.destination.send_message(delivery_style, message) {
+                    // packets emitted by the stream manager are coalesced with other packets
+                    // destined to the same remote destination before they're encrypted
+                    if let Err(error) = self.destination.queue_message(delivery_style, message) {
                         tracing::warn!(
                             target: LOG_TARGET,
                             session_id = ?self.session_id,
@@ -1450,6 +1498,17 @@ impl<R: Runtime> Future for SamSession<R> {
                         "stream closed",
                     );
                 }
+                Poll::Ready(Some(StreamManagerEvent::StreamStats { stats })) => {
+                    let message = Self::on_stream_stats(stats);
+
+                    if let Some(socket) = &mut self.socket {
+                        socket.send_message(message);
+
+                        if let Some(waker) = self.waker.take() {
+                            waker.wake_by_ref();
+                        }
+                    }
+                }
                 Poll::Ready(Some(StreamManagerEvent::ShutDown)) => {
                     tracing::info!(
                         target: LOG_TARGET,
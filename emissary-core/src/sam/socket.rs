@@ -52,6 +52,66 @@ enum WriteState {
     Poisoned,
 }
 
+/// Stream of a SAMv3 client connection.
+pub enum SamStream<R: Runtime> {
+    /// TCP stream.
+    Tcp(R::TcpStream),
+
+    /// Unix domain socket stream.
+    Unix(R::UnixStream),
+}
+
+impl<R: Runtime> AsyncRead for SamStream<R> {
+    fn poll_read(
+        self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &mut [u8],
+    ) -> Poll<crate::Result<usize>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_read(cx, buf),
+            Self::Unix(stream) => Pin::new(stream).poll_read(cx, buf),
+        }
+    }
+}
+
+impl<R: Runtime> AsyncWrite for SamStream<R> {
+    fn poll_write(
+        self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &[u8],
+    ) -> Poll<crate::Result<usize>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_write(cx, buf),
+            Self::Unix(stream) => Pin::new(stream).poll_write(cx, buf),
+        }
+    }
+
+    fn poll_write_vectored(
+        self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        bufs: &[&[u8]],
+    ) -> Poll<crate::Result<usize>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_write_vectored(cx, bufs),
+            Self::Unix(stream) => Pin::new(stream).poll_write_vectored(cx, bufs),
+        }
+    }
+
+    fn poll_flush(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<crate::Result<()>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_flush(cx),
+            Self::Unix(stream) => Pin::new(stream).poll_flush(cx),
+        }
+    }
+
+    fn poll_close(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<crate::Result<()>> {
+        match self.get_mut() {
+            Self::Tcp(stream) => Pin::new(stream).poll_close(cx),
+            Self::Unix(stream) => Pin::new(stream).poll_close(cx),
+        }
+    }
+}
+
 /// SAMv3 socket.
 ///
 /// Reads new line-delimeted commands from socket and returns them to the caller.
@@ -67,30 +127,53 @@ pub struct SamSocket<R: Runtime> {
     /// Read offset.
     read_offset: usize,
 
-    /// TCP stream.
-    stream: R::TcpStream,
+    /// Start of the next, possibly partially read, command in `read_buffer`.
+    command_start: usize,
+
+    /// Offset up to which `read_buffer` has been scanned for a newline.
+    scan_offset: usize,
+
+    /// Client stream.
+    stream: SamStream<R>,
 
     /// Write state.
     write_state: WriteState,
 }
 
 impl<R: Runtime> SamSocket<R> {
-    /// Create new [`SamSocket`] from an active TCP stream.
-    pub fn new(stream: R::TcpStream) -> Self {
+    /// Create new [`SamSocket`] from an active client stream.
+    pub fn new(stream: SamStream<R>) -> Self {
         Self {
             pending_messages: VecDeque::new(),
             read_buffer: vec![0u8; 4096],
             read_offset: 0usize,
+            command_start: 0usize,
+            scan_offset: 0usize,
             stream,
             write_state: WriteState::GetMessage,
         }
     }
 
-    /// Convert [`SamSocket`] into `TcpStream`.
-    pub fn into_inner(self) -> R::TcpStream {
+    /// Convert [`SamSocket`] into [`SamStream`].
+    pub fn into_inner(self) -> SamStream<R> {
         self.stream
     }
 
+    /// Take any data the client has sent after the last command.
+    ///
+    /// Clients of silent outbound streams may start sending stream data right after the
+    /// `STREAM CONNECT` command so the data may already have been read into the socket's buffer
+    /// alongside the command.
+    pub fn take_buffered(&mut self) -> Vec<u8> {
+        let data = self.read_buffer[self.command_start..self.read_offset].to_vec();
+
+        self.command_start = 0usize;
+        self.scan_offset = 0usize;
+        self.read_offset = 0usize;
+
+        data
+    }
+
     /// Send `message` to client.
     pub fn send_message(&mut self, message: Vec<u8>) {
         self.pending_messages.push_back(message);
@@ -110,6 +193,73 @@ impl<R: Runtime> Stream for SamSocket<R> {
         let mut stream = Pin::new(&mut this.stream);
 
         loop {
+            // only the bytes that haven't been scanned yet are searched for the newline and
+            // commands that were read in the same batch are returned one by one before reading
+            // more data from the socket
+            if let Some(pos) = this.read_buffer[this.scan_offset..this.read_offset]
+                .iter()
+                .position(|byte| byte == &b'\n')
+            {
+                let start = this.command_start;
+                let end = this.scan_offset + pos;
+
+                this.command_start = end + 1;
+                this.scan_offset = end + 1;
+
+                let command = match core::str::from_utf8(&this.read_buffer[start..end]) {
+                    Ok(command) => match SamCommand::parse::<R>(command) {
+                        Some(command) => Some(command),
+                        None => {
+                            tracing::warn!(
+                                target: LOG_TARGET,
+                                %command,
+                                "invalid sam command",
+                            );
+                            None
+                        }
+                    },
+                    Err(error) => {
+                        tracing::warn!(
+                            target: LOG_TARGET,
+                            ?error,
+                            "invalid command"
+                        );
+                        return Poll::Ready(None);
+                    }
+                };
+
+                // all buffered commands have been consumed
+                if this.command_start == this.read_offset {
+                    this.command_start = 0usize;
+                    this.scan_offset = 0usize;
+                    this.read_offset = 0usize;
+                }
+
+                match command {
+                    Some(command) => return Poll::Ready(Some(command)),
+                    None => continue,
+                }
+            }
+
+            this.scan_offset = this.read_offset;
+
+            // move the partially read command to the front of the buffer
+            if this.command_start > 0 {
+                this.read_buffer.copy_within(this.command_start..this.read_offset, 0);
+                this.read_offset -= this.command_start;
+                this.scan_offset = this.read_offset;
+                this.command_start = 0usize;
+            }
+
+            if this.read_offset == this.read_buffer.len() {
+                tracing::warn!(
+                    target: LOG_TARGET,
+                    size = ?this.read_buffer.len(),
+                    "command doesn't fit into read buffer",
+                );
+                return Poll::Ready(None);
+            }
+
             match stream.as_mut().poll_read(cx, &mut this.read_buffer[this.read_offset..]) {
                 Poll::Pending => break,
                 Poll::Ready(Err(error)) => {
@@ -121,48 +271,17 @@ impl<R: Runtime> Stream for SamSocket<R> {
 
                     return Poll::Ready(None);
                 }
-                Poll::Ready(Ok(nread)) => {
-                    if nread == 0 {
-                        tracing::debug!(
-                            target: LOG_TARGET,
-                            offset = ?this.read_offset,
-                            "read zero bytes from socket",
-                        );
-
-                        return Poll::Ready(None);
-                    }
+                Poll::Ready(Ok(0)) => {
+                    tracing::debug!(
+                        target: LOG_TARGET,
+                        offset = ?this.read_offset,
+                        "read zero bytes from socket",
+                    );
 
-                    match this.read_buffer.iter().position(|byte| byte == &b'\n') {
-                        // full command hasn't been read yet
-                        None => {
-                            this.read_offset += nread;
-                        }
-                        // full command read
-                        //
-                        // parse and return it to socket's owner
-                        Some(pos) => match core::str::from_utf8(&this.read_buffer[..pos]) {
-                            Ok(command) => {
-                                this.read_offset = 0usize;
-
-                                match SamCommand::parse::<R>(command) {
-                                    Some(command) => return Poll::Ready(Some(command)),
-                                    None => tracing::warn!(
-                                        target: LOG_TARGET,
-                                        %command,
-                                        "invalid sam command",
-                                    ),
-                                }
-                            }
-                            Err(error) => {
-                                tracing::warn!(
-                                    target: LOG_TARGET,
-                                    ?error,
-                                    "invalid command"
-                                );
-                                return Poll::Ready(None);
-                            }
-                        },
-                    }
+                    return Poll::Ready(None);
+                }
+                Poll::Ready(Ok(nread)) => {
+                    this.read_offset += nread;
                 }
             }
         }
@@ -252,7 +371,7 @@ mod tests {
             }
         });
 
-        let mut socket = SamSocket::<MockRuntime>::new(stream2.unwrap());
+        let mut socket = SamSocket::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
 
         match socket.next().await {
             Some(command) => assert_eq!(
@@ -275,7 +394,7 @@ mod tests {
         let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
 
         let (mut stream, _) = stream1.unwrap();
-        let mut socket = SamSocket::<MockRuntime>::new(stream2.unwrap());
+        let mut socket = SamSocket::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
 
         // send partial command at first
         stream.write_all("HELLO VER".as_bytes()).await.unwrap();
@@ -311,4 +430,90 @@ mod tests {
 
         assert_eq!(socket.read_offset, 0usize);
     }
+
+    #[tokio::test]
+    async fn read_pipelined_commands() {
+        let listener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let address = listener.local_addr().unwrap();
+        let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
+
+        let (mut stream, _) = stream1.unwrap();
+        let mut socket = SamSocket::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
+
+        // two full commands and the beginning of a third one in one write
+        stream
+            .write_all("HELLO VERSION\nHELLO VERSION MIN=3.1 MAX=3.3\nHELLO VER".as_bytes())
+            .await
+            .unwrap();
+
+        match socket.next().await {
+            Some(command) => assert_eq!(
+                command,
+                SamCommand::Hello {
+                    min: None,
+                    max: None
+                }
+            ),
+            None => panic!("socket exited"),
+        }
+
+        match socket.next().await {
+            Some(command) => assert_eq!(
+                command,
+                SamCommand::Hello {
+                    min: Some(SamVersion::V31),
+                    max: Some(SamVersion::V33)
+                }
+            ),
+            None => panic!("socket exited"),
+        }
+
+        // send rest of the third command
+        stream.write_all("SION MIN=3.3 MAX=3.3\n".as_bytes()).await.unwrap();
+
+        match socket.next().await {
+            Some(command) => assert_eq!(
+                command,
+                SamCommand::Hello {
+                    min: Some(SamVersion::V33),
+                    max: Some(SamVersion::V33)
+                }
+            ),
+            None => panic!("socket exited"),
+        }
+
+        assert_eq!(socket.read_offset, 0usize);
+        assert_eq!(socket.command_start, 0usize);
+        assert_eq!(socket.scan_offset, 0usize);
+    }
+
+    #[tokio::test]
+    async fn take_data_buffered_after_command() {
+        let listener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let address = listener.local_addr().unwrap();
+        let (stream1, stream2) = tokio::join!(listener.accept(), MockTcpStream::connect(address));
+
+        let (mut stream, _) = stream1.unwrap();
+        let mut socket = SamSocket::<MockRuntime>::new(SamStream::Tcp(stream2.unwrap()));
+
+        // command followed by stream data in one write
+        stream.write_all("HELLO VERSION\nGET / HTTP/1.1\r\n".as_bytes()).await.unwrap();
+
+        match socket.next().await {
+            Some(command) => assert_eq!(
+                command,
+                SamCommand::Hello {
+                    min: None,
+                    max: None
+                }
+            ),
+            None => panic!("socket exited"),
+        }
+
+        assert_eq!(socket.take_buffered(), b"GET / HTTP/1.1\r\n".to_vec());
+        assert!(socket.take_buffered().is_empty());
+        assert_eq!(socket.read_offset, 0usize);
+        assert_eq!(socket.command_start, 0usize);
+        assert_eq!(socket.scan_offset, 0usize);
+    }
 }
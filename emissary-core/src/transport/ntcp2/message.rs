@@ -41,6 +41,9 @@ const OPTIONS_MIN_SIZE: u16 = 12u16;
 /// Minimum size for termination message.
 const TERMINATION_MIN_SIZE: u16 = 9u16;
 
+/// Poly1305 authentication tag length.
+pub const POLY1305_TAG_LEN: usize = 16usize;
+
 /// Block format identifier.
 #[derive(Debug)]
 enum BlockType {
@@ -376,12 +379,16 @@ impl<'a> MessageBlock<'a> {
         out
     }
 
-    // TODO: unnecessary copy
-    pub fn new_i2np_message(message: &[u8]) -> Vec<u8> {
-        let mut out = vec![0u8; message.len() + 1];
+    /// Create new I2NP block from a serialized I2NP message with short header.
+    ///
+    /// The block is written into `out`, which is cleared first, and the returned buffer has room
+    /// for the Poly1305 tag so the block can be encrypted in place without reallocating.
+    pub fn new_i2np_message(message: &[u8], mut out: Vec<u8>) -> Vec<u8> {
+        out.clear();
+        out.reserve_exact(message.len() + 1 + POLY1305_TAG_LEN);
 
-        out[0] = BlockType::I2Np.as_u8();
-        out[1..].copy_from_slice(message);
+        out.push(BlockType::I2Np.as_u8());
+        out.extend_from_slice(message);
 
         out
     }
@@ -23,12 +23,13 @@
 use crate::{
     crypto::{chachapoly::ChaChaPoly, siphash::SipHash},
     events::EventHandle,
+    pool::BufferPool,
     primitives::{RouterId, RouterInfo},
     runtime::{AsyncRead, AsyncWrite, Runtime},
     subsystem::SubsystemCommand,
     transport::{
         ntcp2::{
-            message::MessageBlock,
+            message::{MessageBlock, POLY1305_TAG_LEN},
             session::{KeyContext, Role},
         },
         Direction, SubsystemHandle, TerminationReason,
@@ -99,6 +100,9 @@ enum WriteState {
 
 /// Active NTCP2 session.
 pub struct Ntcp2Session<R: Runtime> {
+    /// Buffer pool.
+    buffer_pool: BufferPool<R>,
+
     /// RX channel for receiving messages from subsystems.
     cmd_rx: Receiver<SubsystemCommand>,
 
@@ -158,6 +162,7 @@ impl<R: Runtime> Ntcp2Session<R> {
         subsystem_handle: SubsystemHandle,
         direction: Direction,
         event_handle: EventHandle<R>,
+        buffer_pool: BufferPool<R>,
     ) -> Self {
         let KeyContext {
             send_key,
@@ -168,6 +173,7 @@ impl<R: Runtime> Ntcp2Session<R> {
         let (cmd_tx, cmd_rx) = channel(512);
 
         Self {
+            buffer_pool,
             cmd_rx,
             cmd_tx,
             direction,
@@ -286,11 +292,12 @@ impl<R: Runtime> Future for Ntcp2Session<R> {
                             }
                             this.bandwidth += this.read_buffer[..size].len();
 
-                            let data_block =
-                                match this.recv_cipher.decrypt(this.read_buffer[..size].to_vec()) {
-                                    Ok(data_block) => data_block,
-                                    Err(_) => return Poll::Ready(TerminationReason::AeadFailure),
-                                };
+                            let mut data_block = this.buffer_pool.get(size);
+                            data_block.extend_from_slice(&this.read_buffer[..size]);
+
+                            if this.recv_cipher.decrypt_with_ad(&[], &mut data_block).is_err() {
+                                return Poll::Ready(TerminationReason::AeadFailure);
+                            }
 
                             let Some(messages) = MessageBlock::parse_multiple(&data_block) else {
                                 tracing::warn!(
@@ -365,6 +372,7 @@ impl<R: Runtime> Future for Ntcp2Session<R> {
                                     "failed to dispatch messages to subsystems",
                                 );
                             }
+                            this.buffer_pool.put(data_block);
                             this.read_state = ReadState::ReadSize { offset: 0usize };
                         }
                     }
@@ -386,9 +394,12 @@ impl<R: Runtime> Future for Ntcp2Session<R> {
                     Poll::Ready(Some(SubsystemCommand::SendMessage { message })) => {
                         assert!(message.len() as u16 <= u16::MAX, "too large message");
 
-                        // TODO: in-place?
-                        let test = MessageBlock::new_i2np_message(&message);
-                        let data_block = this.send_cipher.encrypt(&test).unwrap();
+                        let mut data_block = MessageBlock::new_i2np_message(
+                            &message,
+                            this.buffer_pool.get(message.len() + 1 + POLY1305_TAG_LEN),
+                        );
+                        this.send_cipher.encrypt_with_ad_new(&[], &mut data_block).unwrap();
+                        this.buffer_pool.put(message);
                         let size = this.sip.obfuscate(data_block.len() as u16);
 
                         this.write_state = WriteState::SendSize {
@@ -446,6 +457,7 @@ impl<R: Runtime> Future for Ntcp2Session<R> {
 
                             match nwritten + offset == message.len() {
                                 true => {
+                                    this.buffer_pool.put(message);
                                     this.write_state = WriteState::GetMessage;
                                 }
                                 false => {
@@ -34,6 +34,7 @@ use crate::{
     crypto::{noise::NoiseContext, sha256::Sha256, siphash::SipHash, StaticPrivateKey},
     error::Error,
     events::EventHandle,
+    pool::BufferPool,
     primitives::{RouterId, RouterInfo, TransportKind},
     profile::ProfileStorage,
     router::context::RouterContext,
@@ -170,6 +171,7 @@ impl<R: Runtime> SessionManager<R> {
         allow_local: bool,
         subsystem_handle: SubsystemHandle,
         event_handle: EventHandle<R>,
+        buffer_pool: BufferPool<R>,
     ) -> crate::Result<Ntcp2Session<R>> {
         let router_id = router.identity.id();
 
@@ -271,6 +273,7 @@ impl<R: Runtime> SessionManager<R> {
             subsystem_handle,
             Direction::Outbound,
             event_handle,
+            buffer_pool,
         ))
     }
 
@@ -293,6 +296,7 @@ impl<R: Runtime> SessionManager<R> {
         let allow_local = self.allow_local;
         let mut subsystem_handle = self.subsystem_handle.clone();
         let event_handle = self.router_ctx.event_handle().clone();
+        let buffer_pool = self.router_ctx.buffer_pool().clone();
         let router_id = router.identity.id();
 
         async move {
@@ -305,6 +309,7 @@ impl<R: Runtime> SessionManager<R> {
                 allow_local,
                 subsystem_handle.clone(),
                 event_handle,
+                buffer_pool,
             )
             .await
             {
@@ -335,6 +340,7 @@ impl<R: Runtime> SessionManager<R> {
         iv: [u8; 16],
         profile_storage: ProfileStorage<R>,
         event_handle: EventHandle<R>,
+        buffer_pool: BufferPool<R>,
     ) -> crate::Result<Ntcp2Session<R>> {
         tracing::trace!(
             target: LOG_TARGET,
@@ -389,6 +395,7 @@ impl<R: Runtime> SessionManager<R> {
                     subsystem_handle,
                     Direction::Inbound,
                     event_handle,
+                    buffer_pool,
                 ))
             }
             Err(error) => {
@@ -418,6 +425,7 @@ impl<R: Runtime> SessionManager<R> {
         let iv = self.local_iv;
         let profile_storage = self.router_ctx.profile_storage().clone();
         let event_handle = self.router_ctx.event_handle().clone();
+        let buffer_pool = self.router_ctx.buffer_pool().clone();
 
         async move {
             Self::accept_session_inner(
@@ -430,6 +438,7 @@ impl<R: Runtime> SessionManager<R> {
                 iv,
                 profile_storage,
                 event_handle,
+                buffer_pool,
             )
             .await
             .map_err(|error| (None, error))
@@ -76,6 +76,12 @@ impl TunnelManagerHandle {
         (Self { tx }, rx)
     }
 
+    #[cfg(test)]
+    /// Create new [`TunnelManagerHandle`] for testing.
+    pub fn create() -> (Self, mpsc::Receiver<TunnelManagerCommand, CommandRecycle>) {
+        Self::new()
+    }
+
     /// Create new `TunnelPool` with `config`.
     ///
     /// On success, returns a future which the caller must poll to get a `TunnelPoolHandle`
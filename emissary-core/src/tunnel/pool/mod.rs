@@ -760,11 +760,13 @@ impl<R: Runtime, S: TunnelSelector + HopSelector> TunnelPool<R, S> {
                             message_id,
                             expiration,
                             DeliveryInstructions::Local,
+                            // the clove is encrypted to and only ever parsed by the local router
                             &MessageBuilder::standard()
                                 .with_expiration(expiration)
                                 .with_message_type(MessageType::Data)
                                 .with_message_id(message_id)
                                 .with_payload(&payload)
+                                .without_checksum()
                                 .build(),
                         )
                         .build();
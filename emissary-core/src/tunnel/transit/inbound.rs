@@ -24,6 +24,7 @@ use crate::{
         tunnel::{data::TunnelDataBuilder, gateway::TunnelGateway},
         Message, MessageBuilder, MessageType,
     },
+    pool::{BufferPool, TUNNEL_BUFFER_SIZE},
     primitives::{RouterId, TunnelId},
     runtime::Runtime,
     tunnel::{
@@ -57,6 +58,9 @@ const PAYLOAD_OFFSET: RangeFrom<usize> = 20..;
 
 /// Inbound gateway.
 pub struct InboundGateway<R: Runtime> {
+    /// Buffer pool.
+    buffer_pool: BufferPool<R>,
+
     /// Event handle.
     event_handle: EventHandle<R>,
 
@@ -146,7 +150,7 @@ impl<R: Runtime> InboundGateway<R> {
                     .with_message_id(R::rng().next_u32())
                     .with_expiration(R::time_since_epoch() + Duration::from_secs(8))
                     .with_payload(&message)
-                    .build()
+                    .build_with_buffer(self.buffer_pool.get(TUNNEL_BUFFER_SIZE))
             });
 
         Ok((self.next_router.clone(), messages))
@@ -163,6 +167,7 @@ impl<R: Runtime> TransitTunnel<R> for InboundGateway<R> {
         metrics_handle: R::MetricsHandle,
         message_rx: Receiver<Message>,
         event_handle: EventHandle<R>,
+        buffer_pool: BufferPool<R>,
     ) -> Self {
         // generate random padding bytes used in `TunnelData` messages
         let padding_bytes = {
@@ -181,6 +186,7 @@ impl<R: Runtime> TransitTunnel<R> for InboundGateway<R> {
         };
 
         InboundGateway {
+            buffer_pool,
             event_handle,
             expiration_timer: R::timer(TRANSIT_TUNNEL_EXPIRATION),
             bandwidth: 0usize,
@@ -403,6 +409,7 @@ mod tests {
             MockRuntime::register_metrics(vec![], None),
             msg_rx,
             event_handle.clone(),
+            BufferPool::new(MockRuntime::register_metrics(vec![], None)),
         );
 
         let message = MessageBuilder::standard()
@@ -523,6 +530,7 @@ mod tests {
             MockRuntime::register_metrics(vec![], None),
             msg_rx,
             event_handle.clone(),
+            BufferPool::new(MockRuntime::register_metrics(vec![], None)),
         );
 
         let tunnel_gateway = TunnelGateway {
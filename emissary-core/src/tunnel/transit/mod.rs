@@ -29,6 +29,7 @@ use crate::{
         },
         HopRole, Message, MessageBuilder, MessageType, I2NP_MESSAGE_EXPIRATION,
     },
+    pool::BufferPool,
     primitives::{RouterId, TunnelId},
     router::context::RouterContext,
     runtime::{Counter, Gauge, JoinSet, MetricsHandle, Runtime},
@@ -103,6 +104,7 @@ pub trait TransitTunnel<R: Runtime>: Future<Output = TunnelId> + Send {
         metrics_handle: R::MetricsHandle,
         message_rx: Receiver<Message>,
         event_handle: EventHandle<R>,
+        buffer_pool: BufferPool<R>,
     ) -> Self;
 }
 
@@ -340,6 +342,7 @@ impl<R: Runtime> TransitTunnelManager<R> {
                 )?;
                 let (tx, rx) = oneshot::channel::<()>();
                 let event_handle = self.router_ctx.event_handle().clone();
+                let buffer_pool = self.router_ctx.buffer_pool().clone();
 
                 match role {
                     HopRole::InboundGateway => self.tunnels.push(async move {
@@ -366,6 +369,7 @@ impl<R: Runtime> TransitTunnelManager<R> {
                             metrics,
                             receiver,
                             event_handle,
+                            buffer_pool,
                         )
                         .await)
                     }),
@@ -393,6 +397,7 @@ impl<R: Runtime> TransitTunnelManager<R> {
                             metrics,
                             receiver,
                             event_handle,
+                            buffer_pool,
                         )
                         .await)
                     }),
@@ -420,6 +425,7 @@ impl<R: Runtime> TransitTunnelManager<R> {
                             metrics,
                             receiver,
                             event_handle,
+                            buffer_pool,
                         )
                         .await)
                     }),
@@ -599,6 +605,7 @@ impl<R: Runtime> TransitTunnelManager<R> {
                 let tunnel_keys = session.finalize()?;
                 let (tx, rx) = oneshot::channel::<()>();
                 let event_handle = self.router_ctx.event_handle().clone();
+                let buffer_pool = self.router_ctx.buffer_pool().clone();
 
                 match role {
                     HopRole::InboundGateway => {
@@ -626,6 +633,7 @@ impl<R: Runtime> TransitTunnelManager<R> {
                                 metrics,
                                 receiver,
                                 event_handle,
+                                buffer_pool,
                             )
                             .await)
                         });
@@ -657,6 +665,7 @@ impl<R: Runtime> TransitTunnelManager<R> {
                                 metrics,
                                 receiver,
                                 event_handle,
+                                buffer_pool,
                             )
                             .await)
                         });
@@ -691,6 +700,7 @@ impl<R: Runtime> TransitTunnelManager<R> {
                                 metrics,
                                 receiver,
                                 event_handle,
+                                buffer_pool,
                             )
                             .await)
                         });
@@ -27,6 +27,7 @@ use crate::{
         },
         Message, MessageBuilder, MessageType,
     },
+    pool::BufferPool,
     primitives::{MessageId, RouterId, TunnelId},
     runtime::Runtime,
     tunnel::{
@@ -54,6 +55,9 @@ const LOG_TARGET: &str = "emissary::tunnel::transit::obep";
 
 /// Outbound endpoint.
 pub struct OutboundEndpoint<R: Runtime> {
+    /// Buffer pool.
+    buffer_pool: BufferPool<R>,
+
     /// Event handle.
     event_handle: EventHandle<R>,
 
@@ -247,7 +251,9 @@ impl<R: Runtime> OutboundEndpoint<R> {
                             .with_message_id(message.message_id)
                             .with_expiration(message.expiration)
                             .with_payload(&message.payload)
-                            .build();
+                            .build_with_buffer(
+                                self.buffer_pool.get(message.serialized_len_short()),
+                            );
 
                         Some((router, message))
                     }
@@ -297,8 +303,10 @@ impl<R: Runtime> TransitTunnel<R> for OutboundEndpoint<R> {
         metrics_handle: R::MetricsHandle,
         message_rx: Receiver<Message>,
         event_handle: EventHandle<R>,
+        buffer_pool: BufferPool<R>,
     ) -> Self {
         OutboundEndpoint {
+            buffer_pool,
             event_handle,
             expiration_timer: R::timer(TRANSIT_TUNNEL_EXPIRATION),
             fragment: FragmentHandler::new(),
@@ -520,6 +528,7 @@ mod tests {
             MockRuntime::register_metrics(vec![], None),
             rx,
             event_handle.clone(),
+            BufferPool::new(MockRuntime::register_metrics(vec![], None)),
         );
 
         let (router_id, message) = tunnel.handle_tunnel_data(&parsed).unwrap().next().unwrap();
@@ -634,6 +643,7 @@ mod tests {
             MockRuntime::register_metrics(vec![], None),
             rx,
             event_handle.clone(),
+            BufferPool::new(MockRuntime::register_metrics(vec![], None)),
         );
         assert!(tunnel.handle_tunnel_data(&parsed).unwrap().collect::<Vec<_>>().is_empty());
     }
@@ -737,6 +747,7 @@ mod tests {
             MockRuntime::register_metrics(vec![], None),
             rx,
             event_handle.clone(),
+            BufferPool::new(MockRuntime::register_metrics(vec![], None)),
         );
 
         let (_to_router, messages) = obgw.send_to_router(obep_router_id.clone(), message);
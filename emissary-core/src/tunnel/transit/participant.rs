@@ -19,6 +19,7 @@
 use crate::{
     events::EventHandle,
     i2np::{tunnel::data::EncryptedTunnelData, Message, MessageBuilder, MessageType},
+    pool::{BufferPool, TUNNEL_BUFFER_SIZE},
     primitives::{RouterId, TunnelId},
     runtime::Runtime,
     tunnel::{
@@ -28,7 +29,7 @@ use crate::{
     },
 };
 
-use bytes::{BufMut, BytesMut};
+use bytes::BufMut;
 use futures::FutureExt;
 use rand_core::RngCore;
 
@@ -49,6 +50,9 @@ const LOG_TARGET: &str = "emissary::tunnel::transit::participant";
 /// Only accepts and handles `TunnelData` messages,
 /// all other message types are rejected as invalid.
 pub struct Participant<R: Runtime> {
+    /// Buffer pool.
+    buffer_pool: BufferPool<R>,
+
     /// Event handle.
     event_handle: EventHandle<R>,
 
@@ -100,18 +104,20 @@ impl<R: Runtime> Participant<R> {
         let (ciphertext, iv) = self.tunnel_keys.decrypt_record(tunnel_data);
 
         // tunnel id + iv key + tunnel data payload length
-        let mut out = BytesMut::with_capacity(4 + 16 + ciphertext.len());
+        let mut out = self.buffer_pool.get(4 + 16 + ciphertext.len());
 
         out.put_u32(self.next_tunnel_id.into());
         out.put_slice(&iv);
         out.put_slice(&ciphertext);
 
+        // the message is returned to the pool by the transport once it has been sent
         let message = MessageBuilder::short()
             .with_message_type(MessageType::TunnelData)
             .with_message_id(R::rng().next_u32())
             .with_expiration(R::time_since_epoch() + Duration::from_secs(8))
             .with_payload(&out)
-            .build();
+            .build_with_buffer(self.buffer_pool.get(TUNNEL_BUFFER_SIZE));
+        self.buffer_pool.put(out);
 
         Ok((self.next_router.clone(), message))
     }
@@ -127,8 +133,10 @@ impl<R: Runtime> TransitTunnel<R> for Participant<R> {
         metrics_handle: R::MetricsHandle,
         message_rx: Receiver<Message>,
         event_handle: EventHandle<R>,
+        buffer_pool: BufferPool<R>,
     ) -> Self {
         Participant {
+            buffer_pool,
             event_handle,
             expiration_timer: R::timer(TRANSIT_TUNNEL_EXPIRATION),
             bandwidth: 0usize,
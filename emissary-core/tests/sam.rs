@@ -101,6 +101,7 @@ async fn make_router(
             tcp_port: 0u16,
             udp_port: 0u16,
             host: "127.0.0.1".to_string(),
+            unix_socket: None,
         }),
         transit: Some(TransitConfig {
             max_tunnels: Some(5000),
@@ -1662,6 +1663,7 @@ async fn host_lookup(kind: TransportKind) {
             tcp_port: 0u16,
             udp_port: 0u16,
             host: "127.0.0.1".to_string(),
+            unix_socket: None,
         }),
         ..Default::default()
     };
@@ -19,7 +19,8 @@
 use async_std::net;
 use emissary_core::runtime::{
     AsyncRead, AsyncWrite, Counter, Gauge, Histogram, Instant as InstantT, JoinSet, MetricType,
-    MetricsHandle, Runtime as RuntimeT, TcpListener, TcpStream, UdpSocket,
+    MetricsHandle, Runtime as RuntimeT, TcpListener, TcpStream, UdpSocket, UnixListener,
+    UnixStream,
 };
 use flate2::{
     write::{GzDecoder, GzEncoder},
@@ -33,6 +34,9 @@ use futures::{
 };
 use rand_core::{CryptoRng, RngCore};
 
+#[cfg(unix)]
+use super::unix::{self, SocketFile};
+
 #[cfg(feature = "metrics")]
 use metrics::{counter, describe_counter, describe_gauge, describe_histogram, gauge, histogram};
 #[cfg(feature = "metrics")]
@@ -40,7 +44,7 @@ use metrics_exporter_prometheus::{Matcher, PrometheusBuilder};
 
 use std::{
     future::Future,
-    io::Write,
+    io::{IoSlice, Write},
     net::SocketAddr,
     pin::{pin, Pin},
     task::{Context, Poll, Waker},
@@ -50,6 +54,9 @@ use std::{
 /// Logging targer for the file.
 const LOG_TARGET: &str = "emissary::runtime::async-std";
 
+/// Maximum number of buffers passed to a single vectored write.
+const MAX_IO_SLICES: usize = 4usize;
+
 #[derive(Clone)]
 pub struct Runtime {}
 
@@ -104,6 +111,27 @@ impl AsyncWrite for AsyncStdTcpStream {
         }
     }
 
+    #[inline]
+    fn poll_write_vectored(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        bufs: &[&[u8]],
+    ) -> Poll<emissary_core::Result<usize>> {
+        let mut slices = [IoSlice::new(&[]); MAX_IO_SLICES];
+        let num_slices = bufs.len().min(MAX_IO_SLICES);
+
+        for (slice, buf) in slices.iter_mut().zip(bufs) {
+            *slice = IoSlice::new(buf);
+        }
+
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_write_vectored(cx, &slices[..num_slices])) {
+            Ok(nwritten) => Poll::Ready(Ok(nwritten)),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+
     #[inline]
     fn poll_flush(
         mut self: Pin<&mut Self>,
@@ -216,6 +244,173 @@ impl TcpListener<AsyncStdTcpStream> for AsyncStdTcpListener {
     }
 }
 
+#[cfg(unix)]
+pub struct AsyncStdUnixStream(async_std::os::unix::net::UnixStream);
+
+#[cfg(unix)]
+impl AsyncRead for AsyncStdUnixStream {
+    #[inline]
+    fn poll_read(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &mut [u8],
+    ) -> Poll<emissary_core::Result<usize>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_read(cx, buf)) {
+            Ok(nread) => Poll::Ready(Ok(nread)),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+}
+
+#[cfg(unix)]
+impl AsyncWrite for AsyncStdUnixStream {
+    #[inline]
+    fn poll_write(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &[u8],
+    ) -> Poll<emissary_core::Result<usize>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_write(cx, buf)) {
+            Ok(nwritten) => Poll::Ready(Ok(nwritten)),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+
+    #[inline]
+    fn poll_write_vectored(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        bufs: &[&[u8]],
+    ) -> Poll<emissary_core::Result<usize>> {
+        let mut slices = [IoSlice::new(&[]); MAX_IO_SLICES];
+        let num_slices = bufs.len().min(MAX_IO_SLICES);
+
+        for (slice, buf) in slices.iter_mut().zip(bufs) {
+            *slice = IoSlice::new(buf);
+        }
+
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_write_vectored(cx, &slices[..num_slices])) {
+            Ok(nwritten) => Poll::Ready(Ok(nwritten)),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+
+    #[inline]
+    fn poll_flush(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+    ) -> Poll<emissary_core::Result<()>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_flush(cx)) {
+            Ok(()) => Poll::Ready(Ok(())),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+
+    #[inline]
+    fn poll_close(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+    ) -> Poll<emissary_core::Result<()>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_close(cx)) {
+            Ok(()) => Poll::Ready(Ok(())),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+}
+
+#[cfg(unix)]
+impl UnixStream for AsyncStdUnixStream {}
+
+#[cfg(not(unix))]
+impl UnixStream for AsyncStdTcpStream {}
+
+/// Unix domain socket listener.
+///
+/// The socket file is removed when the listener is dropped.
+#[cfg(unix)]
+pub struct AsyncStdUnixListener(
+    BoxStream<'static, async_std::io::Result<async_std::os::unix::net::UnixStream>>,
+    SocketFile,
+);
+
+#[cfg(unix)]
+impl UnixListener<AsyncStdUnixStream> for AsyncStdUnixListener {
+    async fn bind(path: &str) -> Option<Self> {
+        // remove socket left behind by a previous run but refuse to touch a socket that is still
+        // in use or any other file
+        if !unix::remove_stale_socket(path) {
+            return None;
+        }
+
+        async_std::os::unix::net::UnixListener::bind(path)
+            .await
+            .map_err(|error| {
+                tracing::debug!(
+                    target: LOG_TARGET,
+                    %path,
+                    ?error,
+                    "failed to bind unix domain socket"
+                );
+            })
+            .ok()
+            .map(|listener| {
+                AsyncStdUnixListener(
+                    Box::pin(futures::stream::unfold(listener, |listener| async move {
+                        let result = listener.accept().await.map(|(stream, _)| stream);
+
+                        Some((result, listener))
+                    })),
+                    SocketFile::new(path),
+                )
+            })
+    }
+
+    fn poll_accept(&mut self, cx: &mut Context<'_>) -> Poll<Option<AsyncStdUnixStream>> {
+        match futures::ready!(self.0.poll_next_unpin(cx)) {
+            Some(Ok(stream)) => Poll::Ready(Some(AsyncStdUnixStream(stream))),
+            Some(Err(error)) => {
+                tracing::warn!(
+                    target: LOG_TARGET,
+                    ?error,
+                    "failed to accept unix domain socket connection",
+                );
+                Poll::Ready(None)
+            }
+            None => Poll::Ready(None),
+        }
+    }
+}
+
+#[cfg(not(unix))]
+pub struct AsyncStdUnixListener(());
+
+#[cfg(not(unix))]
+impl UnixListener<AsyncStdTcpStream> for AsyncStdUnixListener {
+    async fn bind(path: &str) -> Option<Self> {
+        tracing::warn!(
+            target: LOG_TARGET,
+            %path,
+            "unix domain sockets are not supported on this platform",
+        );
+
+        None
+    }
+
+    fn poll_accept(&mut self, _cx: &mut Context<'_>) -> Poll<Option<AsyncStdTcpStream>> {
+        Poll::Pending
+    }
+}
+
 pub struct AsyncStdUdpSocket {
     dgram_tx: Sender<(Vec<u8>, SocketAddr)>,
     dgram_rx: Receiver<(Vec<u8>, SocketAddr)>,
@@ -508,6 +703,11 @@ impl RuntimeT for Runtime {
     type TcpStream = AsyncStdTcpStream;
     type UdpSocket = AsyncStdUdpSocket;
     type TcpListener = AsyncStdTcpListener;
+    #[cfg(unix)]
+    type UnixStream = AsyncStdUnixStream;
+    #[cfg(not(unix))]
+    type UnixStream = AsyncStdTcpStream;
+    type UnixListener = AsyncStdUnixListener;
     type JoinSet<T: Send + 'static> = AsyncStdJoinSet<T>;
     type MetricsHandle = AsyncStdMetricsHandle;
     type Instant = AsyncStdInstant;
@@ -609,3 +809,26 @@ impl RuntimeT for Runtime {
         e.finish().ok()
     }
 }
+
+#[cfg(all(test, unix))]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn unix_listener_replaces_stale_socket_and_removes_it_on_drop() {
+        async_std::task::block_on(async {
+            let dir = tempfile::tempdir().unwrap();
+            let path = dir.path().join("i2cp.sock");
+            let path = path.to_str().unwrap();
+
+            // socket file left behind by a previous run
+            drop(std::os::unix::net::UnixListener::bind(path).unwrap());
+
+            let listener = AsyncStdUnixListener::bind(path).await.unwrap();
+            assert!(AsyncStdUnixListener::bind(path).await.is_none());
+
+            drop(listener);
+            assert!(!std::path::Path::new(path).exists());
+        });
+    }
+}
@@ -21,3 +21,6 @@ pub mod tokio;
 
 #[cfg(feature = "async-std")]
 pub mod async_std;
+
+#[cfg(all(unix, any(feature = "tokio", feature = "async-std")))]
+mod unix;
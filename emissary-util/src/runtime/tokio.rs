@@ -18,7 +18,8 @@
 
 use emissary_core::runtime::{
     AsyncRead, AsyncWrite, Counter, Gauge, Histogram, Instant as InstantT, JoinSet, MetricType,
-    MetricsHandle, Runtime as RuntimeT, TcpListener, TcpStream, UdpSocket,
+    MetricsHandle, Runtime as RuntimeT, TcpListener, TcpStream, UdpSocket, UnixListener,
+    UnixStream,
 };
 use flate2::{
     write::{GzDecoder, GzEncoder},
@@ -29,6 +30,9 @@ use rand_core::{CryptoRng, RngCore};
 use tokio::{io::ReadBuf, net, task, time::Sleep};
 use tokio_util::compat::{Compat, TokioAsyncReadCompatExt, TokioAsyncWriteCompatExt};
 
+#[cfg(unix)]
+use super::unix::{self, SocketFile};
+
 #[cfg(feature = "metrics")]
 use metrics::{counter, describe_counter, describe_gauge, describe_histogram, gauge, histogram};
 #[cfg(feature = "metrics")]
@@ -36,7 +40,7 @@ use metrics_exporter_prometheus::{Matcher, PrometheusBuilder};
 
 use std::{
     future::Future,
-    io::Write,
+    io::{IoSlice, Write},
     net::SocketAddr,
     pin::{pin, Pin},
     task::{Context, Poll, Waker},
@@ -46,6 +50,9 @@ use std::{
 /// Logging targer for the file.
 const LOG_TARGET: &str = "emissary::runtime::tokio";
 
+/// Maximum number of buffers passed to a single vectored write.
+const MAX_IO_SLICES: usize = 4usize;
+
 #[derive(Default, Clone)]
 pub struct Runtime {}
 
@@ -97,6 +104,27 @@ impl AsyncWrite for TokioTcpStream {
         }
     }
 
+    #[inline]
+    fn poll_write_vectored(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        bufs: &[&[u8]],
+    ) -> Poll<emissary_core::Result<usize>> {
+        let mut slices = [IoSlice::new(&[]); MAX_IO_SLICES];
+        let num_slices = bufs.len().min(MAX_IO_SLICES);
+
+        for (slice, buf) in slices.iter_mut().zip(bufs) {
+            *slice = IoSlice::new(buf);
+        }
+
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_write_vectored(cx, &slices[..num_slices])) {
+            Ok(nwritten) => Poll::Ready(Ok(nwritten)),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+
     #[inline]
     fn poll_flush(
         mut self: Pin<&mut Self>,
@@ -199,6 +227,162 @@ impl TcpListener<TokioTcpStream> for TokioTcpListener {
     }
 }
 
+#[cfg(unix)]
+pub struct TokioUnixStream(Compat<net::UnixStream>);
+
+#[cfg(unix)]
+impl TokioUnixStream {
+    fn new(stream: net::UnixStream) -> Self {
+        let stream = TokioAsyncReadCompatExt::compat(stream).into_inner();
+        let stream = TokioAsyncWriteCompatExt::compat_write(stream);
+
+        Self(stream)
+    }
+}
+
+#[cfg(unix)]
+impl AsyncRead for TokioUnixStream {
+    #[inline]
+    fn poll_read(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &mut [u8],
+    ) -> Poll<emissary_core::Result<usize>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_read(cx, buf)) {
+            Ok(nread) => Poll::Ready(Ok(nread)),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+}
+
+#[cfg(unix)]
+impl AsyncWrite for TokioUnixStream {
+    #[inline]
+    fn poll_write(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        buf: &[u8],
+    ) -> Poll<emissary_core::Result<usize>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_write(cx, buf)) {
+            Ok(nwritten) => Poll::Ready(Ok(nwritten)),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+
+    #[inline]
+    fn poll_write_vectored(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        bufs: &[&[u8]],
+    ) -> Poll<emissary_core::Result<usize>> {
+        let mut slices = [IoSlice::new(&[]); MAX_IO_SLICES];
+        let num_slices = bufs.len().min(MAX_IO_SLICES);
+
+        for (slice, buf) in slices.iter_mut().zip(bufs) {
+            *slice = IoSlice::new(buf);
+        }
+
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_write_vectored(cx, &slices[..num_slices])) {
+            Ok(nwritten) => Poll::Ready(Ok(nwritten)),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+
+    #[inline]
+    fn poll_flush(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+    ) -> Poll<emissary_core::Result<()>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_flush(cx)) {
+            Ok(()) => Poll::Ready(Ok(())),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+
+    #[inline]
+    fn poll_close(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+    ) -> Poll<emissary_core::Result<()>> {
+        let pinned = pin!(&mut self.0);
+
+        match futures::ready!(pinned.poll_close(cx)) {
+            Ok(()) => Poll::Ready(Ok(())),
+            Err(error) => Poll::Ready(Err(emissary_core::Error::Custom(error.to_string()))),
+        }
+    }
+}
+
+#[cfg(unix)]
+impl UnixStream for TokioUnixStream {}
+
+#[cfg(not(unix))]
+impl UnixStream for TokioTcpStream {}
+
+/// Unix domain socket listener.
+///
+/// The socket file is removed when the listener is dropped.
+#[cfg(unix)]
+pub struct TokioUnixListener(net::UnixListener, SocketFile);
+
+#[cfg(unix)]
+impl UnixListener<TokioUnixStream> for TokioUnixListener {
+    async fn bind(path: &str) -> Option<Self> {
+        // remove socket left behind by a previous run but refuse to touch a socket that is still
+        // in use or any other file
+        if !unix::remove_stale_socket(path) {
+            return None;
+        }
+
+        net::UnixListener::bind(path)
+            .map_err(|error| {
+                tracing::debug!(
+                    target: LOG_TARGET,
+                    %path,
+                    error = ?error.kind(),
+                    "failed to bind unix domain socket"
+                );
+            })
+            .ok()
+            .map(|listener| TokioUnixListener(listener, SocketFile::new(path)))
+    }
+
+    fn poll_accept(&mut self, cx: &mut Context<'_>) -> Poll<Option<TokioUnixStream>> {
+        match futures::ready!(self.0.poll_accept(cx)) {
+            Err(_) => Poll::Ready(None),
+            Ok((stream, _)) => Poll::Ready(Some(TokioUnixStream::new(stream))),
+        }
+    }
+}
+
+#[cfg(not(unix))]
+pub struct TokioUnixListener(());
+
+#[cfg(not(unix))]
+impl UnixListener<TokioTcpStream> for TokioUnixListener {
+    async fn bind(path: &str) -> Option<Self> {
+        tracing::warn!(
+            target: LOG_TARGET,
+            %path,
+            "unix domain sockets are not supported on this platform",
+        );
+
+        None
+    }
+
+    fn poll_accept(&mut self, _cx: &mut Context<'_>) -> Poll<Option<TokioTcpStream>> {
+        Poll::Pending
+    }
+}
+
 pub struct TokioUdpSocket(net::UdpSocket);
 
 impl UdpSocket for TokioUdpSocket {
@@ -366,6 +550,11 @@ impl RuntimeT for Runtime {
     type TcpStream = TokioTcpStream;
     type UdpSocket = TokioUdpSocket;
     type TcpListener = TokioTcpListener;
+    #[cfg(unix)]
+    type UnixStream = TokioUnixStream;
+    #[cfg(not(unix))]
+    type UnixStream = TokioTcpStream;
+    type UnixListener = TokioUnixListener;
     type JoinSet<T: Send + 'static> = TokioJoinSet<T>;
     type MetricsHandle = TokioMetricsHandle;
     type Instant = TokioInstant;
@@ -478,3 +667,63 @@ impl RuntimeT for Runtime {
         e.finish().ok()
     }
 }
+
+#[cfg(all(test, unix))]
+mod tests {
+    use super::*;
+
+    async fn accept(listener: &mut TokioUnixListener) -> TokioUnixStream {
+        futures::future::poll_fn(|cx| listener.poll_accept(cx)).await.unwrap()
+    }
+
+    #[tokio::test]
+    async fn unix_listener_replaces_stale_socket() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+        let path = path.to_str().unwrap();
+
+        // socket file left behind by a previous run
+        drop(std::os::unix::net::UnixListener::bind(path).unwrap());
+
+        let mut listener = TokioUnixListener::bind(path).await.unwrap();
+        let (_stream, client) = tokio::join!(accept(&mut listener), net::UnixStream::connect(path));
+        assert!(client.is_ok());
+    }
+
+    #[tokio::test]
+    async fn unix_listener_keeps_live_socket() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+        let path = path.to_str().unwrap();
+
+        let mut listener = TokioUnixListener::bind(path).await.unwrap();
+        assert!(TokioUnixListener::bind(path).await.is_none());
+
+        // the first listener still owns the socket, starting with the probe connection
+        let _probe = accept(&mut listener).await;
+        let (_stream, client) = tokio::join!(accept(&mut listener), net::UnixStream::connect(path));
+        assert!(client.is_ok());
+    }
+
+    #[tokio::test]
+    async fn unix_listener_keeps_non_socket_file() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+        std::fs::write(&path, b"hello, world").unwrap();
+
+        assert!(TokioUnixListener::bind(path.to_str().unwrap()).await.is_none());
+        assert_eq!(std::fs::read(&path).unwrap(), b"hello, world");
+    }
+
+    #[tokio::test]
+    async fn unix_socket_removed_on_drop() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+
+        let listener = TokioUnixListener::bind(path.to_str().unwrap()).await.unwrap();
+        assert!(path.exists());
+
+        drop(listener);
+        assert!(!path.exists());
+    }
+}
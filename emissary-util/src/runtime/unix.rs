@@ -0,0 +1,201 @@
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//! Unix domain socket file handling shared by the runtimes.
+
+use std::{
+    io::ErrorKind,
+    os::unix::{
+        fs::{FileTypeExt, MetadataExt},
+        net::UnixStream,
+    },
+    path::PathBuf,
+};
+
+/// Logging target for the file.
+const LOG_TARGET: &str = "emissary::runtime::unix";
+
+/// Remove a stale Unix domain socket file at `path`, if there is one.
+///
+/// A socket file is stale if connecting to it is refused, meaning the process that bound it has
+/// exited without removing it. A socket that accepts the connection belongs to a live listener and
+/// is left alone, as is any file that isn't a socket.
+///
+/// Returns `true` if `path` is free to be bound.
+pub fn remove_stale_socket(path: &str) -> bool {
+    let Ok(metadata) = std::fs::symlink_metadata(path) else {
+        return true;
+    };
+
+    if !metadata.file_type().is_socket() {
+        tracing::warn!(
+            target: LOG_TARGET,
+            %path,
+            "refusing to replace non-socket file with unix domain socket",
+        );
+        return false;
+    }
+
+    match UnixStream::connect(path) {
+        Ok(_) => {
+            tracing::warn!(
+                target: LOG_TARGET,
+                %path,
+                "unix domain socket is in use by another process",
+            );
+            false
+        }
+        Err(error) if error.kind() == ErrorKind::ConnectionRefused => {
+            tracing::debug!(
+                target: LOG_TARGET,
+                %path,
+                "removing stale unix domain socket",
+            );
+
+            std::fs::remove_file(path)
+                .map_err(|error| {
+                    tracing::warn!(
+                        target: LOG_TARGET,
+                        %path,
+                        error = ?error.kind(),
+                        "failed to remove stale unix domain socket",
+                    );
+                })
+                .is_ok()
+        }
+        Err(error) => {
+            tracing::warn!(
+                target: LOG_TARGET,
+                %path,
+                error = ?error.kind(),
+                "failed to check if unix domain socket is in use",
+            );
+            false
+        }
+    }
+}
+
+/// Socket file of a bound Unix domain socket listener.
+///
+/// The file is removed when the listener is dropped, unless another file has replaced it since.
+pub struct SocketFile {
+    /// Path of the socket file.
+    path: PathBuf,
+
+    /// Device and inode numbers of the socket file.
+    id: Option<(u64, u64)>,
+}
+
+impl SocketFile {
+    /// Create new [`SocketFile`] for the socket that was just bound at `path`.
+    pub fn new(path: &str) -> Self {
+        Self {
+            path: PathBuf::from(path),
+            id: std::fs::symlink_metadata(path)
+                .ok()
+                .map(|metadata| (metadata.dev(), metadata.ino())),
+        }
+    }
+}
+
+impl Drop for SocketFile {
+    fn drop(&mut self) {
+        let Ok(metadata) = std::fs::symlink_metadata(&self.path) else {
+            return;
+        };
+
+        if self.id == Some((metadata.dev(), metadata.ino())) {
+            let _ = std::fs::remove_file(&self.path);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::os::unix::net::UnixListener;
+
+    #[test]
+    fn missing_path_can_be_bound() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+
+        assert!(remove_stale_socket(path.to_str().unwrap()));
+    }
+
+    #[test]
+    fn stale_socket_is_removed() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+
+        // listener is closed but the socket file is left behind
+        drop(UnixListener::bind(&path).unwrap());
+        assert!(path.exists());
+
+        assert!(remove_stale_socket(path.to_str().unwrap()));
+        assert!(!path.exists());
+    }
+
+    #[test]
+    fn live_socket_is_kept() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+        let listener = UnixListener::bind(&path).unwrap();
+
+        assert!(!remove_stale_socket(path.to_str().unwrap()));
+        assert!(path.exists());
+
+        // the listener still owns the socket and receives the probe connection
+        assert!(listener.accept().is_ok());
+    }
+
+    #[test]
+    fn non_socket_file_is_kept() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+        std::fs::write(&path, b"hello, world").unwrap();
+
+        assert!(!remove_stale_socket(path.to_str().unwrap()));
+        assert_eq!(std::fs::read(&path).unwrap(), b"hello, world");
+    }
+
+    #[test]
+    fn socket_file_removed_on_drop() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+        let _listener = UnixListener::bind(&path).unwrap();
+
+        drop(SocketFile::new(path.to_str().unwrap()));
+        assert!(!path.exists());
+    }
+
+    #[test]
+    fn replaced_socket_file_is_kept() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("i2cp.sock");
+        let _listener1 = UnixListener::bind(&path).unwrap();
+        let file = SocketFile::new(path.to_str().unwrap());
+
+        // another listener takes over the path while the original socket file still exists
+        std::fs::rename(&path, dir.path().join("old.sock")).unwrap();
+        let _listener2 = UnixListener::bind(&path).unwrap();
+
+        drop(file);
+        assert!(path.exists());
+    }
+}